@@ -8,12 +8,176 @@
 
 #include "lcd.hpp"
 
+#if __LCD_ASYNC_TIMER1
+#include <avr/interrupt.h>
+
+LCD *LCD::_async_lcd = NULL;
+
+ISR(TIMER1_COMPA_vect)
+{
+	_lcd_async_timer_isr();
+}
+#endif
+
+/*Lookup tables stay in flash on AVR (read with pgm_read_*())*/
+#if defined(__AVR__)
+#define __LCD_PROGMEM PROGMEM
+#define __LCD_PGM_READ_U8(p) pgm_read_byte(p)
+#define __LCD_PGM_READ_U16(p) pgm_read_word(p)
+#define __LCD_PGM_READ_U32(p) pgm_read_dword(p)
+#else
+#define __LCD_PROGMEM
+#define __LCD_PGM_READ_U8(p) (*(p))
+#define __LCD_PGM_READ_U16(p) (*(p))
+#define __LCD_PGM_READ_U32(p) (*(p))
+#endif
+
+/*
+ * Character generator ROM: code points [first, first + len) are shown by character codes [code, code + len).
+ * Sorted by code point, for a binary search.
+ */
+
+struct _lcd_rom_range {
+	uint16_t first;
+	uint8_t len;
+	uint8_t code;
+};
+
+#if LCD_CFG_ROM_CODE == LCD_ROM_CODE_A00
+static constexpr struct _lcd_rom_range _lcd_rom_ranges[] __LCD_PROGMEM = {
+	{0x0020, 60, 0x20},		/*' ' to '[' (0x5c is the yen sign)*/
+	{0x005d, 33, 0x5d},		/*']' to '}' (0x7e and 0x7f are arrows)*/
+	{0x00a0, 1, 0x20},		/*no-break space*/
+	{0x00a2, 1, 0xec},		/*cent sign*/
+	{0x00a3, 1, 0xed},		/*pound sign*/
+	{0x00a5, 1, 0x5c},		/*yen sign*/
+	{0x00b0, 1, 0xdf},		/*degree sign*/
+	{0x00b5, 1, 0xe4},		/*micro sign*/
+	{0x00b7, 1, 0xa5},		/*middle dot*/
+	{0x00e4, 1, 0xe1},		/*latin small letter a with diaeresis*/
+	{0x00f1, 1, 0xee},		/*latin small letter n with tilde*/
+	{0x00f6, 1, 0xef},		/*latin small letter o with diaeresis*/
+	{0x00f7, 1, 0xfd},		/*division sign*/
+	{0x00fc, 1, 0xf5},		/*latin small letter u with diaeresis*/
+	{0x03a3, 1, 0xf6},		/*greek capital letter sigma*/
+	{0x03a9, 1, 0xf4},		/*greek capital letter omega*/
+	{0x03b1, 1, 0xe0},		/*greek small letter alpha*/
+	{0x03b2, 1, 0xe2},		/*greek small letter beta*/
+	{0x03b5, 1, 0xe3},		/*greek small letter epsilon*/
+	{0x03b8, 1, 0xf2},		/*greek small letter theta*/
+	{0x03bc, 1, 0xe4},		/*greek small letter mu*/
+	{0x03c0, 1, 0xf7},		/*greek small letter pi*/
+	{0x03c1, 1, 0xe6},		/*greek small letter rho*/
+	{0x03c3, 1, 0xe5},		/*greek small letter sigma*/
+	{0x2126, 1, 0xf4},		/*ohm sign*/
+	{0x2190, 1, 0x7f},		/*leftwards arrow*/
+	{0x2192, 1, 0x7e},		/*rightwards arrow*/
+	{0x221a, 1, 0xe8},		/*square root*/
+	{0x221e, 1, 0xf3},		/*infinity*/
+	{0x2588, 1, 0xff},		/*full block*/
+	{0x4e07, 1, 0xfb},		/*cjk unified ideograph-4e07*/
+	{0x5186, 1, 0xfc},		/*cjk unified ideograph-5186*/
+	{0x5343, 1, 0xfa},		/*cjk unified ideograph-5343*/
+	{0xff61, 63, 0xa1}		/*half-width katakana*/
+};
+#elif LCD_CFG_ROM_CODE == LCD_ROM_CODE_A02
+static constexpr struct _lcd_rom_range _lcd_rom_ranges[] __LCD_PROGMEM = {
+	{0x0020, 95, 0x20},		/*' ' to '~'*/
+	{0x00a0, 1, 0x20},		/*no-break space*/
+	{0x00a1, 7, 0xa1},		/*inverted exclamation mark to section sign*/
+	{0x00a9, 3, 0xa9},		/*copyright sign to left guillemet*/
+	{0x00ae, 1, 0xae},		/*registered sign*/
+	{0x00b0, 4, 0xb0},		/*degree sign to superscript three*/
+	{0x00b5, 3, 0xb5},		/*micro sign to middle dot*/
+	{0x00b9, 7, 0xb9},		/*superscript one to inverted question mark*/
+	{0x00c0, 64, 0xc0},		/*Latin-1 letters (A grave to y diaeresis)*/
+	{0x0192, 1, 0xa8},		/*latin small letter f with hook*/
+	{0x0393, 1, 0x92},		/*greek capital letter gamma*/
+	{0x0398, 1, 0x99},		/*greek capital letter theta*/
+	{0x03a3, 1, 0x94},		/*greek capital letter sigma*/
+	{0x03a9, 1, 0x9a},		/*greek capital letter omega*/
+	{0x03b1, 1, 0x90},		/*greek small letter alpha*/
+	{0x03b4, 1, 0x9b},		/*greek small letter delta*/
+	{0x03b5, 1, 0x9e},		/*greek small letter epsilon*/
+	{0x03c0, 1, 0x93},		/*greek small letter pi*/
+	{0x03c3, 1, 0x95},		/*greek small letter sigma*/
+	{0x03c4, 1, 0x97},		/*greek small letter tau*/
+	{0x03c9, 1, 0xb8},		/*greek small letter omega*/
+	{0x0411, 1, 0x80},		/*cyrillic capital letter be*/
+	{0x0414, 1, 0x81},		/*cyrillic capital letter de*/
+	{0x0416, 4, 0x82},		/*Cyrillic ZHE to SHORT I*/
+	{0x041b, 1, 0x86},		/*cyrillic capital letter el*/
+	{0x041f, 1, 0x87},		/*cyrillic capital letter pe*/
+	{0x0423, 1, 0x88},		/*cyrillic capital letter u*/
+	{0x0426, 6, 0x89},		/*Cyrillic TSE to YERU*/
+	{0x042d, 1, 0x8f},		/*cyrillic capital letter e*/
+	{0x042e, 2, 0xac},		/*Cyrillic YU and YA*/
+	{0x2018, 1, 0xaf},		/*left single quotation mark*/
+	{0x201c, 2, 0x12},		/*double quotation marks*/
+	{0x20a7, 1, 0xb4},		/*peseta sign*/
+	{0x2126, 1, 0x9a},		/*ohm sign*/
+	{0x2190, 1, 0x1b},		/*leftwards arrow*/
+	{0x2191, 1, 0x18},		/*upwards arrow*/
+	{0x2192, 1, 0x1a},		/*rightwards arrow*/
+	{0x2193, 1, 0x19},		/*downwards arrow*/
+	{0x21b5, 1, 0x17},		/*downwards arrow with corner leftwards*/
+	{0x221e, 1, 0x9c},		/*infinity*/
+	{0x2229, 1, 0x9f},		/*intersection*/
+	{0x2264, 2, 0x1c},		/*less-than or equal, greater-than or equal*/
+	{0x2302, 1, 0x7f},		/*house*/
+	{0x25b2, 1, 0x1e},		/*black up-pointing triangle*/
+	{0x25b6, 1, 0x10},		/*black right-pointing triangle*/
+	{0x25bc, 1, 0x1f},		/*black down-pointing triangle*/
+	{0x25c0, 1, 0x11},		/*black left-pointing triangle*/
+	{0x25cf, 1, 0x16},		/*black circle*/
+	{0x2665, 1, 0x9d},		/*black heart suit*/
+	{0x266a, 1, 0x91},		/*eighth note*/
+	{0x266c, 1, 0x96}		/*beamed sixteenth notes*/
+};
+#else
+#error "LCD_CFG_ROM_CODE: unknown character ROM"
+#endif
+
+static constexpr uint8_t _LCD_ROM_N_RANGES = (sizeof(_lcd_rom_ranges)/sizeof(struct _lcd_rom_range));
+
+/*UTF-8 lead bytes 0x80-0xff by bits 6-3: sequence length (0: continuation byte or 0xf8-0xff, invalid as a lead byte)*/
+static constexpr uint8_t _lcd_utf8_len[16] __LCD_PROGMEM = {0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 2u, 2u, 2u, 2u, 3u, 3u, 4u, 0u};
+
+/*Smallest code point of each sequence length (longer encodings are malformed)*/
+static constexpr uint32_t _lcd_utf8_min[5] __LCD_PROGMEM = {0u, 0u, 0x80u, 0x800u, 0x10000u};
+
 LCD::LCD(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines)
 {
 	this->resetPinout(db4, db5, db6, db7, rs, e);
 	this->resetDisplaySize(nCharsPerLine, nLines);
 }
 
+LCD::LCD(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines)
+{
+	this->resetPinout(db4, db5, db6, db7, rs, rw, e);
+	this->resetDisplaySize(nCharsPerLine, nLines);
+}
+
+LCD::LCD(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines)
+{
+	this->resetPinout(db0, db1, db2, db3, db4, db5, db6, db7, rs, e);
+	this->resetDisplaySize(nCharsPerLine, nLines);
+}
+
+LCD::LCD(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines)
+{
+	this->resetPinout(db0, db1, db2, db3, db4, db5, db6, db7, rs, rw, e);
+	this->resetDisplaySize(nCharsPerLine, nLines);
+}
+
+LCD::LCD(LCDTransport *transport, uint8_t nCharsPerLine, uint8_t nLines)
+{
+	this->resetPinout(this->PIN_NONE, this->PIN_NONE, this->PIN_NONE, this->PIN_NONE, this->PIN_NONE, this->PIN_NONE);
+	this->resetDisplaySize(nCharsPerLine, nLines);
+
+	this->_transport = transport;
+}
+
 LCD::~LCD(void)
 {
 }
@@ -24,12 +188,72 @@ bool LCD::begin(void)
 
 	this->_status = this->STATUS_UNINITIALIZED;
 
+#if LCD_CFG_ASYNC
+	if(this->_async_mode)
+	{
+		this->waitIdle();
+		this->_async_timer_stop();
+		this->_async_mode = false;
+	}
+#endif
+
 	if(!this->_validate_info())
 	{
 		this->_status = this->STATUS_ERROR;
 		return false;
 	}
 
+	this->_load_line_addr_table();
+
+	this->_bf_ok = false;
+	this->_bf_pending_us = 0u;
+
+	this->_ac_pending = this->_AC_UNKNOWN;
+
+#if LCD_CFG_FRAMEBUFFER
+	this->_fb_mode = false;
+	this->_fb_keep = false;
+	this->_fb_idx = 0u;
+	this->_n_skipped = 0u;
+#endif
+#if LCD_CFG_GLYPHS
+	this->_glyphs = NULL;
+	this->_n_glyphs = 0u;
+	this->_glyph_forget_slots();
+	this->resetGlyphStats();
+#endif
+#if LCD_CFG_STATS
+	this->resetStats();
+	this->_stats_call_begin();
+#endif
+#if LCD_CFG_TRACE
+	this->clearTrace();
+#endif
+
+	if(this->_transport != NULL)
+	{
+		if(!this->_transport->begin())
+		{
+			this->_status = this->STATUS_ERROR;
+			return false;
+		}
+
+#if LCD_CFG_TRACE
+		this->_trace_write(this->TRACE_INIT_NIBBLE, 0x2);
+#endif
+		this->_transport->sendInitNibble(0x2, LCD_TIMING_INIT_US);
+
+		/*Default initialization settings*/
+		this->_send_byte(false, 0x28);
+		this->_send_byte(false, 0x01);
+		this->_send_byte(false, 0x80);
+		this->_send_byte(false, 0x0c);
+		this->_transport_flush();
+
+		this->_status = this->STATUS_INITIALIZED;
+		return true;
+	}
+
 	pinMode(this->_info.e, OUTPUT);
 	digitalWrite(this->_info.e, 0);
 
@@ -39,27 +263,94 @@ bool LCD::begin(void)
 	pinMode(this->_info.db6, OUTPUT);
 	pinMode(this->_info.db7, OUTPUT);
 
-	this->_send_init_nibble();
+	if(this->_info.bus_8bit)
+	{
+		pinMode(this->_info.db0, OUTPUT);
+		pinMode(this->_info.db1, OUTPUT);
+		pinMode(this->_info.db2, OUTPUT);
+		pinMode(this->_info.db3, OUTPUT);
+	}
+
+	if(this->_info.rw != this->PIN_NONE)
+	{
+		pinMode(this->_info.rw, OUTPUT);
+		digitalWrite(this->_info.rw, 0);
+	}
+
+	this->_load_port_masks();
 
 	/*Default initialization settings*/
-	this->_send_byte(false, 0x28);
+	if(this->_info.bus_8bit)
+	{
+		this->_send_init_8bit();
+		this->_send_byte(false, 0x38);
+	}
+	else
+	{
+		this->_send_init_nibble();
+		this->_send_byte(false, 0x28);
+	}
+
 	this->_send_byte(false, 0x01);
 	this->_send_byte(false, 0x80);
+
+	/*Busy flag check: once ready, the address counter must read back 0x00. Otherwise keep the timed profile.*/
+	if(this->_info.rw != this->PIN_NONE)
+	{
+		this->_bf_ok = true;
+		this->_wait_ready();
+
+		if(this->_bf_ok)
+		{
+			this->_set_data_dir(INPUT);
+			if(this->_read_bf_ac() != 0x00) this->_bf_ok = false;
+			this->_set_data_dir(OUTPUT);
+		}
+	}
+
 	this->_send_byte(false, 0x0c);
+	this->_transport_flush();
 
 	this->_status = this->STATUS_INITIALIZED;
 	return true;
 }
 
 void LCD::resetPinout(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e)
+{
+	this->resetPinout(db4, db5, db6, db7, rs, this->PIN_NONE, e);
+	return;
+}
+
+void LCD::resetPinout(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e)
+{
+	this->resetPinout(this->PIN_NONE, this->PIN_NONE, this->PIN_NONE, this->PIN_NONE, db4, db5, db6, db7, rs, rw, e);
+	this->_info.bus_8bit = false;
+
+	return;
+}
+
+void LCD::resetPinout(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e)
+{
+	this->resetPinout(db0, db1, db2, db3, db4, db5, db6, db7, rs, this->PIN_NONE, e);
+	return;
+}
+
+void LCD::resetPinout(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e)
 {
 	this->_status = this->STATUS_UNINITIALIZED;
+	this->_transport = NULL;
 
+	this->_info.bus_8bit = true;
+	this->_info.db0 = db0;
+	this->_info.db1 = db1;
+	this->_info.db2 = db2;
+	this->_info.db3 = db3;
 	this->_info.db4 = db4;
 	this->_info.db5 = db5;
 	this->_info.db6 = db6;
 	this->_info.db7 = db7;
 	this->_info.rs = rs;
+	this->_info.rw = rw;
 	this->_info.e = e;
 
 	return;
@@ -98,6 +389,9 @@ bool LCD::setDisplayMode(intptr_t displayMode)
 {
 	if(this->_status < 1) return false;
 
+	/*A visible cursor shows the address counter*/
+	if((displayMode == this->DISPLAYMODE_DISPLAY_ON_CURSOR_ON) || (displayMode == this->DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK)) this->_sync_cursor();
+
 	switch(displayMode)
 	{
 		case this->DISPLAYMODE_DISPLAY_OFF:
@@ -117,6 +411,7 @@ bool LCD::setDisplayMode(intptr_t displayMode)
 			break;
 	}
 
+	this->_transport_flush();
 	return true;
 }
 
@@ -124,7 +419,21 @@ bool LCD::clear(void)
 {
 	if(this->_status < 1) return false;
 
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
+	{
+		uint8_t idx = 0u;
+
+		for(idx = 0u; idx < this->DDRAM_SIZE; idx++) this->_fb_set(idx, ' ');
+
+		this->_fb_idx = 0u;
+		return true;
+	}
+#endif
+
 	this->_send_byte(false, 0x01);
+	this->_transport_flush();
+
 	return true;
 }
 
@@ -132,27 +441,38 @@ bool LCD::home(void)
 {
 	if(this->_status < 1) return false;
 
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
+	{
+		this->_fb_idx = 0u;
+		return true;
+	}
+#endif
+
 	this->_send_byte(false, 0x02);
+	this->_transport_flush();
+
 	return true;
 }
 
 bool LCD::setCursorPosition(uint8_t cx, uint8_t cy)
 {
-	uint8_t num8 = 0u;
+	uint8_t addr = 0u;
 
 	if(this->_status < 1) return false;
 
-	if(!this->_phys_text_cx_cy_to_virt_text_cx_cy(&cx, &cy, cx, cy)) return false;
-
-	if(cy) this->_send_byte(false, 0xc0);
-	else this->_send_byte(false, 0x80);
+	if(!this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, cy)) return false;
 
-	num8 = 0u;
-	while(num8 < cx)
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
 	{
-		this->_send_byte(false, 0x14);
-		num8++;
+		this->_fb_idx = this->_ddram_addr_to_idx(addr);
+		return true;
 	}
+#endif
+
+	this->_send_byte(false, (0x80 | addr));
+	this->_transport_flush();
 
 	return true;
 }
@@ -161,7 +481,9 @@ bool LCD::printChar(char c)
 {
 	if(this->_status < 1) return false;
 
-	this->_send_byte(true, (uint8_t) c);
+	this->_put_char((uint8_t) c);
+	this->_transport_flush();
+
 	return true;
 }
 
@@ -187,120 +509,1889 @@ bool LCD::printText(const char *text, uintptr_t length)
 	n_char = 0u;
 	while(n_char < length)
 	{
-		this->_send_byte(true, (uint8_t) text[n_char]);
+		this->_put_char((uint8_t) text[n_char]);
 		n_char++;
 	}
 
+	this->_transport_flush();
+	return true;
+}
+
+bool LCD::printTextUtf8(const char *text)
+{
+	uintptr_t length = 0u;
+
+	if(this->_status < 1) return false;
+	if(text == NULL) return false;
+
+	while(text[length] != '\0') length++;
+
+	return this->printTextUtf8(text, length);
+}
+
+bool LCD::printTextUtf8(const char *text, uintptr_t length)
+{
+	uintptr_t n_byte = 0u;
+	uint32_t codepoint = 0u;
+
+	if(this->_status < 1) return false;
+	if(text == NULL) return false;
+
+	while(n_byte < length)
+	{
+		n_byte += this->_utf8_decode((const uint8_t*) &(text[n_byte]), (length - n_byte), &codepoint);
+		this->_put_codepoint(codepoint);
+	}
+
+	this->_transport_flush();
 	return true;
 }
 
+bool LCD::printUInt(uint32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return this->_put_number(value, false, 10u, 0u, width, align, pad);
+}
+
+bool LCD::printInt(int32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return this->printFixed(value, 0u, width, align, pad);
+}
+
+bool LCD::printFixed(int32_t value, uint8_t nDecimals, uint8_t width, intptr_t align, char pad)
+{
+	uint32_t magnitude = 0u;
+
+	if(nDecimals > 9u) return false;
+
+	/*-INT32_MIN doesn't fit in an int32_t*/
+	if(value < 0) magnitude = ((uint32_t) (-(value + 1))) + 1u;
+	else magnitude = (uint32_t) value;
+
+	return this->_put_number(magnitude, (value < 0), 10u, nDecimals, width, align, pad);
+}
+
+bool LCD::printHex(uint32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return this->_put_number(value, false, 16u, 0u, width, align, pad);
+}
+
 bool LCD::fillScreenChar(char c)
 {
-	uint8_t n_char = 0u;
+	return this->fillRect(0u, 0u, this->_info.n_chars, this->_info.n_lines, c);
+}
+
+bool LCD::fillRect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c)
+{
+	uint8_t cursor = 0u;
+	uint8_t addr = 0u;
+	uint8_t idx = 0u;
 	uint8_t n_line = 0u;
-	uint8_t n_chars = 0u;
-	uint8_t n_lines = 0u;
+	uint8_t n_char = 0u;
+	bool clear = false;
+
+	if(this->_status < 1) return false;
+	if(!this->_validate_rect(cx, cy, width, height)) return false;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
+	{
+		cursor = this->_fb_idx;
+
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, n_line);
+			this->_fb_idx = this->_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < width; n_char++) this->_fb_write((uint8_t) c);
+		}
+
+		this->_fb_idx = cursor;
+		return true;
+	}
+#endif
+
+	if(this->_ac_pending < this->DDRAM_SIZE) cursor = this->_ac_pending;
+	else cursor = this->_ac;
+
+	this->_plan_fill(cx, cy, width, height, (uint8_t) c, &clear);
+
+	if(clear)
+	{
+#if LCD_CFG_FRAMEBUFFER
+		/*The RAM shadow becomes what the screen must show afterwards, and the clear leaves it in place to be replayed*/
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, n_line);
+			memset(&(this->_fb[this->_ddram_addr_to_idx(addr)]), (uint8_t) c, width);
+		}
+
+		this->_fb_blank_hidden();
+
+		this->_fb_keep = true;
+		this->_send_byte(false, 0x01);
+		this->_fb_keep = false;
+
+		/*Only the cells that aren't blank are sent*/
+		for(n_line = 0u; n_line < this->_info.n_lines; n_line++)
+		{
+			this->_phys_text_cx_cy_to_ddram_addr(&addr, 0u, n_line);
+			idx = this->_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < this->_info.n_chars; n_char++)
+			{
+				if(this->_fb[idx] != ' ')
+				{
+					this->_ac_pending = idx;
+					this->_put_char(this->_fb[idx]);
+				}
+
+				idx = this->_next_idx(idx);
+			}
+		}
+#else
+		this->_send_byte(false, 0x01);
+#endif
+	}
+	else
+	{
+		/*Cell by cell: the address counter is only moved over the cells that don't need sending*/
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, n_line);
+			idx = this->_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < width; n_char++)
+			{
+#if LCD_CFG_FRAMEBUFFER
+				if(this->_fb[idx] == (uint8_t) c)
+				{
+					this->_n_skipped++;
+#if LCD_CFG_STATS
+					this->_stats.nSkipped++;
+#endif
+					idx = this->_next_idx(idx);
+					continue;
+				}
+#endif
+				this->_ac_pending = idx;
+				this->_put_char((uint8_t) c);
+
+				idx = this->_next_idx(idx);
+			}
+		}
+	}
+
+	/*The cursor stays where it was*/
+	this->_ac_pending = cursor;
+	if(this->_display_ctrl & 0x03) this->_sync_cursor();
+
+	this->_transport_flush();
+	return true;
+}
+
+bool LCD::clearLine(uint8_t cy)
+{
+	return this->fillRect(0u, cy, this->_info.n_chars, 1u, ' ');
+}
+
+bool LCD::clearRect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height)
+{
+	return this->fillRect(cx, cy, width, height, ' ');
+}
+
+int32_t LCD::estimateFillRectUs(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c)
+{
+	bool clear = false;
+
+	if(this->_status < 1) return -1;
+	if(!this->_validate_rect(cx, cy, width, height)) return -1;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode) return 0;
+#endif
+
+	return (int32_t) this->_plan_fill(cx, cy, width, height, (uint8_t) c, &clear);
+}
 
+#if LCD_CFG_FRAMEBUFFER
+bool LCD::setFramebufferMode(bool enable)
+{
 	if(this->_status < 1) return false;
 
-	n_chars = this->_info.n_chars;
-	n_lines = this->_info.n_lines;
+	if(enable == this->_fb_mode) return true;
 
-	for(n_line = 0u; n_line < n_lines; n_line++)
+	if(enable)
 	{
-		this->setCursorPosition(0u, n_line);
+		if(this->_ac_pending < this->DDRAM_SIZE) this->_fb_idx = this->_ac_pending;
+		else if(this->_ac < this->DDRAM_SIZE) this->_fb_idx = this->_ac;
+		else this->_fb_idx = 0u;
+
+		this->_ac_pending = this->_AC_UNKNOWN;
 
-		for(n_char = 0u; n_char < n_chars; n_char++)
-			this->_send_byte(true, (uint8_t) c);
+		this->_fb_mode = true;
+		return true;
 	}
 
+	this->flush();
+	this->_fb_mode = false;
+
+	if(this->_ac != this->_fb_idx) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(this->_fb_idx)));
+	this->_transport_flush();
+
 	return true;
 }
 
-void LCD::_send_byte(bool reg, uint8_t byte)
+bool LCD::flush(void)
 {
-	digitalWrite(this->_info.e, 0);
-	digitalWrite(this->_info.rs, reg);
+	uint8_t n_cell = 0u;
+	uint8_t idx = 0u;
 
-	delayMicroseconds(this->_EN_DELAY_US);
+	if(this->_status < 1) return false;
 
-	this->_write_nibble(byte >> 4);
-	digitalWrite(this->_info.e, 1);
-	delayMicroseconds(this->_EN_DELAY_US);
+	/*
+	 * Walk the DDRAM in address counter order, starting from the current address counter,
+	 * so that runs of changed cells (including runs crossing from one display line into the next) cost a single address set.
+	 * Gaps of unchanged cells are skipped with an address set: resending them never beats it, as a data write takes
+	 * longer than an instruction in every timing profile.
+	 */
 
-	digitalWrite(this->_info.e, 0);
-	delayMicroseconds(this->_EN_DELAY_US);
+	if(this->_ac < this->DDRAM_SIZE) idx = this->_ac;
+	else idx = 0u;
 
-	this->_write_nibble(byte & 0xf);
-	digitalWrite(this->_info.e, 1);
-	delayMicroseconds(this->_EN_DELAY_US);
+	for(n_cell = 0u; n_cell < this->DDRAM_SIZE; n_cell++)
+	{
+		if(this->_fb_is_dirty(idx))
+		{
+			if(this->_ac != idx) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(idx)));
 
-	digitalWrite(this->_info.e, 0);
-	delayMicroseconds(this->_CMD_DELAY_US);
+			this->_send_byte(true, this->_fb[idx]);
+		}
+
+		idx = this->_next_idx(idx);
+	}
+
+	/*Keep the visible cursor where the application left it*/
+	if((this->_display_ctrl & 0x03) && (this->_ac != this->_fb_idx)) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(this->_fb_idx)));
+	this->_transport_flush();
+
+	return true;
+}
+
+uintptr_t LCD::getNSkippedBytes(void)
+{
+	return this->_n_skipped;
+}
+
+void LCD::_fb_write(uint8_t byte)
+{
+	if((this->_fb[this->_fb_idx] == byte) || this->_fb_is_dirty(this->_fb_idx))
+	{
+		this->_n_skipped++;
+#if LCD_CFG_STATS
+		this->_stats.nSkipped++;
+#endif
+	}
+
+	this->_fb_set(this->_fb_idx, byte);
+	this->_fb_idx = this->_next_idx(this->_fb_idx);
 
 	return;
 }
 
-void LCD::_write_nibble(uint8_t nibble)
+void LCD::_fb_set(uint8_t idx, uint8_t byte)
 {
-	digitalWrite(this->_info.db7, (nibble & 0x8));
-	digitalWrite(this->_info.db6, (nibble & 0x4));
-	digitalWrite(this->_info.db5, (nibble & 0x2));
-	digitalWrite(this->_info.db4, (nibble & 0x1));
+	if(this->_fb[idx] == byte) return;
+
+	this->_fb[idx] = byte;
+	this->_fb_set_dirty(idx, true);
 
 	return;
 }
 
-void LCD::_send_init_nibble(void)
+bool LCD::_fb_is_dirty(uint8_t idx)
 {
-	digitalWrite(this->_info.e, 0);
-	digitalWrite(this->_info.rs, 0);
+	return ((this->_fb_dirty[idx >> 3] >> (idx & 0x7)) & 0x1);
+}
 
-	delayMicroseconds(this->_EN_DELAY_US);
+void LCD::_fb_set_dirty(uint8_t idx, bool dirty)
+{
+	if(dirty) this->_fb_dirty[idx >> 3] |= (1u << (idx & 0x7));
+	else this->_fb_dirty[idx >> 3] &= ~(1u << (idx & 0x7));
 
-	this->_write_nibble(0x2);
-	digitalWrite(this->_info.e, 1);
-	delayMicroseconds(this->_EN_DELAY_US);
+	return;
+}
 
-	digitalWrite(this->_info.e, 0);
-	delayMicroseconds((this->_CMD_DELAY_US) << 1);
+/*Blanks the shadow cells that no line of the screen shows, as a clear display does*/
+void LCD::_fb_blank_hidden(void)
+{
+	uint8_t idx = 0u;
+	uint8_t start = 0u;
+	uint8_t n_line = 0u;
+	bool shown = false;
+
+	for(idx = 0u; idx < this->DDRAM_SIZE; idx++)
+	{
+		shown = false;
+
+		for(n_line = 0u; n_line < this->_info.n_lines; n_line++)
+		{
+			start = this->_ddram_addr_to_idx(this->_line_addr[n_line]);
+			if((idx >= start) && (idx < (start + this->_info.n_chars))) shown = true;
+		}
+
+		if(!shown) this->_fb[idx] = ' ';
+	}
 
 	return;
 }
+#endif
 
-bool LCD::_validate_info(void)
+#if LCD_CFG_GLYPHS
+bool LCD::setGlyphTable(const LCDGlyph *glyphs, uint16_t nGlyphs)
 {
-	uintptr_t n_byte = 0u;
-	uint8_t *p_info = NULL;
+	if(this->_status < 1) return false;
+	if((glyphs == NULL) && nGlyphs) return false;
+	if(nGlyphs >= this->GLYPH_NONE) return false;
 
-	p_info = (uint8_t*) &(this->_info);
+	this->_glyphs = glyphs;
+	this->_n_glyphs = nGlyphs;
+	this->_glyph_forget_slots();
 
-	for(n_byte = 0u; n_byte < sizeof(struct _lcd_info); n_byte++) if(p_info[n_byte] == 0xff) return false;
+	return true;
+}
 
-	if(!this->_info.n_chars) return false;
-	if(!this->_info.n_lines) return false;
+bool LCD::printGlyph(uint16_t glyphId)
+{
+	if(this->_status < 1) return false;
+	if(glyphId >= this->_n_glyphs) return false;
+
+	if(!this->_put_glyph(glyphId)) return false;
 
+	this->_transport_flush();
 	return true;
 }
 
-bool LCD::_phys_text_cx_cy_to_virt_text_cx_cy(uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy)
+LCDGlyphStats LCD::getGlyphStats(void)
 {
-	uint8_t virtcx = 0u;
-	uint8_t virtcy = 0u;
+	return this->_glyph_stats;
+}
 
-	if(physcx >= this->_info.n_chars) return false;
-	if(physcy >= this->_info.n_lines) return false;
+void LCD::resetGlyphStats(void)
+{
+	memset(&(this->_glyph_stats), 0, sizeof(LCDGlyphStats));
+	return;
+}
 
-	virtcy = (physcy & 0x1);
+bool LCD::_put_glyph(uint16_t glyph_id)
+{
+	uint8_t idx = 0u;
+	uint8_t slot = 0u;
 
-	virtcx = physcx;
+	if(!this->_fb_mode) this->_sync_cursor();
 
-	physcy = (physcy >> 1);
-	if(physcy) virtcx += physcy*(this->_info.n_chars);
+	/*An upload moves the address counter to CGRAM: remember the cell the glyph goes to*/
+	idx = this->_ac;
+	if(!this->_fb_mode && (idx >= this->DDRAM_SIZE)) return false;
 
-	if(p_virtcx != NULL) *p_virtcx = virtcx;
-	if(p_virtcy != NULL) *p_virtcy = virtcy;
+	slot = this->_glyph_acquire(glyph_id);
 
+	if(!this->_fb_mode && (this->_ac != idx)) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(idx)));
+
+	this->_put_char(slot);
 	return true;
 }
 
+uint16_t LCD::_glyph_find(uint32_t codepoint)
+{
+	uint16_t glyph_id = 0u;
+
+	if((codepoint == 0u) || (codepoint > 0xffff)) return this->GLYPH_NONE;
+
+	for(glyph_id = 0u; glyph_id < this->_n_glyphs; glyph_id++)
+	{
+		if(this->_glyphs[glyph_id].codepoint == codepoint) return glyph_id;
+	}
+
+	return this->GLYPH_NONE;
+}
+
+/*
+ * LRU order: _glyph_lru[] lists the slots from the most to the least recently printed.
+ * Empty slots start at the end, lowest slot last, so they are taken from slot 0 up.
+ */
+
+void LCD::_glyph_forget_slots(void)
+{
+	uint8_t n_slot = 0u;
+
+	for(n_slot = 0u; n_slot < this->CGRAM_SLOTS; n_slot++)
+	{
+		this->_glyph_slot_id[n_slot] = this->GLYPH_NONE;
+		this->_glyph_lru[n_slot] = (this->CGRAM_SLOTS - 1u - n_slot);
+	}
+
+	return;
+}
+
+/*Returns the CGRAM slot (character code) holding "glyph_id", uploading it on a miss*/
+uint8_t LCD::_glyph_acquire(uint16_t glyph_id)
+{
+	uint8_t n_lru = 0u;
+	uint8_t slot = 0u;
+	uint16_t old_id = 0u;
+
+	for(n_lru = 0u; n_lru < this->CGRAM_SLOTS; n_lru++)
+	{
+		slot = this->_glyph_lru[n_lru];
+		if(this->_glyph_slot_id[slot] != glyph_id) continue;
+
+		this->_glyph_stats.nHits++;
+		this->_glyph_touch(n_lru);
+		return slot;
+	}
+
+	n_lru = this->CGRAM_SLOTS - 1u;
+	slot = this->_glyph_lru[n_lru];
+	old_id = this->_glyph_slot_id[slot];
+
+	this->_glyph_stats.nMisses++;
+
+	if(old_id != this->GLYPH_NONE)
+	{
+		this->_glyph_stats.nEvictions++;
+		this->_glyph_repaint(slot, (uint8_t) this->_glyphs[old_id].fallback);
+	}
+
+	this->_glyph_upload(slot, &(this->_glyphs[glyph_id]));
+	this->_glyph_slot_id[slot] = glyph_id;
+
+	this->_glyph_touch(n_lru);
+	return slot;
+}
+
+void LCD::_glyph_touch(uint8_t n_lru)
+{
+	uint8_t slot = this->_glyph_lru[n_lru];
+
+	while(n_lru > 0u)
+	{
+		this->_glyph_lru[n_lru] = this->_glyph_lru[n_lru - 1u];
+		n_lru--;
+	}
+
+	this->_glyph_lru[0] = slot;
+	return;
+}
+
+/*
+ * The RAM shadow holds every DDRAM cell (pending ones too in framebuffer mode). Character codes 0x00-0x0f all show CGRAM,
+ * 0x08-0x0f repeating 0x00-0x07 (5x8 font).
+ */
+
+void LCD::_glyph_repaint(uint8_t slot, uint8_t fallback)
+{
+	uint8_t idx = 0u;
+
+	for(idx = 0u; idx < this->DDRAM_SIZE; idx++)
+	{
+		if((this->_fb[idx] >= 0x10) || ((this->_fb[idx] & 0x07) != slot)) continue;
+
+		this->_glyph_stats.nRepaints++;
+
+		if(this->_fb_mode)
+		{
+			this->_fb_set(idx, fallback);
+			continue;
+		}
+
+		if(this->_ac != idx) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(idx)));
+		this->_send_byte(true, fallback);
+	}
+
+	return;
+}
+
+void LCD::_glyph_upload(uint8_t slot, const LCDGlyph *glyph)
+{
+	uint8_t n_row = 0u;
+
+	this->_send_byte(false, (0x40 | (slot << 3)));
+
+	for(n_row = 0u; n_row < 8u; n_row++) this->_send_byte(true, (glyph->rows[n_row] & 0x1f));
+
+	return;
+}
+#endif
+
+#if LCD_CFG_STATS
+LCDStats LCD::getStats(void)
+{
+	return this->_stats;
+}
+
+void LCD::resetStats(void)
+{
+	memset(&(this->_stats), 0, sizeof(LCDStats));
+	this->_stats_in_call = false;
+
+	return;
+}
+
+/*
+ * A call is timed from its first byte sent (or the start of begin()) to its closing transport flush.
+ * Calls that send nothing (framebuffer mode) never block and aren't timed.
+ */
+
+void LCD::_stats_call_begin(void)
+{
+	if(this->_stats_in_call) return;
+
+	this->_stats_in_call = true;
+	this->_stats_t_call = micros();
+
+	return;
+}
+
+void LCD::_stats_call_end(void)
+{
+	uint32_t call_us = 0u;
+
+	if(!this->_stats_in_call) return;
+
+	call_us = (uint32_t) (micros() - this->_stats_t_call);
+	if(call_us > this->_stats.maxCallUs) this->_stats.maxCallUs = call_us;
+
+	this->_stats_in_call = false;
+	return;
+}
+
+void LCD::_stats_count_byte(bool reg, uint8_t byte)
+{
+	this->_stats_call_begin();
+
+	if(reg)
+	{
+		this->_stats.nData++;
+		return;
+	}
+
+	this->_stats.nCmds++;
+	if((byte == 0x01) || ((byte & 0xfe) == 0x02)) this->_stats.nClearHome++;
+
+	return;
+}
+#endif
+
+#if LCD_CFG_TRACE
+uintptr_t LCD::getTrace(LCDTraceEntry *entries, uintptr_t maxEntries)
+{
+	uint8_t head = 0u;
+	uint8_t first = 0u;
+	uint8_t n_entries = 0u;
+	uint8_t n_entry = 0u;
+	uint8_t n_lost = 0u;
+
+	if(entries == NULL) return 0u;
+
+	/*Count first: read before the head, it can only be lower than the number of entries behind it*/
+	n_entries = this->_trace_count;
+	__asm__ __volatile__("" ::: "memory");
+	head = this->_trace_head;
+	__asm__ __volatile__("" ::: "memory");
+
+	if(n_entries > maxEntries) n_entries = (uint8_t) maxEntries;
+
+	first = (uint8_t) (head - n_entries);
+
+	for(n_entry = 0u; n_entry < n_entries; n_entry++) entries[n_entry] = this->_trace[((uint8_t) (first + n_entry)) & this->_TRACE_MASK];
+
+	/*The writer may have moved on during the copy: entries more than LCD_CFG_TRACE_SIZE - 1 behind the new head are (being) overwritten*/
+	__asm__ __volatile__("" ::: "memory");
+	head = this->_trace_head;
+
+	if(((uint8_t) (head - first)) < LCD_CFG_TRACE_SIZE) return n_entries;
+
+	n_lost = ((uint8_t) (head - first)) - (LCD_CFG_TRACE_SIZE - 1u);
+	if(n_lost >= n_entries) return 0u;
+
+	memmove(entries, &(entries[n_lost]), (n_entries - n_lost)*sizeof(LCDTraceEntry));
+
+	return (n_entries - n_lost);
+}
+
+void LCD::clearTrace(void)
+{
+	this->_trace_count = 0u;
+	this->_trace_head = 0u;
+
+	return;
+}
+
+/*
+ * Single producer: the caller (synchronous mode) or the timer interrupt (async mode), never both.
+ * The entry is complete before the head moves, so readers never see a half written one.
+ */
+
+void LCD::_trace_write(uint8_t kind, uint8_t value)
+{
+	LCDTraceEntry *p_entry = NULL;
+
+	p_entry = &(this->_trace[this->_trace_head & this->_TRACE_MASK]);
+	p_entry->tUs = (uint32_t) micros();
+	p_entry->kind = kind;
+	p_entry->value = value;
+
+	__asm__ __volatile__("" ::: "memory");
+	this->_trace_head++;
+
+	/*The slot at the head is the one filled next: up to LCD_CFG_TRACE_SIZE - 1 complete entries behind it*/
+	if(this->_trace_count < (LCD_CFG_TRACE_SIZE - 1u)) this->_trace_count++;
+
+	return;
+}
+#endif
+
+void LCD::_put_char(uint8_t byte)
+{
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
+	{
+		this->_fb_write(byte);
+		return;
+	}
+#endif
+
+	this->_sync_cursor();
+	this->_send_byte(true, byte);
+	return;
+}
+
+/*
+ * Fields leave the cells they didn't change unsent, so the address counter can lag behind the cursor.
+ * The cursor is then kept in _ac_pending until something needs the address counter there.
+ */
+
+void LCD::_sync_cursor(void)
+{
+	if(this->_ac_pending == this->_AC_UNKNOWN) return;
+
+	if(this->_ac != this->_ac_pending) this->_send_byte(false, (0x80 | this->_idx_to_ddram_addr(this->_ac_pending)));
+	this->_ac_pending = this->_AC_UNKNOWN;
+
+	return;
+}
+
+/*
+ * Same as setCursorPosition(), except the address is only sent once a character needs it
+ * (nothing is sent if the characters printed there are already on the display).
+ */
+
+bool LCD::_set_cursor_lazy(uint8_t cx, uint8_t cy)
+{
+	uint8_t addr = 0u;
+
+	if(!this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, cy)) return false;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_fb_mode)
+	{
+		this->_fb_idx = this->_ddram_addr_to_idx(addr);
+		return true;
+	}
+#endif
+
+	this->_ac_pending = this->_ddram_addr_to_idx(addr);
+	if(this->_display_ctrl & 0x03) this->_sync_cursor();
+
+	return true;
+}
+
+bool LCD::_put_number(uint32_t magnitude, bool negative, uint8_t base, uint8_t n_decimals, uint8_t width, intptr_t align, char pad)
+{
+	uint8_t field[DDRAM_LINE_SIZE];
+	uint8_t n_digits = 0u;
+	uint8_t length = 0u;
+	uint8_t n_pad = 0u;
+	uint8_t n_char = 0u;
+
+	if(this->_status < 1) return false;
+	if(width > this->DDRAM_LINE_SIZE) return false;
+	if((align != this->ALIGN_RIGHT) && (align != this->ALIGN_LEFT)) return false;
+
+	/*Formatted at the end of the field (up to 11 characters), moved into place below*/
+	n_digits = this->_format_number(&(field[this->DDRAM_LINE_SIZE]), magnitude, base, n_decimals);
+	length = n_digits + (negative ? 1u : 0u);
+
+	if(!width) width = length;
+
+	if(length > width)
+	{
+		memset(field, '#', width);
+		this->_put_field(field, width);
+		this->_transport_flush();
+
+		return true;
+	}
+
+	n_pad = width - length;
+
+	if(align == this->ALIGN_RIGHT) n_char = width - n_digits;
+	else n_char = length - n_digits;
+
+	memmove(&(field[n_char]), &(field[this->DDRAM_LINE_SIZE - n_digits]), n_digits);
+
+	/*Sign and padding around the digits: "  -12", "-0012" or "-12  "*/
+	if(align == this->ALIGN_LEFT)
+	{
+		if(negative) field[0] = '-';
+		memset(&(field[length]), pad, n_pad);
+	}
+	else if(pad == '0')
+	{
+		if(negative) field[0] = '-';
+		memset(&(field[length - n_digits]), '0', n_pad);
+	}
+	else
+	{
+		memset(field, pad, n_pad);
+		if(negative) field[n_pad] = '-';
+	}
+
+	this->_put_field(field, width);
+	this->_transport_flush();
+
+	return true;
+}
+
+/*
+ * Writes the digits of "magnitude" backwards from "p_end", with a point before the last "n_decimals" of them
+ * and at least one digit before the point.
+ * returns the number of characters written (up to 11).
+ */
+
+uint8_t LCD::_format_number(uint8_t *p_end, uint32_t magnitude, uint8_t base, uint8_t n_decimals)
+{
+	uint8_t length = 0u;
+	uint8_t n_digits = 0u;
+	uint8_t digit = 0u;
+
+	do
+	{
+		if(n_decimals && (n_digits == n_decimals))
+		{
+			p_end--;
+			*p_end = '.';
+			length++;
+		}
+
+		digit = (uint8_t) (magnitude % base);
+		magnitude /= base;
+
+		p_end--;
+		*p_end = (digit < 10u) ? ('0' + digit) : ('A' + digit - 10u);
+
+		n_digits++;
+		length++;
+	} while(magnitude || (n_digits <= n_decimals));
+
+	return length;
+}
+
+/*
+ * Prints "length" characters at the cursor. Outside framebuffer mode, the RAM shadow holds what the display shows,
+ * so only the characters that differ are sent: an unchanged field costs nothing.
+ */
+
+void LCD::_put_field(const uint8_t *field, uint8_t length)
+{
+	uint8_t n_char = 0u;
+#if LCD_CFG_FRAMEBUFFER
+	uint8_t idx = 0u;
+
+	if(this->_ac_pending < this->DDRAM_SIZE) idx = this->_ac_pending;
+	else idx = this->_ac;
+
+	if(!this->_fb_mode && (idx < this->DDRAM_SIZE))
+	{
+		for(n_char = 0u; n_char < length; n_char++)
+		{
+			if(this->_fb[idx] != field[n_char])
+			{
+				this->_ac_pending = idx;
+				this->_put_char(field[n_char]);
+			}
+			else
+			{
+				this->_n_skipped++;
+#if LCD_CFG_STATS
+				this->_stats.nSkipped++;
+#endif
+			}
+
+			idx = this->_next_idx(idx);
+		}
+
+		this->_ac_pending = idx;
+		if(this->_display_ctrl & 0x03) this->_sync_cursor();
+
+		return;
+	}
+#endif
+
+	for(n_char = 0u; n_char < length; n_char++) this->_put_char(field[n_char]);
+
+	return;
+}
+
+/*ROM character, else glyph of the glyph table, else replacement character*/
+void LCD::_put_codepoint(uint32_t codepoint)
+{
+	uint8_t code = 0u;
+#if LCD_CFG_GLYPHS
+	uint16_t glyph_id = 0u;
+#endif
+
+	if(this->_rom_lookup(codepoint, &code))
+	{
+		this->_put_char(code);
+		return;
+	}
+
+#if LCD_CFG_GLYPHS
+	glyph_id = this->_glyph_find(codepoint);
+
+	if(glyph_id != this->GLYPH_NONE)
+	{
+		if(!this->_put_glyph(glyph_id)) this->_put_char((uint8_t) this->_glyphs[glyph_id].fallback);
+		return;
+	}
+#endif
+
+	this->_put_char((uint8_t) LCD_CFG_UTF8_REPLACEMENT);
+	return;
+}
+
+/*
+ * Decodes the character at "text" ("length" bytes left) into "p_codepoint", _UTF8_INVALID if malformed.
+ * A malformed sequence ends before the first byte that can't continue it, so decoding resumes there.
+ * returns the number of bytes used (at least 1).
+ */
+
+uint8_t LCD::_utf8_decode(const uint8_t *text, uintptr_t length, uint32_t *p_codepoint)
+{
+	uint8_t n_bytes = 0u;
+	uint8_t n_byte = 0u;
+	uint32_t codepoint = 0u;
+
+	if(text[0] < 0x80)
+	{
+		*p_codepoint = text[0];
+		return 1u;
+	}
+
+	n_bytes = __LCD_PGM_READ_U8(&(_lcd_utf8_len[(text[0] >> 3) & 0xf]));
+
+	if(!n_bytes)
+	{
+		*p_codepoint = _UTF8_INVALID;
+		return 1u;
+	}
+
+	codepoint = text[0] & (0x7f >> n_bytes);
+
+	for(n_byte = 1u; n_byte < n_bytes; n_byte++)
+	{
+		if((n_byte >= length) || ((text[n_byte] & 0xc0) != 0x80))
+		{
+			*p_codepoint = _UTF8_INVALID;
+			return n_byte;
+		}
+
+		codepoint = (codepoint << 6) | (text[n_byte] & 0x3f);
+	}
+
+	if(codepoint < __LCD_PGM_READ_U32(&(_lcd_utf8_min[n_bytes]))) codepoint = _UTF8_INVALID;
+
+	*p_codepoint = codepoint;
+	return n_bytes;
+}
+
+bool LCD::_rom_lookup(uint32_t codepoint, uint8_t *p_code)
+{
+	uint8_t lo = 0u;
+	uint8_t hi = _LCD_ROM_N_RANGES;
+	uint8_t mid = 0u;
+	uint16_t first = 0u;
+
+	/*lo ends up as the number of ranges starting at or before the code point*/
+	while(lo < hi)
+	{
+		mid = (lo + hi) >> 1;
+
+		if(__LCD_PGM_READ_U16(&(_lcd_rom_ranges[mid].first)) <= codepoint) lo = mid + 1u;
+		else hi = mid;
+	}
+
+	if(!lo) return false;
+
+	first = __LCD_PGM_READ_U16(&(_lcd_rom_ranges[lo - 1u].first));
+	if((codepoint - first) >= __LCD_PGM_READ_U8(&(_lcd_rom_ranges[lo - 1u].len))) return false;
+
+	*p_code = __LCD_PGM_READ_U8(&(_lcd_rom_ranges[lo - 1u].code)) + (uint8_t) (codepoint - first);
+	return true;
+}
+
+void LCD::_track_byte(bool reg, uint8_t byte)
+{
+	/*Data write: the controller stores the byte at the address counter and increments it*/
+	if(reg)
+	{
+		if(this->_ac >= this->DDRAM_SIZE) return;
+
+#if LCD_CFG_FRAMEBUFFER
+		this->_fb[this->_ac] = byte;
+		this->_fb_set_dirty(this->_ac, false);
+#endif
+		this->_ac = this->_next_idx(this->_ac);
+		return;
+	}
+
+	if(byte & 0x80)
+	{
+		this->_ac = this->_ddram_addr_to_idx(byte & 0x7f);
+		this->_ac_pending = this->_AC_UNKNOWN;
+		return;
+	}
+
+	/*Set CGRAM address: following data writes don't touch the DDRAM*/
+	if(byte & 0x40)
+	{
+		this->_ac = this->_AC_UNKNOWN;
+		this->_ac_pending = this->_AC_UNKNOWN;
+		return;
+	}
+
+	/*Function set*/
+	if(byte & 0x20) return;
+
+	/*Cursor/display shift*/
+	if(byte & 0x10)
+	{
+		if((byte & 0x08) || (this->_ac >= this->DDRAM_SIZE)) return;
+
+		if(byte & 0x04) this->_ac = this->_next_idx(this->_ac);
+		else this->_ac = (this->_ac + this->DDRAM_SIZE - 1u) % this->DDRAM_SIZE;
+
+		return;
+	}
+
+	/*Display control*/
+	if(byte & 0x08)
+	{
+		this->_display_ctrl = byte;
+		return;
+	}
+
+	/*Entry mode set*/
+	if(byte & 0x04) return;
+
+	/*Return home*/
+	if(byte & 0x02)
+	{
+		this->_ac = 0u;
+		this->_ac_pending = this->_AC_UNKNOWN;
+		return;
+	}
+
+	/*Clear display*/
+	if(byte & 0x01)
+	{
+#if LCD_CFG_FRAMEBUFFER
+		/*fillRect() replays the screen from the shadow after its clear*/
+		if(!this->_fb_keep) memset(this->_fb, ' ', this->DDRAM_SIZE);
+		memset(this->_fb_dirty, 0, sizeof(this->_fb_dirty));
+#endif
+		this->_ac = 0u;
+		this->_ac_pending = this->_AC_UNKNOWN;
+		return;
+	}
+
+	return;
+}
+
+bool LCD::_validate_rect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height)
+{
+	if(!width || !height) return false;
+	if((cx >= this->_info.n_chars) || (cy >= this->_info.n_lines)) return false;
+	if(width > (this->_info.n_chars - cx)) return false;
+	if(height > (this->_info.n_lines - cy)) return false;
+
+	return true;
+}
+
+/*
+ * Execution time of filling a rectangle with "byte", the cheaper of:
+ * - address set plus data runs over the cells that differ from the RAM shadow, skipping the others
+ *   (every cell without the shadow). Resending unchanged cells to bridge two runs never beats an address set:
+ *   a data write takes longer than an instruction in every timing profile.
+ * - clear display (1.52ms), then the cells of the whole screen that aren't blank afterwards.
+ *   Without the shadow, only for a blank fill of the whole screen.
+ * Return home is never considered: it takes as long as a clear display, where an address set takes 37us.
+ * Sets "p_clear" if the clear display is the cheaper one. The address sets follow the address counter,
+ * as _put_field() does, and moving a visible cursor back in place afterwards is counted.
+ */
+
+uint32_t LCD::_plan_fill(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, uint8_t byte, bool *p_clear)
+{
+	uint32_t cost_diff = 0u;
+	uint32_t cost_clear = 0u;
+	uint8_t cursor = 0u;
+	uint8_t ac = 0u;
+	uint8_t addr = 0u;
+	uint8_t idx = 0u;
+	uint8_t n_line = 0u;
+	uint8_t n_char = 0u;
+#if LCD_CFG_FRAMEBUFFER
+	uint8_t target = 0u;
+#endif
+
+	*p_clear = false;
+
+	if(this->_ac_pending < this->DDRAM_SIZE) cursor = this->_ac_pending;
+	else cursor = this->_ac;
+
+	ac = this->_ac;
+
+	for(n_line = cy; n_line < (cy + height); n_line++)
+	{
+		this->_phys_text_cx_cy_to_ddram_addr(&addr, cx, n_line);
+		idx = this->_ddram_addr_to_idx(addr);
+
+		for(n_char = 0u; n_char < width; n_char++)
+		{
+#if LCD_CFG_FRAMEBUFFER
+			if(this->_fb[idx] != byte) cost_diff += this->_plan_cell(&ac, idx);
+#else
+			cost_diff += this->_plan_cell(&ac, idx);
+#endif
+			idx = this->_next_idx(idx);
+		}
+	}
+
+	if((this->_display_ctrl & 0x03) && (cursor < this->DDRAM_SIZE) && (ac != cursor)) cost_diff += this->_exec_time_us(false, 0x80);
+
+#if LCD_CFG_FRAMEBUFFER
+	cost_clear = this->_exec_time_us(false, 0x01);
+	ac = 0u;
+
+	for(n_line = 0u; n_line < this->_info.n_lines; n_line++)
+	{
+		this->_phys_text_cx_cy_to_ddram_addr(&addr, 0u, n_line);
+		idx = this->_ddram_addr_to_idx(addr);
+
+		for(n_char = 0u; n_char < this->_info.n_chars; n_char++)
+		{
+			if((n_line >= cy) && (n_line < (cy + height)) && (n_char >= cx) && (n_char < (cx + width))) target = byte;
+			else target = this->_fb[idx];
+
+			if(target != ' ') cost_clear += this->_plan_cell(&ac, idx);
+			idx = this->_next_idx(idx);
+		}
+	}
+#else
+	if((byte != ' ') || (width != this->_info.n_chars) || (height != this->_info.n_lines)) return cost_diff;
+
+	cost_clear = this->_exec_time_us(false, 0x01);
+	ac = 0u;
+#endif
+
+	if((this->_display_ctrl & 0x03) && (cursor < this->DDRAM_SIZE) && (ac != cursor)) cost_clear += this->_exec_time_us(false, 0x80);
+
+	if(cost_clear >= cost_diff) return cost_diff;
+
+	*p_clear = true;
+	return cost_clear;
+}
+
+/*Execution time of sending the cell at DDRAM index "idx" with the address counter at "*p_ac" (moved past it)*/
+
+uint32_t LCD::_plan_cell(uint8_t *p_ac, uint8_t idx)
+{
+	uint32_t cost = LCD::_exec_time_us(true, 0x00);
+
+	if(*p_ac != idx) cost += LCD::_exec_time_us(false, 0x80);
+
+	*p_ac = LCD::_next_idx(idx);
+	return cost;
+}
+
+uint8_t LCD::_ddram_addr_to_idx(uint8_t addr)
+{
+	uint8_t col = 0u;
+
+	col = (addr & 0x3f);
+	if(col >= DDRAM_LINE_SIZE) return _AC_UNKNOWN;
+
+	if(addr & 0x40) return (DDRAM_LINE_SIZE + col);
+
+	return col;
+}
+
+uint8_t LCD::_idx_to_ddram_addr(uint8_t idx)
+{
+	if(idx >= DDRAM_LINE_SIZE) return (0x40 | (idx - DDRAM_LINE_SIZE));
+
+	return idx;
+}
+
+uint8_t LCD::_next_idx(uint8_t idx)
+{
+	idx++;
+	if(idx >= DDRAM_SIZE) idx = 0u;
+
+	return idx;
+}
+
+#if LCD_CFG_ASYNC
+bool LCD::setAsyncMode(bool enable)
+{
+	if(this->_status < 1) return false;
+
+	if(enable == this->_async_mode) return true;
+
+	if(!enable)
+	{
+		this->waitIdle();
+		this->_async_timer_stop();
+		this->_async_mode = false;
+
+		/*The queue waited for the last execution time: the busy flag can be polled again from here*/
+		this->_bf_ok = this->_async_bf_ok;
+		this->_bf_pending_us = 0u;
+		return true;
+	}
+
+	if(this->_transport != NULL) return false;
+	if(!this->_async_timer_start()) return false;
+
+	/*Let the last synchronous instruction finish before the queue takes over*/
+	if(this->_bf_ok) this->_wait_ready();
+	this->_async_bf_ok = this->_bf_ok;
+	this->_bf_ok = false;
+
+	this->_txq_head = 0u;
+	this->_txq_tail = 0u;
+	this->_async_running = false;
+	this->_async_mode = true;
+
+	return true;
+}
+
+bool LCD::isIdle(void)
+{
+	if(!this->_async_mode) return true;
+
+	return ((this->_txq_head == this->_txq_tail) && !this->_async_running);
+}
+
+void LCD::waitIdle(void)
+{
+	while(!this->isIdle());
+
+	return;
+}
+
+uint8_t LCD::getQueueHighWaterMark(void)
+{
+	return this->_txq_hwm;
+}
+
+void LCD::_txq_push(bool reg, uint8_t byte, uint16_t delay_us)
+{
+	uint8_t n_entries = 0u;
+	struct _lcd_txq_entry *p_entry = NULL;
+
+	/*Queue full: wait for the interrupt to free an entry*/
+	while(((uint8_t) (this->_txq_head - this->_txq_tail)) >= LCD_CFG_TXQUEUE_SIZE);
+
+	p_entry = &(this->_txq[this->_txq_head & this->_TXQ_MASK]);
+	p_entry->byte = byte;
+	p_entry->reg = reg;
+	p_entry->delay_us = delay_us;
+
+	this->_txq_head++;
+
+	n_entries = (uint8_t) (this->_txq_head - this->_txq_tail);
+	if(n_entries > this->_txq_hwm) this->_txq_hwm = n_entries;
+
+	noInterrupts();
+
+	if(!this->_async_running)
+	{
+		this->_async_running = true;
+		this->_async_timer_schedule(0u);
+	}
+
+	interrupts();
+	return;
+}
+
+/*
+ * Called from the timer interrupt. Sends the next queued byte and schedules the next interrupt after its execution time.
+ * The interrupt following the last byte only marks the queue as idle, so isIdle() also covers the last instruction execution time.
+ */
+
+void _lcd_async_timer_isr(void)
+{
+#if __LCD_ASYNC_TIMER1
+	LCD *p_lcd = LCD::_async_lcd;
+	struct _lcd_txq_entry *p_entry = NULL;
+
+	if(p_lcd == NULL) return;
+
+	if(p_lcd->_txq_head == p_lcd->_txq_tail)
+	{
+		TIMSK1 &= ~(1 << OCIE1A);
+		p_lcd->_async_running = false;
+		return;
+	}
+
+	p_entry = &(p_lcd->_txq[p_lcd->_txq_tail & p_lcd->_TXQ_MASK]);
+
+	p_lcd->_transmit_byte(p_entry->reg, p_entry->byte);
+	p_lcd->_async_timer_schedule(p_entry->delay_us);
+
+	p_lcd->_txq_tail++;
+#endif
+	return;
+}
+
+bool LCD::_async_timer_start(void)
+{
+#if __LCD_ASYNC_TIMER1
+	if((this->_async_lcd != NULL) && (this->_async_lcd != this)) return false;
+
+	noInterrupts();
+
+	this->_async_lcd = this;
+
+	/*CTC mode, prescaler 8, interrupt enabled on demand*/
+	TCCR1A = 0u;
+	TCCR1B = 0u;
+	TIMSK1 &= ~(1 << OCIE1A);
+
+	interrupts();
+	return true;
+#else
+	return false;
+#endif
+}
+
+void LCD::_async_timer_stop(void)
+{
+#if __LCD_ASYNC_TIMER1
+	noInterrupts();
+
+	TIMSK1 &= ~(1 << OCIE1A);
+	TCCR1B = 0u;
+
+	if(this->_async_lcd == this) this->_async_lcd = NULL;
+
+	interrupts();
+#endif
+	return;
+}
+
+void LCD::_async_timer_schedule(uint16_t delay_us)
+{
+#if __LCD_ASYNC_TIMER1
+	uint32_t ticks = 0u;
+
+	ticks = (((uint32_t) delay_us)*(F_CPU/1000000UL)) >> 3;
+	if(ticks < 2u) ticks = 2u;
+	if(ticks > 0xffff) ticks = 0xffff;
+
+	TCCR1B = 0u;
+	TCNT1 = 0u;
+	OCR1A = (uint16_t) (ticks - 1u);
+	TIFR1 = (1 << OCF1A);
+	TIMSK1 |= (1 << OCIE1A);
+	TCCR1B = ((1 << WGM12) | (1 << CS11));
+#endif
+	return;
+}
+#endif
+
+uint16_t LCD::_exec_time_us(bool reg, uint8_t byte)
+{
+	if(reg) return LCD_TIMING_DATA_US;
+
+	if(byte == 0x01) return LCD_TIMING_CLEAR_US;
+	if((byte & 0xfe) == 0x02) return LCD_TIMING_HOME_US;
+
+	return LCD_TIMING_CMD_US;
+}
+
+void LCD::_send_byte(bool reg, uint8_t byte)
+{
+#if LCD_CFG_STATS
+	unsigned long t_start = 0u;
+
+	this->_stats_count_byte(reg, byte);
+	t_start = micros();
+#endif
+
+	this->_track_byte(reg, byte);
+	this->_bus_send_byte(reg, byte);
+
+#if LCD_CFG_STATS
+	this->_stats.waitUs += (uint32_t) (micros() - t_start);
+#endif
+	return;
+}
+
+/*Sends a byte through the transport, the async queue or the GPIO pins, then waits for its execution time where the path requires it*/
+void LCD::_bus_send_byte(bool reg, uint8_t byte)
+{
+	if(this->_transport != NULL)
+	{
+#if LCD_CFG_TRACE
+		this->_trace_write((reg ? this->TRACE_DATA : this->TRACE_CMD), byte);
+#endif
+		this->_transport->sendByte(reg, byte, this->_exec_time_us(reg, byte));
+		return;
+	}
+
+#if LCD_CFG_ASYNC
+	if(this->_async_mode)
+	{
+		this->_txq_push(reg, byte, this->_exec_time_us(reg, byte));
+		return;
+	}
+#endif
+
+	if(this->_bf_ok) this->_wait_ready();
+
+	this->_transmit_byte(reg, byte);
+
+	if(this->_bf_ok)
+	{
+		this->_bf_pending_us = this->_exec_time_us(reg, byte);
+		this->_bf_t_write = micros();
+		return;
+	}
+
+	delayMicroseconds(this->_exec_time_us(reg, byte));
+
+	return;
+}
+
+void LCD::_transport_flush(void)
+{
+#if LCD_CFG_STATS
+	unsigned long t_start = 0u;
+
+	t_start = micros();
+#endif
+
+	if(this->_transport != NULL) this->_transport->flush();
+
+#if LCD_CFG_STATS
+	if(this->_stats_in_call) this->_stats.waitUs += (uint32_t) (micros() - t_start);
+	this->_stats_call_end();
+#endif
+	return;
+}
+
+void LCD::_transmit_byte(bool reg, uint8_t byte)
+{
+#if LCD_CFG_TRACE
+	this->_trace_write((reg ? this->TRACE_DATA : this->TRACE_CMD), byte);
+#endif
+
+	digitalWrite(this->_info.e, 0);
+	digitalWrite(this->_info.rs, reg);
+
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	if(this->_info.bus_8bit)
+	{
+		this->_write_byte(byte);
+		digitalWrite(this->_info.e, 1);
+		delayMicroseconds(this->_EN_DELAY_US);
+
+		digitalWrite(this->_info.e, 0);
+		return;
+	}
+
+	this->_write_nibble(byte >> 4);
+	digitalWrite(this->_info.e, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	digitalWrite(this->_info.e, 0);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	this->_write_nibble(byte & 0xf);
+	digitalWrite(this->_info.e, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	digitalWrite(this->_info.e, 0);
+
+	return;
+}
+
+void LCD::_write_nibble(uint8_t nibble)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	/*All data lines change at once with a single read-modify-write of the port*/
+	if(this->_db_out != NULL)
+	{
+		sreg = SREG;
+		cli();
+		*(this->_db_out) = (*(this->_db_out) & ~(this->_db_mask)) | this->_db_lut[nibble];
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	digitalWrite(this->_info.db7, (nibble & 0x8));
+	digitalWrite(this->_info.db6, (nibble & 0x4));
+	digitalWrite(this->_info.db5, (nibble & 0x2));
+	digitalWrite(this->_info.db4, (nibble & 0x1));
+
+	return;
+}
+
+void LCD::_write_low_nibble(uint8_t nibble)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	if(this->_db_lo_out != NULL)
+	{
+		sreg = SREG;
+		cli();
+		*(this->_db_lo_out) = (*(this->_db_lo_out) & ~(this->_db_lo_mask)) | this->_db_lo_lut[nibble];
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	digitalWrite(this->_info.db3, (nibble & 0x8));
+	digitalWrite(this->_info.db2, (nibble & 0x4));
+	digitalWrite(this->_info.db1, (nibble & 0x2));
+	digitalWrite(this->_info.db0, (nibble & 0x1));
+
+	return;
+}
+
+void LCD::_write_byte(uint8_t byte)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	/*DB0-DB7 on a single port: the whole byte is one read-modify-write*/
+	if((this->_db_out != NULL) && (this->_db_out == this->_db_lo_out))
+	{
+		sreg = SREG;
+		cli();
+		*(this->_db_out) = (*(this->_db_out) & ~(this->_db_mask | this->_db_lo_mask)) | this->_db_lut[byte >> 4] | this->_db_lo_lut[byte & 0xf];
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	this->_write_nibble(byte >> 4);
+	this->_write_low_nibble(byte & 0xf);
+
+	return;
+}
+
+void LCD::_wait_ready(void)
+{
+	unsigned long elapsed = 0u;
+	unsigned long timeout = 0u;
+	unsigned long poll_us = this->_BF_POLL_US;
+
+	if(!this->_bf_pending_us) return;
+
+	elapsed = micros() - this->_bf_t_write;
+
+	if(elapsed >= this->_bf_pending_us)
+	{
+		this->_bf_pending_us = 0u;
+		return;
+	}
+
+#if defined(__AVR__)
+	if((this->_db_out != NULL) && (!this->_info.bus_8bit || (this->_db_lo_out != NULL))) poll_us = this->_BF_POLL_FAST_US;
+#endif
+
+	/*Less left than a single poll costs (direction switches included): just wait it out*/
+	if((this->_bf_pending_us - elapsed) <= poll_us)
+	{
+		delayMicroseconds(this->_bf_pending_us - elapsed);
+		this->_bf_pending_us = 0u;
+		return;
+	}
+
+	timeout = ((unsigned long) this->_bf_pending_us)*(this->_BF_TIMEOUT_FACTOR);
+
+	this->_set_data_dir(INPUT);
+
+	while(this->_read_bf_ac() & 0x80)
+	{
+		elapsed = micros() - this->_bf_t_write;
+		if(elapsed < timeout) continue;
+
+		/*Busy flag stuck: R/W or DB7 likely not connected. Fall back to the timed profile.*/
+		this->_bf_ok = false;
+		break;
+	}
+
+	this->_set_data_dir(OUTPUT);
+
+	this->_bf_pending_us = 0u;
+	return;
+}
+
+uint8_t LCD::_read_bf_ac(void)
+{
+	uint8_t bf_ac = 0u;
+
+	digitalWrite(this->_info.e, 0);
+	digitalWrite(this->_info.rs, 0);
+	digitalWrite(this->_info.rw, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	digitalWrite(this->_info.e, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+	bf_ac = (this->_read_nibble() << 4);
+
+	if(this->_info.bus_8bit)
+	{
+		bf_ac |= this->_read_low_nibble();
+		digitalWrite(this->_info.e, 0);
+		digitalWrite(this->_info.rw, 0);
+
+		return bf_ac;
+	}
+
+	digitalWrite(this->_info.e, 0);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	digitalWrite(this->_info.e, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+	bf_ac |= this->_read_nibble();
+	digitalWrite(this->_info.e, 0);
+
+	digitalWrite(this->_info.rw, 0);
+
+	return bf_ac;
+}
+
+uint8_t LCD::_read_nibble(void)
+{
+	uint8_t nibble = 0u;
+
+#if defined(__AVR__)
+	uint8_t bits = 0u;
+
+	if(this->_db_out != NULL)
+	{
+		bits = *(this->_db_in);
+
+		if(bits & this->_db_lut[8]) nibble |= 0x8;
+		if(bits & this->_db_lut[4]) nibble |= 0x4;
+		if(bits & this->_db_lut[2]) nibble |= 0x2;
+		if(bits & this->_db_lut[1]) nibble |= 0x1;
+
+		return nibble;
+	}
+#endif
+
+	if(digitalRead(this->_info.db7)) nibble |= 0x8;
+	if(digitalRead(this->_info.db6)) nibble |= 0x4;
+	if(digitalRead(this->_info.db5)) nibble |= 0x2;
+	if(digitalRead(this->_info.db4)) nibble |= 0x1;
+
+	return nibble;
+}
+
+uint8_t LCD::_read_low_nibble(void)
+{
+	uint8_t nibble = 0u;
+
+#if defined(__AVR__)
+	uint8_t bits = 0u;
+
+	if(this->_db_lo_out != NULL)
+	{
+		bits = *(this->_db_lo_in);
+
+		if(bits & this->_db_lo_lut[8]) nibble |= 0x8;
+		if(bits & this->_db_lo_lut[4]) nibble |= 0x4;
+		if(bits & this->_db_lo_lut[2]) nibble |= 0x2;
+		if(bits & this->_db_lo_lut[1]) nibble |= 0x1;
+
+		return nibble;
+	}
+#endif
+
+	if(digitalRead(this->_info.db3)) nibble |= 0x8;
+	if(digitalRead(this->_info.db2)) nibble |= 0x4;
+	if(digitalRead(this->_info.db1)) nibble |= 0x2;
+	if(digitalRead(this->_info.db0)) nibble |= 0x1;
+
+	return nibble;
+}
+
+void LCD::_set_data_dir(uint8_t mode)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	if((this->_db_out != NULL) && (!this->_info.bus_8bit || (this->_db_lo_out != NULL)))
+	{
+		sreg = SREG;
+		cli();
+
+		if(mode == OUTPUT)
+		{
+			*(this->_db_ddr) |= this->_db_mask;
+			if(this->_info.bus_8bit) *(this->_db_lo_ddr) |= this->_db_lo_mask;
+		}
+		else
+		{
+			/*Inputs without pull-ups, as pinMode(INPUT) leaves them*/
+			*(this->_db_ddr) &= ~(this->_db_mask);
+			*(this->_db_out) &= ~(this->_db_mask);
+
+			if(this->_info.bus_8bit)
+			{
+				*(this->_db_lo_ddr) &= ~(this->_db_lo_mask);
+				*(this->_db_lo_out) &= ~(this->_db_lo_mask);
+			}
+		}
+
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	pinMode(this->_info.db4, mode);
+	pinMode(this->_info.db5, mode);
+	pinMode(this->_info.db6, mode);
+	pinMode(this->_info.db7, mode);
+
+	if(this->_info.bus_8bit)
+	{
+		pinMode(this->_info.db0, mode);
+		pinMode(this->_info.db1, mode);
+		pinMode(this->_info.db2, mode);
+		pinMode(this->_info.db3, mode);
+	}
+
+	return;
+}
+
+void LCD::_load_port_masks(void)
+{
+#if defined(__AVR__)
+	uint8_t port = 0u;
+	uint8_t nibble = 0u;
+	uint8_t bits[4];
+
+	this->_db_out = NULL;
+	this->_db_lo_out = NULL;
+
+	/*DB0-DB3 (8-bit mode only, they are PIN_NONE in 4-bit mode and must not be looked up)*/
+	if(this->_info.bus_8bit) port = digitalPinToPort(this->_info.db0);
+	else port = NOT_A_PIN;
+
+	if((port != NOT_A_PIN) && (digitalPinToPort(this->_info.db1) == port) && (digitalPinToPort(this->_info.db2) == port) && (digitalPinToPort(this->_info.db3) == port))
+	{
+		bits[0] = digitalPinToBitMask(this->_info.db0);
+		bits[1] = digitalPinToBitMask(this->_info.db1);
+		bits[2] = digitalPinToBitMask(this->_info.db2);
+		bits[3] = digitalPinToBitMask(this->_info.db3);
+
+		this->_db_lo_mask = bits[0] | bits[1] | bits[2] | bits[3];
+
+		for(nibble = 0u; nibble < 16u; nibble++)
+		{
+			this->_db_lo_lut[nibble] = 0u;
+			if(nibble & 0x1) this->_db_lo_lut[nibble] |= bits[0];
+			if(nibble & 0x2) this->_db_lo_lut[nibble] |= bits[1];
+			if(nibble & 0x4) this->_db_lo_lut[nibble] |= bits[2];
+			if(nibble & 0x8) this->_db_lo_lut[nibble] |= bits[3];
+		}
+
+		this->_db_lo_out = portOutputRegister(port);
+		this->_db_lo_in = portInputRegister(port);
+		this->_db_lo_ddr = portModeRegister(port);
+	}
+
+	/*DB4-DB7*/
+	port = digitalPinToPort(this->_info.db4);
+	if(port == NOT_A_PIN) return;
+
+	if(digitalPinToPort(this->_info.db5) != port) return;
+	if(digitalPinToPort(this->_info.db6) != port) return;
+	if(digitalPinToPort(this->_info.db7) != port) return;
+
+	bits[0] = digitalPinToBitMask(this->_info.db4);
+	bits[1] = digitalPinToBitMask(this->_info.db5);
+	bits[2] = digitalPinToBitMask(this->_info.db6);
+	bits[3] = digitalPinToBitMask(this->_info.db7);
+
+	this->_db_mask = bits[0] | bits[1] | bits[2] | bits[3];
+
+	for(nibble = 0u; nibble < 16u; nibble++)
+	{
+		this->_db_lut[nibble] = 0u;
+		if(nibble & 0x1) this->_db_lut[nibble] |= bits[0];
+		if(nibble & 0x2) this->_db_lut[nibble] |= bits[1];
+		if(nibble & 0x4) this->_db_lut[nibble] |= bits[2];
+		if(nibble & 0x8) this->_db_lut[nibble] |= bits[3];
+	}
+
+	this->_db_out = portOutputRegister(port);
+	this->_db_in = portInputRegister(port);
+	this->_db_ddr = portModeRegister(port);
+#endif
+	return;
+}
+
+void LCD::_send_init_nibble(void)
+{
+#if LCD_CFG_TRACE
+	this->_trace_write(this->TRACE_INIT_NIBBLE, 0x2);
+#endif
+
+	digitalWrite(this->_info.e, 0);
+	digitalWrite(this->_info.rs, 0);
+
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	this->_write_nibble(0x2);
+	digitalWrite(this->_info.e, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	digitalWrite(this->_info.e, 0);
+	delayMicroseconds(LCD_TIMING_INIT_US);
+
+	return;
+}
+
+void LCD::_send_init_8bit(void)
+{
+	/*Initialization by instruction: 3 function sets (8-bit), whatever interface mode the controller was left in*/
+	this->_transmit_byte(false, 0x30);
+	delayMicroseconds(LCD_TIMING_INIT_US);
+
+	this->_transmit_byte(false, 0x30);
+	delayMicroseconds(LCD_TIMING_INIT_RETRY_US);
+
+	this->_transmit_byte(false, 0x30);
+	delayMicroseconds(LCD_TIMING_CMD_US);
+
+	return;
+}
+
+bool LCD::_validate_info(void)
+{
+	/*A transport doesn't use the GPIO pins*/
+	if(this->_transport == NULL)
+	{
+		if(this->_info.db4 == this->PIN_NONE) return false;
+		if(this->_info.db5 == this->PIN_NONE) return false;
+		if(this->_info.db6 == this->PIN_NONE) return false;
+		if(this->_info.db7 == this->PIN_NONE) return false;
+		if(this->_info.rs == this->PIN_NONE) return false;
+
+		if(this->_info.bus_8bit)
+		{
+			if(this->_info.db0 == this->PIN_NONE) return false;
+			if(this->_info.db1 == this->PIN_NONE) return false;
+			if(this->_info.db2 == this->PIN_NONE) return false;
+			if(this->_info.db3 == this->PIN_NONE) return false;
+		}
+
+		if(this->_info.e == this->PIN_NONE) return false;
+	}
+
+	if(this->_info.n_chars == 0xff) return false;
+	if(this->_info.n_lines == 0xff) return false;
+
+	if(!this->_info.n_chars) return false;
+	if(!this->_info.n_lines) return false;
+
+	/*Every line must fit in the controller DDRAM*/
+	if(this->_info.n_lines > 4u) return false;
+	if((this->_info.n_chars)*((this->_info.n_lines + 1u) >> 1) > this->DDRAM_LINE_SIZE) return false;
+
+	return true;
+}
+
+bool LCD::_phys_text_cx_cy_to_virt_text_cx_cy(uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy)
+{
+	uint8_t virtcx = 0u;
+	uint8_t virtcy = 0u;
+
+	if(physcx >= this->_info.n_chars) return false;
+	if(physcy >= this->_info.n_lines) return false;
+
+	virtcy = (physcy & 0x1);
+
+	virtcx = physcx;
+
+	physcy = (physcy >> 1);
+	if(physcy) virtcx += physcy*(this->_info.n_chars);
+
+	if(p_virtcx != NULL) *p_virtcx = virtcx;
+	if(p_virtcy != NULL) *p_virtcy = virtcy;
+
+	return true;
+}
+
+void LCD::_load_line_addr_table(void)
+{
+	uint8_t n_line = 0u;
+	uint8_t virtcx = 0u;
+	uint8_t virtcy = 0u;
+
+	/*
+	 * Lines are interleaved on the two DDRAM lines (0x00 and 0x40):
+	 * 16x2: 0x00 0x40
+	 * 16x4: 0x00 0x40 0x10 0x50
+	 * 20x4: 0x00 0x40 0x14 0x54
+	 */
+
+	for(n_line = 0u; n_line < 4u; n_line++)
+	{
+		if(!this->_phys_text_cx_cy_to_virt_text_cx_cy(&virtcx, &virtcy, 0u, n_line))
+		{
+			this->_line_addr[n_line] = 0u;
+			continue;
+		}
+
+		if(virtcy) virtcx |= 0x40;
+
+		this->_line_addr[n_line] = virtcx;
+	}
+
+	return;
+}
+
+bool LCD::_phys_text_cx_cy_to_ddram_addr(uint8_t *p_addr, uint8_t physcx, uint8_t physcy)
+{
+	if(physcx >= this->_info.n_chars) return false;
+	if(physcy >= this->_info.n_lines) return false;
+
+	if(p_addr != NULL) *p_addr = this->_line_addr[physcy] + physcx;
+
+	return true;
+}
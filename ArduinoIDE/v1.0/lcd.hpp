@@ -12,22 +12,333 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <Arduino.h>
+#include <string.h>
+#include "lcd_hal.hpp"
+
+/*
+ * LCD_CFG_FRAMEBUFFER
+ *
+ * Set to 1 to keep a RAM shadow of the display DDRAM inside every LCD object (required by setFramebufferMode(), flush(),
+ * LCDConsole and the glyph cache; fields, screen layouts and fills only send the characters that changed with it).
+ * Off by default: it costs LCD::DDRAM_SIZE + LCD::DDRAM_SIZE/8 bytes per object, a lot on an AVR.
+ * The Arduino IDE has no per sketch defines: change the default here, or pass -DLCD_CFG_FRAMEBUFFER=1 in the build flags.
+ */
+
+#ifndef LCD_CFG_FRAMEBUFFER
+#define LCD_CFG_FRAMEBUFFER 0
+#endif
+
+/*
+ * LCD_CFG_TIMING_PROFILE
+ *
+ * Selects the controller instruction execution times the driver waits for after each write.
+ * One of LCD_TIMING_PROFILE_HD44780, LCD_TIMING_PROFILE_ST7066U, LCD_TIMING_PROFILE_KS0066, LCD_TIMING_PROFILE_SPLC780.
+ *
+ * LCD_CFG_TIMING_DERATED
+ *
+ * Set to 1 to double every execution time (long cables, low supply voltage, slow controller oscillator).
+ */
+
+#define LCD_TIMING_PROFILE_HD44780 0
+#define LCD_TIMING_PROFILE_ST7066U 1
+#define LCD_TIMING_PROFILE_KS0066 2
+#define LCD_TIMING_PROFILE_SPLC780 3
+
+#ifndef LCD_CFG_TIMING_PROFILE
+#define LCD_CFG_TIMING_PROFILE LCD_TIMING_PROFILE_HD44780
+#endif
+
+#ifndef LCD_CFG_TIMING_DERATED
+#define LCD_CFG_TIMING_DERATED 0
+#endif
+
+/*Datasheet execution times (fosc = 270kHz). Data writes include tADD (address counter update)*/
+#if LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_HD44780
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 41U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_ST7066U
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 43U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_KS0066
+#define __LCD_TIMING_CLEAR_US 1530U
+#define __LCD_TIMING_HOME_US 1530U
+#define __LCD_TIMING_CMD_US 39U
+#define __LCD_TIMING_DATA_US 43U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_SPLC780
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 41U
+#else
+#error "LCD_CFG_TIMING_PROFILE: unknown timing profile"
+#endif
+
+/*Wait after the first (8-bit mode) function set nibble, and after the second one of the 8-bit initialization sequence*/
+#define __LCD_TIMING_INIT_US 4100U
+#define __LCD_TIMING_INIT_RETRY_US 100U
+
+#define LCD_TIMING_CLEAR_US (__LCD_TIMING_CLEAR_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_HOME_US (__LCD_TIMING_HOME_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_CMD_US (__LCD_TIMING_CMD_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_DATA_US (__LCD_TIMING_DATA_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_INIT_US (__LCD_TIMING_INIT_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_INIT_RETRY_US (__LCD_TIMING_INIT_RETRY_US << LCD_CFG_TIMING_DERATED)
+
+/*
+ * LCD_CFG_ASYNC
+ *
+ * Set to 1 to enable the interrupt driven transmit queue (setAsyncMode()).
+ * On AVR the queue is drained from the Timer1 compare A interrupt, so only one LCD object can be in async mode at a time
+ * and Timer1 can't be used by anything else (Servo, tone(), PWM on the Timer1 pins) while it is.
+ *
+ * LCD_CFG_TXQUEUE_SIZE
+ *
+ * Number of entries in the transmit queue (power of 2, up to 128). Each entry takes 4 bytes.
+ */
+
+#ifndef LCD_CFG_ASYNC
+#define LCD_CFG_ASYNC 0
+#endif
+
+#ifndef LCD_CFG_TXQUEUE_SIZE
+#define LCD_CFG_TXQUEUE_SIZE 32
+#endif
+
+/*
+ * LCD_CFG_STATS
+ *
+ * Set to 1 to keep per-object performance counters (getStats(), resetStats()).
+ * Costs two micros() calls per byte sent and LCDStats plus 5 bytes of RAM per object. Set to 0 to compile them out.
+ */
+
+#ifndef LCD_CFG_STATS
+#define LCD_CFG_STATS 0
+#endif
+
+/*
+ * LCD_CFG_TRACE
+ *
+ * Set to 1 to log every byte and initialization nibble sent to the display into a ring buffer inside the LCD object
+ * (getTrace(), clearTrace()). It keeps the newest LCD_CFG_TRACE_SIZE - 1 entries.
+ * Costs one micros() call per byte sent. Set to 0 to compile it out.
+ *
+ * LCD_CFG_TRACE_SIZE
+ *
+ * Number of entries in the ring buffer (power of 2, up to 128). Each entry takes 6 bytes on AVR.
+ */
+
+#ifndef LCD_CFG_TRACE
+#define LCD_CFG_TRACE 0
+#endif
+
+#ifndef LCD_CFG_TRACE_SIZE
+#define LCD_CFG_TRACE_SIZE 32
+#endif
+
+/*
+ * LCD_CFG_GLYPHS
+ *
+ * Set to 1 to enable the custom glyph cache (setGlyphTable(), printGlyph()). Glyphs of an application table are uploaded
+ * to the 8 CGRAM slots when first printed, replacing the least recently printed one once every slot is taken.
+ * The cells still showing a replaced glyph are found in the RAM shadow, so it requires LCD_CFG_FRAMEBUFFER.
+ * Costs 44 bytes of RAM per object on AVR. Set to 0 to compile it out.
+ */
+
+#ifndef LCD_CFG_GLYPHS
+#define LCD_CFG_GLYPHS 0
+#endif
+
+#if LCD_CFG_GLYPHS && !LCD_CFG_FRAMEBUFFER
+#error "LCD_CFG_GLYPHS requires LCD_CFG_FRAMEBUFFER"
+#endif
+
+/*
+ * LCD_CFG_ROM_CODE
+ *
+ * Character generator ROM of the controller, used by printTextUtf8() to find the character code of each character.
+ * LCD_ROM_CODE_A00 (Japanese: ASCII except '\\' and '~', half-width katakana, a few Greek letters and symbols) or
+ * LCD_ROM_CODE_A02 (European: ASCII, Latin-1, a few Greek and Cyrillic letters and symbols).
+ * Printing codes 0x20 to 0xff on the display tells them apart. The table is kept in flash on AVR.
+ *
+ * LCD_CFG_UTF8_REPLACEMENT
+ *
+ * Character code printTextUtf8() prints for malformed sequences and characters it can't show.
+ */
+
+#define LCD_ROM_CODE_A00 0
+#define LCD_ROM_CODE_A02 1
+
+#ifndef LCD_CFG_ROM_CODE
+#define LCD_CFG_ROM_CODE LCD_ROM_CODE_A00
+#endif
+
+#ifndef LCD_CFG_UTF8_REPLACEMENT
+#define LCD_CFG_UTF8_REPLACEMENT '?'
+#endif
+
+#if LCD_CFG_ASYNC && defined(__AVR__) && defined(TCCR1A)
+#define __LCD_ASYNC_TIMER1 1
+#else
+#define __LCD_ASYNC_TIMER1 0
+#endif
+
+struct _lcd_txq_entry {
+	uint8_t byte;
+	bool reg;
+	uint16_t delay_us;
+};
 
 struct _lcd_info {
+	uint8_t db0;
+	uint8_t db1;
+	uint8_t db2;
+	uint8_t db3;
 	uint8_t db4;
 	uint8_t db5;
 	uint8_t db6;
 	uint8_t db7;
 	uint8_t rs;
+	uint8_t rw;
 	uint8_t e;
 	uint8_t n_chars;
 	uint8_t n_lines;
+	bool bus_8bit;
+};
+
+/*
+ * LCDTraceEntry
+ *
+ * One trace entry (LCD_CFG_TRACE).
+ *
+ * tUs: micros() when the transfer started (or was handed to the transport).
+ * kind: LCD::TRACE_CMD, LCD::TRACE_DATA or LCD::TRACE_INIT_NIBBLE.
+ * value: byte (or nibble) sent.
+ */
+
+struct LCDTraceEntry {
+	uint32_t tUs;
+	uint8_t kind;
+	uint8_t value;
+};
+
+/*
+ * LCDStats
+ *
+ * Performance counters (LCD_CFG_STATS), gathered since begin() or the last resetStats().
+ *
+ * nCmds: instructions sent.
+ * nData: data bytes sent.
+ * nSkipped: characters printed (framebuffer mode, fields) that didn't need to be sent.
+ * nClearHome: clear display and return home instructions sent (1.52ms each).
+ * waitUs: time spent sending bytes (execution time waits, busy flag polling, full queue or transport buffer).
+ * Wraps around after about 71 minutes of cumulative waiting.
+ * maxCallUs: longest a single LCD call kept the caller blocked, from its first byte sent to its return.
+ */
+
+struct LCDStats {
+	uint32_t nCmds;
+	uint32_t nData;
+	uint32_t nSkipped;
+	uint32_t nClearHome;
+	uint32_t waitUs;
+	uint32_t maxCallUs;
+};
+
+/*
+ * LCDGlyph
+ *
+ * One custom glyph (LCD_CFG_GLYPHS).
+ *
+ * rows: 5x8 dot pattern, top row first (bit 4 is the leftmost dot, row 7 is the cursor line).
+ * fallback: character shown in place of the glyph once another one took its CGRAM slot.
+ * codepoint: Unicode character printTextUtf8() shows with this glyph if the ROM doesn't have it (0 for none).
+ */
+
+struct LCDGlyph {
+	uint8_t rows[8];
+	char fallback;
+	uint16_t codepoint;
+};
+
+/*
+ * LCDGlyphStats
+ *
+ * Glyph cache counters (LCD_CFG_GLYPHS), gathered since begin() or the last resetGlyphStats().
+ *
+ * nHits: glyphs printed that were already in CGRAM.
+ * nMisses: glyphs printed that had to be uploaded first (9 instructions each).
+ * nEvictions: uploads that replaced another glyph.
+ * nRepaints: cells rewritten with the fallback character of a replaced glyph.
+ */
+
+struct LCDGlyphStats {
+	uint32_t nHits;
+	uint32_t nMisses;
+	uint32_t nEvictions;
+	uint32_t nRepaints;
+};
+
+/*
+ * LCDTransport
+ *
+ * Bus transport interface. Replaces the built-in GPIO bit-banging below the command layer (see lcd_i2c.hpp).
+ * Busy flag polling and the async mode are GPIO only.
+ *
+ * begin(): configures the transport hardware. Called by LCD::begin() before anything is sent.
+ * sendInitNibble(): sends a single nibble with RS low (4-bit mode switch), then keeps the bus idle for "delayUs".
+ * sendByte(): sends a byte to the instruction (reg = false) or data (reg = true) register,
+ * then keeps the bus idle for "delayUs" before the next byte.
+ * flush(): called at the end of every LCD call that sent something. Batching transports send whatever they still hold.
+ */
+
+class LCDTransport {
+	public:
+		virtual ~LCDTransport(void) {}
+
+		virtual bool begin(void) = 0;
+		virtual void sendInitNibble(uint8_t nibble, uint16_t delayUs) = 0;
+		virtual void sendByte(bool reg, uint8_t byte, uint16_t delayUs) = 0;
+		virtual void flush(void) {}
 };
 
 class LCD {
 	public:
 		LCD(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines);
+
+		/*
+		 * R/W pin constructor.
+		 *
+		 * With the display R/W pin connected, the driver polls the busy flag when more of the execution time is left than a poll
+		 * costs (clear and home, or any instruction with the data pins on a single AVR port) and times the rest.
+		 * This only pays off on controllers that run faster than the datasheet worst case; against worst case timing it is a
+		 * few percent slower than the timed constructor. If the busy flag doesn't respond, the timed profile is used.
+		 * The data pins are read back from the display, so they must tolerate the display logic level.
+		 */
+
+		LCD(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines);
+
+		/*
+		 * 8-bit bus constructors.
+		 *
+		 * With all eight data lines connected, every byte is written with a single E strobe instead of two.
+		 * If all the data pins share a port (AVR), each byte is a single port write.
+		 */
+
+		LCD(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines);
+		LCD(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e, uint8_t nCharsPerLine, uint8_t nLines);
+
+		/*
+		 * Transport constructor.
+		 *
+		 * The display is driven through "transport" (I2C backpack, shift register...) instead of GPIO pins.
+		 * The transport object must outlive the LCD object.
+		 */
+
+		LCD(LCDTransport *transport, uint8_t nCharsPerLine, uint8_t nLines);
 		~LCD(void);
 
 		/*
@@ -42,10 +353,13 @@ class LCD {
 		/*
 		 * resetPinout()
 		 *
-		 * Redefine the GPIO pins connected to the display. (Requires object reinitialization "begin()")
+		 * Redefine the GPIO pins connected to the display (drops the transport, if any). (Requires object reinitialization "begin()")
 		 */
 
 		void resetPinout(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e);
+		void resetPinout(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e);
+		void resetPinout(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t e);
+		void resetPinout(uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3, uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs, uint8_t rw, uint8_t e);
 
 		/*
 		 * resetDisplaySize()
@@ -127,21 +441,271 @@ class LCD {
 		bool printText(const char *text);
 		bool printText(const char *text, uintptr_t length);
 
+		/*
+		 * printTextUtf8()
+		 *
+		 * print a UTF-8 text at the current cursor position ("length" in bytes).
+		 * Each character is printed with its code in the controller character ROM (LCD_CFG_ROM_CODE), else with the glyph
+		 * of the glyph table standing for it (LCD_CFG_GLYPHS), else as LCD_CFG_UTF8_REPLACEMENT, like malformed sequences.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printTextUtf8(const char *text);
+		bool printTextUtf8(const char *text, uintptr_t length);
+
+		/*
+		 * printUInt()
+		 *
+		 * print "value" in decimal as a field of "width" characters at the current cursor position (0 for just the digits),
+		 * aligned to the right (ALIGN_RIGHT) or left (ALIGN_LEFT) and padded with "pad".
+		 * A value too wide for the field fills it with '#'. Fields are formatted without stdio nor a caller buffer, and only
+		 * the characters that differ from what the display shows are sent (with LCD_CFG_FRAMEBUFFER).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printUInt(uint32_t value, uint8_t width, intptr_t align, char pad);
+
+		/*
+		 * printInt()
+		 *
+		 * same as printUInt() for a signed value. With '0' as "pad", the minus sign goes before the zeros.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printInt(int32_t value, uint8_t width, intptr_t align, char pad);
+
+		/*
+		 * printFixed()
+		 *
+		 * same as printInt() for a fixed point value: "value" is in units of 10^-"nDecimals" (up to 9),
+		 * e.g. 215 with 1 decimal prints "21.5".
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printFixed(int32_t value, uint8_t nDecimals, uint8_t width, intptr_t align, char pad);
+
+		/*
+		 * printHex()
+		 *
+		 * same as printUInt() in hexadecimal (upper case digits).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printHex(uint32_t value, uint8_t width, intptr_t align, char pad);
+
 		/*
 		 * fillScreenChar()
 		 *
-		 * print a repeated character on the whole screen.
+		 * print a repeated character on the whole screen (see fillRect()).
+		 * The cursor stays where it was (it used to be left after the last cell of the screen).
 		 * returns true if successful, false otherwise.
 		 */
 
 		bool fillScreenChar(char c);
 
+		/*
+		 * fillRect()
+		 *
+		 * fill "width" characters of "height" lines from (cx , cy) with a repeated character. The cursor stays where it was.
+		 * Sends whichever is quicker by the controller execution times (see estimateFillRectUs()): the cells that differ
+		 * from what the display shows (every cell without LCD_CFG_FRAMEBUFFER), or a clear display followed by the cells
+		 * of the whole screen that aren't blank afterwards.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool fillRect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c);
+
+		/*
+		 * clearLine() & clearRect()
+		 *
+		 * blank line "cy", or "width" characters of "height" lines from (cx , cy) (fillRect() with spaces).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool clearLine(uint8_t cy);
+		bool clearRect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height);
+
+		/*
+		 * estimateFillRectUs()
+		 *
+		 * how long fillRect() would keep the display busy with the same arguments, without sending anything:
+		 * the sum of the execution times (LCD_CFG_TIMING_PROFILE) of the bytes it would send.
+		 * The bus transfer time of each byte comes on top (significant with I2C and SPI transports).
+		 * Nothing is sent in framebuffer mode, the estimate is then 0 (the cells go out with flush()).
+		 * returns the estimate in microseconds, or -1 if error.
+		 */
+
+		int32_t estimateFillRectUs(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c);
+
+#if LCD_CFG_FRAMEBUFFER
+		/*
+		 * setFramebufferMode()
+		 *
+		 * enable/disable the framebuffer mode.
+		 * While enabled, setCursorPosition(), print*(), fillScreenChar(), fillRect(), clear*() and home() only update the RAM shadow
+		 * of the display. Nothing is sent to the display until flush() is called.
+		 * Disabling the framebuffer mode flushes any pending changes.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setFramebufferMode(bool enable);
+
+		/*
+		 * flush()
+		 *
+		 * send the characters that changed since the last flush to the display.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool flush(void);
+
+		/*
+		 * getNSkippedBytes()
+		 *
+		 * returns the number of characters printed in framebuffer mode that didn't need to be sent to the display.
+		 */
+
+		uintptr_t getNSkippedBytes(void);
+#endif
+
+#if LCD_CFG_GLYPHS
+		/*
+		 * setGlyphTable()
+		 *
+		 * set the custom glyphs printGlyph() can print, "glyphs[glyphId]" being glyph "glyphId". The table must outlive its use.
+		 * Forgets which glyph each CGRAM slot holds: cells already showing one keep it until they are rewritten.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setGlyphTable(const LCDGlyph *glyphs, uint16_t nGlyphs);
+
+		/*
+		 * printGlyph()
+		 *
+		 * print custom glyph "glyphId" at the current cursor position.
+		 * A glyph not in CGRAM yet is uploaded first (9 instructions), to the least recently printed slot once all 8 are taken.
+		 * Every cell still showing the glyph it replaces gets its fallback character, as the glyph can't be shown there anymore.
+		 * In framebuffer mode, the cells being replaced show the new glyph until the next flush().
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printGlyph(uint16_t glyphId);
+
+		/*
+		 * getGlyphStats()
+		 *
+		 * returns the glyph cache counters (see LCDGlyphStats).
+		 */
+
+		LCDGlyphStats getGlyphStats(void);
+
+		/*
+		 * resetGlyphStats()
+		 *
+		 * set every glyph cache counter back to 0.
+		 */
+
+		void resetGlyphStats(void);
+
+		static constexpr uint8_t CGRAM_SLOTS = 8u;
+		static constexpr uint16_t GLYPH_NONE = 0xffff;
+#endif
+
+#if LCD_CFG_STATS
+		/*
+		 * getStats()
+		 *
+		 * returns the performance counters (see LCDStats).
+		 */
+
+		LCDStats getStats(void);
+
+		/*
+		 * resetStats()
+		 *
+		 * set every performance counter back to 0.
+		 */
+
+		void resetStats(void);
+#endif
+
+#if LCD_CFG_TRACE
+		/*
+		 * getTrace()
+		 *
+		 * copy up to "maxEntries" of the newest trace entries to "entries", oldest first.
+		 * Doesn't block the transfers: it may run while the async mode keeps sending, entries overwritten during the copy are left out.
+		 * returns the number of entries copied.
+		 */
+
+		uintptr_t getTrace(LCDTraceEntry *entries, uintptr_t maxEntries);
+
+		/*
+		 * clearTrace()
+		 *
+		 * empty the trace. Call it while nothing is being sent (async mode idle).
+		 */
+
+		void clearTrace(void);
+#endif
+
+		/*Unconnected optional pin*/
+		static constexpr uint8_t PIN_NONE = 0xff;
+
+#if LCD_CFG_ASYNC
+		/*
+		 * setAsyncMode()
+		 *
+		 * enable/disable the asynchronous mode.
+		 * While enabled, every function that talks to the display queues its bytes and returns immediately.
+		 * The queue is drained in the background by a timer interrupt, respecting each instruction execution time.
+		 * If the queue is full, the caller waits for a free entry.
+		 * Disabling the asynchronous mode waits until the queue is empty, then goes back to busy flag polling if begin() enabled it.
+		 * returns true if successful, false otherwise (no timer support on this platform or the timer is already in use).
+		 */
+
+		bool setAsyncMode(bool enable);
+
+		/*
+		 * isIdle()
+		 *
+		 * returns true if the transmit queue is empty and the display finished executing the last instruction, false otherwise.
+		 */
+
+		bool isIdle(void);
+
+		/*
+		 * waitIdle()
+		 *
+		 * wait until isIdle() is true.
+		 */
+
+		void waitIdle(void);
+
+		/*
+		 * getQueueHighWaterMark()
+		 *
+		 * returns the highest number of entries ever waiting in the transmit queue.
+		 */
+
+		uint8_t getQueueHighWaterMark(void);
+#endif
+
+		static constexpr uint8_t DDRAM_LINE_SIZE = 40u;
+		static constexpr uint8_t DDRAM_SIZE = 80u;
+
 		enum Status {
 			STATUS_ERROR = -1,
 			STATUS_UNINITIALIZED = 0,
 			STATUS_INITIALIZED = 1
 		};
 
+		enum TraceKind {
+			TRACE_CMD = 0,
+			TRACE_DATA = 1,
+			TRACE_INIT_NIBBLE = 2
+		};
+
 		enum DisplayMode {
 			DISPLAYMODE_DISPLAY_OFF = 0,
 			DISPLAYMODE_DISPLAY_ON_CURSOR_OFF = 1,
@@ -149,26 +713,202 @@ class LCD {
 			DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK = 3
 		};
 
+		enum Align {
+			ALIGN_RIGHT = 0,
+			ALIGN_LEFT = 1
+		};
+
 	private:
-		static constexpr uintptr_t _CMD_DELAY_US = 1024u;
+		/*A mirror group replays its bytes into every member's state (lcd_bus.hpp)*/
+		friend class LCDBusMirror;
+
+		/*Screen layouts, marquees and the console draw through the lazy cursor and the RAM shadow (lcd_screen.hpp, lcd_marquee.hpp, lcd_console.hpp)*/
+		friend class LCDScreen;
+		friend class LCDMarquee;
+		friend class LCDConsole;
+
 		static constexpr uintptr_t _EN_DELAY_US = 1u;
 
+		/*Give up busy flag polling after this many times the timed profile delay*/
+		static constexpr uintptr_t _BF_TIMEOUT_FACTOR = 4u;
+
+		/*Rough cost of one busy flag poll plus both data direction switches (pin functions, single port registers)*/
+		static constexpr uintptr_t _BF_POLL_US = 80u;
+		static constexpr uintptr_t _BF_POLL_FAST_US = 8u;
+
 		__attribute__((aligned(64))) struct _lcd_info _info;
 
+		static constexpr uint8_t _AC_UNKNOWN = 0xff;
+
 		intptr_t _status = this->STATUS_UNINITIALIZED;
 
+		LCDTransport *_transport = NULL;
+
+		/*DDRAM address of the first character of each display line*/
+		uint8_t _line_addr[4];
+
+		/*Address counter as a DDRAM index (0 to DDRAM_SIZE - 1), or _AC_UNKNOWN*/
+		uint8_t _ac = this->_AC_UNKNOWN;
+
+		/*Cursor the address counter still has to be moved to after a field (_AC_UNKNOWN if none)*/
+		uint8_t _ac_pending = this->_AC_UNKNOWN;
+		uint8_t _display_ctrl = 0x0c;
+
+#if LCD_CFG_FRAMEBUFFER
+		uint8_t _fb[DDRAM_SIZE];
+		uint8_t _fb_dirty[DDRAM_SIZE >> 3];
+		uint8_t _fb_idx = 0u;
+		bool _fb_mode = false;
+		bool _fb_keep = false;
+		uintptr_t _n_skipped = 0u;
+
+		void _fb_write(uint8_t byte);
+		void _fb_set(uint8_t idx, uint8_t byte);
+		bool _fb_is_dirty(uint8_t idx);
+		void _fb_set_dirty(uint8_t idx, bool dirty);
+		void _fb_blank_hidden(void);
+#endif
+
+#if LCD_CFG_GLYPHS
+		const LCDGlyph *_glyphs = NULL;
+		uint16_t _n_glyphs = 0u;
+
+		/*Glyph in each CGRAM slot, and the slots from the most to the least recently printed*/
+		uint16_t _glyph_slot_id[CGRAM_SLOTS];
+		uint8_t _glyph_lru[CGRAM_SLOTS];
+		LCDGlyphStats _glyph_stats = {0u, 0u, 0u, 0u};
+
+		bool _put_glyph(uint16_t glyph_id);
+		uint16_t _glyph_find(uint32_t codepoint);
+		void _glyph_forget_slots(void);
+		uint8_t _glyph_acquire(uint16_t glyph_id);
+		void _glyph_touch(uint8_t n_lru);
+		void _glyph_repaint(uint8_t slot, uint8_t fallback);
+		void _glyph_upload(uint8_t slot, const LCDGlyph *glyph);
+#endif
+
+#if LCD_CFG_STATS
+		LCDStats _stats = {0u, 0u, 0u, 0u, 0u, 0u};
+		bool _stats_in_call = false;
+		unsigned long _stats_t_call = 0u;
+
+		void _stats_call_begin(void);
+		void _stats_call_end(void);
+		void _stats_count_byte(bool reg, uint8_t byte);
+#endif
+
+#if LCD_CFG_TRACE
+		static constexpr uint8_t _TRACE_MASK = (LCD_CFG_TRACE_SIZE - 1);
+
+		/*8-bit indexes: single (atomic) loads on AVR. The head wraps around cleanly with up to 128 entries*/
+		LCDTraceEntry _trace[LCD_CFG_TRACE_SIZE];
+		volatile uint8_t _trace_head = 0u;
+		volatile uint8_t _trace_count = 0u;
+
+		void _trace_write(uint8_t kind, uint8_t value);
+#endif
+
+		void _put_char(uint8_t byte);
+		void _sync_cursor(void);
+		bool _set_cursor_lazy(uint8_t cx, uint8_t cy);
+		bool _put_number(uint32_t magnitude, bool negative, uint8_t base, uint8_t n_decimals, uint8_t width, intptr_t align, char pad);
+		static uint8_t _format_number(uint8_t *p_end, uint32_t magnitude, uint8_t base, uint8_t n_decimals);
+		void _put_field(const uint8_t *field, uint8_t length);
+		void _put_codepoint(uint32_t codepoint);
+
+		static constexpr uint32_t _UTF8_INVALID = 0xffffffff;
+
+		static uint8_t _utf8_decode(const uint8_t *text, uintptr_t length, uint32_t *p_codepoint);
+		static bool _rom_lookup(uint32_t codepoint, uint8_t *p_code);
+		void _track_byte(bool reg, uint8_t byte);
+
+		bool _validate_rect(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height);
+		uint32_t _plan_fill(uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, uint8_t byte, bool *p_clear);
+		static uint32_t _plan_cell(uint8_t *p_ac, uint8_t idx);
+
+		static uint8_t _ddram_addr_to_idx(uint8_t addr);
+		static uint8_t _idx_to_ddram_addr(uint8_t idx);
+		static uint8_t _next_idx(uint8_t idx);
+
+		/*Busy flag polling state*/
+		bool _bf_ok = false;
+		uint16_t _bf_pending_us = 0u;
+		unsigned long _bf_t_write = 0u;
+
+		static uint16_t _exec_time_us(bool reg, uint8_t byte);
+
 		void _send_byte(bool reg, uint8_t byte);
+		void _bus_send_byte(bool reg, uint8_t byte);
+		void _transport_flush(void);
+		void _transmit_byte(bool reg, uint8_t byte);
 		void _write_nibble(uint8_t nibble);
+		void _write_low_nibble(uint8_t nibble);
+		void _write_byte(uint8_t byte);
+
+#if defined(__AVR__)
+		/*Single port DB4-DB7 fast path (_db_out is NULL if the data pins are spread over several ports)*/
+		volatile uint8_t *_db_out = NULL;
+		volatile uint8_t *_db_in = NULL;
+		volatile uint8_t *_db_ddr = NULL;
+		uint8_t _db_mask = 0u;
+		uint8_t _db_lut[16];
+
+		/*Same for DB0-DB3 in 8-bit mode*/
+		volatile uint8_t *_db_lo_out = NULL;
+		volatile uint8_t *_db_lo_in = NULL;
+		volatile uint8_t *_db_lo_ddr = NULL;
+		uint8_t _db_lo_mask = 0u;
+		uint8_t _db_lo_lut[16];
+#endif
+
+		void _load_port_masks(void);
+
+#if LCD_CFG_ASYNC
+		static constexpr uint8_t _TXQ_MASK = (LCD_CFG_TXQUEUE_SIZE - 1);
+
+		struct _lcd_txq_entry _txq[LCD_CFG_TXQUEUE_SIZE];
+		volatile uint8_t _txq_head = 0u;
+		volatile uint8_t _txq_tail = 0u;
+		volatile bool _async_running = false;
+		bool _async_mode = false;
+		bool _async_bf_ok = false;
+		uint8_t _txq_hwm = 0u;
+
+		void _txq_push(bool reg, uint8_t byte, uint16_t delay_us);
+		bool _async_timer_start(void);
+		void _async_timer_stop(void);
+		void _async_timer_schedule(uint16_t delay_us);
+
+		friend void _lcd_async_timer_isr(void);
+
+#if __LCD_ASYNC_TIMER1
+		static LCD *_async_lcd;
+#endif
+#endif
+
+		void _wait_ready(void);
+		uint8_t _read_bf_ac(void);
+		uint8_t _read_nibble(void);
+		uint8_t _read_low_nibble(void);
+		void _set_data_dir(uint8_t mode);
 
 		void _send_init_nibble(void);
+		void _send_init_8bit(void);
 
 		bool _validate_info(void);
 
 		bool _phys_text_cx_cy_to_virt_text_cx_cy(uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy);
 
+		void _load_line_addr_table(void);
+		bool _phys_text_cx_cy_to_ddram_addr(uint8_t *p_addr, uint8_t physcx, uint8_t physcy);
+
 
 
 };
 
+#if LCD_CFG_ASYNC
+void _lcd_async_timer_isr(void);
+#endif
+
 #endif /*LCD_HPP*/
 
@@ -0,0 +1,597 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Shared bus transport (several displays on the same DB4-DB7 and RS pins, one E pin each).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_bus.hpp"
+
+LCDBus::LCDBus(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs)
+{
+	this->_db4 = db4;
+	this->_db5 = db5;
+	this->_db6 = db6;
+	this->_db7 = db7;
+	this->_rs = rs;
+}
+
+bool LCDBus::poll(void)
+{
+	uint8_t n_display = 0u;
+
+	if(!this->_init) return true;
+
+	while(this->_service());
+
+	for(n_display = 0u; n_display < this->_n_displays; n_display++)
+	{
+		if(this->_displays[n_display]->_head != this->_displays[n_display]->_tail) return false;
+	}
+
+	return true;
+}
+
+void LCDBus::flush(void)
+{
+	while(!this->poll());
+
+	return;
+}
+
+bool LCDBus::isIdle(void)
+{
+	LCDBusTransport *display = NULL;
+	unsigned long t_now = 0u;
+	uint8_t n_display = 0u;
+
+	if(!this->_init) return true;
+
+	t_now = micros();
+
+	for(n_display = 0u; n_display < this->_n_displays; n_display++)
+	{
+		display = this->_displays[n_display];
+
+		if(display->_head != display->_tail) return false;
+		if(((long) (t_now - display->_t_ready)) < 0) return false;
+	}
+
+	return true;
+}
+
+void LCDBus::_init_pins(void)
+{
+#if defined(__AVR__)
+	uint8_t port = 0u;
+	uint8_t nibble = 0u;
+	uint8_t bits[4];
+#endif
+
+	pinMode(this->_rs, OUTPUT);
+	pinMode(this->_db4, OUTPUT);
+	pinMode(this->_db5, OUTPUT);
+	pinMode(this->_db6, OUTPUT);
+	pinMode(this->_db7, OUTPUT);
+
+#if defined(__AVR__)
+	this->_db_out = NULL;
+
+	port = digitalPinToPort(this->_db4);
+
+	if((port != NOT_A_PIN) && (digitalPinToPort(this->_db5) == port) && (digitalPinToPort(this->_db6) == port) && (digitalPinToPort(this->_db7) == port))
+	{
+		bits[0] = digitalPinToBitMask(this->_db4);
+		bits[1] = digitalPinToBitMask(this->_db5);
+		bits[2] = digitalPinToBitMask(this->_db6);
+		bits[3] = digitalPinToBitMask(this->_db7);
+
+		this->_db_mask = bits[0] | bits[1] | bits[2] | bits[3];
+
+		for(nibble = 0u; nibble < 16u; nibble++)
+		{
+			this->_db_lut[nibble] = 0u;
+			if(nibble & 0x1) this->_db_lut[nibble] |= bits[0];
+			if(nibble & 0x2) this->_db_lut[nibble] |= bits[1];
+			if(nibble & 0x4) this->_db_lut[nibble] |= bits[2];
+			if(nibble & 0x8) this->_db_lut[nibble] |= bits[3];
+		}
+
+		this->_db_out = portOutputRegister(port);
+	}
+#endif
+
+	this->_n_displays = 0u;
+	this->_next = 0u;
+	this->_init = true;
+
+	return;
+}
+
+bool LCDBus::_attach(LCDBusTransport *display)
+{
+	uint8_t n_display = 0u;
+
+	for(n_display = 0u; n_display < this->_n_displays; n_display++)
+	{
+		if(this->_displays[n_display] == display) return true;
+	}
+
+	if(this->_n_displays >= LCD_CFG_BUS_MAX_DISPLAYS) return false;
+
+	this->_displays[this->_n_displays] = display;
+	this->_n_displays++;
+
+	return true;
+}
+
+void LCDBus::_detach(LCDBusTransport *display)
+{
+	uint8_t n_display = 0u;
+
+	for(n_display = 0u; n_display < this->_n_displays; n_display++)
+	{
+		if(this->_displays[n_display] != display) continue;
+
+		this->_n_displays--;
+		this->_displays[n_display] = this->_displays[this->_n_displays];
+		this->_next = 0u;
+
+		return;
+	}
+
+	return;
+}
+
+/*
+ * One round robin pass over the displays, starting after the last one served:
+ * every display with a queued byte that isn't executing an instruction gets its next byte.
+ * A mirrored byte waits until it is next in every member queue.
+ * returns true if anything was sent.
+ */
+
+bool LCDBus::_service(void)
+{
+	LCDBusTransport *display = NULL;
+	const struct LCDBusTransport::_entry *entry = NULL;
+	uint8_t n_display = 0u;
+	uint8_t idx = 0u;
+	bool sent = false;
+
+	for(n_display = 0u; n_display < this->_n_displays; n_display++)
+	{
+		idx = this->_next + n_display;
+		if(idx >= this->_n_displays) idx -= this->_n_displays;
+
+		display = this->_displays[idx];
+
+		if(display->_head == display->_tail) continue;
+		if(((long) (micros() - display->_t_ready)) < 0) continue;
+
+		entry = &(display->_queue[display->_tail & display->_QUEUE_MASK]);
+
+		if(entry->flags & display->_ENTRY_MIRROR)
+		{
+			if(this->_service_mirror(display->_mirror)) sent = true;
+			continue;
+		}
+
+		this->_strobe(entry->byte, entry->flags, &display, 1u, NULL);
+
+		display->_t_ready = micros() + ((unsigned long) entry->delay_us) + this->_TICK_US;
+		display->_tail++;
+
+		sent = true;
+	}
+
+	if(this->_n_displays)
+	{
+		this->_next++;
+		if(this->_next >= this->_n_displays) this->_next = 0u;
+	}
+
+	return sent;
+}
+
+/*
+ * Sends the next mirrored byte if every member has it next in its queue and none is executing an instruction.
+ * returns true if it was sent.
+ */
+
+bool LCDBus::_service_mirror(LCDBusMirror *mirror)
+{
+	LCDBusTransport *display = NULL;
+	const struct LCDBusTransport::_entry *entry = NULL;
+	unsigned long t_ready = 0u;
+	uint8_t n_member = 0u;
+
+	for(n_member = 0u; n_member < mirror->_n_members; n_member++)
+	{
+		display = mirror->_displays[n_member];
+
+		if(display->_head == display->_tail) return false;
+		if(!(display->_queue[display->_tail & display->_QUEUE_MASK].flags & display->_ENTRY_MIRROR)) return false;
+		if(((long) (micros() - display->_t_ready)) < 0) return false;
+	}
+
+	entry = &(mirror->_queue[mirror->_tail & mirror->_QUEUE_MASK]);
+
+	this->_strobe(entry->byte, entry->flags, mirror->_displays, mirror->_n_members, mirror);
+
+	t_ready = micros() + ((unsigned long) entry->delay_us) + this->_TICK_US;
+	mirror->_tail++;
+
+	for(n_member = 0u; n_member < mirror->_n_members; n_member++)
+	{
+		mirror->_displays[n_member]->_t_ready = t_ready;
+		mirror->_displays[n_member]->_tail++;
+	}
+
+	return true;
+}
+
+/*Strobes a byte into the given displays (their E lines pulse together), the other displays ignore the shared lines.*/
+void LCDBus::_strobe(uint8_t byte, uint8_t flags, LCDBusTransport *const *displays, uint8_t n_displays, const LCDBusMirror *mirror)
+{
+	digitalWrite(this->_rs, (flags & LCDBusTransport::_ENTRY_REG));
+	this->_write_nibble(byte >> 4);
+	delayMicroseconds(this->_EN_DELAY_US);
+
+	this->_set_e(displays, n_displays, mirror, 1);
+	delayMicroseconds(this->_EN_DELAY_US);
+	this->_set_e(displays, n_displays, mirror, 0);
+
+	if(!(flags & LCDBusTransport::_ENTRY_INIT_NIBBLE))
+	{
+		delayMicroseconds(this->_EN_DELAY_US);
+		this->_write_nibble(byte & 0xf);
+
+		this->_set_e(displays, n_displays, mirror, 1);
+		delayMicroseconds(this->_EN_DELAY_US);
+		this->_set_e(displays, n_displays, mirror, 0);
+	}
+
+	return;
+}
+
+/*Mirror E lines sharing a port change with a single read-modify-write, otherwise one after the other*/
+void LCDBus::_set_e(LCDBusTransport *const *displays, uint8_t n_displays, const LCDBusMirror *mirror, uint8_t level)
+{
+	uint8_t n_display = 0u;
+
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	if((mirror != NULL) && (mirror->_e_out != NULL))
+	{
+		sreg = SREG;
+		cli();
+
+		if(level) *(mirror->_e_out) |= mirror->_e_mask;
+		else *(mirror->_e_out) &= ~(mirror->_e_mask);
+
+		SREG = sreg;
+		return;
+	}
+#else
+	(void) mirror;
+#endif
+
+	for(n_display = 0u; n_display < n_displays; n_display++) digitalWrite(displays[n_display]->_e, level);
+
+	return;
+}
+
+void LCDBus::_write_nibble(uint8_t nibble)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	/*All data lines change at once with a single read-modify-write of the port*/
+	if(this->_db_out != NULL)
+	{
+		sreg = SREG;
+		cli();
+		*(this->_db_out) = (*(this->_db_out) & ~(this->_db_mask)) | this->_db_lut[nibble];
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	digitalWrite(this->_db7, (nibble & 0x8));
+	digitalWrite(this->_db6, (nibble & 0x4));
+	digitalWrite(this->_db5, (nibble & 0x2));
+	digitalWrite(this->_db4, (nibble & 0x1));
+
+	return;
+}
+
+LCDBusTransport::LCDBusTransport(LCDBus *bus, uint8_t e)
+{
+	this->_bus = bus;
+	this->_e = e;
+}
+
+LCDBusTransport::~LCDBusTransport(void)
+{
+	if(this->_mirror != NULL) this->_mirror->_release();
+	if(this->_bus != NULL) this->_bus->_detach(this);
+}
+
+bool LCDBusTransport::begin(void)
+{
+	if(this->_bus == NULL) return false;
+	if(this->_e == LCD::PIN_NONE) return false;
+
+	if(!this->_bus->_init) this->_bus->_init_pins();
+
+	/*Reinitialization sends whatever the bus still had queued first (mirrored bytes need every member's queue)*/
+	this->_bus->flush();
+
+	this->_head = 0u;
+	this->_tail = 0u;
+	this->_t_ready = micros();
+
+	if(!this->_bus->_attach(this)) return false;
+
+	pinMode(this->_e, OUTPUT);
+	digitalWrite(this->_e, 0);
+
+	return true;
+}
+
+void LCDBusTransport::sendInitNibble(uint8_t nibble, uint16_t delayUs)
+{
+	this->_push((nibble << 4), this->_ENTRY_INIT_NIBBLE, delayUs);
+	return;
+}
+
+void LCDBusTransport::sendByte(bool reg, uint8_t byte, uint16_t delayUs)
+{
+	this->_push(byte, (reg ? this->_ENTRY_REG : 0u), delayUs);
+	return;
+}
+
+/*End of an LCD call: whatever is ready goes out now, the rest on the next poll*/
+void LCDBusTransport::flush(void)
+{
+	while(this->_bus->_service());
+
+	return;
+}
+
+/*A full queue keeps the whole bus moving (not just this display) until there's room*/
+void LCDBusTransport::_push(uint8_t byte, uint8_t flags, uint16_t delay_us)
+{
+	struct _entry *entry = NULL;
+
+	while(((uint8_t) (this->_head - this->_tail)) >= LCD_CFG_BUS_QUEUE_SIZE) this->_bus->_service();
+
+	entry = &(this->_queue[this->_head & this->_QUEUE_MASK]);
+	entry->byte = byte;
+	entry->flags = flags;
+	entry->delay_us = delay_us;
+
+	this->_head++;
+	return;
+}
+
+LCDBusMirror::LCDBusMirror(LCDBus *bus, LCD *const *members, uint8_t nMembers)
+{
+	uint8_t n_member = 0u;
+
+	this->_bus = bus;
+
+	for(n_member = 0u; n_member < LCD_CFG_BUS_MAX_DISPLAYS; n_member++) this->_displays[n_member] = NULL;
+
+	if(members == NULL) return;
+	if(nMembers > LCD_CFG_BUS_MAX_DISPLAYS) return;
+
+	for(n_member = 0u; n_member < nMembers; n_member++) this->_members[n_member] = members[n_member];
+
+	this->_n_members = nMembers;
+}
+
+LCDBusMirror::~LCDBusMirror(void)
+{
+	this->_release();
+}
+
+bool LCDBusMirror::begin(void)
+{
+	LCD *member = NULL;
+	uint8_t n_member = 0u;
+	uint8_t n_display = 0u;
+
+	if(this->_bus == NULL) return false;
+	if(!this->_bus->_init) return false;
+	if(!this->_n_members) return false;
+
+	/*Reinitialization: every mirrored byte still queued goes out first*/
+	this->_release();
+
+	for(n_member = 0u; n_member < this->_n_members; n_member++)
+	{
+		member = this->_members[n_member];
+
+		if(member == NULL) return false;
+		if(member->_status != LCD::STATUS_INITIALIZED) return false;
+
+		/*The member transport must be one of the bus displays (no RTTI to check it otherwise)*/
+		for(n_display = 0u; n_display < this->_bus->_n_displays; n_display++)
+		{
+			if(member->_transport == this->_bus->_displays[n_display]) break;
+		}
+
+		if(n_display >= this->_bus->_n_displays) return false;
+		if(this->_bus->_displays[n_display]->_mirror != NULL) return false;
+
+		this->_displays[n_member] = this->_bus->_displays[n_display];
+	}
+
+	for(n_member = 0u; n_member < this->_n_members; n_member++) this->_displays[n_member]->_mirror = this;
+
+	this->_load_e_mask();
+
+	this->_head = 0u;
+	this->_tail = 0u;
+	this->_ac = 0xff;
+
+	return true;
+}
+
+/*The members are already in 4-bit mode: a lone nibble now would be taken as half a byte*/
+void LCDBusMirror::sendInitNibble(uint8_t nibble, uint16_t delayUs)
+{
+	(void) nibble;
+	(void) delayUs;
+
+	return;
+}
+
+/*
+ * Data writes and cursor moves depend on the address counter, which a member's own writes may have moved since the last
+ * mirrored byte: those get an address set first, so that every member writes where the mirror does.
+ */
+
+void LCDBusMirror::sendByte(bool reg, uint8_t byte, uint16_t delayUs)
+{
+	uint8_t n_member = 0u;
+
+	if((reg || ((byte & 0xf8) == 0x10)) && (this->_ac < LCD::DDRAM_SIZE))
+	{
+		for(n_member = 0u; n_member < this->_n_members; n_member++)
+		{
+			if(this->_members[n_member]->_ac == this->_ac) continue;
+
+			this->_push(false, (0x80 | LCD::_idx_to_ddram_addr(this->_ac)), LCD::_exec_time_us(false, 0x80));
+			break;
+		}
+	}
+
+	this->_push(reg, byte, delayUs);
+
+	/*Every member's address counter now matches the mirror's*/
+	this->_ac = this->_members[0]->_ac;
+
+	return;
+}
+
+void LCDBusMirror::flush(void)
+{
+	while(this->_bus->_service());
+
+	return;
+}
+
+uintptr_t LCDBusMirror::sync(LCD *mirror)
+{
+#if LCD_CFG_FRAMEBUFFER
+	uintptr_t n_cells = 0u;
+	uint8_t n_line = 0u;
+	uint8_t n_char = 0u;
+	uint8_t n_member = 0u;
+	uint8_t addr = 0u;
+	uint8_t idx = 0u;
+
+	if(mirror == NULL) return 0u;
+	if(mirror->_status != LCD::STATUS_INITIALIZED) return 0u;
+	if(mirror->_transport != this) return 0u;
+
+	for(n_line = 0u; n_line < mirror->_info.n_lines; n_line++)
+	{
+		for(n_char = 0u; n_char < mirror->_info.n_chars; n_char++)
+		{
+			if(!mirror->_phys_text_cx_cy_to_ddram_addr(&addr, n_char, n_line)) continue;
+
+			idx = LCD::_ddram_addr_to_idx(addr);
+			if(idx >= LCD::DDRAM_SIZE) continue;
+
+			for(n_member = 0u; n_member < this->_n_members; n_member++)
+			{
+				if(this->_members[n_member]->_fb[idx] == mirror->_fb[idx]) continue;
+
+				mirror->_fb_set_dirty(idx, true);
+				n_cells++;
+				break;
+			}
+		}
+	}
+
+	return n_cells;
+#else
+	(void) mirror;
+	return 0u;
+#endif
+}
+
+/*
+ * Queues the byte once in the mirror and a placeholder in every member queue, so that it goes out in order with each
+ * member's own bytes. The members track it as if it had been sent to them alone.
+ */
+
+void LCDBusMirror::_push(bool reg, uint8_t byte, uint16_t delay_us)
+{
+	struct LCDBusTransport::_entry *entry = NULL;
+	uint8_t n_member = 0u;
+
+	while(((uint8_t) (this->_head - this->_tail)) >= LCD_CFG_BUS_QUEUE_SIZE) this->_bus->_service();
+
+	entry = &(this->_queue[this->_head & this->_QUEUE_MASK]);
+	entry->byte = byte;
+	entry->flags = (reg ? LCDBusTransport::_ENTRY_REG : 0u);
+	entry->delay_us = delay_us;
+
+	this->_head++;
+
+	for(n_member = 0u; n_member < this->_n_members; n_member++)
+	{
+		this->_members[n_member]->_track_byte(reg, byte);
+		this->_displays[n_member]->_push(0u, LCDBusTransport::_ENTRY_MIRROR, 0u);
+	}
+
+	return;
+}
+
+void LCDBusMirror::_load_e_mask(void)
+{
+#if defined(__AVR__)
+	uint8_t port = 0u;
+	uint8_t n_member = 0u;
+
+	this->_e_out = NULL;
+	this->_e_mask = 0u;
+
+	port = digitalPinToPort(this->_displays[0]->_e);
+	if(port == NOT_A_PIN) return;
+
+	for(n_member = 0u; n_member < this->_n_members; n_member++)
+	{
+		if(digitalPinToPort(this->_displays[n_member]->_e) != port) return;
+		this->_e_mask |= digitalPinToBitMask(this->_displays[n_member]->_e);
+	}
+
+	this->_e_out = portOutputRegister(port);
+#endif
+	return;
+}
+
+/*Lets the members go, so that they can join another mirror. Their queued placeholders go out first*/
+void LCDBusMirror::_release(void)
+{
+	uint8_t n_member = 0u;
+
+	if((this->_bus != NULL) && this->_bus->_init) this->_bus->flush();
+
+	for(n_member = 0u; n_member < this->_n_members; n_member++)
+	{
+		if(this->_displays[n_member] == NULL) continue;
+		if(this->_displays[n_member]->_mirror == this) this->_displays[n_member]->_mirror = NULL;
+		this->_displays[n_member] = NULL;
+	}
+
+	return;
+}
@@ -0,0 +1,251 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Shared bus transport (several displays on the same DB4-DB7 and RS pins, one E pin each).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_BUS_HPP
+#define LCD_BUS_HPP
+
+#include "lcd.hpp"
+
+/*
+ * LCD_CFG_BUS_QUEUE_SIZE
+ *
+ * Number of bytes each display can have queued (power of 2, up to 128). Each entry takes 4 bytes.
+ * A 20x4 screen refresh takes 84 bytes: with smaller queues, update the displays a line at a time each
+ * (lcd1 line 0, lcd2 line 0, lcd1 line 1...) so that every queue keeps something to send.
+ *
+ * LCD_CFG_BUS_MAX_DISPLAYS
+ *
+ * Maximum number of displays on a single bus.
+ */
+
+#ifndef LCD_CFG_BUS_QUEUE_SIZE
+#define LCD_CFG_BUS_QUEUE_SIZE 32
+#endif
+
+#ifndef LCD_CFG_BUS_MAX_DISPLAYS
+#define LCD_CFG_BUS_MAX_DISPLAYS 4
+#endif
+
+class LCDBusTransport;
+class LCDBusMirror;
+
+/*
+ * LCDBus
+ *
+ * Owns the shared pins and schedules the byte queues of its displays (LCDBusTransport): every display that isn't
+ * executing an instruction gets its next byte, so one display's execution time (37us per byte, 1.52ms per clear)
+ * is spent writing to the others instead of waiting.
+ *
+ * Bytes go out while queuing (when a queue is full), at the end of every LCD call and on poll()/flush().
+ * Call poll() from loop(), or flush() once every display was updated.
+ *
+ * 4-bit bus only, the R/W pins must be tied low (execution times are timed, the busy flag isn't read).
+ * An E pin isn't driven until begin() of its display, so give each E line a pull-down resistor
+ * to keep that display from latching the bytes sent to the others before then.
+ *
+ * Example (TestLCD2 wiring):
+ * LCDBus lcd_bus(20, 21, 22, 23, 14);
+ * LCDBusTransport lcd_bus_1(&lcd_bus, 30);
+ * LCDBusTransport lcd_bus_2(&lcd_bus, 29);
+ * LCD lcd1(&lcd_bus_1, 20, 4);
+ * LCD lcd2(&lcd_bus_2, 16, 2);
+ */
+
+class LCDBus {
+	public:
+		LCDBus(uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7, uint8_t rs);
+
+		/*
+		 * poll()
+		 *
+		 * sends the next queued byte of every display that finished executing its last instruction, as long as there are any,
+		 * without waiting for the busy ones.
+		 * returns true if every queue is empty, false otherwise.
+		 */
+
+		bool poll(void);
+
+		/*
+		 * flush()
+		 *
+		 * sends every queued byte of every display, overlapping their execution times.
+		 * returns once the last byte was sent (the display may still be executing it).
+		 */
+
+		void flush(void);
+
+		/*
+		 * isIdle()
+		 *
+		 * returns true if every queue is empty and every display finished executing its last instruction, false otherwise.
+		 */
+
+		bool isIdle(void);
+
+	private:
+		friend class LCDBusTransport;
+		friend class LCDBusMirror;
+
+		static constexpr uintptr_t _EN_DELAY_US = 1u;
+
+		/*micros() resolution: the execution time is counted from the next tick after the write*/
+#if defined(__AVR__) && defined(F_CPU)
+		static constexpr unsigned long _TICK_US = ((64000000UL/F_CPU) ? (64000000UL/F_CPU) : 1UL);
+#else
+		static constexpr unsigned long _TICK_US = 1UL;
+#endif
+
+		uint8_t _db4 = 0u;
+		uint8_t _db5 = 0u;
+		uint8_t _db6 = 0u;
+		uint8_t _db7 = 0u;
+		uint8_t _rs = 0u;
+		bool _init = false;
+		uint8_t _n_displays = 0u;
+		uint8_t _next = 0u;
+		LCDBusTransport *_displays[LCD_CFG_BUS_MAX_DISPLAYS];
+
+#if defined(__AVR__)
+		/*Single port DB4-DB7 fast path (_db_out is NULL if the data pins are spread over several ports)*/
+		volatile uint8_t *_db_out = NULL;
+		uint8_t _db_mask = 0u;
+		uint8_t _db_lut[16];
+#endif
+
+		void _init_pins(void);
+		bool _attach(LCDBusTransport *display);
+		void _detach(LCDBusTransport *display);
+		bool _service(void);
+		bool _service_mirror(LCDBusMirror *mirror);
+		void _strobe(uint8_t byte, uint8_t flags, LCDBusTransport *const *displays, uint8_t n_displays, const LCDBusMirror *mirror);
+		void _set_e(LCDBusTransport *const *displays, uint8_t n_displays, const LCDBusMirror *mirror, uint8_t level);
+		void _write_nibble(uint8_t nibble);
+};
+
+/*
+ * LCDBusTransport
+ *
+ * One display on an LCDBus, with its own E pin. The bus must outlive it.
+ */
+
+class LCDBusTransport : public LCDTransport {
+	public:
+		LCDBusTransport(LCDBus *bus, uint8_t e);
+		~LCDBusTransport(void);
+
+		bool begin(void) override;
+		void sendInitNibble(uint8_t nibble, uint16_t delayUs) override;
+		void sendByte(bool reg, uint8_t byte, uint16_t delayUs) override;
+		void flush(void) override;
+
+	private:
+		friend class LCDBus;
+		friend class LCDBusMirror;
+
+		static constexpr uint8_t _ENTRY_REG = 0x01;
+		static constexpr uint8_t _ENTRY_INIT_NIBBLE = 0x02;
+
+		/*Placeholder: the next byte of the display's mirror*/
+		static constexpr uint8_t _ENTRY_MIRROR = 0x04;
+
+		static constexpr uint8_t _QUEUE_MASK = (LCD_CFG_BUS_QUEUE_SIZE - 1);
+
+		struct _entry {
+			uint8_t byte;
+			uint8_t flags;
+			uint16_t delay_us;
+		};
+
+		LCDBus *_bus = NULL;
+		uint8_t _e = 0u;
+		unsigned long _t_ready = 0u;
+		uint8_t _head = 0u;
+		uint8_t _tail = 0u;
+		LCDBusMirror *_mirror = NULL;
+		struct _entry _queue[LCD_CFG_BUS_QUEUE_SIZE];
+
+		void _push(uint8_t byte, uint8_t flags, uint16_t delay_us);
+};
+
+/*
+ * LCDBusMirror
+ *
+ * Mirror group: an LCD on this transport drives every member display at once. Each byte it sends is strobed with the
+ * E lines of all members raised together, so mirrored content costs one transfer instead of one per display.
+ * On AVR with every member E pin on the same port, the E lines rise and fall with a single port write. Otherwise they
+ * are raised one after the other (a few microseconds apart), then dropped the same way.
+ * The members stay usable on their own: their own bytes keep going out individually, in order with the mirrored ones.
+ * After a member's own writes, the next mirrored write first puts the cursor of every member back where the mirror left it.
+ *
+ * The members must be LCDs on LCDBusTransports of the same bus, initialized (begin()) before the mirror, and a display
+ * can only belong to one mirror. begin() of the mirror doesn't send the init nibble (the members are already
+ * in 4-bit mode) but clears every member.
+ * The mirror geometry is the area shown on every member: usually the smallest member's size
+ * (16x2 for a 20x4 and a 16x2). 4 line mirrors need members with the same number of characters per line.
+ *
+ * Every member keeps track of the mirrored bytes (cursor position, framebuffer contents). With LCD_CFG_FRAMEBUFFER,
+ * sync() finds the cells a member was given its own content for, so that the next flush() of the mirror LCD
+ * puts the mirrored contents back.
+ *
+ * Example (with the displays of the LCDBus example):
+ * LCD *lcd_members[] = {&lcd1, &lcd2};
+ * LCDBusMirror lcd_mirror(&lcd_bus, lcd_members, 2);
+ * LCD lcd_all(&lcd_mirror, 16, 2);
+ */
+
+class LCDBusMirror : public LCDTransport {
+	public:
+		LCDBusMirror(LCDBus *bus, LCD *const *members, uint8_t nMembers);
+		~LCDBusMirror(void);
+
+		bool begin(void) override;
+		void sendInitNibble(uint8_t nibble, uint16_t delayUs) override;
+		void sendByte(bool reg, uint8_t byte, uint16_t delayUs) override;
+		void flush(void) override;
+
+		/*
+		 * sync()
+		 *
+		 * marks every cell of the mirror area that some member doesn't show (because it was written to that member alone)
+		 * as changed in the framebuffer of "mirror" (the LCD on this transport), so that its next flush() (framebuffer mode)
+		 * rewrites it on every member, one transfer per cell. Cells every member already shows stay untouched.
+		 * Requires LCD_CFG_FRAMEBUFFER.
+		 * returns the number of cells marked.
+		 */
+
+		uintptr_t sync(LCD *mirror);
+
+	private:
+		friend class LCDBus;
+		friend class LCDBusTransport;
+
+		static constexpr uint8_t _QUEUE_MASK = (LCD_CFG_BUS_QUEUE_SIZE - 1);
+
+		LCDBus *_bus = NULL;
+		LCD *_members[LCD_CFG_BUS_MAX_DISPLAYS];
+		LCDBusTransport *_displays[LCD_CFG_BUS_MAX_DISPLAYS];
+		uint8_t _n_members = 0u;
+		uint8_t _ac = 0xff;
+		uint8_t _head = 0u;
+		uint8_t _tail = 0u;
+		struct LCDBusTransport::_entry _queue[LCD_CFG_BUS_QUEUE_SIZE];
+
+#if defined(__AVR__)
+		/*Single port E fast path (_e_out is NULL if the member E pins are spread over several ports)*/
+		volatile uint8_t *_e_out = NULL;
+		uint8_t _e_mask = 0u;
+#endif
+
+		void _push(bool reg, uint8_t byte, uint16_t delay_us);
+		void _release(void);
+		void _load_e_mask(void);
+};
+
+#endif /*LCD_BUS_HPP*/
@@ -0,0 +1,186 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Console (text stream with control characters, line wrap and scrolling).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_console.hpp"
+
+#if LCD_CFG_FRAMEBUFFER
+
+LCDConsole::LCDConsole(LCD *lcd)
+{
+	this->_lcd = lcd;
+}
+
+bool LCDConsole::clear(void)
+{
+	if(this->_lcd == NULL) return false;
+
+	if(!this->_lcd->clear()) return false;
+
+	this->_cx = 0u;
+	this->_cy = 0u;
+
+	return true;
+}
+
+bool LCDConsole::setCursorPosition(uint8_t cx, uint8_t cy)
+{
+	if(this->_lcd == NULL) return false;
+	if(cx >= this->_lcd->_info.n_chars) return false;
+	if(cy >= this->_lcd->_info.n_lines) return false;
+
+	this->_cx = cx;
+	this->_cy = cy;
+
+	return true;
+}
+
+size_t LCDConsole::write(const uint8_t *buffer, size_t size)
+{
+	uint8_t n_chars = 0u;
+	uint8_t n_lines = 0u;
+	size_t n_byte = 0u;
+	uint8_t run = 0u;
+	uint8_t byte = 0u;
+
+	if(buffer == NULL) return 0u;
+	if(this->_lcd == NULL) return 0u;
+	if(this->_lcd->_status < 1) return 0u;
+
+	n_chars = this->_lcd->_info.n_chars;
+	n_lines = this->_lcd->_info.n_lines;
+
+	while(n_byte < size)
+	{
+		if(this->_control(buffer[n_byte]))
+		{
+			n_byte++;
+			continue;
+		}
+
+		/*Line end reached by the previous character: wrap now*/
+		if(this->_cx >= n_chars)
+		{
+			this->_cx = 0u;
+			this->_cy++;
+		}
+
+		/*Printable characters up to the next control character or the line end*/
+		run = 0u;
+		while(((n_byte + run) < size) && (run < (n_chars - this->_cx)))
+		{
+			byte = buffer[n_byte + run];
+			if((byte == '\n') || (byte == '\r') || (byte == '\b') || (byte == '\t')) break;
+			run++;
+		}
+
+		if(this->_cy >= n_lines)
+		{
+			this->_scroll(&(buffer[n_byte]), run);
+			this->_cy = n_lines - 1u;
+		}
+		else
+		{
+			this->_lcd->_set_cursor_lazy(this->_cx, this->_cy);
+			this->_lcd->_put_field(&(buffer[n_byte]), run);
+		}
+
+		this->_cx += run;
+		n_byte += run;
+	}
+
+	/*A visible cursor shows where the next character goes*/
+	if((this->_cx < n_chars) && (this->_cy < n_lines)) this->_lcd->_set_cursor_lazy(this->_cx, this->_cy);
+
+	this->_lcd->_transport_flush();
+	return size;
+}
+
+size_t LCDConsole::write(uint8_t byte)
+{
+	return this->write(&byte, 1u);
+}
+
+/*
+ * Moves the console cursor for a control character. The line and screen ends are handled by the next printable character.
+ * returns false if "byte" is printable.
+ */
+
+bool LCDConsole::_control(uint8_t byte)
+{
+	uint8_t n_chars = this->_lcd->_info.n_chars;
+
+	switch(byte)
+	{
+		case '\n':
+			/*Past the bottom line already: scroll for the blank line in between*/
+			if(this->_cy >= this->_lcd->_info.n_lines)
+			{
+				this->_scroll(NULL, 0u);
+				this->_cy = this->_lcd->_info.n_lines - 1u;
+			}
+
+			this->_cx = 0u;
+			this->_cy++;
+			return true;
+
+		case '\r':
+			this->_cx = 0u;
+			return true;
+
+		case '\b':
+			if(this->_cx > n_chars) this->_cx = n_chars;
+			if(this->_cx) this->_cx--;
+			return true;
+
+		case '\t':
+			this->_cx = ((this->_cx/LCD_CFG_CONSOLE_TAB_SIZE) + 1u)*LCD_CFG_CONSOLE_TAB_SIZE;
+			if(this->_cx > n_chars) this->_cx = n_chars;
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Every line takes the contents of the one below it in the RAM shadow, and the bottom line gets "length" characters of "run"
+ * at the console cursor position (blanks elsewhere). Only the cells that differ from the shadow are sent,
+ * so a log of similar lines costs the characters that differ rather than the whole screen.
+ */
+
+void LCDConsole::_scroll(const uint8_t *run, uint8_t length)
+{
+	uint8_t line[LCD::DDRAM_LINE_SIZE];
+	uint8_t n_chars = this->_lcd->_info.n_chars;
+	uint8_t n_lines = this->_lcd->_info.n_lines;
+	uint8_t addr = 0u;
+	uint8_t idx = 0u;
+	uint8_t cy = 0u;
+
+	for(cy = 1u; cy < n_lines; cy++)
+	{
+		this->_lcd->_phys_text_cx_cy_to_ddram_addr(&addr, 0u, cy);
+		idx = this->_lcd->_ddram_addr_to_idx(addr);
+
+		memcpy(line, &(this->_lcd->_fb[idx]), n_chars);
+
+		this->_lcd->_set_cursor_lazy(0u, (cy - 1u));
+		this->_lcd->_put_field(line, n_chars);
+	}
+
+	memset(line, ' ', n_chars);
+	if(length) memcpy(&(line[this->_cx]), run, length);
+
+	this->_lcd->_set_cursor_lazy(0u, (n_lines - 1u));
+	this->_lcd->_put_field(line, n_chars);
+
+	return;
+}
+
+#endif /*LCD_CFG_FRAMEBUFFER*/
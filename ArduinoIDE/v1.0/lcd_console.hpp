@@ -0,0 +1,101 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Console (text stream with control characters, line wrap and scrolling).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_CONSOLE_HPP
+#define LCD_CONSOLE_HPP
+
+#include "lcd.hpp"
+
+/*
+ * LCD_CFG_CONSOLE_TAB_SIZE
+ *
+ * Distance between two tab stops, in characters.
+ */
+
+#ifndef LCD_CFG_CONSOLE_TAB_SIZE
+#define LCD_CFG_CONSOLE_TAB_SIZE 4
+#endif
+
+#if LCD_CFG_FRAMEBUFFER
+
+/*
+ * LCDConsole
+ *
+ * Arduino Print stream on the display: print(), println() and write() print line after line in screen order
+ * (also on 20x4 displays, whose DDRAM lines are interleaved), like a terminal:
+ *
+ * '\n': next line, first character.
+ * '\r': first character of the line (println() sends "\r\n").
+ * '\b': one character back, without erasing it (nothing at the first character of a line).
+ * '\t': next tab stop (the line end at most), without erasing the characters skipped.
+ *
+ * Text reaching the line end wraps to the next line. Past the bottom line, the screen scrolls up by one line,
+ * but only when something is printed there: println() doesn't leave a blank bottom line.
+ * Scrolling moves the lines through the RAM shadow of the display, so only the cells that differ are sent.
+ * Every other byte (custom glyph codes 0 to 7 included) is printed as is.
+ *
+ * The console keeps its own cursor: LCD::setCursorPosition() and the LCD print functions don't move it.
+ * Requires LCD_CFG_FRAMEBUFFER (the console isn't built without the RAM shadow).
+ *
+ * Example:
+ * LCDConsole console(&lcd1);
+ * console.clear();
+ * console.println("Booting...");
+ * console.print(F("Sensors: "));
+ * console.println(n_sensors);
+ */
+
+class LCDConsole : public Print {
+	public:
+		LCDConsole(LCD *lcd);
+
+		/*
+		 * clear()
+		 *
+		 * clear the display and move the console cursor to (0 , 0). The display must be initialized.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool clear(void);
+
+		/*
+		 * setCursorPosition()
+		 *
+		 * move the console cursor to character "cx" of line "cy".
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setCursorPosition(uint8_t cx, uint8_t cy);
+
+		/*
+		 * write()
+		 *
+		 * print "size" bytes of "buffer" at the console cursor, consecutive printable characters of a line being sent together.
+		 * Print sends whole texts and numbers through it.
+		 * returns the number of bytes printed ("size", or 0 if the display isn't initialized).
+		 */
+
+		size_t write(const uint8_t *buffer, size_t size) override;
+		size_t write(uint8_t byte) override;
+
+		using Print::write;
+
+	private:
+		LCD *_lcd = NULL;
+		uint8_t _cx = 0u;
+		uint8_t _cy = 0u;
+
+		bool _control(uint8_t byte);
+		void _scroll(const uint8_t *run, uint8_t length);
+};
+
+#endif /*LCD_CFG_FRAMEBUFFER*/
+
+#endif /*LCD_CONSOLE_HPP*/
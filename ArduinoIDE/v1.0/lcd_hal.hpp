@@ -0,0 +1,38 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Hardware abstraction layer.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_HAL_HPP
+#define LCD_HAL_HPP
+
+/*
+ * The driver only talks to the hardware through this subset of the Arduino core:
+ *
+ * GPIO: pinMode(), digitalWrite(), digitalRead()
+ * Time: delayMicroseconds(), micros()
+ * Interrupts: noInterrupts(), interrupts()
+ * I2C: TwoWire (lcd_i2c.cpp only)
+ * SPI: SPIClass, SPISettings (lcd_spi.cpp only)
+ * Streams: Print (lcd_console.cpp only)
+ * Flash tables: PROGMEM, pgm_read_byte(), pgm_read_word(), pgm_read_dword() (AVR only)
+ *
+ * The AVR fast paths (direct port writes, Timer1) are only built for AVR targets.
+ *
+ * LCD_HAL_HOST
+ * Define it to build the driver on a host machine: the functions above then come from lcd_hal_host.hpp (see Host/),
+ * which runs them against an emulated HD44780 on a virtual clock.
+ */
+
+#if defined(LCD_HAL_HOST)
+#include "lcd_hal_host.hpp"
+#else
+#include <Arduino.h>
+#endif
+
+#endif /*LCD_HAL_HPP*/
@@ -0,0 +1,208 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * PCF8574/PCF8574A I2C backpack transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_i2c.hpp"
+
+LCDI2CTransport::LCDI2CTransport(uint8_t address, TwoWire *wire, uint32_t clock)
+{
+	this->_address = address;
+	this->_wire = wire;
+	this->_clock = clock;
+}
+
+bool LCDI2CTransport::begin(void)
+{
+	uint8_t address = 0u;
+
+	if(this->_wire == NULL) return false;
+	if(!this->_clock) return false;
+
+	this->_wire->begin();
+	this->_wire->setClock(this->_clock);
+
+	this->_ctrl = this->_BL;
+	this->_rs = 0u;
+	this->_n_bytes = 0u;
+	this->_pending_us = 0u;
+	this->_n_errors = 0u;
+	this->_byte_ns = (uint32_t) ((((uint64_t) this->_BITS_PER_BYTE)*1000000000ULL)/this->_clock);
+
+	/*The probe write also drives E low, so the display ignores the bus until the init nibble*/
+	if(this->_address) return this->_probe(this->_address);
+
+	for(address = 0x20; address <= 0x27; address++)
+	{
+		if(this->_probe(address)) return true;
+	}
+
+	for(address = 0x38; address <= 0x3f; address++)
+	{
+		if(this->_probe(address)) return true;
+	}
+
+	return false;
+}
+
+void LCDI2CTransport::sendInitNibble(uint8_t nibble, uint16_t delayUs)
+{
+	this->_wait_pending();
+
+	this->_rs = 0u;
+	this->_put((nibble << 4) | this->_ctrl);
+	this->_put_nibble(nibble << 4);
+	this->_write();
+
+	delayMicroseconds(delayUs);
+	return;
+}
+
+/*
+ * Expander bytes per display byte:
+ * [RS setup, only if RS changed] [high nibble | E] [high nibble] [low nibble | E] [low nibble]
+ * The display latches each nibble on the E falling edge.
+ */
+
+void LCDI2CTransport::sendByte(bool reg, uint8_t byte, uint16_t delayUs)
+{
+	uint8_t rs = 0u;
+
+	this->_wait_pending();
+
+	if(reg) rs = this->_RS;
+
+	/*RS must be stable before E rises*/
+	if(rs != this->_rs)
+	{
+		this->_rs = rs;
+		this->_put((byte & 0xf0) | this->_ctrl | rs);
+	}
+
+	this->_put_nibble(byte & 0xf0);
+	this->_put_nibble(byte << 4);
+
+	this->_pending_us = delayUs;
+	return;
+}
+
+void LCDI2CTransport::flush(void)
+{
+	this->_write();
+	return;
+}
+
+bool LCDI2CTransport::setBacklight(bool on)
+{
+	if(on) this->_ctrl = this->_BL;
+	else this->_ctrl = 0u;
+
+	/*E low: the display doesn't see this write*/
+	this->_put(this->_ctrl | this->_rs);
+
+	return this->_write();
+}
+
+uint8_t LCDI2CTransport::getAddress(void)
+{
+	return this->_address;
+}
+
+uint32_t LCDI2CTransport::getErrors(void)
+{
+	return this->_n_errors;
+}
+
+bool LCDI2CTransport::_probe(uint8_t address)
+{
+	this->_wire->beginTransmission(address);
+	this->_wire->write(this->_ctrl);
+	if(this->_wire->endTransmission() != 0) return false;
+
+	this->_address = address;
+	return true;
+}
+
+void LCDI2CTransport::_put(uint8_t byte)
+{
+	if(this->_n_bytes >= LCD_CFG_I2C_BUFFER_SIZE) this->_write();
+
+	this->_buf[this->_n_bytes] = byte;
+	this->_n_bytes++;
+
+	return;
+}
+
+void LCDI2CTransport::_put_nibble(uint8_t nibble)
+{
+	nibble &= 0xf0;
+
+	this->_put(nibble | this->_ctrl | this->_rs | this->_E);
+	this->_put(nibble | this->_ctrl | this->_rs);
+
+	return;
+}
+
+/*
+ * Makes sure the previous instruction finished executing before the next E falling edge.
+ * The next byte latches its first nibble 2 expander bytes after the last one queued, so only the rest needs waiting for:
+ * short waits are idle bytes (E low) in the same write, long ones (clear, home) a wait after sending the buffer.
+ */
+
+void LCDI2CTransport::_wait_pending(void)
+{
+	uint32_t wait_ns = 0u;
+	uint32_t n_idle = 0u;
+	uint8_t idle = 0u;
+
+	if(!this->_pending_us) return;
+
+	wait_ns = ((uint32_t) this->_pending_us)*1000u;
+	this->_pending_us = 0u;
+
+	if(wait_ns <= 2u*(this->_byte_ns)) return;
+
+	wait_ns -= 2u*(this->_byte_ns);
+	n_idle = (wait_ns + this->_byte_ns - 1u)/(this->_byte_ns);
+
+	if(n_idle > this->_MAX_IDLE_BYTES)
+	{
+		this->_write();
+		delayMicroseconds((wait_ns + 999u)/1000u);
+		return;
+	}
+
+	if(this->_n_bytes) idle = this->_buf[this->_n_bytes - 1u];
+	else idle = (this->_ctrl | this->_rs);
+
+	while(n_idle--) this->_put(idle);
+
+	return;
+}
+
+/*
+ * Sends the buffered expander bytes. sendByte() and flush() have no way to report a failure to the LCD call,
+ * so a write endTransmission() reports as failed is counted for getErrors().
+ * returns false if the write failed.
+ */
+
+bool LCDI2CTransport::_write(void)
+{
+	uint16_t n_bytes = this->_n_bytes;
+
+	if(!n_bytes) return true;
+
+	this->_n_bytes = 0u;
+
+	this->_wire->beginTransmission(this->_address);
+	this->_wire->write(this->_buf, n_bytes);
+	if(this->_wire->endTransmission() == 0) return true;
+
+	this->_n_errors++;
+	return false;
+}
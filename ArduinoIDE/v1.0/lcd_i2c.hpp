@@ -0,0 +1,122 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * PCF8574/PCF8574A I2C backpack transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_I2C_HPP
+#define LCD_I2C_HPP
+
+#include "lcd.hpp"
+
+#if !defined(LCD_HAL_HOST)
+#include <Wire.h>
+#endif
+
+/*
+ * LCD_CFG_I2C_BUFFER_SIZE
+ *
+ * Maximum number of expander bytes sent in a single I2C write. Each display byte takes 4 (5 if RS changes).
+ * Defaults to the Wire library transmit buffer size.
+ */
+
+#ifndef LCD_CFG_I2C_BUFFER_SIZE
+#if defined(BUFFER_LENGTH)
+#define LCD_CFG_I2C_BUFFER_SIZE BUFFER_LENGTH
+#elif defined(I2C_BUFFER_LENGTH)
+#define LCD_CFG_I2C_BUFFER_SIZE I2C_BUFFER_LENGTH
+#else
+#define LCD_CFG_I2C_BUFFER_SIZE 32
+#endif
+#endif
+
+/*
+ * LCDI2CTransport
+ *
+ * Expander pinout (common backpack wiring):
+ * P0 = RS, P1 = R/W (always low), P2 = E, P3 = backlight, P4-P7 = DB4-DB7.
+ *
+ * The E high/E low sequence of every byte sent by an LCD call is packed into as few I2C writes as the Wire buffer allows.
+ * Instruction execution times are covered by the I2C transfer time itself, by idle expander bytes for slightly longer ones,
+ * or by a wait after the write for clear/home.
+ *
+ * Example:
+ * LCDI2CTransport lcd_i2c;
+ * LCD lcd1(&lcd_i2c, 20, 4);
+ */
+
+class LCDI2CTransport : public LCDTransport {
+	public:
+		/*
+		 * "address": 7-bit expander address, 0 to probe 0x20-0x27 and 0x38-0x3F at begin().
+		 * "clock": I2C clock in Hz.
+		 */
+
+		LCDI2CTransport(uint8_t address = 0u, TwoWire *wire = &Wire, uint32_t clock = 400000UL);
+
+		bool begin(void) override;
+		void sendInitNibble(uint8_t nibble, uint16_t delayUs) override;
+		void sendByte(bool reg, uint8_t byte, uint16_t delayUs) override;
+		void flush(void) override;
+
+		/*
+		 * setBacklight()
+		 *
+		 * turns the backlight on/off (the backlight is on after begin()).
+		 * returns true if successful, false if the expander didn't acknowledge the write.
+		 */
+
+		bool setBacklight(bool on);
+
+		/*
+		 * getAddress()
+		 *
+		 * returns the expander address in use (the probed one if the address was 0), or 0 if none was found.
+		 */
+
+		uint8_t getAddress(void);
+
+		/*
+		 * getErrors()
+		 *
+		 * returns the number of I2C writes the expander didn't acknowledge since begin() (backpack unplugged, bus stuck).
+		 * The bytes of a failed write are lost, so the display may need begin() again.
+		 */
+
+		uint32_t getErrors(void);
+
+	private:
+		static constexpr uint8_t _RS = 0x01;
+		static constexpr uint8_t _RW = 0x02;
+		static constexpr uint8_t _E = 0x04;
+		static constexpr uint8_t _BL = 0x08;
+
+		/*Bits per byte on the wire (8 data + ACK)*/
+		static constexpr uint32_t _BITS_PER_BYTE = 9u;
+
+		/*Longer waits than this many idle bytes are done after the write instead*/
+		static constexpr uint32_t _MAX_IDLE_BYTES = 4u;
+
+		TwoWire *_wire = NULL;
+		uint32_t _clock = 0u;
+		uint8_t _address = 0u;
+		uint8_t _ctrl = 0u;
+		uint8_t _rs = 0u;
+		uint16_t _n_bytes = 0u;
+		uint16_t _pending_us = 0u;
+		uint32_t _byte_ns = 0u;
+		uint32_t _n_errors = 0u;
+		uint8_t _buf[LCD_CFG_I2C_BUFFER_SIZE];
+
+		bool _probe(uint8_t address);
+		void _put(uint8_t byte);
+		void _put_nibble(uint8_t nibble);
+		void _wait_pending(void);
+		bool _write(void);
+};
+
+#endif /*LCD_I2C_HPP*/
@@ -0,0 +1,193 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Marquee (lines longer than the display, scrolled back and forth).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_marquee.hpp"
+
+LCDMarquee::LCDMarquee(LCD *lcd, uint32_t stepMs, uint32_t pauseMs)
+{
+	this->_lcd = lcd;
+	this->setTiming(stepMs, pauseMs);
+}
+
+bool LCDMarquee::setLine(uint8_t cy, const char *text)
+{
+	if(cy >= 4u) return false;
+
+	this->_texts[cy] = text;
+	return true;
+}
+
+void LCDMarquee::setTiming(uint32_t stepMs, uint32_t pauseMs)
+{
+	this->_step_us = stepMs*1000UL;
+	this->_pause_us = pauseMs*1000UL;
+
+	return;
+}
+
+bool LCDMarquee::start(void)
+{
+	size_t length = 0u;
+	uint8_t n_chars = 0u;
+	uint8_t n_lines = 0u;
+	bool shift = false;
+	uint8_t cy = 0u;
+
+	if(this->_lcd == NULL) return false;
+	if(this->_lcd->_status < 1) return false;
+
+	n_chars = this->_lcd->_info.n_chars;
+	n_lines = this->_lcd->_info.n_lines;
+
+	this->_span = 0u;
+
+	/*The display shift moves every line, each over its own 40 character DDRAM line (1 and 2 line displays)*/
+	shift = (n_lines <= 2u);
+#if LCD_CFG_FRAMEBUFFER
+	if(this->_lcd->_fb_mode) shift = false;
+#endif
+
+	for(cy = 0u; cy < 4u; cy++)
+	{
+		if(this->_texts[cy] == NULL)
+		{
+			this->_lens[cy] = 0u;
+			if(cy < n_lines) shift = false;
+			continue;
+		}
+
+		if(cy >= n_lines) return false;
+
+		length = strlen(this->_texts[cy]);
+		if(length > 0xff) return false;
+
+		this->_lens[cy] = (uint8_t) length;
+
+		if(length <= n_chars) shift = false;
+		else if((length - n_chars) > this->_span) this->_span = (uint8_t) (length - n_chars);
+
+		if(length > LCD::DDRAM_LINE_SIZE) shift = false;
+	}
+
+	/*A previous start() may have left the display shifted: return home resets the shift*/
+	if(shift || (this->_running && this->_shift && this->_pos)) this->_lcd->home();
+
+	this->_shift = shift;
+	this->_pos = 0u;
+	this->_backwards = false;
+	this->_running = true;
+
+	/*Display shift: every text is written whole (padded to the longest one), all of it off screen past the line end*/
+	for(cy = 0u; cy < n_lines; cy++)
+	{
+		if(this->_texts[cy] == NULL) continue;
+
+		if(shift) this->_draw_line(cy, 0u, (this->_span + n_chars));
+		else this->_draw_line(cy, 0u, n_chars);
+	}
+
+	this->_t_next = micros() + this->_pause_us;
+
+	this->_lcd->_transport_flush();
+	return true;
+}
+
+bool LCDMarquee::tick(void)
+{
+	unsigned long t_now = 0u;
+	uint8_t n_chars = 0u;
+	uint8_t offset = 0u;
+	uint8_t cy = 0u;
+
+	if(!this->_running || !this->_span) return false;
+
+	t_now = micros();
+	if(((long) (t_now - this->_t_next)) < 0) return false;
+
+	n_chars = this->_lcd->_info.n_chars;
+
+	if(this->_backwards) this->_pos--;
+	else this->_pos++;
+
+	if(this->_shift) this->_lcd->_send_byte(false, (this->_backwards ? this->_SHIFT_RIGHT : this->_SHIFT_LEFT));
+	else
+	{
+		/*Each line stops once its end shows*/
+		for(cy = 0u; cy < this->_lcd->_info.n_lines; cy++)
+		{
+			if(this->_lens[cy] <= n_chars) continue;
+
+			offset = this->_lens[cy] - n_chars;
+			if(this->_pos < offset) offset = this->_pos;
+
+			this->_draw_line(cy, offset, n_chars);
+		}
+	}
+
+	if((this->_pos == 0u) || (this->_pos == this->_span))
+	{
+		this->_backwards = (this->_pos != 0u);
+		this->_t_next = t_now + this->_pause_us;
+	}
+	else this->_t_next = t_now + this->_step_us;
+
+	this->_lcd->_transport_flush();
+	return true;
+}
+
+bool LCDMarquee::stop(void)
+{
+	uint8_t cy = 0u;
+
+	if(!this->_running) return true;
+
+	this->_running = false;
+
+	if(!this->_pos) return true;
+
+	this->_pos = 0u;
+
+	if(this->_shift) return this->_lcd->home();
+
+	for(cy = 0u; cy < this->_lcd->_info.n_lines; cy++)
+	{
+		if(this->_lens[cy] > this->_lcd->_info.n_chars) this->_draw_line(cy, 0u, this->_lcd->_info.n_chars);
+	}
+
+	this->_lcd->_transport_flush();
+	return true;
+}
+
+bool LCDMarquee::usesDisplayShift(void)
+{
+	return (this->_running && this->_shift);
+}
+
+/*
+ * "length" characters of line "cy" from the character "offset" of its text, padded with spaces.
+ * Only the characters that differ from the display are sent.
+ */
+
+void LCDMarquee::_draw_line(uint8_t cy, uint8_t offset, uint8_t length)
+{
+	uint8_t line[LCD::DDRAM_LINE_SIZE];
+	uint8_t n_text = 0u;
+
+	n_text = this->_lens[cy] - offset;
+	if(n_text > length) n_text = length;
+
+	memcpy(line, &(this->_texts[cy][offset]), n_text);
+	memset(&(line[n_text]), ' ', (length - n_text));
+
+	this->_lcd->_set_cursor_lazy(0u, cy);
+	this->_lcd->_put_field(line, length);
+
+	return;
+}
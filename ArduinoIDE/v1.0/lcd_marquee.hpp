@@ -0,0 +1,121 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Marquee (lines longer than the display, scrolled back and forth).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_MARQUEE_HPP
+#define LCD_MARQUEE_HPP
+
+#include "lcd.hpp"
+
+/*
+ * LCDMarquee
+ *
+ * Each display line can get a text longer than the line. start() prints every text, tick() then scrolls the long ones
+ * one character at a time until their end shows, pauses, scrolls them back, pauses, and so on.
+ * Texts that fit in the line don't move.
+ *
+ * Display shift: when every line of a 1 or 2 line display scrolls and every text fits in the 40 characters
+ * of its DDRAM line, the texts are written once and each step is a single display shift instruction.
+ * Otherwise (one line out of several, 4 line displays, longer texts, framebuffer mode) each step rewrites
+ * the characters of the scrolling lines that changed.
+ *
+ * The display shift moves everything shown (cursor positions are still DDRAM positions): don't print on the display
+ * while it runs. clear() and home() undo the shift, call start() again after them.
+ *
+ * Example:
+ * LCDMarquee marquee(&lcd1, 300u, 1500u);
+ * marquee.setLine(0u, "Now playing: a song with a rather long title");
+ * marquee.setLine(1u, "An artist with an even longer name");
+ * marquee.start();
+ * (loop) marquee.tick();
+ */
+
+class LCDMarquee {
+	public:
+		/*
+		 * "stepMs": time between two steps, "pauseMs": pause at both ends.
+		 */
+
+		LCDMarquee(LCD *lcd, uint32_t stepMs, uint32_t pauseMs);
+
+		/*
+		 * setLine()
+		 *
+		 * set the text of line "cy" (NULL for none: the line is left alone). The text must outlive the marquee.
+		 * Takes effect on the next start().
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setLine(uint8_t cy, const char *text);
+
+		/*
+		 * setTiming()
+		 *
+		 * change the time between two steps and the pause at both ends (from the next step on).
+		 */
+
+		void setTiming(uint32_t stepMs, uint32_t pauseMs);
+
+		/*
+		 * start()
+		 *
+		 * print the texts from their start and pick the display shift or the rewriting of the lines.
+		 * The display must be initialized.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool start(void);
+
+		/*
+		 * tick()
+		 *
+		 * scroll by one character if the step or pause time elapsed, never waits. Call it from loop().
+		 * returns true if a step was sent, false otherwise.
+		 */
+
+		bool tick(void);
+
+		/*
+		 * stop()
+		 *
+		 * stop scrolling and show the texts from their start again (undoing the display shift).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool stop(void);
+
+		/*
+		 * usesDisplayShift()
+		 *
+		 * returns true if the running marquee scrolls with the display shift instruction, false otherwise.
+		 */
+
+		bool usesDisplayShift(void);
+
+	private:
+		/*Cursor/display shift instruction: shift the display to the left (texts move left) or to the right*/
+		static constexpr uint8_t _SHIFT_LEFT = 0x18;
+		static constexpr uint8_t _SHIFT_RIGHT = 0x1c;
+
+		LCD *_lcd = NULL;
+		uint32_t _step_us = 0u;
+		uint32_t _pause_us = 0u;
+		const char *_texts[4] = {NULL, NULL, NULL, NULL};
+		uint8_t _lens[4] = {0u, 0u, 0u, 0u};
+		uint8_t _span = 0u;
+		uint8_t _pos = 0u;
+		bool _backwards = false;
+		bool _shift = false;
+		bool _running = false;
+		unsigned long _t_next = 0u;
+
+		void _draw_line(uint8_t cy, uint8_t offset, uint8_t length);
+};
+
+#endif /*LCD_MARQUEE_HPP*/
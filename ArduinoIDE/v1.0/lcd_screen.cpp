@@ -0,0 +1,238 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Screen layouts (static text and dynamic fields declared once, updated with the fewest bytes).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_screen.hpp"
+
+LCDScreen::LCDScreen(LCD *lcd)
+{
+	this->_lcd = lcd;
+}
+
+bool LCDScreen::setLayout(const LCDScreenLayout *layout)
+{
+	uint8_t cy = 0u;
+
+	if(layout == NULL) return false;
+	if(this->_lcd == NULL) return false;
+	if(this->_lcd->_status < 1) return false;
+
+	if(!this->_validate(layout)) return false;
+
+	this->_layout = layout;
+	this->_set = 0u;
+
+	if(layout->nFields < 32u) this->_dirty = ((1UL << layout->nFields) - 1UL);
+	else this->_dirty = 0xffffffffUL;
+
+	for(cy = 0u; cy < this->_lcd->_info.n_lines; cy++) this->_draw_line(cy);
+
+	this->_lcd->_transport_flush();
+	return true;
+}
+
+bool LCDScreen::setField(uint8_t fieldId, int32_t value)
+{
+	uint32_t mask = 0u;
+
+	if(this->_layout == NULL) return false;
+	if(fieldId >= this->_layout->nFields) return false;
+	if(this->_layout->fields[fieldId].format == this->FIELD_TEXT) return false;
+
+	mask = (1UL << fieldId);
+
+	if((this->_set & mask) && (this->_values[fieldId].num == value)) return true;
+
+	this->_values[fieldId].num = value;
+	this->_set |= mask;
+	this->_dirty |= mask;
+
+	return true;
+}
+
+bool LCDScreen::setFieldText(uint8_t fieldId, const char *text)
+{
+	if(this->_layout == NULL) return false;
+	if(text == NULL) return false;
+	if(fieldId >= this->_layout->nFields) return false;
+	if(this->_layout->fields[fieldId].format != this->FIELD_TEXT) return false;
+
+	/*The text may have changed in place: the update finds out which characters did*/
+	this->_values[fieldId].text = text;
+	this->_set |= (1UL << fieldId);
+	this->_dirty |= (1UL << fieldId);
+
+	return true;
+}
+
+bool LCDScreen::update(void)
+{
+	uint8_t field_id = 0u;
+
+	if(this->_layout == NULL) return false;
+	if(this->_lcd->_status < 1) return false;
+
+	for(field_id = 0u; field_id < this->_layout->nFields; field_id++)
+	{
+		if(!(this->_dirty & (1UL << field_id))) continue;
+
+		this->_print_field(field_id);
+	}
+
+	this->_dirty = 0u;
+
+	this->_lcd->_transport_flush();
+	return true;
+}
+
+bool LCDScreen::_validate(const LCDScreenLayout *layout)
+{
+	const LCDScreenText *text = NULL;
+	const LCDScreenField *field = NULL;
+	uint8_t n_chars = 0u;
+	uint8_t n_lines = 0u;
+	uint8_t n_item = 0u;
+
+	n_chars = this->_lcd->_info.n_chars;
+	n_lines = this->_lcd->_info.n_lines;
+
+	if(layout->nFields > LCD_CFG_SCREEN_MAX_FIELDS) return false;
+	if(layout->nTexts && (layout->texts == NULL)) return false;
+	if(layout->nFields && (layout->fields == NULL)) return false;
+
+	for(n_item = 0u; n_item < layout->nTexts; n_item++)
+	{
+		text = &(layout->texts[n_item]);
+
+		if(text->text == NULL) return false;
+		if(text->cy >= n_lines) return false;
+		if(text->cx >= n_chars) return false;
+		if(strlen(text->text) > (size_t) (n_chars - text->cx)) return false;
+	}
+
+	for(n_item = 0u; n_item < layout->nFields; n_item++)
+	{
+		field = &(layout->fields[n_item]);
+
+		if(field->cy >= n_lines) return false;
+		if(!field->width || (field->cx >= n_chars)) return false;
+		if(field->width > (n_chars - field->cx)) return false;
+		if(field->format > this->FIELD_TEXT) return false;
+		if(field->nDecimals > 9u) return false;
+		if((field->align != LCD::ALIGN_RIGHT) && (field->align != LCD::ALIGN_LEFT)) return false;
+	}
+
+	return true;
+}
+
+/*
+ * Line "cy" as the layout wants it: static texts, blanks, and the field cells as they are (the update prints them).
+ * Only the cells that differ from the RAM shadow are sent, so the texts both layouts share cost nothing.
+ */
+
+void LCDScreen::_draw_line(uint8_t cy)
+{
+	uint8_t line[LCD::DDRAM_LINE_SIZE];
+	const LCDScreenText *text = NULL;
+	uint8_t n_item = 0u;
+#if LCD_CFG_FRAMEBUFFER
+	const LCDScreenField *field = NULL;
+	uint8_t addr = 0u;
+	uint8_t idx = 0u;
+#endif
+
+	memset(line, ' ', this->_lcd->_info.n_chars);
+
+#if LCD_CFG_FRAMEBUFFER
+	this->_lcd->_phys_text_cx_cy_to_ddram_addr(&addr, 0u, cy);
+	idx = this->_lcd->_ddram_addr_to_idx(addr);
+
+	for(n_item = 0u; n_item < this->_layout->nFields; n_item++)
+	{
+		field = &(this->_layout->fields[n_item]);
+		if(field->cy != cy) continue;
+
+		memcpy(&(line[field->cx]), &(this->_lcd->_fb[idx + field->cx]), field->width);
+	}
+#endif
+
+	for(n_item = 0u; n_item < this->_layout->nTexts; n_item++)
+	{
+		text = &(this->_layout->texts[n_item]);
+		if(text->cy != cy) continue;
+
+		memcpy(&(line[text->cx]), text->text, strlen(text->text));
+	}
+
+	this->_lcd->_set_cursor_lazy(0u, cy);
+	this->_lcd->_put_field(line, this->_lcd->_info.n_chars);
+
+	return;
+}
+
+void LCDScreen::_print_field(uint8_t field_id)
+{
+	const LCDScreenField *field = NULL;
+	uint8_t blank[LCD::DDRAM_LINE_SIZE];
+	int32_t value = 0;
+
+	field = &(this->_layout->fields[field_id]);
+	value = this->_values[field_id].num;
+
+	this->_lcd->_set_cursor_lazy(field->cx, field->cy);
+
+	/*Not set since the layout was selected*/
+	if(!(this->_set & (1UL << field_id)))
+	{
+		memset(blank, ' ', field->width);
+		this->_lcd->_put_field(blank, field->width);
+		return;
+	}
+
+	switch(field->format)
+	{
+		case this->FIELD_UINT:
+			this->_lcd->printUInt((uint32_t) value, field->width, field->align, field->pad);
+			break;
+
+		case this->FIELD_INT:
+			this->_lcd->printInt(value, field->width, field->align, field->pad);
+			break;
+
+		case this->FIELD_FIXED:
+			this->_lcd->printFixed(value, field->nDecimals, field->width, field->align, field->pad);
+			break;
+
+		case this->FIELD_HEX:
+			this->_lcd->printHex((uint32_t) value, field->width, field->align, field->pad);
+			break;
+
+		case this->FIELD_TEXT:
+			this->_print_text(field, this->_values[field_id].text);
+			break;
+	}
+
+	return;
+}
+
+void LCDScreen::_print_text(const LCDScreenField *field, const char *text)
+{
+	uint8_t buffer[LCD::DDRAM_LINE_SIZE];
+	uint8_t length = 0u;
+
+	while((length < field->width) && (text[length] != '\0')) length++;
+
+	memset(buffer, field->pad, field->width);
+
+	if(field->align == LCD::ALIGN_LEFT) memcpy(buffer, text, length);
+	else memcpy(&(buffer[field->width - length]), text, length);
+
+	this->_lcd->_put_field(buffer, field->width);
+	return;
+}
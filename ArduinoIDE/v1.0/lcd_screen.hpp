@@ -0,0 +1,175 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Screen layouts (static text and dynamic fields declared once, updated with the fewest bytes).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_SCREEN_HPP
+#define LCD_SCREEN_HPP
+
+#include "lcd.hpp"
+
+/*
+ * LCD_CFG_SCREEN_MAX_FIELDS
+ *
+ * Maximum number of fields in a layout (up to 32). Each field takes 4 bytes in every LCDScreen.
+ */
+
+#ifndef LCD_CFG_SCREEN_MAX_FIELDS
+#define LCD_CFG_SCREEN_MAX_FIELDS 16
+#endif
+
+#if (LCD_CFG_SCREEN_MAX_FIELDS > 32)
+#error "lcd_screen.hpp: LCD_CFG_SCREEN_MAX_FIELDS must be 32 or less"
+#endif
+
+/*
+ * LCDScreenText
+ *
+ * Static text of a layout.
+ *
+ * cx, cy: position (character within the line, line).
+ * text: the text, which must fit in the line.
+ */
+
+struct LCDScreenText {
+	uint8_t cx;
+	uint8_t cy;
+	const char *text;
+};
+
+/*
+ * LCDScreenField
+ *
+ * Dynamic field of a layout.
+ *
+ * cx, cy: position (character within the line, line).
+ * width: number of characters, which must fit in the line.
+ * format: LCDScreen::FIELD_UINT, FIELD_INT, FIELD_FIXED, FIELD_HEX or FIELD_TEXT.
+ * nDecimals: decimals of FIELD_FIXED (see LCD::printFixed()).
+ * align: LCD::ALIGN_RIGHT or LCD::ALIGN_LEFT.
+ * pad: padding character.
+ */
+
+struct LCDScreenField {
+	uint8_t cx;
+	uint8_t cy;
+	uint8_t width;
+	uint8_t format;
+	uint8_t nDecimals;
+	uint8_t align;
+	char pad;
+};
+
+/*
+ * LCDScreenLayout
+ *
+ * Static texts and fields of a screen. Fields are identified by their index in "fields" (an enum of field names, typically).
+ */
+
+struct LCDScreenLayout {
+	const LCDScreenText *texts;
+	uint8_t nTexts;
+	const LCDScreenField *fields;
+	uint8_t nFields;
+};
+
+/*
+ * LCDScreen
+ *
+ * setLayout() draws the static texts of a layout and blanks the cells no longer used, sending only the cells that differ
+ * from what the previous layout left on the display (no clear).
+ * setField() only stores a value and marks its field dirty: update() then prints every dirty field, sending only
+ * the characters that changed (see LCD::printUInt()). Fields not set since the layout was selected are blank.
+ *
+ * The diff relies on the RAM shadow of the display (LCD_CFG_FRAMEBUFFER), otherwise layout switches and fields are sent whole.
+ * Layout tables live in RAM on AVR (no PROGMEM).
+ *
+ * Example:
+ * enum {FIELD_TEMP, FIELD_STATE};
+ * constexpr LCDScreenText main_texts[] = {{0u, 0u, "Temp:"}, {11u, 0u, "C"}};
+ * constexpr LCDScreenField main_fields[] = {
+ * 	{5u, 0u, 5u, LCDScreen::FIELD_FIXED, 1u, LCD::ALIGN_RIGHT, ' '},
+ * 	{0u, 1u, 8u, LCDScreen::FIELD_TEXT, 0u, LCD::ALIGN_LEFT, ' '}
+ * };
+ * constexpr LCDScreenLayout main_layout = {main_texts, 2u, main_fields, 2u};
+ *
+ * LCDScreen screen(&lcd1);
+ * screen.setLayout(&main_layout);
+ * screen.setField(FIELD_TEMP, 215);
+ * screen.update();
+ */
+
+class LCDScreen {
+	public:
+		LCDScreen(LCD *lcd);
+
+		/*
+		 * setLayout()
+		 *
+		 * select "layout" (which must outlive its use) and draw its static texts. Every field is left unset and dirty.
+		 * The display must be initialized. The layout is checked first: nothing is drawn if any text or field doesn't fit.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setLayout(const LCDScreenLayout *layout);
+
+		/*
+		 * setField()
+		 *
+		 * set the value of a numeric field (FIELD_UINT and FIELD_HEX read it as uint32_t). Nothing is sent.
+		 * An unchanged value doesn't mark the field dirty.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setField(uint8_t fieldId, int32_t value);
+
+		/*
+		 * setFieldText()
+		 *
+		 * set the text of a FIELD_TEXT field (which must outlive the next update()), cut to the field width. Nothing is sent.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setFieldText(uint8_t fieldId, const char *text);
+
+		/*
+		 * update()
+		 *
+		 * print the fields set since the last update.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool update(void);
+
+		enum FieldFormat {
+			FIELD_UINT = 0,
+			FIELD_INT = 1,
+			FIELD_FIXED = 2,
+			FIELD_HEX = 3,
+			FIELD_TEXT = 4
+		};
+
+	private:
+		union _value {
+			int32_t num;
+			const char *text;
+		};
+
+		LCD *_lcd = NULL;
+		const LCDScreenLayout *_layout = NULL;
+		uint32_t _dirty = 0u;
+		uint32_t _set = 0u;
+		union _value _values[LCD_CFG_SCREEN_MAX_FIELDS];
+
+		bool _validate(const LCDScreenLayout *layout);
+		void _draw_line(uint8_t cy);
+		void _print_field(uint8_t field_id);
+		void _print_text(const LCDScreenField *field, const char *text);
+};
+
+#endif /*LCD_SCREEN_HPP*/
@@ -0,0 +1,233 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * 74HC595 shift register transport (hardware SPI).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_spi.hpp"
+
+LCDSPITransport::LCDSPITransport(uint8_t latch, uint32_t clock, SPIClass *spi)
+{
+	this->_latch = latch;
+	this->_clock = clock;
+	this->_spi = spi;
+}
+
+bool LCDSPITransport::begin(void)
+{
+	if(this->_spi == NULL) return false;
+	if(!this->_clock) return false;
+	if(this->_latch == LCD::PIN_NONE) return false;
+
+	pinMode(this->_latch, OUTPUT);
+	digitalWrite(this->_latch, 0);
+
+#if defined(__AVR__)
+	this->_latch_out = NULL;
+
+	if(digitalPinToPort(this->_latch) != NOT_A_PIN)
+	{
+		this->_latch_out = portOutputRegister(digitalPinToPort(this->_latch));
+		this->_latch_mask = digitalPinToBitMask(this->_latch);
+	}
+#endif
+
+	this->_spi->begin();
+
+	this->_ctrl = this->_BL;
+	this->_rs = 0u;
+	this->_n_frames = 0u;
+	this->_pending_us = 0u;
+	this->_frame_ns = (uint32_t) ((((uint64_t) this->_BITS_PER_FRAME)*1000000000ULL)/this->_clock);
+	this->_n_sent = 0u;
+	this->_t_bus_us = 0u;
+
+	/*E low before the init nibble*/
+	this->_put(this->_ctrl);
+	this->_write();
+
+	return true;
+}
+
+void LCDSPITransport::sendInitNibble(uint8_t nibble, uint16_t delayUs)
+{
+	this->_wait_pending();
+
+	this->_rs = 0u;
+	this->_put((nibble << 4) | this->_ctrl);
+	this->_put_nibble(nibble << 4);
+	this->_write();
+
+	delayMicroseconds(delayUs);
+	return;
+}
+
+/*
+ * Frames per display byte:
+ * [RS setup, only if RS changed] [high nibble | E] [high nibble] [low nibble | E] [low nibble] [idle frames...]
+ * The display latches each nibble on the E falling edge.
+ */
+
+void LCDSPITransport::sendByte(bool reg, uint8_t byte, uint16_t delayUs)
+{
+	uint8_t rs = 0u;
+
+	this->_wait_pending();
+
+	if(reg) rs = this->_RS;
+
+	/*RS must be stable before E rises*/
+	if(rs != this->_rs)
+	{
+		this->_rs = rs;
+		this->_put((byte & 0xf0) | this->_ctrl | rs);
+	}
+
+	this->_put_nibble(byte & 0xf0);
+	this->_put_nibble(byte << 4);
+
+	this->_pending_us = delayUs;
+	this->_n_sent++;
+
+	return;
+}
+
+void LCDSPITransport::flush(void)
+{
+	this->_write();
+	return;
+}
+
+void LCDSPITransport::setBacklight(bool on)
+{
+	if(on) this->_ctrl = this->_BL;
+	else this->_ctrl = 0u;
+
+	/*E low: the display doesn't see this frame*/
+	this->_put(this->_ctrl | this->_rs);
+	this->_write();
+
+	return;
+}
+
+uint32_t LCDSPITransport::getBytesPerSec(void)
+{
+	if(!this->_t_bus_us) return 0u;
+
+	return (uint32_t) ((((uint64_t) this->_n_sent)*1000000ULL)/(this->_t_bus_us));
+}
+
+void LCDSPITransport::_put(uint8_t frame)
+{
+	if(this->_n_frames >= LCD_CFG_SPI_BUFFER_SIZE) this->_write();
+
+	this->_buf[this->_n_frames] = frame;
+	this->_n_frames++;
+
+	return;
+}
+
+void LCDSPITransport::_put_nibble(uint8_t nibble)
+{
+	nibble &= 0xf0;
+
+	this->_put(nibble | this->_ctrl | this->_rs | this->_E);
+	this->_put(nibble | this->_ctrl | this->_rs);
+
+	return;
+}
+
+/*
+ * Makes sure the previous instruction finished executing before the next E falling edge.
+ * The next byte latches its first nibble 2 frames after the last one queued, so only the rest needs waiting for:
+ * idle frames (E low) in the same burst, or a wait after the burst for clear/home.
+ * Frame times are computed from the SPI clock alone, so the latch overhead only makes them longer (safe side).
+ */
+
+void LCDSPITransport::_wait_pending(void)
+{
+	uint32_t wait_ns = 0u;
+	uint32_t n_idle = 0u;
+	unsigned long t_start = 0u;
+	uint8_t idle = 0u;
+
+	if(!this->_pending_us) return;
+
+	wait_ns = ((uint32_t) this->_pending_us)*1000u;
+	this->_pending_us = 0u;
+
+	if(wait_ns <= 2u*(this->_frame_ns)) return;
+
+	wait_ns -= 2u*(this->_frame_ns);
+	n_idle = (wait_ns + this->_frame_ns - 1u)/(this->_frame_ns);
+
+	if(n_idle > this->_MAX_IDLE_FRAMES)
+	{
+		this->_write();
+
+		t_start = micros();
+		delayMicroseconds((wait_ns + 999u)/1000u);
+		this->_t_bus_us += (uint32_t) (micros() - t_start);
+
+		return;
+	}
+
+	if(this->_n_frames) idle = this->_buf[this->_n_frames - 1u];
+	else idle = (this->_ctrl | this->_rs);
+
+	while(n_idle--) this->_put(idle);
+
+	return;
+}
+
+void LCDSPITransport::_write(void)
+{
+	uint16_t n_frame = 0u;
+	unsigned long t_start = 0u;
+
+	if(!this->_n_frames) return;
+
+	t_start = micros();
+
+	/*The shift register has no automatic latch, so frames go out one by one with a latch pulse after each*/
+	this->_spi->beginTransaction(SPISettings(this->_clock, MSBFIRST, SPI_MODE0));
+
+	for(n_frame = 0u; n_frame < this->_n_frames; n_frame++)
+	{
+		this->_spi->transfer(this->_buf[n_frame]);
+		this->_pulse_latch();
+	}
+
+	this->_spi->endTransaction();
+
+	this->_t_bus_us += (uint32_t) (micros() - t_start);
+	this->_n_frames = 0u;
+
+	return;
+}
+
+void LCDSPITransport::_pulse_latch(void)
+{
+#if defined(__AVR__)
+	uint8_t sreg = 0u;
+
+	if(this->_latch_out != NULL)
+	{
+		sreg = SREG;
+		cli();
+		*(this->_latch_out) |= this->_latch_mask;
+		*(this->_latch_out) &= ~(this->_latch_mask);
+		SREG = sreg;
+		return;
+	}
+#endif
+
+	digitalWrite(this->_latch, 1);
+	digitalWrite(this->_latch, 0);
+
+	return;
+}
@@ -0,0 +1,106 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * 74HC595 shift register transport (hardware SPI).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_SPI_HPP
+#define LCD_SPI_HPP
+
+#include "lcd.hpp"
+
+#if !defined(LCD_HAL_HOST)
+#include <SPI.h>
+#endif
+
+/*
+ * LCD_CFG_SPI_BUFFER_SIZE
+ *
+ * Maximum number of shift register frames sent in a single burst.
+ */
+
+#ifndef LCD_CFG_SPI_BUFFER_SIZE
+#define LCD_CFG_SPI_BUFFER_SIZE 64
+#endif
+
+/*
+ * LCDSPITransport
+ *
+ * Shift register pinout (same as the I2C backpack):
+ * Q0 = RS, Q1 = R/W (always low), Q2 = E, Q3 = backlight, Q4-Q7 = DB4-DB7.
+ * MOSI -> SER, SCK -> SRCLK, "latch" pin -> RCLK.
+ *
+ * Every byte sent by an LCD call becomes an E high/E low frame sequence, padded with idle frames (E low) covering
+ * the instruction execution times, and the whole buffer is clocked out in a single SPI transaction.
+ * Each frame is latched with a direct port write (AVR). Clear/home execution times are waited for after the burst instead.
+ *
+ * Example:
+ * LCDSPITransport lcd_spi(10);
+ * LCD lcd1(&lcd_spi, 20, 4);
+ */
+
+class LCDSPITransport : public LCDTransport {
+	public:
+		LCDSPITransport(uint8_t latch, uint32_t clock = 4000000UL, SPIClass *spi = &SPI);
+
+		bool begin(void) override;
+		void sendInitNibble(uint8_t nibble, uint16_t delayUs) override;
+		void sendByte(bool reg, uint8_t byte, uint16_t delayUs) override;
+		void flush(void) override;
+
+		/*
+		 * setBacklight()
+		 *
+		 * turns the backlight on/off (the backlight is on after begin()).
+		 */
+
+		void setBacklight(bool on);
+
+		/*
+		 * getBytesPerSec()
+		 *
+		 * returns the achieved display throughput: bytes sent to the display per second of bus time (bursts and execution waits).
+		 */
+
+		uint32_t getBytesPerSec(void);
+
+	private:
+		static constexpr uint8_t _RS = 0x01;
+		static constexpr uint8_t _RW = 0x02;
+		static constexpr uint8_t _E = 0x04;
+		static constexpr uint8_t _BL = 0x08;
+
+		static constexpr uint32_t _BITS_PER_FRAME = 8u;
+
+		/*Longer waits than this many idle frames are done after the burst instead*/
+		static constexpr uint32_t _MAX_IDLE_FRAMES = 32u;
+
+		SPIClass *_spi = NULL;
+		uint32_t _clock = 0u;
+		uint8_t _latch = 0u;
+		uint8_t _ctrl = 0u;
+		uint8_t _rs = 0u;
+		uint16_t _n_frames = 0u;
+		uint16_t _pending_us = 0u;
+		uint32_t _frame_ns = 0u;
+		uint32_t _n_sent = 0u;
+		uint32_t _t_bus_us = 0u;
+		uint8_t _buf[LCD_CFG_SPI_BUFFER_SIZE];
+
+#if defined(__AVR__)
+		volatile uint8_t *_latch_out = NULL;
+		uint8_t _latch_mask = 0u;
+#endif
+
+		void _put(uint8_t frame);
+		void _put_nibble(uint8_t nibble);
+		void _wait_pending(void);
+		void _write(void);
+		void _pulse_latch(void);
+};
+
+#endif /*LCD_SPI_HPP*/
@@ -0,0 +1,440 @@
+/*
+ * Generic Alphanumeric LCD Display Driver for Arduino IDE.
+ * Version 1.0
+ *
+ * Compile-time pinout variant.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_STATIC_HPP
+#define LCD_STATIC_HPP
+
+#include "lcd.hpp"
+
+/*
+ * Arduino pin number to PORTx data space address and bit mask.
+ * Known boards: ATmega328P (Uno, Nano, Pro Mini) and ATmega1280/2560 (Mega).
+ * Any other board (or an unknown pin) resolves to port 0 and falls back to digitalWrite().
+ */
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+
+constexpr uint16_t _LCD_STATIC_PORT[] = {
+	0x2b, 0x2b, 0x2b, 0x2b, 0x2b, 0x2b, 0x2b, 0x2b,		/*0-7: PORTD*/
+	0x25, 0x25, 0x25, 0x25, 0x25, 0x25,			/*8-13: PORTB*/
+	0x28, 0x28, 0x28, 0x28, 0x28, 0x28			/*14-19 (A0-A5): PORTC*/
+};
+
+constexpr uint8_t _LCD_STATIC_BIT[] = {
+	0, 1, 2, 3, 4, 5, 6, 7,
+	0, 1, 2, 3, 4, 5,
+	0, 1, 2, 3, 4, 5
+};
+
+#elif defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+
+#define __LCD_STATIC_PA 0x22
+#define __LCD_STATIC_PB 0x25
+#define __LCD_STATIC_PC 0x28
+#define __LCD_STATIC_PD 0x2b
+#define __LCD_STATIC_PE 0x2e
+#define __LCD_STATIC_PF 0x31
+#define __LCD_STATIC_PG 0x34
+#define __LCD_STATIC_PH 0x102
+#define __LCD_STATIC_PJ 0x105
+#define __LCD_STATIC_PK 0x108
+#define __LCD_STATIC_PL 0x10b
+
+constexpr uint16_t _LCD_STATIC_PORT[] = {
+	__LCD_STATIC_PE, __LCD_STATIC_PE, __LCD_STATIC_PE, __LCD_STATIC_PE, __LCD_STATIC_PG, __LCD_STATIC_PE, __LCD_STATIC_PH, __LCD_STATIC_PH,	/*0-7*/
+	__LCD_STATIC_PH, __LCD_STATIC_PH, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PJ, __LCD_STATIC_PJ,	/*8-15*/
+	__LCD_STATIC_PH, __LCD_STATIC_PH, __LCD_STATIC_PD, __LCD_STATIC_PD, __LCD_STATIC_PD, __LCD_STATIC_PD, __LCD_STATIC_PA, __LCD_STATIC_PA,	/*16-23*/
+	__LCD_STATIC_PA, __LCD_STATIC_PA, __LCD_STATIC_PA, __LCD_STATIC_PA, __LCD_STATIC_PA, __LCD_STATIC_PA, __LCD_STATIC_PC, __LCD_STATIC_PC,	/*24-31*/
+	__LCD_STATIC_PC, __LCD_STATIC_PC, __LCD_STATIC_PC, __LCD_STATIC_PC, __LCD_STATIC_PC, __LCD_STATIC_PC, __LCD_STATIC_PD, __LCD_STATIC_PG,	/*32-39*/
+	__LCD_STATIC_PG, __LCD_STATIC_PG, __LCD_STATIC_PL, __LCD_STATIC_PL, __LCD_STATIC_PL, __LCD_STATIC_PL, __LCD_STATIC_PL, __LCD_STATIC_PL,	/*40-47*/
+	__LCD_STATIC_PL, __LCD_STATIC_PL, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PB, __LCD_STATIC_PF, __LCD_STATIC_PF,	/*48-55*/
+	__LCD_STATIC_PF, __LCD_STATIC_PF, __LCD_STATIC_PF, __LCD_STATIC_PF, __LCD_STATIC_PF, __LCD_STATIC_PF, __LCD_STATIC_PK, __LCD_STATIC_PK,	/*56-63*/
+	__LCD_STATIC_PK, __LCD_STATIC_PK, __LCD_STATIC_PK, __LCD_STATIC_PK, __LCD_STATIC_PK, __LCD_STATIC_PK					/*64-69*/
+};
+
+constexpr uint8_t _LCD_STATIC_BIT[] = {
+	0, 1, 4, 5, 5, 3, 3, 4,
+	5, 6, 4, 5, 6, 7, 1, 0,
+	1, 0, 3, 2, 1, 0, 0, 1,
+	2, 3, 4, 5, 6, 7, 7, 6,
+	5, 4, 3, 2, 1, 0, 7, 2,
+	1, 0, 7, 6, 5, 4, 3, 2,
+	1, 0, 3, 2, 1, 0, 0, 1,
+	2, 3, 4, 5, 6, 7, 0, 1,
+	2, 3, 4, 5, 6, 7
+};
+
+#else
+
+constexpr uint16_t _LCD_STATIC_PORT[] = {0};
+constexpr uint8_t _LCD_STATIC_BIT[] = {0};
+
+#endif
+
+constexpr uint16_t _lcd_static_port(uint8_t pin)
+{
+	return (pin < (sizeof(_LCD_STATIC_PORT)/sizeof(uint16_t))) ? _LCD_STATIC_PORT[pin] : 0u;
+}
+
+constexpr uint8_t _lcd_static_mask(uint8_t pin)
+{
+	return (pin < (sizeof(_LCD_STATIC_BIT)/sizeof(uint8_t))) ? (uint8_t) (1u << _LCD_STATIC_BIT[pin]) : 0u;
+}
+
+/*
+ * StaticLCD
+ *
+ * Same API as LCD, with the pinout and display size fixed at compile time.
+ * Ports, bit masks and line addresses are resolved by the compiler, so pin writes compile to sbi/cbi or single port writes.
+ * Use LCD instead if the pinout must change at runtime (resetPinout()).
+ *
+ * Example: StaticLCD<20, 21, 22, 23, 14, 30, 20, 4> lcd1;
+ */
+
+template <uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7, uint8_t RS, uint8_t E, uint8_t Cols, uint8_t Lines>
+class StaticLCD {
+	public:
+		static_assert((Cols > 0u) && (Lines > 0u) && (Lines <= 4u), "StaticLCD: invalid display size");
+		static_assert((Cols*((Lines + 1u) >> 1)) <= LCD::DDRAM_LINE_SIZE, "StaticLCD: display lines don't fit in DDRAM");
+
+		/*
+		 * begin()
+		 *
+		 * Initializes LCD object.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool begin(void)
+		{
+			if(this->_status > 0) return true;
+
+			pinMode(E, OUTPUT);
+			this->_pin_write<E>(0);
+
+			pinMode(RS, OUTPUT);
+			pinMode(DB4, OUTPUT);
+			pinMode(DB5, OUTPUT);
+			pinMode(DB6, OUTPUT);
+			pinMode(DB7, OUTPUT);
+
+			this->_pin_write<RS>(0);
+			delayMicroseconds(this->_EN_DELAY_US);
+
+			this->_write_nibble(0x2);
+			this->_pin_write<E>(1);
+			delayMicroseconds(this->_EN_DELAY_US);
+			this->_pin_write<E>(0);
+			delayMicroseconds(LCD_TIMING_INIT_US);
+
+			/*Default initialization settings*/
+			this->_send_byte(false, 0x28);
+			this->_send_byte(false, 0x01);
+			this->_send_byte(false, 0x80);
+			this->_send_byte(false, 0x0c);
+
+			this->_status = LCD::STATUS_INITIALIZED;
+			return true;
+		}
+
+		/*
+		 * getStatus()
+		 *
+		 * returns the current object status.
+		 */
+
+		intptr_t getStatus(void)
+		{
+			return this->_status;
+		}
+
+		/*
+		 * getNCharsPerLine() & getNLines()
+		 *
+		 * returns the number of characters per line and the number of lines, respectivelly.
+		 */
+
+		int8_t getNCharsPerLine(void)
+		{
+			return (int8_t) Cols;
+		}
+
+		int8_t getNLines(void)
+		{
+			return (int8_t) Lines;
+		}
+
+		/*
+		 * setDisplayMode()
+		 *
+		 * set the display power/cursor view mode (LCD::DISPLAYMODE_*).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setDisplayMode(intptr_t displayMode)
+		{
+			if(this->_status < 1) return false;
+
+			switch(displayMode)
+			{
+				case LCD::DISPLAYMODE_DISPLAY_OFF:
+					this->_send_byte(false, 0x08);
+					break;
+
+				case LCD::DISPLAYMODE_DISPLAY_ON_CURSOR_OFF:
+					this->_send_byte(false, 0x0c);
+					break;
+
+				case LCD::DISPLAYMODE_DISPLAY_ON_CURSOR_ON:
+					this->_send_byte(false, 0x0e);
+					break;
+
+				case LCD::DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK:
+					this->_send_byte(false, 0x0f);
+					break;
+			}
+
+			return true;
+		}
+
+		/*
+		 * clear()
+		 *
+		 * clear the display screen.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool clear(void)
+		{
+			if(this->_status < 1) return false;
+
+			this->_send_byte(false, 0x01);
+			return true;
+		}
+
+		/*
+		 * home()
+		 *
+		 * set cursor position to (0 , 0)
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool home(void)
+		{
+			if(this->_status < 1) return false;
+
+			this->_send_byte(false, 0x02);
+			return true;
+		}
+
+		/*
+		 * setCursorPosition()
+		 *
+		 * set the cursor position. "cx" horizontal coordinate (character position within a line), "cy" vertical coordinate (line).
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool setCursorPosition(uint8_t cx, uint8_t cy)
+		{
+			if(this->_status < 1) return false;
+			if(cx >= Cols) return false;
+			if(cy >= Lines) return false;
+
+			this->_send_byte(false, (0x80 | (this->_line_addr(cy) + cx)));
+			return true;
+		}
+
+		/*
+		 * printChar()
+		 *
+		 * print a single character at the current cursor position.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printChar(char c)
+		{
+			if(this->_status < 1) return false;
+
+			this->_send_byte(true, (uint8_t) c);
+			return true;
+		}
+
+		/*
+		 * printText()
+		 *
+		 * print a text at the current cursor position.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool printText(const char *text)
+		{
+			uintptr_t length = 0u;
+
+			if(this->_status < 1) return false;
+			if(text == NULL) return false;
+
+			while(text[length] != '\0') length++;
+
+			return this->printText(text, length);
+		}
+
+		bool printText(const char *text, uintptr_t length)
+		{
+			uintptr_t n_char = 0u;
+
+			if(this->_status < 1) return false;
+			if(text == NULL) return false;
+
+			for(n_char = 0u; n_char < length; n_char++) this->_send_byte(true, (uint8_t) text[n_char]);
+
+			return true;
+		}
+
+		/*
+		 * fillScreenChar()
+		 *
+		 * print a repeated character on the whole screen.
+		 * returns true if successful, false otherwise.
+		 */
+
+		bool fillScreenChar(char c)
+		{
+			uint8_t n_char = 0u;
+			uint8_t n_line = 0u;
+
+			if(this->_status < 1) return false;
+
+			for(n_line = 0u; n_line < Lines; n_line++)
+			{
+				this->_send_byte(false, (0x80 | this->_line_addr(n_line)));
+
+				for(n_char = 0u; n_char < Cols; n_char++) this->_send_byte(true, (uint8_t) c);
+			}
+
+			return true;
+		}
+
+	private:
+		static constexpr uintptr_t _EN_DELAY_US = 1u;
+
+		static constexpr uint16_t _DB_PORT = _lcd_static_port(DB4);
+		static constexpr uint8_t _DB_MASK = _lcd_static_mask(DB4) | _lcd_static_mask(DB5) | _lcd_static_mask(DB6) | _lcd_static_mask(DB7);
+
+		/*All data lines on one port: a nibble is a single port write*/
+		static constexpr bool _DB_SAME_PORT = (_DB_PORT != 0u) && (_lcd_static_port(DB5) == _DB_PORT) && (_lcd_static_port(DB6) == _DB_PORT) && (_lcd_static_port(DB7) == _DB_PORT);
+
+		/*...and in ascending consecutive bits: the nibble only needs a shift*/
+		static constexpr bool _DB_CONSECUTIVE = _DB_SAME_PORT && (_lcd_static_mask(DB5) == (_lcd_static_mask(DB4) << 1)) && (_lcd_static_mask(DB6) == (_lcd_static_mask(DB4) << 2)) && (_lcd_static_mask(DB7) == (_lcd_static_mask(DB4) << 3));
+
+		intptr_t _status = LCD::STATUS_UNINITIALIZED;
+
+		static constexpr uint8_t _line_addr(uint8_t line)
+		{
+			return (((line & 0x1) ? 0x40 : 0x00) + (line >> 1)*Cols);
+		}
+
+		static constexpr uint8_t _db_shift(uint8_t mask)
+		{
+			return (mask & 0x1) ? 0u : (1u + _db_shift(mask >> 1));
+		}
+
+		template <uint8_t PIN>
+		static inline void _pin_write(bool value)
+		{
+			uint8_t sreg = 0u;
+
+			if(_lcd_static_port(PIN) == 0u)
+			{
+				digitalWrite(PIN, value);
+				return;
+			}
+
+#if defined(__AVR__)
+			/*Above the sbi/cbi range (PORTH to PORTL on a Mega): a load-modify-store an interrupt could split*/
+			if(_lcd_static_port(PIN) > 0x3f)
+			{
+				sreg = SREG;
+				cli();
+				if(value) *((volatile uint8_t*) (uintptr_t) _lcd_static_port(PIN)) |= _lcd_static_mask(PIN);
+				else *((volatile uint8_t*) (uintptr_t) _lcd_static_port(PIN)) &= (uint8_t) ~_lcd_static_mask(PIN);
+				SREG = sreg;
+				return;
+			}
+#else
+			(void) sreg;
+#endif
+
+			if(value) *((volatile uint8_t*) (uintptr_t) _lcd_static_port(PIN)) |= _lcd_static_mask(PIN);
+			else *((volatile uint8_t*) (uintptr_t) _lcd_static_port(PIN)) &= (uint8_t) ~_lcd_static_mask(PIN);
+
+			return;
+		}
+
+		static inline void _write_nibble(uint8_t nibble)
+		{
+			uint8_t bits = 0u;
+			uint8_t sreg = 0u;
+
+			if(!_DB_SAME_PORT)
+			{
+				_pin_write<DB7>(nibble & 0x8);
+				_pin_write<DB6>(nibble & 0x4);
+				_pin_write<DB5>(nibble & 0x2);
+				_pin_write<DB4>(nibble & 0x1);
+				return;
+			}
+
+			if(_DB_CONSECUTIVE) bits = (nibble << _db_shift(_lcd_static_mask(DB4)));
+			else
+			{
+				if(nibble & 0x1) bits |= _lcd_static_mask(DB4);
+				if(nibble & 0x2) bits |= _lcd_static_mask(DB5);
+				if(nibble & 0x4) bits |= _lcd_static_mask(DB6);
+				if(nibble & 0x8) bits |= _lcd_static_mask(DB7);
+			}
+
+#if defined(__AVR__)
+			sreg = SREG;
+			cli();
+			*((volatile uint8_t*) (uintptr_t) _DB_PORT) = (*((volatile uint8_t*) (uintptr_t) _DB_PORT) & ((uint8_t) ~_DB_MASK)) | bits;
+			SREG = sreg;
+#else
+			(void) sreg;
+			(void) bits;
+#endif
+			return;
+		}
+
+		static void _send_byte(bool reg, uint8_t byte)
+		{
+			_pin_write<E>(0);
+			_pin_write<RS>(reg);
+			delayMicroseconds(_EN_DELAY_US);
+
+			_write_nibble(byte >> 4);
+			_pin_write<E>(1);
+			delayMicroseconds(_EN_DELAY_US);
+			_pin_write<E>(0);
+			delayMicroseconds(_EN_DELAY_US);
+
+			_write_nibble(byte & 0xf);
+			_pin_write<E>(1);
+			delayMicroseconds(_EN_DELAY_US);
+			_pin_write<E>(0);
+
+			if(reg) delayMicroseconds(LCD_TIMING_DATA_US);
+			else if(byte == 0x01) delayMicroseconds(LCD_TIMING_CLEAR_US);
+			else if((byte & 0xfe) == 0x02) delayMicroseconds(LCD_TIMING_HOME_US);
+			else delayMicroseconds(LCD_TIMING_CMD_US);
+
+			return;
+		}
+};
+
+#endif /*LCD_STATIC_HPP*/
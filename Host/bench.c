@@ -0,0 +1,79 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Benchmark scenarios and CSV output shared by bench_pico.c and bench_arduino.cpp.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+void bench_print_header(void)
+{
+	printf("platform,config,scenario,iterations,wall_us,call_us,us_per_iter,lcd_bytes,bytes_per_sec,e_pulses,commands,data_writes,reads,violations\n");
+	return;
+}
+
+void bench_start(bench_run_t *p_run)
+{
+	hd44780_clear_stats(&host_lcd);
+
+	p_run->t_start_ns = host_bus_time_ns();
+	p_run->t_call_ns = p_run->t_start_ns;
+	p_run->t_end_ns = p_run->t_start_ns;
+
+	return;
+}
+
+void bench_stop(bench_run_t *p_run)
+{
+	p_run->t_call_ns = host_bus_time_ns();
+	p_run->t_end_ns = p_run->t_call_ns;
+
+	return;
+}
+
+void bench_end(bench_run_t *p_run)
+{
+	p_run->t_end_ns = host_bus_time_ns();
+	return;
+}
+
+void bench_report(const bench_run_t *p_run, const char *platform, const char *config, const char *scenario, uint32_t n_iterations)
+{
+	uint64_t wall_ns;
+	uint64_t call_ns;
+	uint32_t n_bytes;
+	uint64_t bytes_per_sec = 0u;
+
+	wall_ns = p_run->t_end_ns - p_run->t_start_ns;
+	call_ns = p_run->t_call_ns - p_run->t_start_ns;
+	n_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	if(wall_ns) bytes_per_sec = (((uint64_t) n_bytes)*1000000000u)/wall_ns;
+	if(!n_iterations) n_iterations = 1u;
+
+	printf("%s,%s,%s,%u,%.3f,%.3f,%.3f,%u,%llu,%u,%u,%u,%u,%u\n", platform, config, scenario, n_iterations,
+		(double) wall_ns/1000.0, (double) call_ns/1000.0, (double) wall_ns/(1000.0*n_iterations),
+		n_bytes, (unsigned long long) bytes_per_sec, host_lcd.n_e_pulses, host_lcd.n_cmds, host_lcd.n_data, host_lcd.n_reads, host_lcd.n_violations);
+
+	return;
+}
+
+void bench_redraw_line(char *buf, uint32_t n_iter, uint8_t n_line)
+{
+	uint8_t n_char;
+
+	for(n_char = 0u; n_char < BENCH_NCHARS; n_char++) buf[n_char] = (char) (0x21 + ((n_iter + n_line + n_char)%94u));
+
+	buf[BENCH_NCHARS] = '\0';
+	return;
+}
+
+uint32_t bench_rand(uint32_t seed)
+{
+	return (seed*1103515245u + 12345u);
+}
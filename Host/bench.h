@@ -0,0 +1,98 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Benchmark scenarios and CSV output shared by bench_pico.c and bench_arduino.cpp.
+ *
+ * One line per (platform, config, scenario) run:
+ * platform,config,scenario,iterations,wall_us,call_us,us_per_iter,lcd_bytes,bytes_per_sec,e_pulses,commands,data_writes,reads,violations
+ *
+ * wall_us: virtual time from the first call until the controller received the last byte.
+ * call_us: virtual time spent inside the driver calls (differs from wall_us in async mode only).
+ * lcd_bytes: instructions plus data writes the controller executed (bus protocol overhead not included).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "host_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_NCHARS 20U
+#define BENCH_NLINES 4U
+
+#define BENCH_REDRAW_ITERATIONS 50U
+#define BENCH_COUNTER_ITERATIONS 1000U
+#define BENCH_RANDOM_ITERATIONS 1000U
+
+#define BENCH_SEED 0x2545f491U
+
+typedef struct {
+	uint64_t t_start_ns;
+	uint64_t t_call_ns;
+	uint64_t t_end_ns;
+} bench_run_t;
+
+/*
+ * bench_print_header()
+ * prints the CSV header line.
+ */
+
+extern void bench_print_header(void);
+
+/*
+ * bench_start()
+ * clears the emulator counters and starts timing a run.
+ */
+
+extern void bench_start(bench_run_t *p_run);
+
+/*
+ * bench_stop()
+ * marks the return of the last driver call of the run.
+ */
+
+extern void bench_stop(bench_run_t *p_run);
+
+/*
+ * bench_end()
+ * marks the end of the run, once the driver is idle (only needed when it differs from bench_stop()).
+ */
+
+extern void bench_end(bench_run_t *p_run);
+
+/*
+ * bench_report()
+ * prints the CSV line of a run.
+ */
+
+extern void bench_report(const bench_run_t *p_run, const char *platform, const char *config, const char *scenario, uint32_t n_iterations);
+
+/*
+ * bench_redraw_line()
+ * writes line "n_line" of full redraw iteration "n_iter" (BENCH_NCHARS chars, different on every iteration) to "buf".
+ */
+
+extern void bench_redraw_line(char *buf, uint32_t n_iter, uint8_t n_line);
+
+/*
+ * bench_rand()
+ * next value of the random cursor scenario sequence (LCG, same on every platform and run).
+ */
+
+extern uint32_t bench_rand(uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*BENCH_H*/
@@ -0,0 +1,258 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Arduino driver benchmark on the virtual clock.
+ * Runs every scenario on every bus configuration and prints one CSV line per run (see bench.h).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "lcd.hpp"
+#include "lcd_i2c.hpp"
+#include "lcd_spi.hpp"
+#include "lcd_static.hpp"
+
+#include "bench.h"
+
+#define LCD_DB0 14U
+#define LCD_DB1 15U
+#define LCD_DB2 16U
+#define LCD_DB3 17U
+#define LCD_DB4 4U
+#define LCD_DB5 5U
+#define LCD_DB6 6U
+#define LCD_DB7 7U
+#define LCD_RS 8U
+#define LCD_RW 9U
+#define LCD_E 3U
+#define LCD_LATCH 10U
+
+void wire_gpio(bool rw, bool bus_8bit)
+{
+	lcd_hal_host_init();
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+
+	if(rw) host_bus_connect(LCD_RW, HD44780_PIN_RW);
+
+	if(bus_8bit)
+	{
+		host_bus_connect(LCD_DB0, HD44780_PIN_DB0);
+		host_bus_connect(LCD_DB1, HD44780_PIN_DB1);
+		host_bus_connect(LCD_DB2, HD44780_PIN_DB2);
+		host_bus_connect(LCD_DB3, HD44780_PIN_DB3);
+	}
+
+	return;
+}
+
+/*
+ * Framebuffer mode: StaticLCD has none, the template overloads are no-ops.
+ */
+
+void set_framebuffer_mode(LCD *p_lcd)
+{
+#if LCD_CFG_FRAMEBUFFER
+	p_lcd->setFramebufferMode(true);
+#else
+	(void) p_lcd;
+#endif
+	return;
+}
+
+template <class T> void set_framebuffer_mode(T *p_lcd)
+{
+	(void) p_lcd;
+	return;
+}
+
+/*End of an iteration: framebuffer mode sends it now*/
+void end_iteration(LCD *p_lcd, bool framebuffer)
+{
+#if LCD_CFG_FRAMEBUFFER
+	if(framebuffer) p_lcd->flush();
+#else
+	(void) p_lcd;
+	(void) framebuffer;
+#endif
+	return;
+}
+
+template <class T> void end_iteration(T *p_lcd, bool framebuffer)
+{
+	(void) p_lcd;
+	(void) framebuffer;
+
+	return;
+}
+
+/*
+ * Typed fields: StaticLCD has none, the template overload prints nothing.
+ */
+
+bool print_counter_field(LCD *p_lcd, uint32_t value)
+{
+	return p_lcd->printUInt(value, 8u, LCD::ALIGN_LEFT, ' ');
+}
+
+template <class T> bool print_counter_field(T *p_lcd, uint32_t value)
+{
+	(void) p_lcd;
+	(void) value;
+
+	return false;
+}
+
+template <class T> void run_config(const char *config, T *p_lcd, bool framebuffer)
+{
+	bench_run_t run;
+	char text[BENCH_NCHARS + 1u];
+	uint32_t n_iter = 0u;
+	uint8_t n_line = 0u;
+	uint32_t seed = 0u;
+
+	/*begin*/
+	bench_start(&run);
+	p_lcd->begin();
+	bench_stop(&run);
+	bench_report(&run, "arduino", config, "begin", 1u);
+
+	if(framebuffer) set_framebuffer_mode(p_lcd);
+
+	/*Full screen redraw, different contents every time*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_REDRAW_ITERATIONS; n_iter++)
+	{
+		for(n_line = 0u; n_line < BENCH_NLINES; n_line++)
+		{
+			bench_redraw_line(text, n_iter, n_line);
+			p_lcd->setCursorPosition(0u, n_line);
+			p_lcd->printText(text);
+		}
+
+		end_iteration(p_lcd, framebuffer);
+	}
+
+	bench_stop(&run);
+	bench_report(&run, "arduino", config, "full_redraw", BENCH_REDRAW_ITERATIONS);
+
+	/*Counter field (TestLCD2.ino)*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_COUNTER_ITERATIONS; n_iter++)
+	{
+		snprintf(text, sizeof(text), "%u    ", (unsigned int) n_iter);
+		p_lcd->setCursorPosition(12u, 0u);
+		p_lcd->printText(text);
+
+		end_iteration(p_lcd, framebuffer);
+	}
+
+	bench_stop(&run);
+	bench_report(&run, "arduino", config, "counter", BENCH_COUNTER_ITERATIONS);
+
+	/*Same counter as a typed field: only the digits that changed are sent*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_COUNTER_ITERATIONS; n_iter++)
+	{
+		p_lcd->setCursorPosition(12u, 0u);
+		if(!print_counter_field(p_lcd, n_iter)) break;
+
+		end_iteration(p_lcd, framebuffer);
+	}
+
+	bench_stop(&run);
+	if(n_iter == BENCH_COUNTER_ITERATIONS) bench_report(&run, "arduino", config, "counter_field", BENCH_COUNTER_ITERATIONS);
+
+	/*Single characters at random positions*/
+	seed = BENCH_SEED;
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_RANDOM_ITERATIONS; n_iter++)
+	{
+		seed = bench_rand(seed);
+		p_lcd->setCursorPosition(((seed >> 16) % BENCH_NCHARS), ((seed >> 8) % BENCH_NLINES));
+		p_lcd->printChar((char) ('a' + (seed % 26u)));
+
+		end_iteration(p_lcd, framebuffer);
+	}
+
+	bench_stop(&run);
+	bench_report(&run, "arduino", config, "random_cursor", BENCH_RANDOM_ITERATIONS);
+
+	return;
+}
+
+int main(void)
+{
+	bench_print_header();
+
+	{
+		LCD lcd(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, BENCH_NCHARS, BENCH_NLINES);
+		wire_gpio(false, false);
+		run_config("gpio4", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_RW, LCD_E, BENCH_NCHARS, BENCH_NLINES);
+		wire_gpio(true, false);
+		run_config("gpio4_bf", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB0, LCD_DB1, LCD_DB2, LCD_DB3, LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, BENCH_NCHARS, BENCH_NLINES);
+		wire_gpio(false, true);
+		run_config("gpio8", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB0, LCD_DB1, LCD_DB2, LCD_DB3, LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_RW, LCD_E, BENCH_NCHARS, BENCH_NLINES);
+		wire_gpio(true, true);
+		run_config("gpio8_bf", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, BENCH_NCHARS, BENCH_NLINES);
+		wire_gpio(false, false);
+		run_config("gpio4_fb", &lcd, true);
+	}
+
+	{
+		LCDI2CTransport lcd_i2c(0x27, &Wire, 400000UL);
+		LCD lcd(&lcd_i2c, BENCH_NCHARS, BENCH_NLINES);
+
+		lcd_hal_host_init();
+		run_config("i2c_400k", &lcd, false);
+	}
+
+	{
+		LCDSPITransport lcd_spi(LCD_LATCH, 4000000UL, &SPI);
+		LCD lcd(&lcd_spi, BENCH_NCHARS, BENCH_NLINES);
+
+		lcd_hal_host_init();
+		host_bus_connect(LCD_LATCH, HOST_BUS_FN_SR_LATCH);
+		run_config("spi_4m", &lcd, false);
+	}
+
+	{
+		StaticLCD<LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, BENCH_NCHARS, BENCH_NLINES> lcd;
+		wire_gpio(false, false);
+		run_config("static4", &lcd, false);
+	}
+
+	return 0;
+}
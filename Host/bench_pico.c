@@ -0,0 +1,261 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Raspberry Pi Pico driver benchmark on the virtual clock.
+ * Runs every scenario on every bus configuration and prints one CSV line per run (see bench.h).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "lcd.h"
+#include "lcd_hal.h"
+#include "lcd_i2c.h"
+#include "lcd_spi.h"
+
+#include "bench.h"
+
+#define LCD_DB0 10U
+#define LCD_DB1 11U
+#define LCD_DB2 12U
+#define LCD_DB3 13U
+#define LCD_DB4 6U
+#define LCD_DB5 7U
+#define LCD_DB6 8U
+#define LCD_DB7 9U
+#define LCD_RS 5U
+#define LCD_RW 4U
+#define LCD_E 3U
+
+#define CFG_GPIO4 0U
+#define CFG_GPIO4_BF 1U
+#define CFG_GPIO8 2U
+#define CFG_GPIO8_BF 3U
+#define CFG_GPIO4_FB 4U
+#define CFG_GPIO4_ASYNC 5U
+#define CFG_I2C_400K 6U
+#define CFG_I2C_1M 7U
+#define CFG_SPI_4M 8U
+#define CFG_SPI_16M 9U
+#define N_CFG 10U
+
+static const char *const config_names[N_CFG] = {"gpio4", "gpio4_bf", "gpio8", "gpio8_bf", "gpio4_fb", "gpio4_async", "i2c_400k", "i2c_1m", "spi_4m", "spi_16m"};
+
+lcd_t lcd;
+lcd_i2c_t lcd_i2c;
+lcd_spi_t lcd_spi;
+bool fb_mode = false;
+bool async_mode = false;
+
+void open_config(uint8_t config)
+{
+	bool rw;
+	bool bus_8bit;
+
+	memset(&lcd, 0, sizeof(lcd_t));
+	memset(&lcd_i2c, 0, sizeof(lcd_i2c_t));
+	memset(&lcd_spi, 0, sizeof(lcd_spi_t));
+
+	lcd_hal_host_init();
+
+	lcd.n_chars = BENCH_NCHARS;
+	lcd.n_lines = BENCH_NLINES;
+
+	fb_mode = (config == CFG_GPIO4_FB);
+	async_mode = (config == CFG_GPIO4_ASYNC);
+
+	switch(config)
+	{
+		case CFG_I2C_400K:
+		case CFG_I2C_1M:
+			lcd_i2c.i2c = i2c0;
+			lcd_i2c.address = host_bus_i2c_address;
+			if(config == CFG_I2C_1M) lcd_i2c.baudrate = 1000000u;
+			else lcd_i2c.baudrate = 400000u;
+
+			lcd.transport = &lcd_transport_i2c;
+			lcd.transport_ctx = &lcd_i2c;
+			return;
+
+		case CFG_SPI_4M:
+		case CFG_SPI_16M:
+			lcd_spi.spi = spi0;
+			if(config == CFG_SPI_16M) lcd_spi.baudrate = 16000000u;
+			else lcd_spi.baudrate = 4000000u;
+
+			lcd.transport = &lcd_transport_spi;
+			lcd.transport_ctx = &lcd_spi;
+			return;
+
+		default:
+			break;
+	}
+
+	rw = (config == CFG_GPIO4_BF) || (config == CFG_GPIO8_BF);
+	bus_8bit = (config == CFG_GPIO8) || (config == CFG_GPIO8_BF);
+
+	lcd.db4 = LCD_DB4;
+	lcd.db5 = LCD_DB5;
+	lcd.db6 = LCD_DB6;
+	lcd.db7 = LCD_DB7;
+	lcd.rs = LCD_RS;
+	lcd.e = LCD_E;
+	lcd.rw = LCD_RW;
+	lcd.use_rw = rw;
+	lcd.bus_8bit = bus_8bit;
+	lcd.db0 = LCD_DB0;
+	lcd.db1 = LCD_DB1;
+	lcd.db2 = LCD_DB2;
+	lcd.db3 = LCD_DB3;
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+
+	if(rw) host_bus_connect(LCD_RW, HD44780_PIN_RW);
+
+	if(bus_8bit)
+	{
+		host_bus_connect(LCD_DB0, HD44780_PIN_DB0);
+		host_bus_connect(LCD_DB1, HD44780_PIN_DB1);
+		host_bus_connect(LCD_DB2, HD44780_PIN_DB2);
+		host_bus_connect(LCD_DB3, HD44780_PIN_DB3);
+	}
+
+	return;
+}
+
+/*End of an iteration: framebuffer mode sends it now*/
+void end_iteration(void)
+{
+#if LCD_CFG_FRAMEBUFFER
+	if(fb_mode) lcd_flush(&lcd);
+#endif
+	return;
+}
+
+/*End of a run: async mode waits for the queue to drain*/
+void end_run(void)
+{
+#if LCD_CFG_ASYNC
+	if(async_mode) lcd_wait_idle(&lcd);
+#endif
+	return;
+}
+
+void run_config(uint8_t config)
+{
+	bench_run_t run;
+	char text[BENCH_NCHARS + 1u];
+	uint32_t n_iter;
+	uint8_t n_line;
+	uint32_t seed;
+
+	open_config(config);
+
+	/*begin*/
+	bench_start(&run);
+	lcd_init(&lcd);
+	bench_stop(&run);
+	bench_report(&run, "pico", config_names[config], "begin", 1u);
+
+#if LCD_CFG_FRAMEBUFFER
+	if(fb_mode) lcd_set_framebuffer_mode(&lcd, true);
+#endif
+#if LCD_CFG_ASYNC
+	if(async_mode) lcd_set_async_mode(&lcd, true);
+#endif
+
+	/*Full screen redraw, different contents every time*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_REDRAW_ITERATIONS; n_iter++)
+	{
+		for(n_line = 0u; n_line < BENCH_NLINES; n_line++)
+		{
+			bench_redraw_line(text, n_iter, n_line);
+			lcd_set_cursor_pos(&lcd, 0u, n_line);
+			lcd_print_text(&lcd, text);
+		}
+
+		end_iteration();
+	}
+
+	bench_stop(&run);
+	end_run();
+	bench_end(&run);
+	bench_report(&run, "pico", config_names[config], "full_redraw", BENCH_REDRAW_ITERATIONS);
+
+	/*Counter field (Test/main.c)*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_COUNTER_ITERATIONS; n_iter++)
+	{
+		snprintf(text, sizeof(text), "%u    ", (unsigned int) n_iter);
+		lcd_set_cursor_pos(&lcd, 12u, 0u);
+		lcd_print_text(&lcd, text);
+
+		end_iteration();
+	}
+
+	bench_stop(&run);
+	end_run();
+	bench_end(&run);
+	bench_report(&run, "pico", config_names[config], "counter", BENCH_COUNTER_ITERATIONS);
+
+	/*Same counter as a typed field: only the digits that changed are sent*/
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_COUNTER_ITERATIONS; n_iter++)
+	{
+		lcd_set_cursor_pos(&lcd, 12u, 0u);
+		lcd_print_uint(&lcd, n_iter, 8u, LCD_ALIGN_LEFT, ' ');
+
+		end_iteration();
+	}
+
+	bench_stop(&run);
+	end_run();
+	bench_end(&run);
+	bench_report(&run, "pico", config_names[config], "counter_field", BENCH_COUNTER_ITERATIONS);
+
+	/*Single characters at random positions*/
+	seed = BENCH_SEED;
+	bench_start(&run);
+
+	for(n_iter = 0u; n_iter < BENCH_RANDOM_ITERATIONS; n_iter++)
+	{
+		seed = bench_rand(seed);
+		lcd_set_cursor_pos(&lcd, ((seed >> 16) % BENCH_NCHARS), ((seed >> 8) % BENCH_NLINES));
+		lcd_print_char(&lcd, (char) ('a' + (seed % 26u)));
+
+		end_iteration();
+	}
+
+	bench_stop(&run);
+	end_run();
+	bench_end(&run);
+	bench_report(&run, "pico", config_names[config], "random_cursor", BENCH_RANDOM_ITERATIONS);
+
+	return;
+}
+
+int main(void)
+{
+	uint8_t config;
+
+	bench_print_header();
+
+	for(config = 0u; config < N_CFG; config++) run_config(config);
+
+	return 0;
+}
@@ -0,0 +1,1045 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Runs the Arduino driver against the HD44780 emulator: every bus mode and transport the host HAL covers,
+ * checking the resulting display contents and that the controller saw no timing violation.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "lcd.hpp"
+#include "lcd_i2c.hpp"
+#include "lcd_spi.hpp"
+#include "lcd_static.hpp"
+#include "lcd_bus.hpp"
+#include "lcd_screen.hpp"
+#include "lcd_marquee.hpp"
+#include "lcd_console.hpp"
+
+#include "trace_vcd.h"
+
+#define LCD_DB0 14U
+#define LCD_DB1 15U
+#define LCD_DB2 16U
+#define LCD_DB3 17U
+#define LCD_DB4 4U
+#define LCD_DB5 5U
+#define LCD_DB6 6U
+#define LCD_DB7 7U
+#define LCD_RS 8U
+#define LCD_RW 9U
+#define LCD_E 3U
+#define LCD_E2 2U
+#define LCD_LATCH 10U
+
+#define LCD_NCHARS 20U
+#define LCD_NLINES 4U
+#define LCD2_NCHARS 16U
+#define LCD2_NLINES 2U
+
+static const char *const expected_text[LCD_NLINES] = {
+	"Hello, World!       ",
+	"                    ",
+	"0123456789ABCDEFGHIJ",
+	"             Host   "
+};
+
+uint32_t n_failed = 0u;
+
+void wire_gpio(bool rw, bool bus_8bit)
+{
+	lcd_hal_host_init();
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+
+	if(rw) host_bus_connect(LCD_RW, HD44780_PIN_RW);
+
+	if(bus_8bit)
+	{
+		host_bus_connect(LCD_DB0, HD44780_PIN_DB0);
+		host_bus_connect(LCD_DB1, HD44780_PIN_DB1);
+		host_bus_connect(LCD_DB2, HD44780_PIN_DB2);
+		host_bus_connect(LCD_DB3, HD44780_PIN_DB3);
+	}
+
+	return;
+}
+
+/*LCD on the 4-bit GPIO pinout, wired to the emulator*/
+class GpioLCD : public LCD {
+	public:
+		GpioLCD(uint8_t n_chars, uint8_t n_lines) : LCD(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, n_chars, n_lines)
+		{
+			wire_gpio(false, false);
+		}
+};
+
+template <class T> void draw(T *p_lcd)
+{
+	p_lcd->clear();
+	p_lcd->printText("Hello, World!");
+	p_lcd->setCursorPosition(0u, 2u);
+	p_lcd->printText("0123456789ABCDEFGHIJ");
+	p_lcd->setCursorPosition(13u, 3u);
+	p_lcd->printText("Host");
+
+	return;
+}
+
+void check(const char *name, uint64_t t_start_ns)
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line = 0u;
+	bool ok = false;
+
+	ok = host_lcd.d && (host_lcd.n_violations == 0u);
+
+	for(n_line = 0u; n_line < LCD_NLINES; n_line++)
+	{
+		hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, n_line, line);
+		if(strcmp(line, expected_text[n_line])) ok = false;
+	}
+
+	printf("%-24s %s  %8.3f ms  %5u E pulses  %u violations\n", name, ok ? "PASS" : "FAIL", (double) (host_bus_time_ns() - t_start_ns)/1000000.0, host_lcd.n_e_pulses, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+
+	return;
+}
+
+void check_lcd(const char *name, LCD *p_lcd, bool framebuffer)
+{
+	uint64_t t_start_ns = 0u;
+
+	t_start_ns = host_bus_time_ns();
+
+	if(!p_lcd->begin())
+	{
+		printf("%-24s FAIL  begin()\n", name);
+		n_failed++;
+		return;
+	}
+
+#if LCD_CFG_FRAMEBUFFER
+	if(framebuffer) p_lcd->setFramebufferMode(true);
+#else
+	(void) framebuffer;
+#endif
+
+	draw(p_lcd);
+
+#if LCD_CFG_FRAMEBUFFER
+	if(framebuffer) p_lcd->flush();
+#endif
+
+	check(name, t_start_ns);
+	return;
+}
+
+/*
+ * Performance counters against what the emulator saw.
+ */
+
+void check_stats(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	LCDStats stats;
+	uint64_t t_start_ns = 0u;
+	uint32_t elapsed_us = 0u;
+	uint32_t wait_us = 0u;
+	uint32_t max_call_us = 0u;
+	bool ok = false;
+
+	ok = lcd.begin();
+
+	lcd.resetStats();
+	hd44780_clear_stats(&host_lcd);
+	t_start_ns = host_bus_time_ns();
+
+	draw(&lcd);
+
+	elapsed_us = (uint32_t) ((host_bus_time_ns() - t_start_ns)/1000u);
+	stats = lcd.getStats();
+
+	ok = ok && (stats.nCmds == host_lcd.n_cmds) && (stats.nData == host_lcd.n_data) && (stats.nClearHome == 1u) && !stats.nSkipped;
+	ok = ok && (stats.maxCallUs >= LCD_TIMING_CLEAR_US) && (stats.waitUs <= elapsed_us) && (stats.waitUs >= (elapsed_us - (elapsed_us >> 3)));
+
+	wait_us = (uint32_t) stats.waitUs;
+	max_call_us = stats.maxCallUs;
+
+	/*Reprinting the same text in framebuffer mode sends nothing*/
+	lcd.resetStats();
+	lcd.setFramebufferMode(true);
+	lcd.home();
+	lcd.printText("Hello, World!");
+	lcd.flush();
+	stats = lcd.getStats();
+
+	ok = ok && (stats.nSkipped == 13u) && !stats.nData;
+
+	printf("%-24s %s  %u us waiting  %u us longest call\n", "stats", ok ? "PASS" : "FAIL", wait_us, max_call_us);
+	if(!ok) n_failed++;
+
+	return;
+}
+
+/*
+ * Glyph cache: the 8 CGRAM slots are filled from slot 0 up, the least recently printed glyph is the one replaced,
+ * and the cells still showing it get its fallback character (at once, or on the next flush in framebuffer mode).
+ */
+
+void check_glyphs(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	LCDGlyph glyphs[10];
+	LCDGlyphStats stats;
+	char line[LCD_NCHARS + 1u];
+	uint16_t glyph_id = 0u;
+	uint8_t n_row = 0u;
+	bool ok = false;
+
+	memset(glyphs, 0, sizeof(glyphs));
+
+	for(glyph_id = 0u; glyph_id < 10u; glyph_id++)
+	{
+		for(n_row = 0u; n_row < 8u; n_row++) glyphs[glyph_id].rows[n_row] = (uint8_t) ((glyph_id*3u + n_row) & 0x1f);
+		glyphs[glyph_id].fallback = (char) ('a' + glyph_id);
+	}
+
+	ok = lcd.begin() && lcd.setGlyphTable(glyphs, 10u);
+	ok = ok && !lcd.printGlyph(10u);
+
+	/*Every slot taken, then glyph 0 printed again: glyph 1 becomes the least recently printed*/
+	lcd.setCursorPosition(0u, 0u);
+	for(glyph_id = 0u; glyph_id < 8u; glyph_id++) lcd.printGlyph(glyph_id);
+
+	lcd.setCursorPosition(0u, 1u);
+	lcd.printGlyph(0u);
+	lcd.printChar('>');
+
+	lcd.setCursorPosition(19u, 3u);
+	lcd.printGlyph(8u);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "\x00" "b" "\x02\x03\x04\x05\x06\x07" " ", 9u);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[0] == 0x00) && (line[1] == '>');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 3u, line);
+	ok = ok && (line[19] == 0x01);
+
+	for(n_row = 0u; n_row < 8u; n_row++) ok = ok && (host_lcd.cgram[8u + n_row] == glyphs[8].rows[n_row]);
+
+	/*Framebuffer mode: glyph 2 is replaced, its cell gets 'c' on the flush*/
+	lcd.setFramebufferMode(true);
+	lcd.setCursorPosition(5u, 1u);
+	lcd.printGlyph(9u);
+	lcd.setFramebufferMode(false);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && (line[2] == 'c');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[5] == 0x02);
+
+	for(n_row = 0u; n_row < 8u; n_row++) ok = ok && (host_lcd.cgram[16u + n_row] == glyphs[9].rows[n_row]);
+
+	stats = lcd.getGlyphStats();
+	ok = ok && (stats.nHits == 1u) && (stats.nMisses == 10u) && (stats.nEvictions == 2u) && (stats.nRepaints == 2u);
+	ok = ok && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u hits  %u misses  %u cells repainted  %u violations\n", "glyph cache", ok ? "PASS" : "FAIL", stats.nHits, stats.nMisses, stats.nRepaints, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * UTF-8 text (A00 ROM): ROM characters, a glyph standing for a character the ROM lacks, and the replacement character
+ * for the other ones and for malformed sequences (stray 0xff, truncated sequence at the end).
+ */
+
+void check_utf8(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	const LCDGlyph glyph_e_acute = {{0x02, 0x04, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00}, 'e', 0x00e9};
+	char line[LCD_NCHARS + 1u];
+	bool ok = false;
+
+	ok = lcd.begin() && lcd.setGlyphTable(&glyph_e_acute, 1u);
+
+	/*21.5 degree C, micro, yen, katakana A, e acute, euro, backslash, 0xff, truncated euro*/
+	ok = ok && lcd.printTextUtf8("21.5\xc2\xb0" "C \xc2\xb5\xc2\xa5\xef\xbd\xb1\xc3\xa9\xe2\x82\xac\\\xff\xe2\x82");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "21.5\xdf" "C \xe4\x5c\xb1\x00????     ", LCD_NCHARS);
+	ok = ok && (host_lcd.cgram[0] == 0x02) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u violations\n", "utf-8 text", ok ? "PASS" : "FAIL", host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Typed fields: formatting (sign before zero padding, fixed point, overflow), and a changed value
+ * only sends the characters that differ (plus the address to reach the first one).
+ */
+
+void check_fields(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	char line[LCD_NCHARS + 1u];
+	uint32_t n_cmds = 0u;
+	uint32_t n_data = 0u;
+	uint32_t n_unchanged = 0u;
+	bool ok = false;
+
+	ok = lcd.begin();
+	ok = ok && !lcd.printUInt(0u, (LCD::DDRAM_LINE_SIZE + 1u), LCD::ALIGN_RIGHT, ' ') && !lcd.printUInt(0u, 4u, 2, ' ');
+
+	ok = ok && lcd.printUInt(1234u, 6u, LCD::ALIGN_RIGHT, ' ') && lcd.printText("|");
+
+	lcd.setCursorPosition(0u, 1u);
+	ok = ok && lcd.printInt(-42, 6u, LCD::ALIGN_RIGHT, '0') && lcd.printFixed(-5, 1u, 0u, LCD::ALIGN_LEFT, ' ');
+	ok = ok && lcd.printHex(0xbeefu, 0u, LCD::ALIGN_LEFT, ' ') && lcd.printUInt(123456u, 3u, LCD::ALIGN_RIGHT, ' ');
+
+	lcd.setCursorPosition(0u, 2u);
+	ok = ok && lcd.printInt(INT32_MIN, 0u, LCD::ALIGN_RIGHT, ' ') && lcd.printFixed(1234, 2u, 7u, LCD::ALIGN_LEFT, '_');
+
+	/*1234 -> 1235: the address of the last digit and the digit*/
+	lcd.setCursorPosition(0u, 0u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd.printUInt(1235u, 6u, LCD::ALIGN_RIGHT, ' ');
+	n_cmds = host_lcd.n_cmds;
+	n_data = host_lcd.n_data;
+
+	/*The same value again sends nothing, and the text after it still lands after the field*/
+	lcd.setCursorPosition(0u, 0u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd.printUInt(1235u, 6u, LCD::ALIGN_RIGHT, ' ');
+	n_unchanged = host_lcd.n_cmds + host_lcd.n_data;
+	ok = ok && lcd.printText("!");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "  1235!", 7u);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && !memcmp(line, "-00042-0.5BEEF###   ", LCD_NCHARS);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line);
+	ok = ok && !memcmp(line, "-214748364812.34__  ", LCD_NCHARS);
+
+	ok = ok && (n_cmds == 1u) && (n_data == 1u) && !n_unchanged && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes for 1 changed digit  %u for none\n", "fields", ok ? "PASS" : "FAIL", (n_cmds + n_data), n_unchanged);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Screen layouts: a changed field sends its changed digit, an unchanged update sends nothing, and switching
+ * to a layout that shares texts and a field position with the current one only sends the cells that differ.
+ */
+
+enum {SCREEN_TEMP, SCREEN_HUM};
+enum {SCREEN_FAN = 1};
+
+constexpr LCDScreenText screen_a_texts[] = {{0u, 0u, "Temp:"}, {11u, 0u, "C"}, {0u, 1u, "Hum:"}, {7u, 1u, "%"}};
+constexpr LCDScreenField screen_a_fields[] = {
+	{5u, 0u, 5u, LCDScreen::FIELD_FIXED, 1u, LCD::ALIGN_RIGHT, ' '},
+	{4u, 1u, 3u, LCDScreen::FIELD_UINT, 0u, LCD::ALIGN_RIGHT, ' '}
+};
+constexpr LCDScreenLayout screen_a = {screen_a_texts, 4u, screen_a_fields, 2u};
+
+constexpr LCDScreenText screen_b_texts[] = {{0u, 0u, "Temp:"}, {11u, 0u, "F"}, {0u, 1u, "Fan:"}};
+constexpr LCDScreenField screen_b_fields[] = {
+	{5u, 0u, 5u, LCDScreen::FIELD_FIXED, 1u, LCD::ALIGN_RIGHT, ' '},
+	{5u, 1u, 4u, LCDScreen::FIELD_TEXT, 0u, LCD::ALIGN_LEFT, '.'}
+};
+constexpr LCDScreenLayout screen_b = {screen_b_texts, 3u, screen_b_fields, 2u};
+
+constexpr LCDScreenField screen_bad_fields[] = {{18u, 0u, 3u, LCDScreen::FIELD_UINT, 0u, LCD::ALIGN_RIGHT, ' '}};
+constexpr LCDScreenLayout screen_bad = {NULL, 0u, screen_bad_fields, 1u};
+
+void check_screen(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	LCDScreen screen(&lcd);
+	char line[LCD_NCHARS + 1u];
+	uint32_t n_field_bytes = 0u;
+	uint32_t n_idle_bytes = 0u;
+	uint32_t n_switch_bytes = 0u;
+	bool ok = false;
+
+	ok = lcd.begin() && !screen.setLayout(&screen_bad) && screen.setLayout(&screen_a);
+	ok = ok && screen.setField(SCREEN_TEMP, 215) && screen.setField(SCREEN_HUM, 40) && screen.update();
+
+	/*21.5 -> 21.6, humidity unchanged*/
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && screen.setField(SCREEN_TEMP, 216) && screen.setField(SCREEN_HUM, 40) && screen.update();
+	n_field_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && screen.update();
+	n_idle_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	/*'C' -> 'F' (address, character), "Hum" -> "Fan" (address, 3 characters), the rest stays*/
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && screen.setLayout(&screen_b);
+	n_switch_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	ok = ok && !screen.setField(SCREEN_FAN, 1) && screen.setFieldText(SCREEN_FAN, "ON");
+	ok = ok && screen.setField(SCREEN_TEMP, 216) && screen.update();
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "Temp: 21.6 F        ", LCD_NCHARS);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && !memcmp(line, "Fan: ON..           ", LCD_NCHARS);
+
+	ok = ok && (n_field_bytes == 2u) && !n_idle_bytes && (n_switch_bytes == 6u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes for 1 changed digit  %u for no change  %u for a layout switch\n", "screen layout", ok ? "PASS" : "FAIL", n_field_bytes, n_idle_bytes, n_switch_bytes);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Marquee on a 16x2 display: both lines scrolling is a single display shift instruction per step,
+ * with the pauses at both ends. A single line scrolling under a static one falls back to rewriting it.
+ */
+
+void check_marquee(void)
+{
+	GpioLCD lcd(LCD2_NCHARS, LCD2_NLINES);
+	LCDMarquee marquee(&lcd, 100u, 500u);
+	char line0[LCD2_NCHARS + 1u];
+	char line1[LCD2_NCHARS + 1u];
+	uint32_t n_step_bytes = 0u;
+	uint8_t n_step = 0u;
+	bool ok = false;
+
+	ok = lcd.begin();
+	ok = ok && marquee.setLine(0u, "0123456789ABCDEFGHIJ") && marquee.setLine(1u, "abcdefghijklmnopqr");
+	ok = ok && marquee.start() && marquee.usesDisplayShift() && !marquee.tick();
+
+	/*End of the first pause: one instruction*/
+	host_bus_advance_ns(500000000u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && marquee.tick();
+	n_step_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "123456789ABCDEFG");
+
+	for(n_step = 0u; n_step < 3u; n_step++)
+	{
+		host_bus_advance_ns(100000000u);
+		ok = ok && marquee.tick();
+	}
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 1u, line1);
+	ok = ok && !strcmp(line0, "456789ABCDEFGHIJ") && !strcmp(line1, "efghijklmnopqr  ");
+
+	/*Pause at the end, then back*/
+	host_bus_advance_ns(100000000u);
+	ok = ok && !marquee.tick();
+	host_bus_advance_ns(400000000u);
+	ok = ok && marquee.tick();
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "3456789ABCDEFGHI");
+
+	ok = ok && marquee.stop();
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "0123456789ABCDEF");
+
+	/*Line 1 stays: rewriting line 0*/
+	ok = ok && lcd.setCursorPosition(0u, 1u) && lcd.printText("static          ");
+	ok = ok && marquee.setLine(1u, NULL) && marquee.start() && !marquee.usesDisplayShift();
+
+	host_bus_advance_ns(500000000u);
+	ok = ok && marquee.tick();
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 1u, line1);
+	ok = ok && !strcmp(line0, "123456789ABCDEFG") && !strcmp(line1, "static          ");
+
+	ok = ok && (n_step_bytes == 1u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes per display shift step  %u violations\n", "marquee", ok ? "PASS" : "FAIL", n_step_bytes, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD2_NCHARS, LCD2_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Console on the 20x4 display: line wrap in screen order (line 1 after line 0, not the DDRAM order),
+ * control characters, no scroll until the bottom line gets a character,
+ * then a log of similar lines scrolling with only the characters that differ.
+ */
+
+static const char *const console_text[LCD_NLINES] = {
+	"zVwxT               ",
+	"line 2              ",
+	"line 3              ",
+	"line 4              "
+};
+
+static const char *const console_log[LCD_NLINES] = {
+	"line 3              ",
+	"line 4              ",
+	"line 5              ",
+	"line 6              "
+};
+
+bool check_text(const char *const expected[LCD_NLINES])
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line;
+
+	for(n_line = 0u; n_line < LCD_NLINES; n_line++)
+	{
+		hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, n_line, line);
+		if(strcmp(line, expected[n_line])) return false;
+	}
+
+	return true;
+}
+
+void check_console(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	LCDConsole console(&lcd);
+	char line0[LCD_NCHARS + 1u];
+	char line1[LCD_NCHARS + 1u];
+	char line2[LCD_NCHARS + 1u];
+	uint32_t n_scroll_bytes = 0u;
+	bool ok = false;
+
+	ok = lcd.begin() && console.clear();
+	ok = ok && (console.print("abcdefghijklmnopqrstuvwxy") == 25u);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line1);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line2);
+	ok = ok && !strcmp(line0, "abcdefghijklmnopqrst") && !strcmp(line1, "uvwxy               ") && !strcmp(line2, "                    ");
+
+	/*"UVwxy", back to 'U' -> "zVwxy", tab stop 4 -> "zVwxT"*/
+	ok = ok && console.print("\rUV\b\bz\tT") && console.println() && console.println("line 2") && console.println("line 3");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "abcdefghijklmnopqrst");
+
+	ok = ok && console.print("line 4") && check_text(console_text);
+
+	/*Each line differs from the one below it by a single character: address and character per line*/
+	ok = ok && console.print("\nline 5");
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && console.write('\n') && console.print("line 6");
+	n_scroll_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	ok = ok && check_text(console_log) && (n_scroll_bytes == 8u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes per scroll  %u violations\n", "console", ok ? "PASS" : "FAIL", n_scroll_bytes, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Region planner on the 20x4 display: each fill sends what it estimated (execution times from the driver counters),
+ * a clear display only when it beats the cells that differ, nothing for a fill already shown, and the cursor stays.
+ */
+
+static const char *const fill_text[LCD_NLINES] = {
+	"  A                 ",
+	"     ##########     ",
+	"     ##########     ",
+	"xxxxxxxxxxxxxxxxxxxx"
+};
+
+uint32_t fill_stats_us(LCD *p_lcd)
+{
+	LCDStats stats = p_lcd->getStats();
+
+	return stats.nClearHome*LCD_TIMING_CLEAR_US + (stats.nCmds - stats.nClearHome)*LCD_TIMING_CMD_US + stats.nData*LCD_TIMING_DATA_US;
+}
+
+void check_fill(void)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	int32_t est_line_us = 0;
+	int32_t est_screen_us = 0;
+	int32_t est_rect_us = 0;
+	int32_t est_again_us = 0;
+	char line[LCD_NCHARS + 1u];
+	bool ok = false;
+
+	ok = lcd.begin();
+	draw(&lcd);
+
+	/*"Hello, World!": address set and 13 characters, the rest of the screen stays*/
+	est_line_us = lcd.estimateFillRectUs(0u, 0u, LCD_NCHARS, 1u, ' ');
+	lcd.resetStats();
+	ok = ok && lcd.clearLine(0u) && (fill_stats_us(&lcd) == (uint32_t) est_line_us);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line);
+	ok = ok && !strcmp(line, expected_text[2]);
+
+	/*Every cell differs: rewriting them beats a clear display followed by the same cells*/
+	est_screen_us = lcd.estimateFillRectUs(0u, 0u, LCD_NCHARS, LCD_NLINES, 'x');
+	lcd.resetStats();
+	ok = ok && lcd.fillScreenChar('x') && (fill_stats_us(&lcd) == (uint32_t) est_screen_us) && !lcd.getStats().nClearHome;
+
+	/*3 lines out of 4: a clear display and the last line beat 60 characters*/
+	ok = ok && lcd.setCursorPosition(2u, 0u);
+	est_rect_us = lcd.estimateFillRectUs(0u, 0u, LCD_NCHARS, 3u, ' ');
+	lcd.resetStats();
+	ok = ok && lcd.clearRect(0u, 0u, LCD_NCHARS, 3u) && (fill_stats_us(&lcd) == (uint32_t) est_rect_us) && (lcd.getStats().nClearHome == 1u);
+
+	ok = ok && lcd.fillRect(5u, 1u, 10u, 2u, '#');
+	est_again_us = lcd.estimateFillRectUs(5u, 1u, 10u, 2u, '#');
+	lcd.resetStats();
+	ok = ok && lcd.fillRect(5u, 1u, 10u, 2u, '#') && (fill_stats_us(&lcd) == 0u) && (est_again_us == 0);
+
+	ok = ok && lcd.printChar('A') && check_text(fill_text);
+	ok = ok && !lcd.fillRect(15u, 0u, 6u, 1u, '-') && !lcd.clearLine(LCD_NLINES) && (lcd.estimateFillRectUs(0u, 0u, 0u, 1u, ' ') < 0) && !host_lcd.n_violations;
+
+	printf("%-24s %s  clear line %ld us, fill screen %ld us, clear 3 lines %ld us  %u violations\n", "fill planner", ok ? "PASS" : "FAIL", (long) est_line_us, (long) est_screen_us, (long) est_rect_us, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Bus trace: the newest entries must be the end of draw(), oldest first, in time order.
+ * The trace is written to "vcdPath" if not NULL.
+ */
+
+void check_trace(const char *vcdPath)
+{
+	GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+	LCDTraceEntry trace[LCD_CFG_TRACE_SIZE];
+	trace_vcd_entry_t vcd[LCD_CFG_TRACE_SIZE];
+	uintptr_t n_entries = 0u;
+	uintptr_t n_entry = 0u;
+	char tail[5];
+	bool ok = false;
+
+	ok = lcd.begin();
+	draw(&lcd);
+
+	n_entries = lcd.getTrace(trace, LCD_CFG_TRACE_SIZE);
+
+	if(!ok || (n_entries < 5u))
+	{
+		printf("%-24s FAIL  %u entries\n", "trace", (unsigned int) n_entries);
+		n_failed++;
+		return;
+	}
+
+	/*Initialization (1 nibble, 4 instructions) plus draw() (3 instructions, 37 characters)*/
+	if(LCD_CFG_TRACE_SIZE > 45u) ok = (n_entries == 45u) && (trace[0].kind == LCD::TRACE_INIT_NIBBLE);
+	else ok = (n_entries == (LCD_CFG_TRACE_SIZE - 1u));
+
+	/*Last cursor move (13, 3), then "Host"*/
+	ok = ok && (trace[n_entries - 5u].kind == LCD::TRACE_CMD) && (trace[n_entries - 5u].value == (0x80 | (0x54 + 13u)));
+
+	for(n_entry = 0u; n_entry < 4u; n_entry++)
+	{
+		if(trace[n_entries - 4u + n_entry].kind != LCD::TRACE_DATA) ok = false;
+		tail[n_entry] = (char) trace[n_entries - 4u + n_entry].value;
+	}
+
+	tail[4] = '\0';
+	ok = ok && !strcmp(tail, "Host");
+
+	for(n_entry = 0u; n_entry < n_entries; n_entry++)
+	{
+		if(n_entry && ((int32_t) (trace[n_entry].tUs - trace[n_entry - 1u].tUs) < 0)) ok = false;
+
+		vcd[n_entry].t_us = trace[n_entry].tUs;
+		vcd[n_entry].kind = trace[n_entry].kind;
+		vcd[n_entry].value = trace[n_entry].value;
+	}
+
+	/*Only the newest entries when asked for fewer*/
+	ok = ok && (lcd.getTrace(trace, 1u) == 1u) && (trace[0].value == 't');
+
+	lcd.clearTrace();
+	ok = ok && !lcd.getTrace(trace, LCD_CFG_TRACE_SIZE);
+
+	if((vcdPath != NULL) && !trace_vcd_write(vcdPath, vcd, n_entries)) ok = false;
+
+	printf("%-24s %s  %u entries%s%s\n", "trace", ok ? "PASS" : "FAIL", (unsigned int) n_entries, (vcdPath != NULL) ? " written to " : "", (vcdPath != NULL) ? vcdPath : "");
+	if(!ok) n_failed++;
+
+	return;
+}
+
+/*
+ * Two displays on the same DB4-DB7 and RS (TestLCD2 wiring): 20x4 on E, 16x2 on E2.
+ */
+
+void wire_pair(void)
+{
+	lcd_hal_host_init();
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+	host_bus_connect(LCD_E2, HOST_BUS_FN_E2);
+
+	return;
+}
+
+/*Fills line "n_line" with "c + n_line" (nothing if the display has fewer lines)*/
+void draw_line(LCD *p_lcd, uint8_t n_line, char c)
+{
+	char text[LCD_NCHARS + 1u];
+
+	if(n_line >= p_lcd->getNLines()) return;
+
+	memset(text, (c + n_line), p_lcd->getNCharsPerLine());
+	text[p_lcd->getNCharsPerLine()] = '\0';
+
+	p_lcd->setCursorPosition(0u, n_line);
+	p_lcd->printText(text);
+
+	return;
+}
+
+bool check_lines(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, char c)
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line = 0u;
+	uint8_t n_char = 0u;
+
+	if(!p_emu->d || p_emu->n_violations) return false;
+
+	for(n_line = 0u; n_line < n_lines; n_line++)
+	{
+		hd44780_get_line(p_emu, n_chars, n_lines, n_line, line);
+
+		for(n_char = 0u; n_char < n_chars; n_char++)
+		{
+			if(line[n_char] != (char) (c + n_line)) return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * The same refresh of both displays through two GPIO LCD objects, one after the other, then through the shared bus,
+ * which must hide most of the second display behind the execution times of the first.
+ * The default queues are smaller than a 20x4 refresh, so the bus refresh goes a line at a time on each display.
+ */
+
+void check_bus(void)
+{
+	uint64_t t_start_ns = 0u;
+	uint64_t t1_ns = 0u;
+	uint64_t t2_ns = 0u;
+	uint64_t t_bus_ns = 0u;
+	uint8_t n_line = 0u;
+	bool ok = false;
+
+	{
+		LCD lcd1(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, LCD_NCHARS, LCD_NLINES);
+		LCD lcd2(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E2, LCD2_NCHARS, LCD2_NLINES);
+
+		wire_pair();
+
+		ok = lcd1.begin() && lcd2.begin();
+
+		t_start_ns = host_bus_time_ns();
+		lcd1.clear();
+		for(n_line = 0u; n_line < LCD_NLINES; n_line++) draw_line(&lcd1, n_line, 'A');
+		t1_ns = host_bus_time_ns() - t_start_ns;
+
+		t_start_ns = host_bus_time_ns();
+		lcd2.clear();
+		for(n_line = 0u; n_line < LCD2_NLINES; n_line++) draw_line(&lcd2, n_line, 'a');
+		t2_ns = host_bus_time_ns() - t_start_ns;
+
+		ok = ok && check_lines(&host_lcd, LCD_NCHARS, LCD_NLINES, 'A') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'a');
+	}
+
+	{
+		LCDBus lcd_bus(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS);
+		LCDBusTransport lcd_bus_1(&lcd_bus, LCD_E);
+		LCDBusTransport lcd_bus_2(&lcd_bus, LCD_E2);
+		LCD lcd1(&lcd_bus_1, LCD_NCHARS, LCD_NLINES);
+		LCD lcd2(&lcd_bus_2, LCD2_NCHARS, LCD2_NLINES);
+
+		wire_pair();
+
+		ok = ok && lcd1.begin() && lcd2.begin();
+
+		lcd_bus.flush();
+		while(!lcd_bus.isIdle());
+
+		t_start_ns = host_bus_time_ns();
+
+		lcd1.clear();
+		lcd2.clear();
+
+		for(n_line = 0u; n_line < LCD_NLINES; n_line++)
+		{
+			draw_line(&lcd1, n_line, 'A');
+			draw_line(&lcd2, n_line, 'a');
+		}
+
+		lcd_bus.flush();
+		while(!lcd_bus.isIdle());
+
+		t_bus_ns = host_bus_time_ns() - t_start_ns;
+
+		ok = ok && check_lines(&host_lcd, LCD_NCHARS, LCD_NLINES, 'A') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'a');
+		ok = ok && (t_bus_ns < (t1_ns + (t2_ns >> 2)));
+	}
+
+	printf("%-24s %s  %8.3f ms  (%.3f ms + %.3f ms one after the other)  %u violations\n", "shared bus 20x4 + 16x2", ok ? "PASS" : "FAIL", (double) t_bus_ns/1000000.0, (double) t1_ns/1000000.0, (double) t2_ns/1000000.0, (host_lcd.n_violations + host_lcd2.n_violations));
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	hd44780_print(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+	if(host_lcd2.n_violations) printf("last violation: %s\n", host_lcd2.last_viol);
+
+	return;
+}
+
+/*
+ * A 16x2 mirror of both displays: the same screen written once through the mirror must reach both displays for the
+ * strobes of a single one. A cell then written to one member alone must be found by sync() and restored by the next
+ * mirror flush.
+ */
+
+void check_mirror(void)
+{
+	LCDBus lcd_bus(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS);
+	LCDBusTransport lcd_bus_1(&lcd_bus, LCD_E);
+	LCDBusTransport lcd_bus_2(&lcd_bus, LCD_E2);
+	LCD lcd1(&lcd_bus_1, LCD_NCHARS, LCD_NLINES);
+	LCD lcd2(&lcd_bus_2, LCD2_NCHARS, LCD2_NLINES);
+	LCD *lcd_members[] = {&lcd1, &lcd2};
+	LCDBusMirror lcd_mirror(&lcd_bus, lcd_members, 2u);
+	LCD lcd_all(&lcd_mirror, LCD2_NCHARS, LCD2_NLINES);
+	uint32_t n_strobes = 0u;
+	uint32_t n_single = 0u;
+	uint32_t n_mirror = 0u;
+	uintptr_t n_synced = 0u;
+	uint8_t n_line = 0u;
+	char line[LCD_NCHARS + 1u];
+	bool ok = false;
+
+	wire_pair();
+
+	ok = lcd1.begin() && lcd2.begin();
+
+	/*Reference: the same screen on a single display*/
+	n_strobes = host_bus_n_strobes;
+	lcd2.clear();
+	for(n_line = 0u; n_line < LCD2_NLINES; n_line++) draw_line(&lcd2, n_line, 'a');
+	lcd_bus.flush();
+	n_single = host_bus_n_strobes - n_strobes;
+
+	ok = ok && lcd_all.begin();
+
+	n_strobes = host_bus_n_strobes;
+	lcd_all.clear();
+	for(n_line = 0u; n_line < LCD2_NLINES; n_line++) draw_line(&lcd_all, n_line, 'M');
+	lcd_bus.flush();
+	n_mirror = host_bus_n_strobes - n_strobes;
+
+	ok = ok && check_lines(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 'M') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'M');
+	ok = ok && (n_mirror <= n_single);
+
+	/*Each member's own content (outside and inside the mirror area) between two mirrored writes*/
+	lcd_all.setCursorPosition(10u, 1u);
+	lcd1.setCursorPosition(18u, 0u);
+	lcd1.printText("!");
+	lcd2.setCursorPosition(3u, 1u);
+	lcd2.printText("x");
+	lcd_all.printText("z");
+	lcd_bus.flush();
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && (line[18] == '!');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[10] == 'z');
+	hd44780_get_line(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 1u, line);
+	ok = ok && (line[3] == 'x') && (line[10] == 'z');
+
+#if LCD_CFG_FRAMEBUFFER
+	lcd_all.setFramebufferMode(true);
+	n_synced = lcd_mirror.sync(&lcd_all);
+	lcd_all.flush();
+	lcd_all.setFramebufferMode(false);
+	lcd_bus.flush();
+
+	hd44780_get_line(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 1u, line);
+	ok = ok && (n_synced == 1u) && (line[3] == 'N');
+#endif
+
+	ok = ok && !host_lcd.n_violations && !host_lcd2.n_violations;
+
+	printf("%-24s %s  %u strobes  (%u writing each display)  %u cell synced  %u violations\n", "bus mirror 20x4 + 16x2", ok ? "PASS" : "FAIL", n_mirror, (2u*n_single), (unsigned int) n_synced, (host_lcd.n_violations + host_lcd2.n_violations));
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	hd44780_print(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+	if(host_lcd2.n_violations) printf("last violation: %s\n", host_lcd2.last_viol);
+
+	return;
+}
+
+/*
+ * check_arduino [trace.vcd]
+ */
+
+int main(int argc, char **argv)
+{
+	uint64_t t_start_ns = 0u;
+
+	{
+		GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+		check_lcd("gpio 4-bit", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_RW, LCD_E, LCD_NCHARS, LCD_NLINES);
+		wire_gpio(true, false);
+		check_lcd("gpio 4-bit busy flag", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB0, LCD_DB1, LCD_DB2, LCD_DB3, LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, LCD_NCHARS, LCD_NLINES);
+		wire_gpio(false, true);
+		check_lcd("gpio 8-bit", &lcd, false);
+	}
+
+	{
+		LCD lcd(LCD_DB0, LCD_DB1, LCD_DB2, LCD_DB3, LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_RW, LCD_E, LCD_NCHARS, LCD_NLINES);
+		wire_gpio(true, true);
+		check_lcd("gpio 8-bit busy flag", &lcd, false);
+	}
+
+	{
+		GpioLCD lcd(LCD_NCHARS, LCD_NLINES);
+		check_lcd("gpio 4-bit framebuffer", &lcd, true);
+	}
+
+	{
+		LCDI2CTransport lcd_i2c(0u, &Wire, 400000UL);
+		LCD lcd(&lcd_i2c, LCD_NCHARS, LCD_NLINES);
+
+		lcd_hal_host_init();
+		host_bus_i2c_address = 0x3f;
+		check_lcd("i2c 400kHz", &lcd, false);
+
+		/*Backpack unplugged: the write isn't acknowledged and gets counted*/
+		host_bus_i2c_address = 0x27;
+
+		if(lcd_i2c.setBacklight(true) || (lcd_i2c.getErrors() != 1u))
+		{
+			printf("%-24s FAIL  unacknowledged write not reported\n", "i2c 400kHz");
+			n_failed++;
+		}
+	}
+
+	{
+		LCDSPITransport lcd_spi(LCD_LATCH, 4000000UL, &SPI);
+		LCD lcd(&lcd_spi, LCD_NCHARS, LCD_NLINES);
+
+		lcd_hal_host_init();
+		host_bus_connect(LCD_LATCH, HOST_BUS_FN_SR_LATCH);
+		check_lcd("spi 4MHz", &lcd, false);
+	}
+
+	{
+		StaticLCD<LCD_DB4, LCD_DB5, LCD_DB6, LCD_DB7, LCD_RS, LCD_E, LCD_NCHARS, LCD_NLINES> lcd;
+
+		wire_gpio(false, false);
+		t_start_ns = host_bus_time_ns();
+
+		lcd.begin();
+		draw(&lcd);
+		check("static 4-bit", t_start_ns);
+	}
+
+	check_bus();
+	check_mirror();
+	check_stats();
+	check_glyphs();
+	check_utf8();
+	check_fields();
+	check_screen();
+	check_marquee();
+	check_console();
+	check_fill();
+	check_trace((argc > 1) ? argv[1] : NULL);
+
+	if(n_failed)
+	{
+		printf("%u checks failed\n", n_failed);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,1363 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Runs the Raspberry Pi Pico driver against the HD44780 emulator: every bus mode and transport the host HAL covers,
+ * checking the resulting display contents and that the controller saw no timing violation.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "lcd.h"
+#include "lcd_hal.h"
+#include "lcd_i2c.h"
+#include "lcd_spi.h"
+#include "lcd_bus.h"
+#include "lcd_screen.h"
+#include "lcd_marquee.h"
+#include "lcd_console.h"
+#include "lcd_core1.h"
+
+#include "trace_vcd.h"
+
+#define LCD_DB0 10U
+#define LCD_DB1 11U
+#define LCD_DB2 12U
+#define LCD_DB3 13U
+#define LCD_DB4 6U
+#define LCD_DB5 7U
+#define LCD_DB6 8U
+#define LCD_DB7 9U
+#define LCD_RS 5U
+#define LCD_RW 4U
+#define LCD_E 3U
+#define LCD_E2 2U
+
+#define LCD_NCHARS 20U
+#define LCD_NLINES 4U
+#define LCD2_NCHARS 16U
+#define LCD2_NLINES 2U
+
+static const char *const expected_text[LCD_NLINES] = {
+	"Hello, World!       ",
+	"                    ",
+	"0123456789ABCDEFGHIJ",
+	"             Host   "
+};
+
+uint32_t n_failed = 0u;
+
+void wire_gpio(bool rw, bool bus_8bit)
+{
+	lcd_hal_host_init();
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+
+	if(rw) host_bus_connect(LCD_RW, HD44780_PIN_RW);
+
+	if(bus_8bit)
+	{
+		host_bus_connect(LCD_DB0, HD44780_PIN_DB0);
+		host_bus_connect(LCD_DB1, HD44780_PIN_DB1);
+		host_bus_connect(LCD_DB2, HD44780_PIN_DB2);
+		host_bus_connect(LCD_DB3, HD44780_PIN_DB3);
+	}
+
+	return;
+}
+
+/*Zeroed lcd_t on the 4-bit GPIO pinout, wired to the emulator*/
+void gpio_lcd_init(lcd_t *p_lcd, uint8_t n_chars, uint8_t n_lines)
+{
+	memset(p_lcd, 0, sizeof(lcd_t));
+
+	p_lcd->db4 = LCD_DB4;
+	p_lcd->db5 = LCD_DB5;
+	p_lcd->db6 = LCD_DB6;
+	p_lcd->db7 = LCD_DB7;
+	p_lcd->rs = LCD_RS;
+	p_lcd->e = LCD_E;
+	p_lcd->n_chars = n_chars;
+	p_lcd->n_lines = n_lines;
+
+	wire_gpio(false, false);
+	return;
+}
+
+void draw(lcd_t *p_lcd)
+{
+	lcd_clear(p_lcd);
+	lcd_print_text(p_lcd, "Hello, World!");
+	lcd_set_cursor_pos(p_lcd, 0u, 2u);
+	lcd_print_text(p_lcd, "0123456789ABCDEFGHIJ");
+	lcd_set_cursor_pos(p_lcd, 13u, 3u);
+	lcd_print_text(p_lcd, "Host");
+
+	return;
+}
+
+void check(const char *name, uint64_t t_start_ns)
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line;
+	bool ok;
+
+	ok = host_lcd.d && (host_lcd.n_violations == 0u);
+
+	for(n_line = 0u; n_line < LCD_NLINES; n_line++)
+	{
+		hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, n_line, line);
+		if(strcmp(line, expected_text[n_line])) ok = false;
+	}
+
+	printf("%-24s %s  %8.3f ms  %5u E pulses  %u violations\n", name, ok ? "PASS" : "FAIL", (double) (host_bus_time_ns() - t_start_ns)/1000000.0, host_lcd.n_e_pulses, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+
+	return;
+}
+
+void check_gpio(const char *name, bool rw, bool bus_8bit, bool async, bool framebuffer)
+{
+	lcd_t lcd;
+	uint64_t t_start_ns;
+#if LCD_CFG_ASYNC
+	uint32_t n_reads;
+#endif
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+
+	lcd.rw = LCD_RW;
+	lcd.use_rw = rw;
+	lcd.bus_8bit = bus_8bit;
+	lcd.db0 = LCD_DB0;
+	lcd.db1 = LCD_DB1;
+	lcd.db2 = LCD_DB2;
+	lcd.db3 = LCD_DB3;
+
+	/*R/W and DB0-DB3 on top of the 4-bit wiring*/
+	wire_gpio(rw, bus_8bit);
+	t_start_ns = host_bus_time_ns();
+
+	if(!lcd_init(&lcd))
+	{
+		printf("%-24s FAIL  lcd_init()\n", name);
+		n_failed++;
+		return;
+	}
+
+#if LCD_CFG_ASYNC
+	if(async) lcd_set_async_mode(&lcd, true);
+#else
+	(void) async;
+#endif
+
+#if LCD_CFG_FRAMEBUFFER
+	if(framebuffer) lcd_set_framebuffer_mode(&lcd, true);
+#else
+	(void) framebuffer;
+#endif
+
+	draw(&lcd);
+
+#if LCD_CFG_FRAMEBUFFER
+	if(framebuffer) lcd_flush(&lcd);
+#endif
+
+#if LCD_CFG_ASYNC
+	lcd_wait_idle(&lcd);
+
+	/*Back to synchronous writes: the busy flag is polled again*/
+	if(async && rw)
+	{
+		n_reads = host_lcd.n_reads;
+		lcd_set_async_mode(&lcd, false);
+		lcd_home(&lcd);
+		lcd_home(&lcd);
+
+		if(host_lcd.n_reads == n_reads)
+		{
+			printf("%-24s FAIL  busy flag not polled after async mode\n", name);
+			n_failed++;
+			return;
+		}
+	}
+#endif
+
+	check(name, t_start_ns);
+	return;
+}
+
+void check_i2c(const char *name, uint32_t baudrate)
+{
+	lcd_t lcd;
+	lcd_i2c_t lcd_i2c;
+	uint64_t t_start_ns;
+
+	memset(&lcd, 0, sizeof(lcd_t));
+	memset(&lcd_i2c, 0, sizeof(lcd_i2c_t));
+
+	lcd_i2c.i2c = i2c0;
+	lcd_i2c.baudrate = baudrate;
+
+	lcd.n_chars = LCD_NCHARS;
+	lcd.n_lines = LCD_NLINES;
+	lcd.transport = &lcd_transport_i2c;
+	lcd.transport_ctx = &lcd_i2c;
+
+	lcd_hal_host_init();
+	host_bus_i2c_address = 0x3f;
+	t_start_ns = host_bus_time_ns();
+
+	if(!lcd_init(&lcd) || (lcd_i2c_get_address(&lcd) != 0x3f))
+	{
+		printf("%-24s FAIL  lcd_init() (address probe)\n", name);
+		n_failed++;
+		return;
+	}
+
+	draw(&lcd);
+	check(name, t_start_ns);
+
+	/*Backpack unplugged: the write isn't acknowledged and gets counted*/
+	host_bus_i2c_address = 0x27;
+
+	if(lcd_i2c_set_backlight(&lcd, true) || (lcd_i2c_get_errors(&lcd) != 1u))
+	{
+		printf("%-24s FAIL  unacknowledged write not reported\n", name);
+		n_failed++;
+	}
+
+	return;
+}
+
+void check_spi(const char *name, uint32_t baudrate)
+{
+	lcd_t lcd;
+	lcd_spi_t lcd_spi;
+	uint64_t t_start_ns;
+
+	memset(&lcd, 0, sizeof(lcd_t));
+	memset(&lcd_spi, 0, sizeof(lcd_spi_t));
+
+	lcd_spi.spi = spi0;
+	lcd_spi.baudrate = baudrate;
+
+	lcd.n_chars = LCD_NCHARS;
+	lcd.n_lines = LCD_NLINES;
+	lcd.transport = &lcd_transport_spi;
+	lcd.transport_ctx = &lcd_spi;
+
+	lcd_hal_host_init();
+	t_start_ns = host_bus_time_ns();
+
+	if(!lcd_init(&lcd))
+	{
+		printf("%-24s FAIL  lcd_init()\n", name);
+		n_failed++;
+		return;
+	}
+
+	draw(&lcd);
+	check(name, t_start_ns);
+
+	return;
+}
+
+/*
+ * Performance counters against what the emulator saw.
+ */
+
+void check_stats(void)
+{
+	lcd_t lcd;
+	lcd_stats_t stats;
+	uint64_t t_start_ns;
+	uint32_t elapsed_us;
+	uint32_t wait_us;
+	uint32_t max_call_us;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+
+	ok = lcd_init(&lcd);
+
+	lcd_reset_stats(&lcd);
+	hd44780_clear_stats(&host_lcd);
+	t_start_ns = host_bus_time_ns();
+
+	draw(&lcd);
+
+	elapsed_us = (uint32_t) ((host_bus_time_ns() - t_start_ns)/1000u);
+	ok = ok && lcd_get_stats(&lcd, &stats);
+
+	ok = ok && (stats.n_cmds == host_lcd.n_cmds) && (stats.n_data == host_lcd.n_data) && (stats.n_clear_home == 1u) && !stats.n_skipped;
+	ok = ok && (stats.max_call_us >= LCD_TIMING_CLEAR_US) && (stats.wait_us <= elapsed_us) && (stats.wait_us >= (elapsed_us - (elapsed_us >> 3)));
+
+	wait_us = (uint32_t) stats.wait_us;
+	max_call_us = stats.max_call_us;
+
+	/*Reprinting the same text in framebuffer mode sends nothing*/
+	lcd_reset_stats(&lcd);
+	lcd_set_framebuffer_mode(&lcd, true);
+	lcd_home(&lcd);
+	lcd_print_text(&lcd, "Hello, World!");
+	lcd_flush(&lcd);
+	lcd_get_stats(&lcd, &stats);
+
+	ok = ok && (stats.n_skipped == 13u) && !stats.n_data;
+
+	printf("%-24s %s  %u us waiting  %u us longest call\n", "stats", ok ? "PASS" : "FAIL", wait_us, max_call_us);
+	if(!ok) n_failed++;
+
+	return;
+}
+
+/*
+ * Glyph cache: the 8 CGRAM slots are filled from slot 0 up, the least recently printed glyph is the one replaced,
+ * and the cells still showing it get its fallback character (at once, or on the next flush in framebuffer mode).
+ */
+
+void check_glyphs(void)
+{
+	lcd_t lcd;
+	lcd_glyph_t glyphs[10];
+	lcd_glyph_stats_t stats;
+	char line[LCD_NCHARS + 1u];
+	uint16_t glyph_id;
+	uint8_t n_row;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	memset(glyphs, 0, sizeof(glyphs));
+
+	for(glyph_id = 0u; glyph_id < 10u; glyph_id++)
+	{
+		for(n_row = 0u; n_row < 8u; n_row++) glyphs[glyph_id].rows[n_row] = (uint8_t) ((glyph_id*3u + n_row) & 0x1f);
+		glyphs[glyph_id].fallback = (char) ('a' + glyph_id);
+	}
+
+	ok = lcd_init(&lcd) && lcd_set_glyph_table(&lcd, glyphs, 10u);
+	ok = ok && !lcd_print_glyph(&lcd, 10u);
+
+	/*Every slot taken, then glyph 0 printed again: glyph 1 becomes the least recently printed*/
+	lcd_set_cursor_pos(&lcd, 0u, 0u);
+	for(glyph_id = 0u; glyph_id < 8u; glyph_id++) lcd_print_glyph(&lcd, glyph_id);
+
+	lcd_set_cursor_pos(&lcd, 0u, 1u);
+	lcd_print_glyph(&lcd, 0u);
+	lcd_print_char(&lcd, '>');
+
+	lcd_set_cursor_pos(&lcd, 19u, 3u);
+	lcd_print_glyph(&lcd, 8u);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "\x00" "b" "\x02\x03\x04\x05\x06\x07" " ", 9u);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[0] == 0x00) && (line[1] == '>');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 3u, line);
+	ok = ok && (line[19] == 0x01);
+
+	for(n_row = 0u; n_row < 8u; n_row++) ok = ok && (host_lcd.cgram[8u + n_row] == glyphs[8].rows[n_row]);
+
+	/*Framebuffer mode: glyph 2 is replaced, its cell gets 'c' on the flush*/
+	lcd_set_framebuffer_mode(&lcd, true);
+	lcd_set_cursor_pos(&lcd, 5u, 1u);
+	lcd_print_glyph(&lcd, 9u);
+	lcd_set_framebuffer_mode(&lcd, false);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && (line[2] == 'c');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[5] == 0x02);
+
+	for(n_row = 0u; n_row < 8u; n_row++) ok = ok && (host_lcd.cgram[16u + n_row] == glyphs[9].rows[n_row]);
+
+	lcd_get_glyph_stats(&lcd, &stats);
+	ok = ok && (stats.n_hits == 1u) && (stats.n_misses == 10u) && (stats.n_evictions == 2u) && (stats.n_repaints == 2u);
+	ok = ok && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u hits  %u misses  %u cells repainted  %u violations\n", "glyph cache", ok ? "PASS" : "FAIL", stats.n_hits, stats.n_misses, stats.n_repaints, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * UTF-8 text (A00 ROM): ROM characters, a glyph standing for a character the ROM lacks, and the replacement character
+ * for the other ones and for malformed sequences (stray 0xff, truncated sequence at the end).
+ */
+
+void check_utf8(void)
+{
+	lcd_t lcd;
+	lcd_glyph_t glyph_e_acute;
+	char line[LCD_NCHARS + 1u];
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	memset(&glyph_e_acute, 0, sizeof(lcd_glyph_t));
+
+	glyph_e_acute.rows[0] = 0x02;
+	glyph_e_acute.rows[1] = 0x04;
+	glyph_e_acute.rows[2] = 0x0e;
+	glyph_e_acute.rows[3] = 0x11;
+	glyph_e_acute.rows[4] = 0x1f;
+	glyph_e_acute.rows[5] = 0x10;
+	glyph_e_acute.rows[6] = 0x0e;
+	glyph_e_acute.fallback = 'e';
+	glyph_e_acute.codepoint = 0x00e9;
+
+	ok = lcd_init(&lcd) && lcd_set_glyph_table(&lcd, &glyph_e_acute, 1u);
+
+	/*21.5 degree C, micro, yen, katakana A, e acute, euro, backslash, 0xff, truncated euro*/
+	ok = ok && lcd_print_text_utf8(&lcd, "21.5\xc2\xb0" "C \xc2\xb5\xc2\xa5\xef\xbd\xb1\xc3\xa9\xe2\x82\xac\\\xff\xe2\x82");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "21.5\xdf" "C \xe4\x5c\xb1\x00????     ", LCD_NCHARS);
+	ok = ok && (host_lcd.cgram[0] == 0x02) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u violations\n", "utf-8 text", ok ? "PASS" : "FAIL", host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Typed fields: formatting (sign before zero padding, fixed point, overflow), and a changed value
+ * only sends the characters that differ (plus the address to reach the first one).
+ */
+
+void check_fields(void)
+{
+	lcd_t lcd;
+	char line[LCD_NCHARS + 1u];
+	uint32_t n_cmds;
+	uint32_t n_data;
+	uint32_t n_unchanged;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+
+	ok = lcd_init(&lcd);
+	ok = ok && !lcd_print_uint(&lcd, 0u, (LCD_DDRAM_LINE_SIZE + 1u), LCD_ALIGN_RIGHT, ' ') && !lcd_print_uint(&lcd, 0u, 4u, 2, ' ');
+
+	ok = ok && lcd_print_uint(&lcd, 1234u, 6u, LCD_ALIGN_RIGHT, ' ') && lcd_print_text(&lcd, "|");
+
+	lcd_set_cursor_pos(&lcd, 0u, 1u);
+	ok = ok && lcd_print_int(&lcd, -42, 6u, LCD_ALIGN_RIGHT, '0') && lcd_print_fixed(&lcd, -5, 1u, 0u, LCD_ALIGN_LEFT, ' ');
+	ok = ok && lcd_print_hex(&lcd, 0xbeefu, 0u, LCD_ALIGN_LEFT, ' ') && lcd_print_uint(&lcd, 123456u, 3u, LCD_ALIGN_RIGHT, ' ');
+
+	lcd_set_cursor_pos(&lcd, 0u, 2u);
+	ok = ok && lcd_print_int(&lcd, INT32_MIN, 0u, LCD_ALIGN_RIGHT, ' ') && lcd_print_fixed(&lcd, 1234, 2u, 7u, LCD_ALIGN_LEFT, '_');
+
+	/*1234 -> 1235: the address of the last digit and the digit*/
+	lcd_set_cursor_pos(&lcd, 0u, 0u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_print_uint(&lcd, 1235u, 6u, LCD_ALIGN_RIGHT, ' ');
+	n_cmds = host_lcd.n_cmds;
+	n_data = host_lcd.n_data;
+
+	/*The same value again sends nothing, and the text after it still lands after the field*/
+	lcd_set_cursor_pos(&lcd, 0u, 0u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_print_uint(&lcd, 1235u, 6u, LCD_ALIGN_RIGHT, ' ');
+	n_unchanged = host_lcd.n_cmds + host_lcd.n_data;
+	ok = ok && lcd_print_text(&lcd, "!");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "  1235!", 7u);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && !memcmp(line, "-00042-0.5BEEF###   ", LCD_NCHARS);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line);
+	ok = ok && !memcmp(line, "-214748364812.34__  ", LCD_NCHARS);
+
+	ok = ok && (n_cmds == 1u) && (n_data == 1u) && !n_unchanged && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes for 1 changed digit  %u for none\n", "fields", ok ? "PASS" : "FAIL", (n_cmds + n_data), n_unchanged);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Screen layouts: a changed field sends its changed digit, an unchanged update sends nothing, and switching
+ * to a layout that shares texts and a field position with the current one only sends the cells that differ.
+ */
+
+enum {SCREEN_TEMP, SCREEN_HUM};
+enum {SCREEN_FAN = 1};
+
+static const lcd_screen_text_t screen_a_texts[] = {{0, 0, "Temp:"}, {11, 0, "C"}, {0, 1, "Hum:"}, {7, 1, "%"}};
+static const lcd_screen_field_t screen_a_fields[] = {
+	[SCREEN_TEMP] = {.cx = 5, .cy = 0, .width = 5, .format = LCD_FIELD_FIXED, .n_decimals = 1, .align = LCD_ALIGN_RIGHT, .pad = ' '},
+	[SCREEN_HUM] = {.cx = 4, .cy = 1, .width = 3, .format = LCD_FIELD_UINT, .align = LCD_ALIGN_RIGHT, .pad = ' '}
+};
+static const lcd_screen_layout_t screen_a = {screen_a_texts, 4, screen_a_fields, 2};
+
+static const lcd_screen_text_t screen_b_texts[] = {{0, 0, "Temp:"}, {11, 0, "F"}, {0, 1, "Fan:"}};
+static const lcd_screen_field_t screen_b_fields[] = {
+	[SCREEN_TEMP] = {.cx = 5, .cy = 0, .width = 5, .format = LCD_FIELD_FIXED, .n_decimals = 1, .align = LCD_ALIGN_RIGHT, .pad = ' '},
+	[SCREEN_FAN] = {.cx = 5, .cy = 1, .width = 4, .format = LCD_FIELD_TEXT, .align = LCD_ALIGN_LEFT, .pad = '.'}
+};
+static const lcd_screen_layout_t screen_b = {screen_b_texts, 3, screen_b_fields, 2};
+
+static const lcd_screen_field_t screen_bad_fields[] = {{.cx = 18, .cy = 0, .width = 3, .format = LCD_FIELD_UINT, .align = LCD_ALIGN_RIGHT, .pad = ' '}};
+static const lcd_screen_layout_t screen_bad = {NULL, 0, screen_bad_fields, 1};
+
+void check_screen(void)
+{
+	lcd_t lcd;
+	lcd_screen_t screen;
+	char line[LCD_NCHARS + 1u];
+	uint32_t n_field_bytes;
+	uint32_t n_idle_bytes;
+	uint32_t n_switch_bytes;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	memset(&screen, 0, sizeof(lcd_screen_t));
+
+	screen.lcd = &lcd;
+
+	ok = lcd_init(&lcd) && !lcd_screen_set_layout(&screen, &screen_bad) && lcd_screen_set_layout(&screen, &screen_a);
+	ok = ok && lcd_screen_set_field(&screen, SCREEN_TEMP, 215) && lcd_screen_set_field(&screen, SCREEN_HUM, 40) && lcd_screen_update(&screen);
+
+	/*21.5 -> 21.6, humidity unchanged*/
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_screen_set_field(&screen, SCREEN_TEMP, 216) && lcd_screen_set_field(&screen, SCREEN_HUM, 40) && lcd_screen_update(&screen);
+	n_field_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_screen_update(&screen);
+	n_idle_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	/*'C' -> 'F' (address, character), "Hum" -> "Fan" (address, 3 characters), the rest stays*/
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_screen_set_layout(&screen, &screen_b);
+	n_switch_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	ok = ok && !lcd_screen_set_field(&screen, SCREEN_FAN, 1) && lcd_screen_set_field_text(&screen, SCREEN_FAN, "ON");
+	ok = ok && lcd_screen_set_field(&screen, SCREEN_TEMP, 216) && lcd_screen_update(&screen);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && !memcmp(line, "Temp: 21.6 F        ", LCD_NCHARS);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && !memcmp(line, "Fan: ON..           ", LCD_NCHARS);
+
+	ok = ok && (n_field_bytes == 2u) && !n_idle_bytes && (n_switch_bytes == 6u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes for 1 changed digit  %u for no change  %u for a layout switch\n", "screen layout", ok ? "PASS" : "FAIL", n_field_bytes, n_idle_bytes, n_switch_bytes);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Marquee on a 16x2 display: both lines scrolling is a single display shift instruction per step,
+ * with the pauses at both ends. A single line scrolling under a static one falls back to rewriting it.
+ */
+
+void check_marquee(void)
+{
+	lcd_t lcd;
+	lcd_marquee_t marquee;
+	char line0[LCD2_NCHARS + 1u];
+	char line1[LCD2_NCHARS + 1u];
+	uint32_t n_step_bytes;
+	uint8_t n_step;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD2_NCHARS, LCD2_NLINES);
+	memset(&marquee, 0, sizeof(lcd_marquee_t));
+
+	marquee.lcd = &lcd;
+	marquee.step_ms = 100u;
+	marquee.pause_ms = 500u;
+
+	ok = lcd_init(&lcd);
+	ok = ok && lcd_marquee_set_line(&marquee, 0u, "0123456789ABCDEFGHIJ") && lcd_marquee_set_line(&marquee, 1u, "abcdefghijklmnopqr");
+	ok = ok && lcd_marquee_start(&marquee) && lcd_marquee_uses_display_shift(&marquee) && !lcd_marquee_tick(&marquee);
+
+	/*End of the first pause: one instruction*/
+	host_bus_advance_ns(500000000u);
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_marquee_tick(&marquee);
+	n_step_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "123456789ABCDEFG");
+
+	for(n_step = 0u; n_step < 3u; n_step++)
+	{
+		host_bus_advance_ns(100000000u);
+		ok = ok && lcd_marquee_tick(&marquee);
+	}
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 1u, line1);
+	ok = ok && !strcmp(line0, "456789ABCDEFGHIJ") && !strcmp(line1, "efghijklmnopqr  ");
+
+	/*Pause at the end, then back*/
+	host_bus_advance_ns(100000000u);
+	ok = ok && !lcd_marquee_tick(&marquee);
+	host_bus_advance_ns(400000000u);
+	ok = ok && lcd_marquee_tick(&marquee);
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "3456789ABCDEFGHI");
+
+	ok = ok && lcd_marquee_stop(&marquee);
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "0123456789ABCDEF");
+
+	/*Line 1 stays: rewriting line 0*/
+	ok = ok && lcd_set_cursor_pos(&lcd, 0u, 1u) && lcd_print_text(&lcd, "static          ");
+	ok = ok && lcd_marquee_set_line(&marquee, 1u, NULL) && lcd_marquee_start(&marquee) && !lcd_marquee_uses_display_shift(&marquee);
+
+	host_bus_advance_ns(500000000u);
+	ok = ok && lcd_marquee_tick(&marquee);
+
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 1u, line1);
+	ok = ok && !strcmp(line0, "123456789ABCDEFG") && !strcmp(line1, "static          ");
+
+	ok = ok && (n_step_bytes == 1u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes per display shift step  %u violations\n", "marquee", ok ? "PASS" : "FAIL", n_step_bytes, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD2_NCHARS, LCD2_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Console on the 20x4 display: line wrap in screen order (line 1 after line 0, not the DDRAM order),
+ * control characters, no scroll until the bottom line gets a character,
+ * then a log of similar lines scrolling with only the characters that differ.
+ */
+
+static const char *const console_text[LCD_NLINES] = {
+	"zVwxT               ",
+	"line 2              ",
+	"line 3              ",
+	"line 4              "
+};
+
+static const char *const console_log[LCD_NLINES] = {
+	"line 3              ",
+	"line 4              ",
+	"line 5              ",
+	"line 6              "
+};
+
+bool check_text(const char *const expected[LCD_NLINES])
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line;
+
+	for(n_line = 0u; n_line < LCD_NLINES; n_line++)
+	{
+		hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, n_line, line);
+		if(strcmp(line, expected[n_line])) return false;
+	}
+
+	return true;
+}
+
+void check_console(void)
+{
+	lcd_t lcd;
+	lcd_console_t console;
+	char line0[LCD_NCHARS + 1u];
+	char line1[LCD_NCHARS + 1u];
+	char line2[LCD_NCHARS + 1u];
+	uint32_t n_scroll_bytes;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	memset(&console, 0, sizeof(lcd_console_t));
+
+	console.lcd = &lcd;
+
+	ok = lcd_init(&lcd) && lcd_console_clear(&console);
+	ok = ok && lcd_console_print(&console, "abcdefghijklmnopqrstuvwxy");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line0);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line1);
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line2);
+	ok = ok && !strcmp(line0, "abcdefghijklmnopqrst") && !strcmp(line1, "uvwxy               ") && !strcmp(line2, "                    ");
+
+	/*"UVwxy", back to 'U' -> "zVwxy", tab stop 4 -> "zVwxT"*/
+	ok = ok && lcd_console_print(&console, "\rUV\b\bz\tT") && lcd_console_print(&console, "\nline 2\nline 3\n");
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line0);
+	ok = ok && !strcmp(line0, "abcdefghijklmnopqrst");
+
+	ok = ok && lcd_console_print(&console, "line 4") && check_text(console_text);
+
+	/*Each line differs from the one below it by a single character: address and character per line*/
+	ok = ok && lcd_console_print(&console, "\nline 5");
+	hd44780_clear_stats(&host_lcd);
+	ok = ok && lcd_console_put_char(&console, '\n') && lcd_console_print(&console, "line 6");
+	n_scroll_bytes = host_lcd.n_cmds + host_lcd.n_data;
+
+	ok = ok && check_text(console_log) && (n_scroll_bytes == 8u) && !host_lcd.n_violations;
+
+	printf("%-24s %s  %u bytes per scroll  %u violations\n", "console", ok ? "PASS" : "FAIL", n_scroll_bytes, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Region planner on the 20x4 display: each fill sends what it estimated (execution times from the driver counters),
+ * a clear display only when it beats the cells that differ, nothing for a fill already shown, and the cursor stays.
+ */
+
+static const char *const fill_text[LCD_NLINES] = {
+	"  A                 ",
+	"     ##########     ",
+	"     ##########     ",
+	"xxxxxxxxxxxxxxxxxxxx"
+};
+
+uint32_t fill_stats_us(const lcd_t *p_lcd)
+{
+	lcd_stats_t stats;
+
+	lcd_get_stats(p_lcd, &stats);
+
+	return stats.n_clear_home*LCD_TIMING_CLEAR_US + (stats.n_cmds - stats.n_clear_home)*LCD_TIMING_CMD_US + stats.n_data*LCD_TIMING_DATA_US;
+}
+
+void check_fill(void)
+{
+	lcd_t lcd;
+	lcd_stats_t stats;
+	uint32_t est_line_us;
+	uint32_t est_screen_us;
+	uint32_t est_rect_us;
+	uint32_t est_again_us;
+	char line[LCD_NCHARS + 1u];
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+
+	ok = lcd_init(&lcd);
+	draw(&lcd);
+
+	/*"Hello, World!": address set and 13 characters, the rest of the screen stays*/
+	ok = ok && lcd_estimate_fill_rect(&lcd, 0u, 0u, LCD_NCHARS, 1u, ' ', &est_line_us);
+	lcd_reset_stats(&lcd);
+	ok = ok && lcd_clear_line(&lcd, 0u) && (fill_stats_us(&lcd) == est_line_us);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 2u, line);
+	ok = ok && !strcmp(line, expected_text[2]);
+
+	/*Every cell differs: rewriting them beats a clear display followed by the same cells*/
+	ok = ok && lcd_estimate_fill_rect(&lcd, 0u, 0u, LCD_NCHARS, LCD_NLINES, 'x', &est_screen_us);
+	lcd_reset_stats(&lcd);
+	ok = ok && lcd_fill_screen_char(&lcd, 'x') && (fill_stats_us(&lcd) == est_screen_us);
+	ok = ok && lcd_get_stats(&lcd, &stats) && !stats.n_clear_home;
+
+	/*3 lines out of 4: a clear display and the last line beat 60 characters*/
+	ok = ok && lcd_set_cursor_pos(&lcd, 2u, 0u) && lcd_estimate_fill_rect(&lcd, 0u, 0u, LCD_NCHARS, 3u, ' ', &est_rect_us);
+	lcd_reset_stats(&lcd);
+	ok = ok && lcd_clear_rect(&lcd, 0u, 0u, LCD_NCHARS, 3u) && (fill_stats_us(&lcd) == est_rect_us);
+	ok = ok && lcd_get_stats(&lcd, &stats) && (stats.n_clear_home == 1u);
+
+	ok = ok && lcd_fill_rect(&lcd, 5u, 1u, 10u, 2u, '#') && lcd_estimate_fill_rect(&lcd, 5u, 1u, 10u, 2u, '#', &est_again_us);
+	lcd_reset_stats(&lcd);
+	ok = ok && lcd_fill_rect(&lcd, 5u, 1u, 10u, 2u, '#') && (fill_stats_us(&lcd) == 0u) && (est_again_us == 0u);
+
+	ok = ok && lcd_print_char(&lcd, 'A') && check_text(fill_text);
+	ok = ok && !lcd_fill_rect(&lcd, 15u, 0u, 6u, 1u, '-') && !lcd_clear_line(&lcd, LCD_NLINES) && !host_lcd.n_violations;
+
+	printf("%-24s %s  clear line %u us, fill screen %u us, clear 3 lines %u us  %u violations\n", "fill planner", ok ? "PASS" : "FAIL", est_line_us, est_screen_us, est_rect_us, host_lcd.n_violations);
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+
+	return;
+}
+
+/*
+ * Bus trace: the newest entries must be the end of draw(), oldest first, in time order.
+ * The trace is written to "vcd_path" if not NULL.
+ */
+
+void check_trace(const char *vcd_path)
+{
+	lcd_t lcd;
+	lcd_trace_entry_t trace[LCD_CFG_TRACE_SIZE];
+	trace_vcd_entry_t vcd[LCD_CFG_TRACE_SIZE];
+	uintptr_t n_entries;
+	uintptr_t n_entry;
+	char tail[5];
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+
+	ok = lcd_init(&lcd);
+	draw(&lcd);
+
+	n_entries = lcd_get_trace(&lcd, trace, LCD_CFG_TRACE_SIZE);
+
+	if(!ok || (n_entries < 5u))
+	{
+		printf("%-24s FAIL  %u entries\n", "trace", (unsigned int) n_entries);
+		n_failed++;
+		return;
+	}
+
+	/*Initialization (1 nibble, 4 instructions) plus draw() (3 instructions, 37 characters)*/
+	if(LCD_CFG_TRACE_SIZE > 45u) ok = (n_entries == 45u) && (trace[0].kind == LCD_TRACE_INIT_NIBBLE);
+	else ok = (n_entries == (LCD_CFG_TRACE_SIZE - 1u));
+
+	/*Last cursor move (13, 3), then "Host"*/
+	ok = ok && (trace[n_entries - 5u].kind == LCD_TRACE_CMD) && (trace[n_entries - 5u].value == (0x80 | (0x54 + 13u)));
+
+	for(n_entry = 0u; n_entry < 4u; n_entry++)
+	{
+		if(trace[n_entries - 4u + n_entry].kind != LCD_TRACE_DATA) ok = false;
+		tail[n_entry] = (char) trace[n_entries - 4u + n_entry].value;
+	}
+
+	tail[4] = '\0';
+	ok = ok && !strcmp(tail, "Host");
+
+	for(n_entry = 0u; n_entry < n_entries; n_entry++)
+	{
+		if(n_entry && ((int32_t) (trace[n_entry].t_us - trace[n_entry - 1u].t_us) < 0)) ok = false;
+
+		vcd[n_entry].t_us = trace[n_entry].t_us;
+		vcd[n_entry].kind = trace[n_entry].kind;
+		vcd[n_entry].value = trace[n_entry].value;
+	}
+
+	/*Only the newest entries when asked for fewer*/
+	ok = ok && (lcd_get_trace(&lcd, trace, 1u) == 1u) && (trace[0].value == 't');
+
+	lcd_clear_trace(&lcd);
+	ok = ok && !lcd_get_trace(&lcd, trace, LCD_CFG_TRACE_SIZE);
+
+	if((vcd_path != NULL) && !trace_vcd_write(vcd_path, vcd, n_entries)) ok = false;
+
+	printf("%-24s %s  %u entries%s%s\n", "trace", ok ? "PASS" : "FAIL", (unsigned int) n_entries, (vcd_path != NULL) ? " written to " : "", (vcd_path != NULL) ? vcd_path : "");
+	if(!ok) n_failed++;
+
+	return;
+}
+
+/*
+ * Two displays on the same DB4-DB7 and RS (TestLCD2 wiring): 20x4 on E, 16x2 on E2.
+ */
+
+void wire_pair(void)
+{
+	lcd_hal_host_init();
+
+	host_bus_connect(LCD_DB4, HD44780_PIN_DB4);
+	host_bus_connect(LCD_DB5, HD44780_PIN_DB5);
+	host_bus_connect(LCD_DB6, HD44780_PIN_DB6);
+	host_bus_connect(LCD_DB7, HD44780_PIN_DB7);
+	host_bus_connect(LCD_RS, HD44780_PIN_RS);
+	host_bus_connect(LCD_E, HD44780_PIN_E);
+	host_bus_connect(LCD_E2, HOST_BUS_FN_E2);
+
+	return;
+}
+
+/*Clears the display, then fills line n with "c + n"*/
+void draw_lines(lcd_t *p_lcd, char c)
+{
+	char text[LCD_NCHARS + 1u];
+	uint8_t n_line;
+
+	lcd_clear(p_lcd);
+
+	for(n_line = 0u; n_line < p_lcd->n_lines; n_line++)
+	{
+		memset(text, (c + n_line), p_lcd->n_chars);
+		text[p_lcd->n_chars] = '\0';
+
+		lcd_set_cursor_pos(p_lcd, 0u, n_line);
+		lcd_print_text(p_lcd, text);
+	}
+
+	return;
+}
+
+bool check_lines(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, char c)
+{
+	char line[LCD_NCHARS + 1u];
+	uint8_t n_line;
+	uint8_t n_char;
+
+	if(!p_emu->d || p_emu->n_violations) return false;
+
+	for(n_line = 0u; n_line < n_lines; n_line++)
+	{
+		hd44780_get_line(p_emu, n_chars, n_lines, n_line, line);
+
+		for(n_char = 0u; n_char < n_chars; n_char++)
+		{
+			if(line[n_char] != (char) (c + n_line)) return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * The same refresh of both displays through two GPIO lcd_t, one after the other, then through the shared bus transport,
+ * which must hide most of the second display behind the execution times of the first.
+ */
+
+void check_bus(void)
+{
+	lcd_t lcd1;
+	lcd_t lcd2;
+	lcd_bus_t lcd_bus;
+	lcd_bus_display_t lcd_bus_1;
+	lcd_bus_display_t lcd_bus_2;
+	uint64_t t_start_ns;
+	uint64_t t1_ns;
+	uint64_t t2_ns;
+	uint64_t t_bus_ns;
+	bool ok;
+
+	memset(&lcd1, 0, sizeof(lcd_t));
+	memset(&lcd2, 0, sizeof(lcd_t));
+
+	lcd1.db4 = LCD_DB4;
+	lcd1.db5 = LCD_DB5;
+	lcd1.db6 = LCD_DB6;
+	lcd1.db7 = LCD_DB7;
+	lcd1.rs = LCD_RS;
+	lcd1.e = LCD_E;
+	lcd1.n_chars = LCD_NCHARS;
+	lcd1.n_lines = LCD_NLINES;
+
+	lcd2 = lcd1;
+	lcd2.e = LCD_E2;
+	lcd2.n_chars = LCD2_NCHARS;
+	lcd2.n_lines = LCD2_NLINES;
+
+	wire_pair();
+
+	ok = lcd_init(&lcd1) && lcd_init(&lcd2);
+
+	t_start_ns = host_bus_time_ns();
+	draw_lines(&lcd1, 'A');
+	t1_ns = host_bus_time_ns() - t_start_ns;
+
+	t_start_ns = host_bus_time_ns();
+	draw_lines(&lcd2, 'a');
+	t2_ns = host_bus_time_ns() - t_start_ns;
+
+	ok = ok && check_lines(&host_lcd, LCD_NCHARS, LCD_NLINES, 'A') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'a');
+
+	/*Shared bus transport*/
+	memset(&lcd1, 0, sizeof(lcd_t));
+	memset(&lcd2, 0, sizeof(lcd_t));
+	memset(&lcd_bus, 0, sizeof(lcd_bus_t));
+	memset(&lcd_bus_1, 0, sizeof(lcd_bus_display_t));
+	memset(&lcd_bus_2, 0, sizeof(lcd_bus_display_t));
+
+	lcd_bus.db4 = LCD_DB4;
+	lcd_bus.db5 = LCD_DB5;
+	lcd_bus.db6 = LCD_DB6;
+	lcd_bus.db7 = LCD_DB7;
+	lcd_bus.rs = LCD_RS;
+
+	lcd_bus_1.bus = &lcd_bus;
+	lcd_bus_1.e = LCD_E;
+	lcd_bus_2.bus = &lcd_bus;
+	lcd_bus_2.e = LCD_E2;
+
+	lcd1.n_chars = LCD_NCHARS;
+	lcd1.n_lines = LCD_NLINES;
+	lcd1.transport = &lcd_transport_bus;
+	lcd1.transport_ctx = &lcd_bus_1;
+
+	lcd2.n_chars = LCD2_NCHARS;
+	lcd2.n_lines = LCD2_NLINES;
+	lcd2.transport = &lcd_transport_bus;
+	lcd2.transport_ctx = &lcd_bus_2;
+
+	wire_pair();
+
+	ok = ok && lcd_init(&lcd1) && lcd_init(&lcd2);
+
+	lcd_bus_flush(&lcd_bus);
+	while(!lcd_bus_is_idle(&lcd_bus)) tight_loop_contents();
+
+	t_start_ns = host_bus_time_ns();
+
+	draw_lines(&lcd1, 'A');
+	draw_lines(&lcd2, 'a');
+	lcd_bus_flush(&lcd_bus);
+	while(!lcd_bus_is_idle(&lcd_bus)) tight_loop_contents();
+
+	t_bus_ns = host_bus_time_ns() - t_start_ns;
+
+	ok = ok && check_lines(&host_lcd, LCD_NCHARS, LCD_NLINES, 'A') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'a');
+	ok = ok && (t_bus_ns < (t1_ns + (t2_ns >> 2)));
+
+	printf("%-24s %s  %8.3f ms  (%.3f ms + %.3f ms one after the other)  %u violations\n", "shared bus 20x4 + 16x2", ok ? "PASS" : "FAIL", (double) t_bus_ns/1000000.0, (double) t1_ns/1000000.0, (double) t2_ns/1000000.0, (host_lcd.n_violations + host_lcd2.n_violations));
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	hd44780_print(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+	if(host_lcd2.n_violations) printf("last violation: %s\n", host_lcd2.last_viol);
+
+	return;
+}
+
+/*
+ * A 16x2 mirror of both displays: the same screen written once through the mirror must reach both displays for the
+ * strobes of a single one. A cell then written to one member alone must be found by lcd_bus_mirror_sync() and
+ * restored by the next mirror flush.
+ */
+
+void check_mirror(void)
+{
+	lcd_t lcd1;
+	lcd_t lcd2;
+	lcd_t lcd_all;
+	lcd_bus_t lcd_bus;
+	lcd_bus_display_t lcd_bus_1;
+	lcd_bus_display_t lcd_bus_2;
+	lcd_bus_mirror_t lcd_mirror;
+	uint32_t n_strobes;
+	uint32_t n_single;
+	uint32_t n_mirror;
+	uintptr_t n_synced;
+	char line[LCD_NCHARS + 1u];
+	bool ok;
+
+	memset(&lcd1, 0, sizeof(lcd_t));
+	memset(&lcd2, 0, sizeof(lcd_t));
+	memset(&lcd_all, 0, sizeof(lcd_t));
+	memset(&lcd_bus, 0, sizeof(lcd_bus_t));
+	memset(&lcd_bus_1, 0, sizeof(lcd_bus_display_t));
+	memset(&lcd_bus_2, 0, sizeof(lcd_bus_display_t));
+	memset(&lcd_mirror, 0, sizeof(lcd_bus_mirror_t));
+
+	lcd_bus.db4 = LCD_DB4;
+	lcd_bus.db5 = LCD_DB5;
+	lcd_bus.db6 = LCD_DB6;
+	lcd_bus.db7 = LCD_DB7;
+	lcd_bus.rs = LCD_RS;
+
+	lcd_bus_1.bus = &lcd_bus;
+	lcd_bus_1.e = LCD_E;
+	lcd_bus_2.bus = &lcd_bus;
+	lcd_bus_2.e = LCD_E2;
+
+	lcd1.n_chars = LCD_NCHARS;
+	lcd1.n_lines = LCD_NLINES;
+	lcd1.transport = &lcd_transport_bus;
+	lcd1.transport_ctx = &lcd_bus_1;
+
+	lcd2.n_chars = LCD2_NCHARS;
+	lcd2.n_lines = LCD2_NLINES;
+	lcd2.transport = &lcd_transport_bus;
+	lcd2.transport_ctx = &lcd_bus_2;
+
+	lcd_mirror.members[0] = &lcd1;
+	lcd_mirror.members[1] = &lcd2;
+	lcd_mirror.n_members = 2u;
+
+	lcd_all.n_chars = LCD2_NCHARS;
+	lcd_all.n_lines = LCD2_NLINES;
+	lcd_all.transport = &lcd_transport_bus_mirror;
+	lcd_all.transport_ctx = &lcd_mirror;
+
+	wire_pair();
+
+	ok = lcd_init(&lcd1) && lcd_init(&lcd2);
+
+	/*Reference: the same screen on a single display*/
+	n_strobes = host_bus_n_strobes;
+	draw_lines(&lcd2, 'a');
+	lcd_bus_flush(&lcd_bus);
+	n_single = host_bus_n_strobes - n_strobes;
+
+	ok = ok && lcd_init(&lcd_all);
+
+	n_strobes = host_bus_n_strobes;
+	draw_lines(&lcd_all, 'M');
+	lcd_bus_flush(&lcd_bus);
+	n_mirror = host_bus_n_strobes - n_strobes;
+
+	ok = ok && check_lines(&host_lcd, LCD2_NCHARS, LCD2_NLINES, 'M') && check_lines(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 'M');
+	ok = ok && (n_mirror <= n_single);
+
+	/*Each member's own content (outside and inside the mirror area) between two mirrored writes*/
+	lcd_set_cursor_pos(&lcd_all, 10u, 1u);
+	lcd_set_cursor_pos(&lcd1, 18u, 0u);
+	lcd_print_text(&lcd1, "!");
+	lcd_set_cursor_pos(&lcd2, 3u, 1u);
+	lcd_print_text(&lcd2, "x");
+	lcd_print_text(&lcd_all, "z");
+	lcd_bus_flush(&lcd_bus);
+
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 0u, line);
+	ok = ok && (line[18] == '!');
+	hd44780_get_line(&host_lcd, LCD_NCHARS, LCD_NLINES, 1u, line);
+	ok = ok && (line[10] == 'z');
+	hd44780_get_line(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 1u, line);
+	ok = ok && (line[3] == 'x') && (line[10] == 'z');
+
+#if LCD_CFG_FRAMEBUFFER
+	lcd_set_framebuffer_mode(&lcd_all, true);
+	n_synced = lcd_bus_mirror_sync(&lcd_all);
+	lcd_flush(&lcd_all);
+	lcd_set_framebuffer_mode(&lcd_all, false);
+	lcd_bus_flush(&lcd_bus);
+
+	hd44780_get_line(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, 1u, line);
+	ok = ok && (n_synced == 1u) && (line[3] == 'N');
+#else
+	n_synced = 0u;
+#endif
+
+	ok = ok && !host_lcd.n_violations && !host_lcd2.n_violations;
+
+	printf("%-24s %s  %u strobes  (%u writing each display)  %u cell synced  %u violations\n", "bus mirror 20x4 + 16x2", ok ? "PASS" : "FAIL", n_mirror, (2u*n_single), (unsigned int) n_synced, (host_lcd.n_violations + host_lcd2.n_violations));
+
+	if(ok) return;
+
+	n_failed++;
+	hd44780_print(&host_lcd, LCD_NCHARS, LCD_NLINES, stdout);
+	hd44780_print(&host_lcd2, LCD2_NCHARS, LCD2_NLINES, stdout);
+	if(host_lcd.n_violations) printf("last violation: %s\n", host_lcd.last_viol);
+	if(host_lcd2.n_violations) printf("last violation: %s\n", host_lcd2.last_viol);
+
+	return;
+}
+
+/*
+ * Core 1 offload: the host runs a single core, so core 0 queues the whole refresh first and this check then plays
+ * core 1 (lcd_core1_task()). Core 0 must only spend a fraction of the GPIO refresh time, without filling the ring.
+ */
+
+void check_core1(void)
+{
+	lcd_t lcd;
+	lcd_core1_t lcd_core1;
+	uint64_t t_start_ns;
+	uint64_t t_core0_ns;
+	uint32_t n_free;
+	bool ok;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	memset(&lcd_core1, 0, sizeof(lcd_core1_t));
+
+	lcd.transport = &lcd_transport_core1;
+	lcd.transport_ctx = &lcd_core1;
+
+	ok = lcd_core1_launch(&lcd) && (host_core1_entry != NULL);
+
+	/*Core 0*/
+	t_start_ns = host_bus_time_ns();
+	ok = ok && lcd_init(&lcd);
+	draw(&lcd);
+	t_core0_ns = host_bus_time_ns() - t_start_ns;
+	n_free = lcd_core1_get_free(&lcd);
+
+	ok = ok && !host_lcd.n_e_pulses && !lcd_core1_is_idle(&lcd);
+
+	/*Core 1*/
+	while(!lcd_core1_is_idle(&lcd))
+	{
+		if(!lcd_core1_task(&lcd)) tight_loop_contents();
+	}
+
+	ok = ok && (n_free > 0u) && (n_free < LCD_CFG_CORE1_QUEUE_SIZE) && !lcd_core1_get_n_stalls(&lcd);
+	ok = ok && ((10u*t_core0_ns) < (host_bus_time_ns() - t_start_ns));
+
+	printf("%-24s %s  %8.3f ms on core 0  %3u entries free\n", "core1 offload", ok ? "PASS" : "FAIL", (double) t_core0_ns/1000000.0, n_free);
+	if(!ok) n_failed++;
+
+	check("core1 offload display", t_start_ns);
+	return;
+}
+
+/*
+ * The emulator must catch what the driver is supposed to avoid.
+ */
+
+void check_emulator(void)
+{
+	uint64_t t_ns;
+	bool ok;
+
+	hd44780_reset(&host_lcd, 0u);
+	t_ns = 1000u;
+
+	/*Function set, 4-bit interface (single 8-bit transfer)*/
+	hd44780_set_pins(&host_lcd, 0x20, t_ns);
+	hd44780_set_pins(&host_lcd, (0x20 | HD44780_PIN_E), t_ns + 100u);
+	hd44780_set_pins(&host_lcd, 0x20, t_ns + 400u);
+
+	/*Display control, first nibble still inside the function set execution time*/
+	t_ns += 10000u;
+	hd44780_set_pins(&host_lcd, 0x00, t_ns);
+	hd44780_set_pins(&host_lcd, HD44780_PIN_E, t_ns + 100u);
+	hd44780_set_pins(&host_lcd, 0x00, t_ns + 400u);
+
+	/*Second nibble with a 100ns E pulse*/
+	hd44780_set_pins(&host_lcd, 0xc0, t_ns + 1000u);
+	hd44780_set_pins(&host_lcd, (0xc0 | HD44780_PIN_E), t_ns + 1100u);
+	hd44780_set_pins(&host_lcd, 0xc0, t_ns + 1200u);
+
+	ok = (host_lcd.n_viol[HD44780_VIOL_BUSY] == 1u) && (host_lcd.n_viol[HD44780_VIOL_PWEH] == 1u) && !host_lcd.dl && host_lcd.d;
+
+	printf("%-24s %s  %u violations caught\n", "emulator self check", ok ? "PASS" : "FAIL", host_lcd.n_violations);
+	if(!ok) n_failed++;
+
+	return;
+}
+
+#if LCD_CFG_ASYNC
+int64_t check_async_no_alarm_fn(alarm_id_t id, void *user_data)
+{
+	(void) id;
+	(void) user_data;
+
+	return 0;
+}
+#endif
+
+/*
+ * Async mode with every alarm slot taken: the queue must be sent synchronously instead of never draining.
+ */
+
+void check_async_no_alarm(void)
+{
+#if LCD_CFG_ASYNC
+	lcd_t lcd;
+	uint64_t t_start_ns;
+	uint8_t n_alarm;
+
+	gpio_lcd_init(&lcd, LCD_NCHARS, LCD_NLINES);
+	wire_gpio(false, false);
+	t_start_ns = host_bus_time_ns();
+
+	if(!lcd_init(&lcd) || !lcd_set_async_mode(&lcd, true))
+	{
+		printf("%-24s FAIL  lcd_init()\n", "gpio async no alarm");
+		n_failed++;
+		return;
+	}
+
+	for(n_alarm = 0u; n_alarm < HOST_BUS_N_TIMERS; n_alarm++) add_alarm_in_us(3600000000u, check_async_no_alarm_fn, NULL, true);
+
+	draw(&lcd);
+
+	if(!lcd_is_idle(&lcd))
+	{
+		printf("%-24s FAIL  queue not drained\n", "gpio async no alarm");
+		n_failed++;
+		return;
+	}
+
+	check("gpio async no alarm", t_start_ns);
+#endif
+	return;
+}
+
+/*
+ * check_pico [trace.vcd]
+ */
+
+int main(int argc, char **argv)
+{
+	check_emulator();
+
+	check_gpio("gpio 4-bit", false, false, false, false);
+	check_gpio("gpio 4-bit busy flag", true, false, false, false);
+	check_gpio("gpio 8-bit", false, true, false, false);
+	check_gpio("gpio 8-bit busy flag", true, true, false, false);
+	check_gpio("gpio 4-bit framebuffer", false, false, false, true);
+	check_gpio("gpio 4-bit async", false, false, true, false);
+	check_gpio("gpio busy flag async", true, false, true, false);
+	check_async_no_alarm();
+
+	check_i2c("i2c 100kHz", 100000u);
+	check_i2c("i2c 400kHz", 400000u);
+	check_i2c("i2c 1MHz", 1000000u);
+
+	check_spi("spi 4MHz", 4000000u);
+	check_spi("spi 16MHz", 16000000u);
+
+	check_bus();
+	check_mirror();
+	check_core1();
+
+	check_stats();
+	check_glyphs();
+	check_utf8();
+	check_fields();
+	check_screen();
+	check_marquee();
+	check_console();
+	check_fill();
+	check_trace((argc > 1) ? argv[1] : NULL);
+
+	if(n_failed)
+	{
+		printf("%u checks failed\n", n_failed);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,485 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * HD44780 controller emulator.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "hd44780.h"
+
+#include <string.h>
+
+#define __HD44780_PINS_CTRL (HD44780_PIN_RS | HD44780_PIN_RW)
+
+#define __HD44780_LINE_SIZE 40U
+#define __HD44780_LINE1_ADDR 0x40U
+#define __HD44780_1LINE_SIZE 80U
+
+static const char *const _hd44780_viol_names[HD44780_N_VIOL] = {"busy", "tcycE", "PWEH", "tAS", "tAH", "tDSW", "tH", "tDDR"};
+
+extern uint64_t _hd44780_exec_ns(const hd44780_t *p_emu, uint32_t t_ns);
+extern void _hd44780_violation(hd44780_t *p_emu, uint8_t kind, uint64_t t_ns);
+extern void _hd44780_e_rise(hd44780_t *p_emu, uint64_t t_ns);
+extern void _hd44780_e_fall(hd44780_t *p_emu, uint64_t t_ns);
+extern void _hd44780_write(hd44780_t *p_emu, bool rs, uint8_t byte, uint64_t t_ns);
+extern void _hd44780_exec_cmd(hd44780_t *p_emu, uint8_t cmd, uint64_t t_ns);
+extern void _hd44780_set_ac(hd44780_t *p_emu, uint8_t ac, bool cgram);
+extern void _hd44780_step_ac(hd44780_t *p_emu, bool inc);
+extern void _hd44780_step_shift(hd44780_t *p_emu, bool left);
+extern uint8_t _hd44780_read_byte(const hd44780_t *p_emu, bool rs, uint64_t t_ns);
+
+void hd44780_reset(hd44780_t *p_emu, uint32_t fosc_hz)
+{
+	bool verbose;
+
+	if(p_emu == NULL) return;
+
+	verbose = p_emu->verbose;
+	memset(p_emu, 0, sizeof(hd44780_t));
+
+	if(!fosc_hz) fosc_hz = HD44780_FOSC_HZ;
+
+	p_emu->fosc_hz = fosc_hz;
+	p_emu->verbose = verbose;
+
+	memset(p_emu->ddram, 0x20, HD44780_DDRAM_SIZE);
+
+	p_emu->dl = true;
+	p_emu->id = true;
+
+	return;
+}
+
+void hd44780_set_pins(hd44780_t *p_emu, uint16_t pins, uint64_t t_ns)
+{
+	uint16_t changed;
+
+	if(p_emu == NULL) return;
+
+	changed = pins ^ p_emu->pins;
+	if(!changed) return;
+
+	if(changed & __HD44780_PINS_CTRL)
+	{
+		/*RS and R/W are sampled on the E rising edge and must stay put until E falls*/
+		if(p_emu->pins & HD44780_PIN_E) _hd44780_violation(p_emu, HD44780_VIOL_AS, t_ns);
+		else if(p_emu->e_fell && ((t_ns - p_emu->t_e_fall_ns) < HD44780_T_AH_NS)) _hd44780_violation(p_emu, HD44780_VIOL_AH, t_ns);
+
+		p_emu->t_ctrl_ns = t_ns;
+	}
+
+	if(changed & HD44780_PINS_DB)
+	{
+		if(!(p_emu->pins & (HD44780_PIN_E | HD44780_PIN_RW)) && p_emu->e_fell && ((t_ns - p_emu->t_e_fall_ns) < HD44780_T_H_NS)) _hd44780_violation(p_emu, HD44780_VIOL_H, t_ns);
+
+		p_emu->t_db_ns = t_ns;
+	}
+
+	p_emu->pins = pins;
+
+	if(!(changed & HD44780_PIN_E)) return;
+
+	if(pins & HD44780_PIN_E) _hd44780_e_rise(p_emu, t_ns);
+	else _hd44780_e_fall(p_emu, t_ns);
+
+	return;
+}
+
+uint8_t hd44780_read_db(hd44780_t *p_emu, uint64_t t_ns)
+{
+	if(!hd44780_is_driving(p_emu)) return 0u;
+
+	if(((t_ns - p_emu->t_e_rise_ns) < HD44780_T_DDR_NS) && !p_emu->ddr_flagged)
+	{
+		p_emu->ddr_flagged = true;
+		_hd44780_violation(p_emu, HD44780_VIOL_DDR, t_ns);
+	}
+
+	if(p_emu->dl) return p_emu->rd;
+
+	/*4-bit mode: high nibble first, both on DB4-DB7*/
+	if(p_emu->nibble_lo) return (p_emu->rd << 4);
+
+	return (p_emu->rd & 0xf0);
+}
+
+bool hd44780_is_driving(const hd44780_t *p_emu)
+{
+	if(p_emu == NULL) return false;
+
+	return ((p_emu->pins & (HD44780_PIN_RW | HD44780_PIN_E)) == (HD44780_PIN_RW | HD44780_PIN_E));
+}
+
+bool hd44780_is_busy(const hd44780_t *p_emu, uint64_t t_ns)
+{
+	if(p_emu == NULL) return false;
+
+	return (t_ns < p_emu->t_busy_ns);
+}
+
+bool hd44780_get_line(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, uint8_t line, char *p_buf)
+{
+	uint8_t n_char;
+	uint32_t offset;
+	uint8_t addr;
+
+	if(p_emu == NULL) return false;
+	if(p_buf == NULL) return false;
+	if(line >= n_lines) return false;
+
+	for(n_char = 0u; n_char < n_chars; n_char++)
+	{
+		if(p_emu->n)
+		{
+			offset = ((uint32_t) (line >> 1))*n_chars + n_char + p_emu->shift;
+			addr = (uint8_t) (offset % __HD44780_LINE_SIZE);
+			if(line & 0x1) addr |= __HD44780_LINE1_ADDR;
+		}
+		else
+		{
+			offset = ((uint32_t) line)*n_chars + n_char + p_emu->shift;
+			addr = (uint8_t) (offset % __HD44780_1LINE_SIZE);
+		}
+
+		p_buf[n_char] = (char) p_emu->ddram[addr];
+	}
+
+	p_buf[n_chars] = '\0';
+	return true;
+}
+
+void hd44780_print(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, FILE *p_file)
+{
+	char line[256];
+	uint8_t n_line;
+	uint8_t n_char;
+	uint8_t c;
+
+	if(p_emu == NULL) return;
+	if(p_file == NULL) return;
+
+	fputc('+', p_file);
+	for(n_char = 0u; n_char < n_chars; n_char++) fputc('-', p_file);
+	fprintf(p_file, "+%s\n", p_emu->d ? "" : " (display off)");
+
+	for(n_line = 0u; n_line < n_lines; n_line++)
+	{
+		hd44780_get_line(p_emu, n_chars, n_lines, n_line, line);
+
+		fputc('|', p_file);
+
+		for(n_char = 0u; n_char < n_chars; n_char++)
+		{
+			c = (uint8_t) line[n_char];
+
+			if(c < 0x10) c = '0' + (c & 0x7);
+			else if((c < 0x20) || (c > 0x7e)) c = '?';
+
+			fputc(c, p_file);
+		}
+
+		fputs("|\n", p_file);
+	}
+
+	fputc('+', p_file);
+	for(n_char = 0u; n_char < n_chars; n_char++) fputc('-', p_file);
+	fputs("+\n", p_file);
+
+	return;
+}
+
+const char *hd44780_viol_name(uint8_t kind)
+{
+	if(kind >= HD44780_N_VIOL) return "unknown";
+
+	return _hd44780_viol_names[kind];
+}
+
+void hd44780_clear_stats(hd44780_t *p_emu)
+{
+	if(p_emu == NULL) return;
+
+	p_emu->n_e_pulses = 0u;
+	p_emu->n_cmds = 0u;
+	p_emu->n_data = 0u;
+	p_emu->n_reads = 0u;
+	p_emu->n_violations = 0u;
+	memset(p_emu->n_viol, 0, sizeof(p_emu->n_viol));
+	p_emu->last_viol[0] = '\0';
+
+	return;
+}
+
+uint64_t _hd44780_exec_ns(const hd44780_t *p_emu, uint32_t t_ns)
+{
+	return (((uint64_t) t_ns)*HD44780_FOSC_HZ + p_emu->fosc_hz - 1u)/(p_emu->fosc_hz);
+}
+
+void _hd44780_violation(hd44780_t *p_emu, uint8_t kind, uint64_t t_ns)
+{
+	p_emu->n_violations++;
+	p_emu->n_viol[kind]++;
+
+	snprintf(p_emu->last_viol, sizeof(p_emu->last_viol), "%s at %llu ns", _hd44780_viol_names[kind], (unsigned long long) t_ns);
+
+	if(p_emu->verbose) fprintf(stderr, "hd44780: %s violation at %llu ns\n", _hd44780_viol_names[kind], (unsigned long long) t_ns);
+
+	return;
+}
+
+void _hd44780_e_rise(hd44780_t *p_emu, uint64_t t_ns)
+{
+	bool rs;
+
+	if(p_emu->e_rose && ((t_ns - p_emu->t_e_rise_ns) < HD44780_T_CYCE_NS)) _hd44780_violation(p_emu, HD44780_VIOL_CYCE, t_ns);
+	if((t_ns - p_emu->t_ctrl_ns) < HD44780_T_AS_NS) _hd44780_violation(p_emu, HD44780_VIOL_AS, t_ns);
+
+	p_emu->e_rose = true;
+	p_emu->t_e_rise_ns = t_ns;
+	p_emu->ddr_flagged = false;
+
+	if(!(p_emu->pins & HD44780_PIN_RW)) return;
+
+	/*Read: the whole byte is latched on the first transfer, 4-bit mode hands it out in two halves*/
+	if(p_emu->nibble_lo && !p_emu->dl) return;
+
+	rs = (p_emu->pins & HD44780_PIN_RS) != 0u;
+
+	if(rs && (t_ns < p_emu->t_busy_ns)) _hd44780_violation(p_emu, HD44780_VIOL_BUSY, t_ns);
+
+	p_emu->rd = _hd44780_read_byte(p_emu, rs, t_ns);
+	return;
+}
+
+void _hd44780_e_fall(hd44780_t *p_emu, uint64_t t_ns)
+{
+	uint8_t db;
+
+	if((t_ns - p_emu->t_e_rise_ns) < HD44780_T_PWEH_NS) _hd44780_violation(p_emu, HD44780_VIOL_PWEH, t_ns);
+	if(p_emu->t_ctrl_ns == t_ns) _hd44780_violation(p_emu, HD44780_VIOL_AH, t_ns);
+
+	p_emu->e_fell = true;
+	p_emu->t_e_fall_ns = t_ns;
+	p_emu->n_e_pulses++;
+
+	if(p_emu->pins & HD44780_PIN_RW)
+	{
+		if(!p_emu->dl && !p_emu->nibble_lo)
+		{
+			p_emu->nibble_lo = true;
+			return;
+		}
+
+		p_emu->nibble_lo = false;
+		p_emu->n_reads++;
+
+		if(!(p_emu->pins & HD44780_PIN_RS)) return;
+
+		/*Data read: the address counter moves on like after a write*/
+		_hd44780_step_ac(p_emu, p_emu->id);
+		p_emu->t_busy_ns = t_ns + _hd44780_exec_ns(p_emu, HD44780_T_EXEC_NS);
+		p_emu->t_ac_ns = p_emu->t_busy_ns + _hd44780_exec_ns(p_emu, HD44780_T_ADD_NS);
+
+		return;
+	}
+
+	if((t_ns - p_emu->t_db_ns) < HD44780_T_DSW_NS) _hd44780_violation(p_emu, HD44780_VIOL_DSW, t_ns);
+
+	db = (uint8_t) (p_emu->pins & HD44780_PINS_DB);
+
+	if(p_emu->dl)
+	{
+		if(t_ns < p_emu->t_busy_ns) _hd44780_violation(p_emu, HD44780_VIOL_BUSY, t_ns);
+
+		_hd44780_write(p_emu, ((p_emu->pins & HD44780_PIN_RS) != 0u), db, t_ns);
+		return;
+	}
+
+	if(!p_emu->nibble_lo)
+	{
+		if(t_ns < p_emu->t_busy_ns) _hd44780_violation(p_emu, HD44780_VIOL_BUSY, t_ns);
+
+		p_emu->hi = (db & 0xf0);
+		p_emu->nibble_lo = true;
+		return;
+	}
+
+	p_emu->nibble_lo = false;
+	_hd44780_write(p_emu, ((p_emu->pins & HD44780_PIN_RS) != 0u), (p_emu->hi | (db >> 4)), t_ns);
+
+	return;
+}
+
+void _hd44780_write(hd44780_t *p_emu, bool rs, uint8_t byte, uint64_t t_ns)
+{
+	if(!rs)
+	{
+		_hd44780_exec_cmd(p_emu, byte, t_ns);
+		return;
+	}
+
+	p_emu->n_data++;
+
+	if(p_emu->ac_cgram) p_emu->cgram[p_emu->ac & 0x3f] = byte;
+	else p_emu->ddram[p_emu->ac & 0x7f] = byte;
+
+	_hd44780_step_ac(p_emu, p_emu->id);
+
+	if(p_emu->s && !p_emu->ac_cgram) _hd44780_step_shift(p_emu, p_emu->id);
+
+	p_emu->t_busy_ns = t_ns + _hd44780_exec_ns(p_emu, HD44780_T_EXEC_NS);
+	p_emu->t_ac_ns = p_emu->t_busy_ns + _hd44780_exec_ns(p_emu, HD44780_T_ADD_NS);
+
+	return;
+}
+
+void _hd44780_exec_cmd(hd44780_t *p_emu, uint8_t cmd, uint64_t t_ns)
+{
+	uint32_t exec_ns;
+
+	exec_ns = HD44780_T_EXEC_NS;
+	p_emu->n_cmds++;
+
+	if(cmd & 0x80)
+	{
+		_hd44780_set_ac(p_emu, (cmd & 0x7f), false);
+	}
+	else if(cmd & 0x40)
+	{
+		_hd44780_set_ac(p_emu, (cmd & 0x3f), true);
+	}
+	else if(cmd & 0x20)
+	{
+		p_emu->dl = (cmd & 0x10) != 0u;
+		p_emu->n = (cmd & 0x08) != 0u;
+		p_emu->f = (cmd & 0x04) != 0u;
+
+		if(!p_emu->dl) p_emu->nibble_lo = false;
+	}
+	else if(cmd & 0x10)
+	{
+		/*S/C: display shift or cursor move, R/L: direction*/
+		if(cmd & 0x08) _hd44780_step_shift(p_emu, ((cmd & 0x04) == 0u));
+		else _hd44780_step_ac(p_emu, ((cmd & 0x04) != 0u));
+	}
+	else if(cmd & 0x08)
+	{
+		p_emu->d = (cmd & 0x04) != 0u;
+		p_emu->c = (cmd & 0x02) != 0u;
+		p_emu->b = (cmd & 0x01) != 0u;
+	}
+	else if(cmd & 0x04)
+	{
+		p_emu->id = (cmd & 0x02) != 0u;
+		p_emu->s = (cmd & 0x01) != 0u;
+	}
+	else if(cmd & 0x02)
+	{
+		_hd44780_set_ac(p_emu, 0x00, false);
+		p_emu->shift = 0u;
+
+		exec_ns = HD44780_T_CLEAR_NS;
+	}
+	else if(cmd & 0x01)
+	{
+		memset(p_emu->ddram, 0x20, HD44780_DDRAM_SIZE);
+		_hd44780_set_ac(p_emu, 0x00, false);
+		p_emu->id = true;
+		p_emu->shift = 0u;
+
+		exec_ns = HD44780_T_CLEAR_NS;
+	}
+	else
+	{
+		/*Not an instruction*/
+		p_emu->n_cmds--;
+		return;
+	}
+
+	p_emu->t_busy_ns = t_ns + _hd44780_exec_ns(p_emu, exec_ns);
+	p_emu->t_ac_ns = p_emu->t_busy_ns + _hd44780_exec_ns(p_emu, HD44780_T_ADD_NS);
+
+	return;
+}
+
+void _hd44780_set_ac(hd44780_t *p_emu, uint8_t ac, bool cgram)
+{
+	p_emu->ac_prev = p_emu->ac;
+	p_emu->ac = ac;
+	p_emu->ac_cgram = cgram;
+
+	return;
+}
+
+void _hd44780_step_ac(hd44780_t *p_emu, bool inc)
+{
+	uint8_t ac;
+
+	ac = p_emu->ac;
+
+	if(p_emu->ac_cgram)
+	{
+		if(inc) ac++;
+		else ac--;
+
+		_hd44780_set_ac(p_emu, (ac & 0x3f), true);
+		return;
+	}
+
+	/*1 line: 0x00-0x4F. 2 lines: 0x00-0x27 and 0x40-0x67, each end wrapping to the start of the other line.*/
+	if(!p_emu->n)
+	{
+		if(inc) ac = (ac >= (__HD44780_1LINE_SIZE - 1u)) ? 0x00 : (ac + 1u);
+		else ac = (ac == 0x00) ? (__HD44780_1LINE_SIZE - 1u) : (ac - 1u);
+	}
+	else if(inc)
+	{
+		ac++;
+		if(ac == __HD44780_LINE_SIZE) ac = __HD44780_LINE1_ADDR;
+		else if(ac >= (__HD44780_LINE1_ADDR + __HD44780_LINE_SIZE)) ac = 0x00;
+	}
+	else
+	{
+		if(ac == 0x00) ac = __HD44780_LINE1_ADDR + __HD44780_LINE_SIZE - 1u;
+		else if(ac == __HD44780_LINE1_ADDR) ac = __HD44780_LINE_SIZE - 1u;
+		else ac--;
+	}
+
+	_hd44780_set_ac(p_emu, (ac & 0x7f), false);
+	return;
+}
+
+void _hd44780_step_shift(hd44780_t *p_emu, bool left)
+{
+	uint8_t size;
+
+	if(p_emu->n) size = __HD44780_LINE_SIZE;
+	else size = __HD44780_1LINE_SIZE;
+
+	if(left) p_emu->shift = (p_emu->shift + 1u) % size;
+	else p_emu->shift = (p_emu->shift + size - 1u) % size;
+
+	return;
+}
+
+uint8_t _hd44780_read_byte(const hd44780_t *p_emu, bool rs, uint64_t t_ns)
+{
+	uint8_t bf_ac;
+
+	if(rs)
+	{
+		if(p_emu->ac_cgram) return p_emu->cgram[p_emu->ac & 0x3f];
+
+		return p_emu->ddram[p_emu->ac & 0x7f];
+	}
+
+	if(t_ns < p_emu->t_ac_ns) bf_ac = p_emu->ac_prev;
+	else bf_ac = p_emu->ac;
+
+	bf_ac &= 0x7f;
+	if(t_ns < p_emu->t_busy_ns) bf_ac |= 0x80;
+
+	return bf_ac;
+}
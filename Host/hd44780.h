@@ -0,0 +1,201 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * HD44780 controller emulator.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef HD44780_H
+#define HD44780_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pin bits of hd44780_set_pins()
+ */
+
+#define HD44780_PIN_DB0 0x0001U
+#define HD44780_PIN_DB1 0x0002U
+#define HD44780_PIN_DB2 0x0004U
+#define HD44780_PIN_DB3 0x0008U
+#define HD44780_PIN_DB4 0x0010U
+#define HD44780_PIN_DB5 0x0020U
+#define HD44780_PIN_DB6 0x0040U
+#define HD44780_PIN_DB7 0x0080U
+#define HD44780_PIN_RS 0x0100U
+#define HD44780_PIN_RW 0x0200U
+#define HD44780_PIN_E 0x0400U
+
+#define HD44780_PINS_DB 0x00ffU
+
+/*
+ * Bus timing (HD44780U datasheet, VCC = 4.5V to 5.5V), in ns
+ */
+
+#define HD44780_T_CYCE_NS 500U		/*E cycle time (rising edge to rising edge)*/
+#define HD44780_T_PWEH_NS 230U		/*E pulse width (high level)*/
+#define HD44780_T_AS_NS 40U		/*RS, R/W setup time (before E rising edge)*/
+#define HD44780_T_AH_NS 10U		/*RS, R/W hold time (after E falling edge)*/
+#define HD44780_T_DSW_NS 80U		/*Data setup time (before E falling edge)*/
+#define HD44780_T_H_NS 10U		/*Data hold time (after E falling edge)*/
+#define HD44780_T_DDR_NS 160U		/*Data delay time (read, after E rising edge)*/
+
+/*
+ * Execution times at fosc = 270kHz, in ns. They scale with 270kHz/fosc.
+ */
+
+#define HD44780_FOSC_HZ 270000U
+#define HD44780_T_EXEC_NS 37000U	/*Every instruction but clear/home, data write/read*/
+#define HD44780_T_CLEAR_NS 1520000U	/*Clear display, return home*/
+#define HD44780_T_ADD_NS 4000U		/*Address counter update after the busy flag clears*/
+
+/*
+ * Violations
+ */
+
+#define HD44780_VIOL_BUSY 0		/*Instruction, data write or data read while the controller is busy*/
+#define HD44780_VIOL_CYCE 1
+#define HD44780_VIOL_PWEH 2
+#define HD44780_VIOL_AS 3
+#define HD44780_VIOL_AH 4
+#define HD44780_VIOL_DSW 5
+#define HD44780_VIOL_H 6
+#define HD44780_VIOL_DDR 7		/*Data lines sampled before the controller drives them*/
+#define HD44780_N_VIOL 8
+
+#define HD44780_DDRAM_SIZE 128U
+#define HD44780_CGRAM_SIZE 64U
+
+struct _hd44780 {
+	uint32_t fosc_hz;			/*OSCILLATOR FREQUENCY (EXECUTION TIMES SCALE WITH 270kHz/fosc)*/
+	bool verbose;				/*PRINT EVERY VIOLATION TO stderr*/
+
+	/*Controller state*/
+	uint8_t ddram[HD44780_DDRAM_SIZE];	/*INDEXED BY DDRAM ADDRESS*/
+	uint8_t cgram[HD44780_CGRAM_SIZE];
+	uint8_t ac;				/*ADDRESS COUNTER*/
+	uint8_t ac_prev;			/*ADDRESS COUNTER BEFORE THE LAST UPDATE (READ BACK UNTIL tADD ELAPSES)*/
+	bool ac_cgram;				/*ADDRESS COUNTER POINTS TO CGRAM*/
+	bool dl;				/*FUNCTION SET: 8-BIT INTERFACE*/
+	bool n;					/*FUNCTION SET: 2 LINES*/
+	bool f;					/*FUNCTION SET: 5x10 FONT*/
+	bool d;					/*DISPLAY ON*/
+	bool c;					/*CURSOR ON*/
+	bool b;					/*CURSOR BLINK*/
+	bool id;				/*ENTRY MODE: INCREMENT*/
+	bool s;					/*ENTRY MODE: SHIFT THE DISPLAY*/
+	uint8_t shift;				/*DISPLAY SHIFT (CHARACTERS TO THE LEFT)*/
+
+	/*Bus state*/
+	uint16_t pins;				/*LEVELS DRIVEN BY THE MCU*/
+	bool nibble_lo;				/*4-BIT MODE: NEXT TRANSFER IS THE LOW NIBBLE*/
+	uint8_t hi;				/*4-BIT MODE: HIGH NIBBLE ALREADY RECEIVED*/
+	uint8_t rd;				/*BYTE BEING READ*/
+	bool e_rose;				/*E HAS HAD A RISING EDGE SINCE RESET*/
+	bool e_fell;				/*E HAS HAD A FALLING EDGE SINCE RESET*/
+	bool ddr_flagged;			/*EARLY READ ALREADY FLAGGED FOR THIS E PULSE*/
+	uint64_t t_busy_ns;			/*BUSY UNTIL*/
+	uint64_t t_ac_ns;			/*ADDRESS COUNTER VALID FROM*/
+	uint64_t t_e_rise_ns;
+	uint64_t t_e_fall_ns;
+	uint64_t t_ctrl_ns;			/*LAST RS OR R/W CHANGE*/
+	uint64_t t_db_ns;			/*LAST DATA LINE CHANGE*/
+
+	/*Statistics*/
+	uint32_t n_e_pulses;
+	uint32_t n_cmds;			/*INSTRUCTIONS EXECUTED*/
+	uint32_t n_data;			/*DATA WRITES*/
+	uint32_t n_reads;			/*BUSY FLAG/ADDRESS AND DATA READS*/
+	uint32_t n_violations;
+	uint32_t n_viol[HD44780_N_VIOL];
+	char last_viol[96];
+};
+
+typedef struct _hd44780 hd44780_t;
+
+/*
+ * hd44780_reset()
+ * puts the controller in its internal reset (power on) state: 8-bit interface, 1 line, display off,
+ * increment without shift, DDRAM filled with spaces, address counter 0.
+ * "fosc_hz" 0 for 270kHz.
+ */
+
+extern void hd44780_reset(hd44780_t *p_emu, uint32_t fosc_hz);
+
+/*
+ * hd44780_set_pins()
+ * updates the levels the MCU drives on RS, R/W, E and DB0-DB7 (HD44780_PIN_* bits), at time "t_ns".
+ * "t_ns" must never go backwards. Every change is checked against the bus timing, and the controller
+ * latches a transfer on each E falling edge.
+ */
+
+extern void hd44780_set_pins(hd44780_t *p_emu, uint16_t pins, uint64_t t_ns);
+
+/*
+ * hd44780_read_db()
+ * returns the levels the controller drives on DB0-DB7 at time "t_ns" (R/W and E high), 0 if it isn't driving them.
+ * Sampling them earlier than tDDR after the E rising edge is flagged.
+ */
+
+extern uint8_t hd44780_read_db(hd44780_t *p_emu, uint64_t t_ns);
+
+/*
+ * hd44780_is_driving()
+ * returns true if the controller drives the data lines (R/W and E high).
+ */
+
+extern bool hd44780_is_driving(const hd44780_t *p_emu);
+
+/*
+ * hd44780_is_busy()
+ * returns true if the controller is still executing an instruction at time "t_ns".
+ */
+
+extern bool hd44780_is_busy(const hd44780_t *p_emu, uint64_t t_ns);
+
+/*
+ * hd44780_get_line()
+ * copies the characters shown on a line of an "n_chars" wide display (display shift applied) into "p_buf".
+ * Lines 2 and 3 of 4 line displays continue lines 0 and 1 in DDRAM.
+ * "p_buf" gets "n_chars" character codes plus a null terminator.
+ *
+ * returns false if the line doesn't exist.
+ */
+
+extern bool hd44780_get_line(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, uint8_t line, char *p_buf);
+
+/*
+ * hd44780_print()
+ * prints the display contents in a frame, with CGRAM characters as '0'-'7' and other non ASCII codes as '?'.
+ */
+
+extern void hd44780_print(const hd44780_t *p_emu, uint8_t n_chars, uint8_t n_lines, FILE *p_file);
+
+/*
+ * hd44780_viol_name()
+ * returns the name of a violation (HD44780_VIOL_*).
+ */
+
+extern const char *hd44780_viol_name(uint8_t kind);
+
+/*
+ * hd44780_clear_stats()
+ * zeroes the counters and violations.
+ */
+
+extern void hd44780_clear_stats(hd44780_t *p_emu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*HD44780_H*/
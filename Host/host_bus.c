@@ -0,0 +1,322 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Virtual clock and wiring between the host HAL shims and the HD44780 emulator.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "host_bus.h"
+
+#include <string.h>
+
+#define __HOST_BUS_EXP_RS 0x01U
+#define __HOST_BUS_EXP_RW 0x02U
+#define __HOST_BUS_EXP_E 0x04U
+#define __HOST_BUS_EXP_BL 0x08U
+
+#define __HOST_BUS_I2C_BITS_PER_BYTE 9U
+
+struct _host_bus_timer {
+	host_bus_timer_fn_t fn;
+	void *p_arg;
+	uint64_t t_ns;
+};
+
+hd44780_t host_lcd;
+hd44780_t host_lcd2;
+host_bus_costs_t host_bus_costs;
+uint8_t host_bus_i2c_address = 0x27;
+bool host_bus_backlight = false;
+uint32_t host_bus_n_strobes = 0u;
+
+static uint64_t _host_bus_t_ns = 0u;
+static uint16_t _host_bus_fn[HOST_BUS_N_PINS];
+static bool _host_bus_level[HOST_BUS_N_PINS];
+static bool _host_bus_out[HOST_BUS_N_PINS];
+static uint8_t _host_bus_sr = 0u;
+static struct _host_bus_timer _host_bus_timers[HOST_BUS_N_TIMERS];
+static uint32_t _host_bus_irq_off = 0u;
+static bool _host_bus_in_timer = false;
+static bool _host_bus_e_high = false;
+
+extern void _host_bus_update_lcd(void);
+extern void _host_bus_expander_write(uint8_t value);
+extern void _host_bus_run_timers(uint64_t t_end_ns);
+extern uint64_t _host_bus_bits_ns(uint32_t n_bits, uint32_t baudrate);
+
+void host_bus_reset(uint32_t fosc_hz)
+{
+	memset(_host_bus_fn, 0, sizeof(_host_bus_fn));
+	memset(_host_bus_level, 0, sizeof(_host_bus_level));
+	memset(_host_bus_out, 0, sizeof(_host_bus_out));
+	memset(_host_bus_timers, 0, sizeof(_host_bus_timers));
+
+	_host_bus_sr = 0u;
+	_host_bus_irq_off = 0u;
+	_host_bus_in_timer = false;
+	_host_bus_e_high = false;
+	host_bus_backlight = false;
+	host_bus_n_strobes = 0u;
+
+	hd44780_reset(&host_lcd, fosc_hz);
+	hd44780_reset(&host_lcd2, fosc_hz);
+
+	return;
+}
+
+uint64_t host_bus_time_ns(void)
+{
+	return _host_bus_t_ns;
+}
+
+void host_bus_advance_ns(uint64_t ns)
+{
+	uint64_t t_end_ns;
+
+	t_end_ns = _host_bus_t_ns + ns;
+
+	_host_bus_run_timers(t_end_ns);
+
+	if(_host_bus_t_ns < t_end_ns) _host_bus_t_ns = t_end_ns;
+
+	return;
+}
+
+void host_bus_connect(uint8_t pin, uint16_t fn)
+{
+	if(pin >= HOST_BUS_N_PINS) return;
+
+	_host_bus_fn[pin] = fn;
+	_host_bus_update_lcd();
+
+	return;
+}
+
+void host_bus_pin_write(uint8_t pin, bool level)
+{
+	bool rising;
+
+	if(pin >= HOST_BUS_N_PINS) return;
+
+	rising = level && !_host_bus_level[pin];
+	_host_bus_level[pin] = level;
+
+	if(_host_bus_fn[pin] == HOST_BUS_FN_SR_LATCH)
+	{
+		if(rising) _host_bus_expander_write(_host_bus_sr);
+		return;
+	}
+
+	if(_host_bus_fn[pin] != HOST_BUS_FN_NONE) _host_bus_update_lcd();
+
+	return;
+}
+
+void host_bus_pins_write(uint64_t mask, uint64_t levels)
+{
+	uint8_t pin;
+
+	/*All pins change at the same instant*/
+	for(pin = 0u; pin < 64u; pin++)
+	{
+		if(mask & (1ULL << pin)) _host_bus_level[pin] = (levels >> pin) & 0x1;
+	}
+
+	_host_bus_update_lcd();
+	return;
+}
+
+bool host_bus_pin_read(uint8_t pin)
+{
+	uint16_t fn;
+
+	if(pin >= HOST_BUS_N_PINS) return false;
+
+	fn = _host_bus_fn[pin];
+
+	if(!_host_bus_out[pin] && (fn & HD44780_PINS_DB) && hd44780_is_driving(&host_lcd))
+	{
+		return (hd44780_read_db(&host_lcd, _host_bus_t_ns) & fn) != 0u;
+	}
+
+	if(!_host_bus_out[pin] && (fn & HD44780_PINS_DB) && hd44780_is_driving(&host_lcd2))
+	{
+		return (hd44780_read_db(&host_lcd2, _host_bus_t_ns) & fn) != 0u;
+	}
+
+	return _host_bus_level[pin];
+}
+
+void host_bus_pin_set_dir(uint8_t pin, bool out)
+{
+	if(pin >= HOST_BUS_N_PINS) return;
+
+	_host_bus_out[pin] = out;
+	return;
+}
+
+int host_bus_i2c_write(uint8_t address, const uint8_t *p_buf, size_t len, uint32_t baudrate)
+{
+	size_t n_byte;
+
+	/*START and the address byte*/
+	host_bus_advance_ns(_host_bus_bits_ns(1u + __HOST_BUS_I2C_BITS_PER_BYTE, baudrate));
+
+	if(address != host_bus_i2c_address)
+	{
+		host_bus_advance_ns(_host_bus_bits_ns(1u, baudrate));
+		return -1;
+	}
+
+	for(n_byte = 0u; n_byte < len; n_byte++)
+	{
+		host_bus_advance_ns(_host_bus_bits_ns(__HOST_BUS_I2C_BITS_PER_BYTE, baudrate));
+		_host_bus_expander_write(p_buf[n_byte]);
+	}
+
+	/*STOP*/
+	host_bus_advance_ns(_host_bus_bits_ns(1u, baudrate));
+
+	return (int) len;
+}
+
+void host_bus_spi_write(const uint8_t *p_buf, size_t len, uint32_t baudrate, bool latch_each)
+{
+	size_t n_byte;
+
+	for(n_byte = 0u; n_byte < len; n_byte++)
+	{
+		host_bus_advance_ns(_host_bus_bits_ns(8u, baudrate) + host_bus_costs.spi_byte_ns);
+		_host_bus_sr = p_buf[n_byte];
+
+		if(!latch_each) continue;
+
+		/*CSn goes high for one bit time between frames: its rising edge is the RCLK pulse*/
+		_host_bus_expander_write(_host_bus_sr);
+		host_bus_advance_ns(_host_bus_bits_ns(1u, baudrate));
+	}
+
+	return;
+}
+
+int host_bus_add_timer(uint64_t t_ns, host_bus_timer_fn_t fn, void *p_arg)
+{
+	uint8_t n_timer;
+
+	if(fn == NULL) return -1;
+
+	for(n_timer = 0u; n_timer < HOST_BUS_N_TIMERS; n_timer++)
+	{
+		if(_host_bus_timers[n_timer].fn != NULL) continue;
+
+		_host_bus_timers[n_timer].fn = fn;
+		_host_bus_timers[n_timer].p_arg = p_arg;
+		_host_bus_timers[n_timer].t_ns = t_ns;
+
+		return (int) n_timer;
+	}
+
+	return -1;
+}
+
+void host_bus_irq_disable(void)
+{
+	_host_bus_irq_off++;
+	return;
+}
+
+void host_bus_irq_enable(void)
+{
+	if(_host_bus_irq_off) _host_bus_irq_off--;
+
+	/*Whatever came due while masked runs now*/
+	if(!_host_bus_irq_off) _host_bus_run_timers(_host_bus_t_ns);
+
+	return;
+}
+
+void _host_bus_update_lcd(void)
+{
+	uint8_t pin;
+	uint16_t pins;
+
+	pins = 0u;
+
+	for(pin = 0u; pin < HOST_BUS_N_PINS; pin++)
+	{
+		if(_host_bus_fn[pin] == HOST_BUS_FN_SR_LATCH) continue;
+		if(_host_bus_level[pin]) pins |= _host_bus_fn[pin];
+	}
+
+	/*A strobe starts when the first E goes high and ends when the last one goes low*/
+	if((pins & (HD44780_PIN_E | HOST_BUS_FN_E2)) && !_host_bus_e_high) host_bus_n_strobes++;
+	_host_bus_e_high = (pins & (HD44780_PIN_E | HOST_BUS_FN_E2)) != 0u;
+
+	hd44780_set_pins(&host_lcd, (pins & ~HOST_BUS_FN_E2), _host_bus_t_ns);
+
+	/*The second controller sees the same lines, but its own E*/
+	if(pins & HOST_BUS_FN_E2) pins |= HD44780_PIN_E;
+	else pins &= ~HD44780_PIN_E;
+
+	hd44780_set_pins(&host_lcd2, (pins & ~HOST_BUS_FN_E2), _host_bus_t_ns);
+	return;
+}
+
+void _host_bus_expander_write(uint8_t value)
+{
+	uint16_t pins;
+
+	pins = (value & 0xf0);
+	if(value & __HOST_BUS_EXP_RS) pins |= HD44780_PIN_RS;
+	if(value & __HOST_BUS_EXP_RW) pins |= HD44780_PIN_RW;
+	if(value & __HOST_BUS_EXP_E) pins |= HD44780_PIN_E;
+
+	host_bus_backlight = (value & __HOST_BUS_EXP_BL) != 0u;
+
+	hd44780_set_pins(&host_lcd, pins, _host_bus_t_ns);
+	return;
+}
+
+void _host_bus_run_timers(uint64_t t_end_ns)
+{
+	struct _host_bus_timer *p_next;
+	uint8_t n_timer;
+
+	if(_host_bus_irq_off) return;
+	if(_host_bus_in_timer) return;
+
+	while(true)
+	{
+		p_next = NULL;
+
+		for(n_timer = 0u; n_timer < HOST_BUS_N_TIMERS; n_timer++)
+		{
+			if(_host_bus_timers[n_timer].fn == NULL) continue;
+			if(_host_bus_timers[n_timer].t_ns > t_end_ns) continue;
+			if((p_next != NULL) && (p_next->t_ns <= _host_bus_timers[n_timer].t_ns)) continue;
+
+			p_next = &(_host_bus_timers[n_timer]);
+		}
+
+		if(p_next == NULL) break;
+
+		if(_host_bus_t_ns < p_next->t_ns) _host_bus_t_ns = p_next->t_ns;
+
+		_host_bus_in_timer = true;
+		p_next->t_ns = p_next->fn(p_next->p_arg, p_next->t_ns);
+		_host_bus_in_timer = false;
+
+		if(!p_next->t_ns) p_next->fn = NULL;
+	}
+
+	return;
+}
+
+uint64_t _host_bus_bits_ns(uint32_t n_bits, uint32_t baudrate)
+{
+	if(!baudrate) return 0u;
+
+	return (((uint64_t) n_bits)*1000000000ULL + baudrate - 1u)/baudrate;
+}
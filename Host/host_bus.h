@@ -0,0 +1,129 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Virtual clock and wiring between the host HAL shims and the HD44780 emulator.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef HOST_BUS_H
+#define HOST_BUS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hd44780.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_BUS_N_PINS 128U
+#define HOST_BUS_N_TIMERS 4U
+
+/*
+ * Pin functions (host_bus_connect()): one of the HD44780_PIN_* bits, or one of these.
+ */
+
+#define HOST_BUS_FN_NONE 0x0000U
+#define HOST_BUS_FN_SR_LATCH 0x8000U	/*74HC595 RCLK (Arduino SPI transport latch pin)*/
+#define HOST_BUS_FN_E2 0x4000U		/*E OF THE SECOND CONTROLLER (THE OTHER PINS ARE SHARED, AS WIRED IN TestLCD2)*/
+
+/*
+ * Time every HAL call takes on the emulated MCU, in ns.
+ * The shims load the defaults of their platform, benchmarks can change them afterwards.
+ */
+
+struct _host_bus_costs {
+	uint32_t gpio_write_ns;		/*ONE PIN (OR MASKED) WRITE*/
+	uint32_t gpio_read_ns;		/*ONE PIN READ*/
+	uint32_t gpio_dir_ns;		/*ONE PIN DIRECTION CHANGE*/
+	uint32_t clock_read_ns;		/*ONE TIME READ (time_us_32(), micros())*/
+	uint32_t spin_ns;		/*ONE ITERATION OF A WAIT LOOP*/
+	uint32_t spi_byte_ns;		/*SOFTWARE OVERHEAD OF ONE SPI BYTE*/
+};
+
+typedef struct _host_bus_costs host_bus_costs_t;
+
+/*
+ * Timer callback: runs at "t_ns" with the interrupts of the emulated MCU masked.
+ * returns the absolute time of the next run, 0 to stop.
+ */
+
+typedef uint64_t (*host_bus_timer_fn_t)(void *p_arg, uint64_t t_ns);
+
+extern hd44780_t host_lcd;		/*THE EMULATED CONTROLLER*/
+extern hd44780_t host_lcd2;		/*SECOND CONTROLLER ON THE SAME PINS, WITH ITS OWN E (HOST_BUS_FN_E2)*/
+extern host_bus_costs_t host_bus_costs;
+extern uint8_t host_bus_i2c_address;	/*PCF8574 ADDRESS (DEFAULT 0x27)*/
+extern bool host_bus_backlight;		/*BACKLIGHT OUTPUT OF THE PCF8574/74HC595*/
+extern uint32_t host_bus_n_strobes;	/*E STROBES ON THE GPIO BUS (E AND E2 RAISED TOGETHER COUNT ONCE)*/
+
+/*
+ * host_bus_reset()
+ * disconnects every pin, drops the timers and resets the emulated controllers (see hd44780_reset()).
+ * The virtual clock keeps running.
+ */
+
+extern void host_bus_reset(uint32_t fosc_hz);
+
+/*
+ * host_bus_time_ns()
+ * returns the virtual clock.
+ */
+
+extern uint64_t host_bus_time_ns(void);
+
+/*
+ * host_bus_advance_ns()
+ * moves the virtual clock forward, running the timers that come due on the way (unless masked).
+ */
+
+extern void host_bus_advance_ns(uint64_t ns);
+
+/*
+ * host_bus_connect()
+ * wires an MCU pin to a controller pin (HD44780_PIN_*), to the E pin of the second controller (HOST_BUS_FN_E2)
+ * or to the 74HC595 latch (HOST_BUS_FN_SR_LATCH).
+ */
+
+extern void host_bus_connect(uint8_t pin, uint16_t fn);
+
+/*
+ * MCU pins. Writes take effect at the current time. The data lines read back the controller output while it drives them.
+ */
+
+extern void host_bus_pin_write(uint8_t pin, bool level);
+extern void host_bus_pins_write(uint64_t mask, uint64_t levels);
+extern bool host_bus_pin_read(uint8_t pin);
+extern void host_bus_pin_set_dir(uint8_t pin, bool out);
+
+/*
+ * Expanders (common backpack wiring: P0/Q0 RS, P1/Q1 R/W, P2/Q2 E, P3/Q3 backlight, P4-P7/Q4-Q7 DB4-DB7).
+ *
+ * host_bus_i2c_write(): I2C write to the PCF8574 at "baudrate", each byte reaches the outputs on its ACK.
+ * returns the number of bytes written, -1 if no device acknowledged the address.
+ *
+ * host_bus_spi_write(): SPI write to the 74HC595 at "baudrate". With "latch_each" set, the outputs are latched
+ * after every byte (hardware CSn wired to RCLK), otherwise only by the pin connected as HOST_BUS_FN_SR_LATCH.
+ */
+
+extern int host_bus_i2c_write(uint8_t address, const uint8_t *p_buf, size_t len, uint32_t baudrate);
+extern void host_bus_spi_write(const uint8_t *p_buf, size_t len, uint32_t baudrate, bool latch_each);
+
+/*
+ * Timers and interrupt masking of the emulated MCU.
+ * host_bus_add_timer() returns the timer id, -1 if none is free.
+ */
+
+extern int host_bus_add_timer(uint64_t t_ns, host_bus_timer_fn_t fn, void *p_arg);
+extern void host_bus_irq_disable(void);
+extern void host_bus_irq_enable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*HOST_BUS_H*/
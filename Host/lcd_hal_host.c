@@ -0,0 +1,272 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Pico SDK shim (the subset listed in RaspberryPiPico/v1.1/lcd_hal.h), running on the host bus.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_hal_host.h"
+
+#include <string.h>
+
+/*HAL call costs on a 125MHz RP2040 (SIO register access plus the call itself)*/
+#define __LCD_HAL_HOST_GPIO_NS 24U
+#define __LCD_HAL_HOST_CLOCK_NS 40U
+#define __LCD_HAL_HOST_SPIN_NS 16U
+
+struct _host_alarm {
+	alarm_callback_t callback;
+	void *user_data;
+	alarm_id_t id;
+};
+
+i2c_inst_t host_i2c0;
+i2c_inst_t host_i2c1;
+spi_inst_t host_spi0;
+spi_inst_t host_spi1;
+void (*host_core1_entry)(void) = NULL;
+
+static struct _host_alarm _lcd_hal_host_alarms[HOST_BUS_N_TIMERS];
+static uint32_t _lcd_hal_host_irq_depth = 0u;
+
+extern uint64_t _lcd_hal_host_alarm_fn(void *p_arg, uint64_t t_ns);
+
+void lcd_hal_host_init(void)
+{
+	host_bus_reset(0u);
+
+	host_bus_costs.gpio_write_ns = __LCD_HAL_HOST_GPIO_NS;
+	host_bus_costs.gpio_read_ns = __LCD_HAL_HOST_GPIO_NS;
+	host_bus_costs.gpio_dir_ns = __LCD_HAL_HOST_GPIO_NS;
+	host_bus_costs.clock_read_ns = __LCD_HAL_HOST_CLOCK_NS;
+	host_bus_costs.spin_ns = __LCD_HAL_HOST_SPIN_NS;
+	host_bus_costs.spi_byte_ns = 0u;
+
+	memset(_lcd_hal_host_alarms, 0, sizeof(_lcd_hal_host_alarms));
+	_lcd_hal_host_irq_depth = 0u;
+	host_core1_entry = NULL;
+
+	return;
+}
+
+void gpio_init(unsigned int gpio)
+{
+	host_bus_pin_set_dir(gpio, false);
+	host_bus_pin_write(gpio, false);
+	host_bus_advance_ns(host_bus_costs.gpio_dir_ns);
+
+	return;
+}
+
+void gpio_set_dir(unsigned int gpio, bool out)
+{
+	host_bus_pin_set_dir(gpio, out);
+	host_bus_advance_ns(host_bus_costs.gpio_dir_ns);
+
+	return;
+}
+
+void gpio_put(unsigned int gpio, bool value)
+{
+	host_bus_pin_write(gpio, value);
+	host_bus_advance_ns(host_bus_costs.gpio_write_ns);
+
+	return;
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+	host_bus_pins_write(mask, value);
+	host_bus_advance_ns(host_bus_costs.gpio_write_ns);
+
+	return;
+}
+
+bool gpio_get(unsigned int gpio)
+{
+	bool level;
+
+	level = host_bus_pin_read(gpio);
+	host_bus_advance_ns(host_bus_costs.gpio_read_ns);
+
+	return level;
+}
+
+void gpio_set_function(unsigned int gpio, enum gpio_function fn)
+{
+	(void) gpio;
+	(void) fn;
+
+	host_bus_advance_ns(host_bus_costs.gpio_dir_ns);
+	return;
+}
+
+void gpio_pull_up(unsigned int gpio)
+{
+	(void) gpio;
+
+	host_bus_advance_ns(host_bus_costs.gpio_dir_ns);
+	return;
+}
+
+void sleep_us(uint64_t us)
+{
+	host_bus_advance_ns(us*1000u);
+	return;
+}
+
+void busy_wait_us_32(uint32_t delay_us)
+{
+	host_bus_advance_ns(((uint64_t) delay_us)*1000u);
+	return;
+}
+
+void sleep_ms(uint32_t ms)
+{
+	host_bus_advance_ns(((uint64_t) ms)*1000000u);
+	return;
+}
+
+uint32_t time_us_32(void)
+{
+	return (uint32_t) time_us_64();
+}
+
+uint64_t time_us_64(void)
+{
+	uint64_t t_us;
+
+	t_us = host_bus_time_ns()/1000u;
+	host_bus_advance_ns(host_bus_costs.clock_read_ns);
+
+	return t_us;
+}
+
+void tight_loop_contents(void)
+{
+	host_bus_advance_ns(host_bus_costs.spin_ns);
+	return;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	uint8_t n_alarm;
+	int timer;
+
+	(void) fire_if_past;
+
+	for(n_alarm = 0u; n_alarm < HOST_BUS_N_TIMERS; n_alarm++)
+	{
+		if(_lcd_hal_host_alarms[n_alarm].callback == NULL) break;
+	}
+
+	if(n_alarm >= HOST_BUS_N_TIMERS) return -1;
+
+	_lcd_hal_host_alarms[n_alarm].callback = callback;
+	_lcd_hal_host_alarms[n_alarm].user_data = user_data;
+	_lcd_hal_host_alarms[n_alarm].id = (alarm_id_t) (n_alarm + 1u);
+
+	timer = host_bus_add_timer((host_bus_time_ns() + us*1000u), _lcd_hal_host_alarm_fn, &(_lcd_hal_host_alarms[n_alarm]));
+
+	if(timer < 0)
+	{
+		_lcd_hal_host_alarms[n_alarm].callback = NULL;
+		return -1;
+	}
+
+	/*An alarm already due fires as soon as interrupts allow*/
+	host_bus_advance_ns(0u);
+
+	return _lcd_hal_host_alarms[n_alarm].id;
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+	host_bus_irq_disable();
+	_lcd_hal_host_irq_depth++;
+
+	return _lcd_hal_host_irq_depth;
+}
+
+void restore_interrupts(uint32_t status)
+{
+	(void) status;
+
+	if(_lcd_hal_host_irq_depth) _lcd_hal_host_irq_depth--;
+	host_bus_irq_enable();
+
+	return;
+}
+
+unsigned int i2c_init(i2c_inst_t *i2c, unsigned int baudrate)
+{
+	i2c->baudrate = baudrate;
+	return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+	int n_written;
+
+	(void) nostop;
+
+	n_written = host_bus_i2c_write(addr, src, len, i2c->baudrate);
+	if(n_written < 0) return PICO_ERROR_GENERIC;
+
+	return n_written;
+}
+
+unsigned int spi_init(spi_inst_t *spi, unsigned int baudrate)
+{
+	spi->baudrate = baudrate;
+	spi->latch_each = true;
+
+	return baudrate;
+}
+
+void spi_set_format(spi_inst_t *spi, unsigned int data_bits, enum spi_cpol cpol, enum spi_cpha cpha, enum spi_order order)
+{
+	(void) data_bits;
+	(void) cpol;
+	(void) order;
+
+	/*CSn only pulses between frames with CPHA = 0*/
+	spi->latch_each = (cpha == SPI_CPHA_0);
+
+	return;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+	host_bus_spi_write(src, len, spi->baudrate, spi->latch_each);
+	return (int) len;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+	host_core1_entry = entry;
+	return;
+}
+
+/*
+ * Alarm callback return value, as in the SDK: > 0 reschedules that many us after the callback returns,
+ * < 0 that many us after the previous alarm time, 0 stops.
+ */
+
+uint64_t _lcd_hal_host_alarm_fn(void *p_arg, uint64_t t_ns)
+{
+	struct _host_alarm *p_alarm;
+	int64_t ret;
+
+	p_alarm = (struct _host_alarm*) p_arg;
+
+	ret = p_alarm->callback(p_alarm->id, p_alarm->user_data);
+
+	if(ret > 0) return host_bus_time_ns() + ((uint64_t) ret)*1000u;
+	if(ret < 0) return t_ns + ((uint64_t) -ret)*1000u;
+
+	p_alarm->callback = NULL;
+	return 0u;
+}
@@ -0,0 +1,236 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Arduino core shim (the subset listed in ArduinoIDE/v1.0/lcd_hal.hpp), running on the host bus.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_hal_host.hpp"
+
+/*HAL call costs on a 16MHz ATmega328P (Arduino core digitalWrite()/digitalRead()/pinMode()/micros())*/
+#define __LCD_HAL_HOST_WRITE_NS 3400U
+#define __LCD_HAL_HOST_READ_NS 3200U
+#define __LCD_HAL_HOST_DIR_NS 3900U
+#define __LCD_HAL_HOST_CLOCK_NS 3600U
+#define __LCD_HAL_HOST_SPIN_NS 250U
+#define __LCD_HAL_HOST_SPI_BYTE_NS 1100U
+
+TwoWire Wire;
+SPIClass SPI;
+
+void lcd_hal_host_init(void)
+{
+	host_bus_reset(0u);
+
+	host_bus_costs.gpio_write_ns = __LCD_HAL_HOST_WRITE_NS;
+	host_bus_costs.gpio_read_ns = __LCD_HAL_HOST_READ_NS;
+	host_bus_costs.gpio_dir_ns = __LCD_HAL_HOST_DIR_NS;
+	host_bus_costs.clock_read_ns = __LCD_HAL_HOST_CLOCK_NS;
+	host_bus_costs.spin_ns = __LCD_HAL_HOST_SPIN_NS;
+	host_bus_costs.spi_byte_ns = __LCD_HAL_HOST_SPI_BYTE_NS;
+
+	return;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	host_bus_pin_set_dir(pin, (mode == OUTPUT));
+	host_bus_advance_ns(host_bus_costs.gpio_dir_ns);
+
+	return;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	host_bus_pin_write(pin, (val != LOW));
+	host_bus_advance_ns(host_bus_costs.gpio_write_ns);
+
+	return;
+}
+
+int digitalRead(uint8_t pin)
+{
+	bool level = false;
+
+	level = host_bus_pin_read(pin);
+	host_bus_advance_ns(host_bus_costs.gpio_read_ns);
+
+	if(level) return HIGH;
+	return LOW;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	host_bus_advance_ns(((uint64_t) us)*1000u);
+	return;
+}
+
+void delay(unsigned long ms)
+{
+	host_bus_advance_ns(((uint64_t) ms)*1000000u);
+	return;
+}
+
+unsigned long micros(void)
+{
+	unsigned long t_us = 0u;
+
+	t_us = (unsigned long) (host_bus_time_ns()/1000u);
+	host_bus_advance_ns(host_bus_costs.clock_read_ns);
+
+	return t_us;
+}
+
+unsigned long millis(void)
+{
+	return (unsigned long) (host_bus_time_ns()/1000000u);
+}
+
+void noInterrupts(void)
+{
+	host_bus_irq_disable();
+	return;
+}
+
+void interrupts(void)
+{
+	host_bus_irq_enable();
+	return;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t n_byte = 0u;
+
+	while(n_byte < size)
+	{
+		if(!this->write(buffer[n_byte])) break;
+		n_byte++;
+	}
+
+	return n_byte;
+}
+
+size_t Print::write(const char *str)
+{
+	if(str == NULL) return 0u;
+
+	return this->write((const uint8_t*) str, strlen(str));
+}
+
+size_t Print::write(const char *buffer, size_t size)
+{
+	return this->write((const uint8_t*) buffer, size);
+}
+
+size_t Print::print(const char *str)
+{
+	return this->write(str);
+}
+
+size_t Print::print(char c)
+{
+	return this->write((uint8_t) c);
+}
+
+size_t Print::println(const char *str)
+{
+	size_t n_bytes = this->write(str);
+
+	return n_bytes + this->println();
+}
+
+size_t Print::println(void)
+{
+	return this->write("\r\n");
+}
+
+void TwoWire::begin(void)
+{
+	this->_n_bytes = 0u;
+	return;
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+	this->_clock = clock;
+	return;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	this->_address = address;
+	this->_n_bytes = 0u;
+
+	return;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+	if(this->_n_bytes >= BUFFER_LENGTH) return 0u;
+
+	this->_buf[this->_n_bytes] = data;
+	this->_n_bytes++;
+
+	return 1u;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+	size_t n_byte = 0u;
+
+	for(n_byte = 0u; n_byte < quantity; n_byte++)
+	{
+		if(!this->write(data[n_byte])) break;
+	}
+
+	return n_byte;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	(void) sendStop;
+
+	/*0: success, 2: address NACK*/
+	if(host_bus_i2c_write(this->_address, this->_buf, this->_n_bytes, this->_clock) < 0) return 2u;
+
+	return 0u;
+}
+
+SPISettings::SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+{
+	(void) bitOrder;
+	(void) dataMode;
+
+	this->clock = clock;
+}
+
+void SPIClass::begin(void)
+{
+	return;
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+	this->_clock = settings.clock;
+	return;
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+	host_bus_spi_write(&data, 1u, this->_clock, false);
+	return 0u;
+}
+
+void SPIClass::transfer(void *buf, size_t count)
+{
+	host_bus_spi_write((const uint8_t*) buf, count, this->_clock, false);
+	return;
+}
+
+void SPIClass::endTransaction(void)
+{
+	return;
+}
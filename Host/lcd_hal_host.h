@@ -0,0 +1,122 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Pico SDK shim (the subset listed in RaspberryPiPico/v1.1/lcd_hal.h), running on the host bus.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_HAL_HOST_H
+#define LCD_HAL_HOST_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "host_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_OUT true
+#define GPIO_IN false
+
+#define PICO_ERROR_GENERIC -1
+
+enum gpio_function {
+	GPIO_FUNC_SPI = 1,
+	GPIO_FUNC_I2C = 3,
+	GPIO_FUNC_SIO = 5
+};
+
+enum spi_cpol {
+	SPI_CPOL_0 = 0,
+	SPI_CPOL_1 = 1
+};
+
+enum spi_cpha {
+	SPI_CPHA_0 = 0,
+	SPI_CPHA_1 = 1
+};
+
+enum spi_order {
+	SPI_LSB_FIRST = 0,
+	SPI_MSB_FIRST = 1
+};
+
+struct _host_i2c {
+	uint32_t baudrate;
+};
+
+struct _host_spi {
+	uint32_t baudrate;
+	bool latch_each;
+};
+
+typedef struct _host_i2c i2c_inst_t;
+typedef struct _host_spi spi_inst_t;
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+extern i2c_inst_t host_i2c0;
+extern i2c_inst_t host_i2c1;
+extern spi_inst_t host_spi0;
+extern spi_inst_t host_spi1;
+
+#define i2c0 (&host_i2c0)
+#define i2c1 (&host_i2c1)
+#define spi0 (&host_spi0)
+#define spi1 (&host_spi1)
+
+#define __dmb() __asm__ volatile("" ::: "memory")
+
+/*
+ * lcd_hal_host_init()
+ * resets the host bus and loads the Pico (125MHz) HAL call costs.
+ */
+
+extern void lcd_hal_host_init(void);
+
+extern void gpio_init(unsigned int gpio);
+extern void gpio_set_dir(unsigned int gpio, bool out);
+extern void gpio_put(unsigned int gpio, bool value);
+extern void gpio_put_masked(uint32_t mask, uint32_t value);
+extern bool gpio_get(unsigned int gpio);
+extern void gpio_set_function(unsigned int gpio, enum gpio_function fn);
+extern void gpio_pull_up(unsigned int gpio);
+
+extern void sleep_us(uint64_t us);
+extern void busy_wait_us_32(uint32_t delay_us);
+extern void sleep_ms(uint32_t ms);
+extern uint32_t time_us_32(void);
+extern uint64_t time_us_64(void);
+extern void tight_loop_contents(void);
+
+extern alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+
+extern uint32_t save_and_disable_interrupts(void);
+extern void restore_interrupts(uint32_t status);
+
+extern unsigned int i2c_init(i2c_inst_t *i2c, unsigned int baudrate);
+extern int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+extern unsigned int spi_init(spi_inst_t *spi, unsigned int baudrate);
+extern void spi_set_format(spi_inst_t *spi, unsigned int data_bits, enum spi_cpol cpol, enum spi_cpha cpha, enum spi_order order);
+extern int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+
+/*
+ * multicore_launch_core1()
+ * the host runs a single core: only records "entry" (host_core1_entry). Checks run the core 1 side themselves.
+ */
+
+extern void (*host_core1_entry)(void);
+extern void multicore_launch_core1(void (*entry)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*LCD_HAL_HOST_H*/
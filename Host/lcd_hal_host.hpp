@@ -0,0 +1,110 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Arduino core shim (the subset listed in ArduinoIDE/v1.0/lcd_hal.hpp), running on the host bus.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_HAL_HOST_HPP
+#define LCD_HAL_HOST_HPP
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "host_bus.h"
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0c
+
+#define BUFFER_LENGTH 32
+
+/*
+ * lcd_hal_host_init()
+ * resets the host bus and loads the Arduino Uno (16MHz ATmega328P) HAL call costs.
+ */
+
+extern void lcd_hal_host_init(void);
+
+extern void pinMode(uint8_t pin, uint8_t mode);
+extern void digitalWrite(uint8_t pin, uint8_t val);
+extern int digitalRead(uint8_t pin);
+
+extern void delayMicroseconds(unsigned int us);
+extern void delay(unsigned long ms);
+extern unsigned long micros(void);
+extern unsigned long millis(void);
+
+extern void noInterrupts(void);
+extern void interrupts(void);
+
+/*Print: the text subset (no numbers, no flash strings)*/
+class Print {
+	public:
+		virtual ~Print(void) {}
+
+		virtual size_t write(uint8_t byte) = 0;
+		virtual size_t write(const uint8_t *buffer, size_t size);
+		size_t write(const char *str);
+		size_t write(const char *buffer, size_t size);
+
+		size_t print(const char *str);
+		size_t print(char c);
+		size_t println(const char *str);
+		size_t println(void);
+};
+
+class TwoWire {
+	public:
+		void begin(void);
+		void setClock(uint32_t clock);
+		void beginTransmission(uint8_t address);
+		size_t write(uint8_t data);
+		size_t write(const uint8_t *data, size_t quantity);
+		uint8_t endTransmission(bool sendStop = true);
+
+	private:
+		uint32_t _clock = 100000UL;
+		uint8_t _address = 0u;
+		uint8_t _n_bytes = 0u;
+		uint8_t _buf[BUFFER_LENGTH];
+};
+
+class SPISettings {
+	public:
+		SPISettings(uint32_t clock = 4000000UL, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0);
+
+		uint32_t clock = 4000000UL;
+};
+
+class SPIClass {
+	public:
+		void begin(void);
+		void beginTransaction(SPISettings settings);
+		uint8_t transfer(uint8_t data);
+		void transfer(void *buf, size_t count);
+		void endTransaction(void);
+
+	private:
+		uint32_t _clock = 4000000UL;
+};
+
+extern TwoWire Wire;
+extern SPIClass SPI;
+
+#endif /*LCD_HAL_HOST_HPP*/
@@ -0,0 +1,78 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Writes a driver bus trace (LCD_CFG_TRACE) as a Value Change Dump file.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "trace_vcd.h"
+
+#include <stdio.h>
+
+#define __TRACE_VCD_STROBE_NS 50U
+#define __TRACE_VCD_MIN_GAP_NS 100U
+
+extern void _trace_vcd_write_byte(FILE *p_file, uint8_t byte);
+
+bool trace_vcd_write(const char *path, const trace_vcd_entry_t *p_entries, uintptr_t n_entries)
+{
+	FILE *p_file;
+	uintptr_t n_entry;
+	uint64_t t_ns;
+	uint64_t t_prev_ns;
+	bool ok;
+
+	if(path == NULL) return false;
+	if((p_entries == NULL) && n_entries) return false;
+
+	p_file = fopen(path, "w");
+	if(p_file == NULL) return false;
+
+	fprintf(p_file, "$comment Generic Alphanumeric LCD Display Driver bus trace, %lu transfers $end\n", (unsigned long) n_entries);
+	fprintf(p_file, "$timescale 1ns $end\n");
+	fprintf(p_file, "$scope module lcd $end\n");
+	fprintf(p_file, "$var wire 1 ! rs $end\n");
+	fprintf(p_file, "$var wire 1 \" init_nibble $end\n");
+	fprintf(p_file, "$var wire 8 # db [7:0] $end\n");
+	fprintf(p_file, "$var wire 1 $ strobe $end\n");
+	fprintf(p_file, "$upscope $end\n");
+	fprintf(p_file, "$enddefinitions $end\n");
+	fprintf(p_file, "$dumpvars\nx!\nx\"\nbxxxxxxxx #\n0$\n$end\n");
+
+	t_prev_ns = 0u;
+
+	for(n_entry = 0u; n_entry < n_entries; n_entry++)
+	{
+		/*Unsigned difference: the 32-bit driver clock may wrap around inside the trace*/
+		t_ns = ((uint64_t) (uint32_t) (p_entries[n_entry].t_us - p_entries[0].t_us))*1000u;
+		if(n_entry && (t_ns < (t_prev_ns + __TRACE_VCD_MIN_GAP_NS))) t_ns = t_prev_ns + __TRACE_VCD_MIN_GAP_NS;
+
+		fprintf(p_file, "#%llu\n", (unsigned long long) t_ns);
+		fprintf(p_file, "%c!\n", (p_entries[n_entry].kind == TRACE_VCD_DATA) ? '1' : '0');
+		fprintf(p_file, "%c\"\n", (p_entries[n_entry].kind == TRACE_VCD_INIT_NIBBLE) ? '1' : '0');
+		_trace_vcd_write_byte(p_file, p_entries[n_entry].value);
+		fprintf(p_file, "1$\n");
+		fprintf(p_file, "#%llu\n0$\n", (unsigned long long) (t_ns + __TRACE_VCD_STROBE_NS));
+
+		t_prev_ns = t_ns;
+	}
+
+	ok = !ferror(p_file);
+	if(fclose(p_file)) ok = false;
+
+	return ok;
+}
+
+void _trace_vcd_write_byte(FILE *p_file, uint8_t byte)
+{
+	char bits[9];
+	uint8_t n_bit;
+
+	for(n_bit = 0u; n_bit < 8u; n_bit++) bits[n_bit] = ((byte << n_bit) & 0x80) ? '1' : '0';
+	bits[8] = '\0';
+
+	fprintf(p_file, "b%s #\n", bits);
+	return;
+}
@@ -0,0 +1,54 @@
+/*
+ * Generic Alphanumeric LCD Display Driver - Host build
+ *
+ * Writes a driver bus trace (LCD_CFG_TRACE) as a Value Change Dump file, for GTKWave or any other VCD viewer.
+ *
+ * Signals (module "lcd"):
+ * rs: register of the last transfer (0 instruction, 1 data).
+ * init_nibble: 1 if the last transfer was a single initialization nibble.
+ * db[7:0]: byte (or nibble) of the last transfer.
+ * strobe: 50ns pulse at the start of every transfer, so repeated identical bytes stay visible.
+ *
+ * Times are relative to the first entry. The driver timestamps have a 1us resolution, entries sharing a timestamp
+ * (batching transports) are spread 100ns apart.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef TRACE_VCD_H
+#define TRACE_VCD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Same values as LCD_TRACE_* (Pico) and LCD::TRACE_* (Arduino)*/
+#define TRACE_VCD_CMD 0U
+#define TRACE_VCD_DATA 1U
+#define TRACE_VCD_INIT_NIBBLE 2U
+
+typedef struct {
+	uint32_t t_us;
+	uint8_t kind;
+	uint8_t value;
+} trace_vcd_entry_t;
+
+/*
+ * trace_vcd_write()
+ * writes "n_entries" trace entries (oldest first) to the VCD file "path".
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool trace_vcd_write(const char *path, const trace_vcd_entry_t *p_entries, uintptr_t n_entries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*TRACE_VCD_H*/
@@ -8,135 +8,413 @@
 
 #include "lcd.h"
 
-#include "pico.h"
-#include "pico/time.h"
-#include "hardware/gpio.h"
+#include <string.h>
+
+#include "lcd_hal.h"
 
 #define __LCD_EN_DELAY_US 1U
-#define __LCD_CMD_DELAY_US 1024U
 
-extern void _lcd_send_byte(const lcd_t *p_lcd, bool reg, uint8_t byte);
+/*Give up busy flag polling after this many times the timed profile delay*/
+#define __LCD_BF_TIMEOUT_FACTOR 4U
+
+/*Rough cost of one busy flag poll plus both data direction switches*/
+#define __LCD_BF_POLL_US 4U
+
+#define __LCD_AC_UNKNOWN 0xffU
+
+#define __LCD_UTF8_INVALID 0xffffffffU
+
+#define __LCD_TXQ_MASK (LCD_CFG_TXQUEUE_SIZE - 1U)
+#define __LCD_TRACE_MASK (LCD_CFG_TRACE_SIZE - 1U)
+
+extern uint16_t _lcd_exec_time_us(bool reg, uint8_t byte);
+extern void _lcd_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+extern void _lcd_bus_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+extern void _lcd_transport_flush(lcd_t *p_lcd);
+extern void _lcd_transmit_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+#if LCD_CFG_ASYNC
+extern void _lcd_txq_push(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern int64_t _lcd_async_alarm_callback(alarm_id_t id, void *user_data);
+extern void _lcd_txq_drain(lcd_t *p_lcd);
+#endif
+#if LCD_CFG_STATS
+extern void _lcd_stats_call_begin(lcd_t *p_lcd);
+extern void _lcd_stats_call_end(lcd_t *p_lcd);
+extern void _lcd_stats_count_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+#endif
+#if LCD_CFG_TRACE
+extern void _lcd_trace(lcd_t *p_lcd, uint8_t kind, uint8_t value);
+#endif
+extern void _lcd_put_char(lcd_t *p_lcd, uint8_t byte);
+extern void _lcd_sync_cursor(lcd_t *p_lcd);
+extern bool _lcd_set_cursor_lazy(lcd_t *p_lcd, uint8_t cx, uint8_t cy);
+extern bool _lcd_put_number(lcd_t *p_lcd, uint32_t magnitude, bool negative, uint8_t base, uint8_t n_decimals, uint8_t width, intptr_t align, char pad);
+extern uint8_t _lcd_format_number(uint8_t *p_end, uint32_t magnitude, uint8_t base, uint8_t n_decimals);
+extern void _lcd_put_field(lcd_t *p_lcd, const uint8_t *p_field, uint8_t len);
+extern void _lcd_put_codepoint(lcd_t *p_lcd, uint32_t codepoint);
+extern uint8_t _lcd_utf8_decode(const uint8_t *p_text, uintptr_t len, uint32_t *p_codepoint);
+extern bool _lcd_rom_lookup(uint32_t codepoint, uint8_t *p_code);
+extern void _lcd_track_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+extern uint8_t _lcd_ddram_addr_to_idx(uint8_t addr);
+extern uint8_t _lcd_idx_to_ddram_addr(uint8_t idx);
+extern uint8_t _lcd_next_idx(uint8_t idx);
+extern bool _lcd_validate_rect(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height);
+extern uint32_t _lcd_plan_fill(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, uint8_t byte, bool *p_clear);
+extern uint32_t _lcd_plan_cell(uint8_t *p_ac, uint8_t idx);
+#if LCD_CFG_FRAMEBUFFER
+extern void _lcd_fb_write(lcd_t *p_lcd, uint8_t byte);
+extern void _lcd_fb_set(lcd_t *p_lcd, uint8_t idx, uint8_t byte);
+extern void _lcd_fb_blank_hidden(lcd_t *p_lcd);
+extern bool _lcd_fb_is_dirty(const lcd_t *p_lcd, uint8_t idx);
+extern void _lcd_fb_set_dirty(lcd_t *p_lcd, uint8_t idx, bool dirty);
+#endif
+#if LCD_CFG_GLYPHS
+extern bool _lcd_put_glyph(lcd_t *p_lcd, uint16_t glyph_id);
+extern uint16_t _lcd_glyph_find(const lcd_t *p_lcd, uint32_t codepoint);
+extern void _lcd_glyph_forget_slots(lcd_t *p_lcd);
+extern uint8_t _lcd_glyph_acquire(lcd_t *p_lcd, uint16_t glyph_id);
+extern void _lcd_glyph_touch(lcd_t *p_lcd, uint8_t n_lru);
+extern void _lcd_glyph_repaint(lcd_t *p_lcd, uint8_t slot, uint8_t fallback);
+extern void _lcd_glyph_upload(lcd_t *p_lcd, uint8_t slot, const lcd_glyph_t *p_glyph);
+#endif
 extern void _lcd_write_nibble(const lcd_t *p_lcd, uint8_t nibble);
-extern void _lcd_send_init_nibble(const lcd_t *p_lcd);
+extern void _lcd_write_byte(const lcd_t *p_lcd, uint8_t byte);
+extern void _lcd_wait_ready(lcd_t *p_lcd);
+extern uint8_t _lcd_read_bf_ac(const lcd_t *p_lcd);
+extern uint8_t _lcd_read_nibble(const lcd_t *p_lcd);
+extern uint8_t _lcd_read_low_nibble(const lcd_t *p_lcd);
+extern void _lcd_set_data_dir(const lcd_t *p_lcd, bool out);
+extern void _lcd_gpio_init(lcd_t *p_lcd);
+extern void _lcd_send_init_nibble(lcd_t *p_lcd);
+extern void _lcd_send_init_8bit(lcd_t *p_lcd);
 extern bool _lcd_validate_info(const lcd_t *p_lcd);
 extern bool _phys_text_cx_cy_to_virt_text_cx_cy(const lcd_t *p_lcd, uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy);
+extern void _lcd_load_line_addr_table(lcd_t *p_lcd);
+extern bool _lcd_phys_text_cx_cy_to_ddram_addr(const lcd_t *p_lcd, uint8_t *p_addr, uint8_t physcx, uint8_t physcy);
+
+/*
+ * Character generator ROM: code points [first, first + len) are shown by character codes [code, code + len).
+ * Sorted by code point, for a binary search.
+ */
+
+struct _lcd_rom_range {
+	uint16_t first;
+	uint8_t len;
+	uint8_t code;
+};
+
+#if LCD_CFG_ROM_CODE == LCD_ROM_CODE_A00
+const struct _lcd_rom_range _lcd_rom_ranges[] = {
+	{0x0020, 60, 0x20},		/*' ' to '[' (0x5c is the yen sign)*/
+	{0x005d, 33, 0x5d},		/*']' to '}' (0x7e and 0x7f are arrows)*/
+	{0x00a0, 1, 0x20},		/*no-break space*/
+	{0x00a2, 1, 0xec},		/*cent sign*/
+	{0x00a3, 1, 0xed},		/*pound sign*/
+	{0x00a5, 1, 0x5c},		/*yen sign*/
+	{0x00b0, 1, 0xdf},		/*degree sign*/
+	{0x00b5, 1, 0xe4},		/*micro sign*/
+	{0x00b7, 1, 0xa5},		/*middle dot*/
+	{0x00e4, 1, 0xe1},		/*latin small letter a with diaeresis*/
+	{0x00f1, 1, 0xee},		/*latin small letter n with tilde*/
+	{0x00f6, 1, 0xef},		/*latin small letter o with diaeresis*/
+	{0x00f7, 1, 0xfd},		/*division sign*/
+	{0x00fc, 1, 0xf5},		/*latin small letter u with diaeresis*/
+	{0x03a3, 1, 0xf6},		/*greek capital letter sigma*/
+	{0x03a9, 1, 0xf4},		/*greek capital letter omega*/
+	{0x03b1, 1, 0xe0},		/*greek small letter alpha*/
+	{0x03b2, 1, 0xe2},		/*greek small letter beta*/
+	{0x03b5, 1, 0xe3},		/*greek small letter epsilon*/
+	{0x03b8, 1, 0xf2},		/*greek small letter theta*/
+	{0x03bc, 1, 0xe4},		/*greek small letter mu*/
+	{0x03c0, 1, 0xf7},		/*greek small letter pi*/
+	{0x03c1, 1, 0xe6},		/*greek small letter rho*/
+	{0x03c3, 1, 0xe5},		/*greek small letter sigma*/
+	{0x2126, 1, 0xf4},		/*ohm sign*/
+	{0x2190, 1, 0x7f},		/*leftwards arrow*/
+	{0x2192, 1, 0x7e},		/*rightwards arrow*/
+	{0x221a, 1, 0xe8},		/*square root*/
+	{0x221e, 1, 0xf3},		/*infinity*/
+	{0x2588, 1, 0xff},		/*full block*/
+	{0x4e07, 1, 0xfb},		/*cjk unified ideograph-4e07*/
+	{0x5186, 1, 0xfc},		/*cjk unified ideograph-5186*/
+	{0x5343, 1, 0xfa},		/*cjk unified ideograph-5343*/
+	{0xff61, 63, 0xa1}		/*half-width katakana*/
+};
+#elif LCD_CFG_ROM_CODE == LCD_ROM_CODE_A02
+const struct _lcd_rom_range _lcd_rom_ranges[] = {
+	{0x0020, 95, 0x20},		/*' ' to '~'*/
+	{0x00a0, 1, 0x20},		/*no-break space*/
+	{0x00a1, 7, 0xa1},		/*inverted exclamation mark to section sign*/
+	{0x00a9, 3, 0xa9},		/*copyright sign to left guillemet*/
+	{0x00ae, 1, 0xae},		/*registered sign*/
+	{0x00b0, 4, 0xb0},		/*degree sign to superscript three*/
+	{0x00b5, 3, 0xb5},		/*micro sign to middle dot*/
+	{0x00b9, 7, 0xb9},		/*superscript one to inverted question mark*/
+	{0x00c0, 64, 0xc0},		/*Latin-1 letters (A grave to y diaeresis)*/
+	{0x0192, 1, 0xa8},		/*latin small letter f with hook*/
+	{0x0393, 1, 0x92},		/*greek capital letter gamma*/
+	{0x0398, 1, 0x99},		/*greek capital letter theta*/
+	{0x03a3, 1, 0x94},		/*greek capital letter sigma*/
+	{0x03a9, 1, 0x9a},		/*greek capital letter omega*/
+	{0x03b1, 1, 0x90},		/*greek small letter alpha*/
+	{0x03b4, 1, 0x9b},		/*greek small letter delta*/
+	{0x03b5, 1, 0x9e},		/*greek small letter epsilon*/
+	{0x03c0, 1, 0x93},		/*greek small letter pi*/
+	{0x03c3, 1, 0x95},		/*greek small letter sigma*/
+	{0x03c4, 1, 0x97},		/*greek small letter tau*/
+	{0x03c9, 1, 0xb8},		/*greek small letter omega*/
+	{0x0411, 1, 0x80},		/*cyrillic capital letter be*/
+	{0x0414, 1, 0x81},		/*cyrillic capital letter de*/
+	{0x0416, 4, 0x82},		/*Cyrillic ZHE to SHORT I*/
+	{0x041b, 1, 0x86},		/*cyrillic capital letter el*/
+	{0x041f, 1, 0x87},		/*cyrillic capital letter pe*/
+	{0x0423, 1, 0x88},		/*cyrillic capital letter u*/
+	{0x0426, 6, 0x89},		/*Cyrillic TSE to YERU*/
+	{0x042d, 1, 0x8f},		/*cyrillic capital letter e*/
+	{0x042e, 2, 0xac},		/*Cyrillic YU and YA*/
+	{0x2018, 1, 0xaf},		/*left single quotation mark*/
+	{0x201c, 2, 0x12},		/*double quotation marks*/
+	{0x20a7, 1, 0xb4},		/*peseta sign*/
+	{0x2126, 1, 0x9a},		/*ohm sign*/
+	{0x2190, 1, 0x1b},		/*leftwards arrow*/
+	{0x2191, 1, 0x18},		/*upwards arrow*/
+	{0x2192, 1, 0x1a},		/*rightwards arrow*/
+	{0x2193, 1, 0x19},		/*downwards arrow*/
+	{0x21b5, 1, 0x17},		/*downwards arrow with corner leftwards*/
+	{0x221e, 1, 0x9c},		/*infinity*/
+	{0x2229, 1, 0x9f},		/*intersection*/
+	{0x2264, 2, 0x1c},		/*less-than or equal, greater-than or equal*/
+	{0x2302, 1, 0x7f},		/*house*/
+	{0x25b2, 1, 0x1e},		/*black up-pointing triangle*/
+	{0x25b6, 1, 0x10},		/*black right-pointing triangle*/
+	{0x25bc, 1, 0x1f},		/*black down-pointing triangle*/
+	{0x25c0, 1, 0x11},		/*black left-pointing triangle*/
+	{0x25cf, 1, 0x16},		/*black circle*/
+	{0x2665, 1, 0x9d},		/*black heart suit*/
+	{0x266a, 1, 0x91},		/*eighth note*/
+	{0x266c, 1, 0x96}		/*beamed sixteenth notes*/
+};
+#else
+#error "LCD_CFG_ROM_CODE: unknown character ROM"
+#endif
+
+#define __LCD_ROM_N_RANGES (sizeof(_lcd_rom_ranges)/sizeof(struct _lcd_rom_range))
+
+/*UTF-8 lead bytes 0x80-0xff by bits 6-3: sequence length (0: continuation byte or 0xf8-0xff, invalid as a lead byte)*/
+const uint8_t _lcd_utf8_len[16] = {0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 2u, 2u, 2u, 2u, 3u, 3u, 4u, 0u};
+
+/*Smallest code point of each sequence length (longer encodings are malformed)*/
+const uint32_t _lcd_utf8_min[5] = {0u, 0u, 0x80u, 0x800u, 0x10000u};
 
 bool lcd_init(lcd_t *p_lcd)
 {
 	if(p_lcd == NULL) return false;
 
+#if LCD_CFG_ASYNC
+	/*Initialized again: the queue of the previous run must drain first (a zeroed object reads as never initialized)*/
+	if((p_lcd->_status == __LCD_STATUS_INITIALIZED) && p_lcd->_async_mode) lcd_wait_idle(p_lcd);
+
+	p_lcd->_async_mode = false;
+	p_lcd->_async_bf_ok = false;
+	p_lcd->_async_running = false;
+	p_lcd->_txq_head = 0u;
+	p_lcd->_txq_tail = 0u;
+	p_lcd->_txq_hwm = 0u;
+#endif
+
 	if(!_lcd_validate_info(p_lcd))
 	{
 		p_lcd->_status = __LCD_STATUS_ERROR;
 		return false;
 	}
 
-	gpio_init(p_lcd->e);
-	gpio_set_dir(p_lcd->e, GPIO_OUT);
-	gpio_put(p_lcd->e, 0);
-
-	gpio_init(p_lcd->rs);
-	gpio_set_dir(p_lcd->rs, GPIO_OUT);
-
-	gpio_init(p_lcd->db4);
-	gpio_init(p_lcd->db5);
-	gpio_init(p_lcd->db6);
-	gpio_init(p_lcd->db7);
-
-	gpio_set_dir(p_lcd->db4, GPIO_OUT);
-	gpio_set_dir(p_lcd->db5, GPIO_OUT);
-	gpio_set_dir(p_lcd->db6, GPIO_OUT);
-	gpio_set_dir(p_lcd->db7, GPIO_OUT);
+	_lcd_load_line_addr_table(p_lcd);
+
+	p_lcd->_bf_ok = false;
+	p_lcd->_bf_pending_us = 0u;
+
+	p_lcd->_ac = __LCD_AC_UNKNOWN;
+	p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+	p_lcd->_display_ctrl = 0x0c;
+#if LCD_CFG_FRAMEBUFFER
+	p_lcd->_fb_mode = false;
+	p_lcd->_fb_keep = false;
+	p_lcd->_fb_idx = 0u;
+	p_lcd->_n_skipped = 0u;
+#endif
+#if LCD_CFG_GLYPHS
+	p_lcd->_glyphs = NULL;
+	p_lcd->_n_glyphs = 0u;
+	_lcd_glyph_forget_slots(p_lcd);
+	lcd_reset_glyph_stats(p_lcd);
+#endif
+#if LCD_CFG_STATS
+	lcd_reset_stats(p_lcd);
+	_lcd_stats_call_begin(p_lcd);
+#endif
+#if LCD_CFG_TRACE
+	p_lcd->_trace_head = 0u;
+#endif
+
+	if(p_lcd->transport != NULL)
+	{
+		if(!p_lcd->transport->init(p_lcd))
+		{
+			p_lcd->_status = __LCD_STATUS_ERROR;
+			return false;
+		}
+
+#if LCD_CFG_TRACE
+		_lcd_trace(p_lcd, LCD_TRACE_INIT_NIBBLE, 0x2);
+#endif
+		p_lcd->transport->send_init_nibble(p_lcd, 0x2, LCD_TIMING_INIT_US);
+	}
+	else
+	{
+		_lcd_gpio_init(p_lcd);
 
-	_lcd_send_init_nibble(p_lcd);
+		if(p_lcd->bus_8bit) _lcd_send_init_8bit(p_lcd);
+		else _lcd_send_init_nibble(p_lcd);
+	}
 
 	/*Default Settings*/
-	_lcd_send_byte(p_lcd, false, 0x28);
+	if(p_lcd->bus_8bit) _lcd_send_byte(p_lcd, false, 0x38);
+	else _lcd_send_byte(p_lcd, false, 0x28);
 	_lcd_send_byte(p_lcd, false, 0x01);
 	_lcd_send_byte(p_lcd, false, 0x80);
+
+	/*Busy flag check: once ready, the address counter must read back 0x00. Otherwise keep the timed profile.*/
+	if(p_lcd->use_rw && (p_lcd->transport == NULL))
+	{
+		p_lcd->_bf_ok = true;
+		_lcd_wait_ready(p_lcd);
+
+		if(p_lcd->_bf_ok)
+		{
+			_lcd_set_data_dir(p_lcd, false);
+			if(_lcd_read_bf_ac(p_lcd) != 0x00) p_lcd->_bf_ok = false;
+			_lcd_set_data_dir(p_lcd, true);
+		}
+	}
+
 	_lcd_send_byte(p_lcd, false, 0x0c);
+	_lcd_transport_flush(p_lcd);
 
 	p_lcd->_status = __LCD_STATUS_INITIALIZED;
 	return true;
 }
 
-bool lcd_clear(const lcd_t *p_lcd)
+bool lcd_clear(lcd_t *p_lcd)
 {
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		uint8_t idx;
+
+		for(idx = 0u; idx < LCD_DDRAM_SIZE; idx++) _lcd_fb_set(p_lcd, idx, ' ');
+
+		p_lcd->_fb_idx = 0u;
+		return true;
+	}
+#endif
+
 	_lcd_send_byte(p_lcd, false, 0x01);
+	_lcd_transport_flush(p_lcd);
+
 	return true;
 }
 
-bool lcd_home(const lcd_t *p_lcd)
+bool lcd_home(lcd_t *p_lcd)
 {
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		p_lcd->_fb_idx = 0u;
+		return true;
+	}
+#endif
+
 	_lcd_send_byte(p_lcd, false, 0x02);
+	_lcd_transport_flush(p_lcd);
+
 	return true;
 }
 
-bool lcd_set_display_mode(const lcd_t *p_lcd, intptr_t display_mode)
+bool lcd_set_display_mode(lcd_t *p_lcd, intptr_t display_mode)
 {
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
+	/*A visible cursor shows the address counter*/
+	if((display_mode == LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_ON) || (display_mode == LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK)) _lcd_sync_cursor(p_lcd);
+
 	switch(display_mode)
 	{
 		case LCD_DISPLAYMODE_DISPLAY_OFF:
 			_lcd_send_byte(p_lcd, false, 0x08);
-			return true;
+			break;
 
 		case LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_OFF:
 			_lcd_send_byte(p_lcd, false, 0x0c);
-			return true;
+			break;
 
 		case LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_ON:
 			_lcd_send_byte(p_lcd, false, 0x0e);
-			return true;
+			break;
 
 		case LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK:
 			_lcd_send_byte(p_lcd, false, 0x0f);
-			return true;
+			break;
+
+		default:
+			return false;
 	}
 
-	return false;
+	_lcd_transport_flush(p_lcd);
+	return true;
 }
 
-bool lcd_set_cursor_pos(const lcd_t *p_lcd, uint8_t cx, uint8_t cy)
+bool lcd_set_cursor_pos(lcd_t *p_lcd, uint8_t cx, uint8_t cy)
 {
-	uint8_t num8;
+	uint8_t addr;
 
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
-	if(!_phys_text_cx_cy_to_virt_text_cx_cy(p_lcd, &cx, &cy, cx, cy)) return false;
+	if(!_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, cy)) return false;
 
-	if(cy) _lcd_send_byte(p_lcd, false, 0xc0);
-	else _lcd_send_byte(p_lcd, false, 0x80);
-
-	num8 = 0u;
-	while(num8 < cx)
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
 	{
-		_lcd_send_byte(p_lcd, false, 0x14);
-		num8++;
+		p_lcd->_fb_idx = _lcd_ddram_addr_to_idx(addr);
+		return true;
 	}
+#endif
+
+	_lcd_send_byte(p_lcd, false, (0x80 | addr));
+	_lcd_transport_flush(p_lcd);
 
 	return true;
 }
 
-bool lcd_print_char(const lcd_t *p_lcd, char c)
+bool lcd_print_char(lcd_t *p_lcd, char c)
 {
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
-	_lcd_send_byte(p_lcd, true, (uint8_t) c);
+	_lcd_put_char(p_lcd, (uint8_t) c);
+	_lcd_transport_flush(p_lcd);
+
 	return true;
 }
 
-bool lcd_print_text(const lcd_t *p_lcd, const char *text)
+bool lcd_print_text(lcd_t *p_lcd, const char *text)
 {
 	uintptr_t len;
 
@@ -152,7 +430,7 @@ bool lcd_print_text(const lcd_t *p_lcd, const char *text)
 	return true;
 }
 
-bool lcd_print_text_deflen(const lcd_t *p_lcd, const char *text, uintptr_t len)
+bool lcd_print_text_deflen(lcd_t *p_lcd, const char *text, uintptr_t len)
 {
 	uintptr_t n_char;
 
@@ -163,114 +441,1792 @@ bool lcd_print_text_deflen(const lcd_t *p_lcd, const char *text, uintptr_t len)
 	n_char = 0u;
 	while(n_char < len)
 	{
-		_lcd_send_byte(p_lcd, true, (uint8_t) text[n_char]);
+		_lcd_put_char(p_lcd, (uint8_t) text[n_char]);
 		n_char++;
 	}
 
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_print_text_utf8(lcd_t *p_lcd, const char *text)
+{
+	uintptr_t len;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(text == NULL) return false;
+
+	len = 0u;
+	while(text[len] != '\0') len++;
+
+	lcd_print_text_utf8_deflen(p_lcd, text, len);
+
+	return true;
+}
+
+bool lcd_print_text_utf8_deflen(lcd_t *p_lcd, const char *text, uintptr_t len)
+{
+	uintptr_t n_byte;
+	uint32_t codepoint;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(text == NULL) return false;
+
+	n_byte = 0u;
+	while(n_byte < len)
+	{
+		n_byte += _lcd_utf8_decode((const uint8_t*) &(text[n_byte]), (len - n_byte), &codepoint);
+		_lcd_put_codepoint(p_lcd, codepoint);
+	}
+
+	_lcd_transport_flush(p_lcd);
 	return true;
 }
 
-bool lcd_fill_screen_char(const lcd_t *p_lcd, char c)
+bool lcd_print_uint(lcd_t *p_lcd, uint32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return _lcd_put_number(p_lcd, value, false, 10u, 0u, width, align, pad);
+}
+
+bool lcd_print_int(lcd_t *p_lcd, int32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return lcd_print_fixed(p_lcd, value, 0u, width, align, pad);
+}
+
+bool lcd_print_fixed(lcd_t *p_lcd, int32_t value, uint8_t n_decimals, uint8_t width, intptr_t align, char pad)
 {
-	uint8_t n_chars;
-	uint8_t n_lines;
+	uint32_t magnitude;
 
+	if(n_decimals > 9u) return false;
+
+	/*-INT32_MIN doesn't fit in an int32_t*/
+	if(value < 0) magnitude = ((uint32_t) (-(value + 1))) + 1u;
+	else magnitude = (uint32_t) value;
+
+	return _lcd_put_number(p_lcd, magnitude, (value < 0), 10u, n_decimals, width, align, pad);
+}
+
+bool lcd_print_hex(lcd_t *p_lcd, uint32_t value, uint8_t width, intptr_t align, char pad)
+{
+	return _lcd_put_number(p_lcd, value, false, 16u, 0u, width, align, pad);
+}
+
+bool lcd_fill_screen_char(lcd_t *p_lcd, char c)
+{
+	if(p_lcd == NULL) return false;
+
+	return lcd_fill_rect(p_lcd, 0u, 0u, p_lcd->n_chars, p_lcd->n_lines, c);
+}
+
+bool lcd_fill_rect(lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c)
+{
+	uint8_t cursor;
+	uint8_t addr;
+	uint8_t idx;
+	uint8_t n_line;
 	uint8_t n_char;
+	bool clear;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(!_lcd_validate_rect(p_lcd, cx, cy, width, height)) return false;
+
+	addr = 0u;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		cursor = p_lcd->_fb_idx;
+
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, n_line);
+			p_lcd->_fb_idx = _lcd_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < width; n_char++) _lcd_fb_write(p_lcd, (uint8_t) c);
+		}
+
+		p_lcd->_fb_idx = cursor;
+		return true;
+	}
+#endif
+
+	if(p_lcd->_ac_pending < LCD_DDRAM_SIZE) cursor = p_lcd->_ac_pending;
+	else cursor = p_lcd->_ac;
+
+	_lcd_plan_fill(p_lcd, cx, cy, width, height, (uint8_t) c, &clear);
+
+	if(clear)
+	{
+#if LCD_CFG_FRAMEBUFFER
+		/*The RAM shadow becomes what the screen must show afterwards, and the clear leaves it in place to be replayed*/
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, n_line);
+			memset(&(p_lcd->_fb[_lcd_ddram_addr_to_idx(addr)]), (uint8_t) c, width);
+		}
+
+		_lcd_fb_blank_hidden(p_lcd);
+
+		p_lcd->_fb_keep = true;
+		_lcd_send_byte(p_lcd, false, 0x01);
+		p_lcd->_fb_keep = false;
+
+		/*Only the cells that aren't blank are sent*/
+		for(n_line = 0u; n_line < p_lcd->n_lines; n_line++)
+		{
+			_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, 0u, n_line);
+			idx = _lcd_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < p_lcd->n_chars; n_char++)
+			{
+				if(p_lcd->_fb[idx] != ' ')
+				{
+					p_lcd->_ac_pending = idx;
+					_lcd_put_char(p_lcd, p_lcd->_fb[idx]);
+				}
+
+				idx = _lcd_next_idx(idx);
+			}
+		}
+#else
+		_lcd_send_byte(p_lcd, false, 0x01);
+#endif
+	}
+	else
+	{
+		/*Cell by cell: the address counter is only moved over the cells that don't need sending*/
+		for(n_line = cy; n_line < (cy + height); n_line++)
+		{
+			_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, n_line);
+			idx = _lcd_ddram_addr_to_idx(addr);
+
+			for(n_char = 0u; n_char < width; n_char++)
+			{
+#if LCD_CFG_FRAMEBUFFER
+				if(p_lcd->_fb[idx] == (uint8_t) c)
+				{
+					p_lcd->_n_skipped++;
+#if LCD_CFG_STATS
+					p_lcd->_stats.n_skipped++;
+#endif
+					idx = _lcd_next_idx(idx);
+					continue;
+				}
+#endif
+				p_lcd->_ac_pending = idx;
+				_lcd_put_char(p_lcd, (uint8_t) c);
+
+				idx = _lcd_next_idx(idx);
+			}
+		}
+	}
+
+	/*The cursor stays where it was*/
+	p_lcd->_ac_pending = cursor;
+	if(p_lcd->_display_ctrl & 0x03) _lcd_sync_cursor(p_lcd);
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_clear_line(lcd_t *p_lcd, uint8_t cy)
+{
+	if(p_lcd == NULL) return false;
+
+	return lcd_fill_rect(p_lcd, 0u, cy, p_lcd->n_chars, 1u, ' ');
+}
+
+bool lcd_clear_rect(lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height)
+{
+	return lcd_fill_rect(p_lcd, cx, cy, width, height, ' ');
+}
+
+bool lcd_estimate_fill_rect(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c, uint32_t *p_us)
+{
+	bool clear;
+
+	if(p_lcd == NULL) return false;
+	if(p_us == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(!_lcd_validate_rect(p_lcd, cx, cy, width, height)) return false;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		*p_us = 0u;
+		return true;
+	}
+#endif
+
+	*p_us = _lcd_plan_fill(p_lcd, cx, cy, width, height, (uint8_t) c, &clear);
+	return true;
+}
+
+bool _lcd_validate_rect(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height)
+{
+	if(!width || !height) return false;
+	if((cx >= p_lcd->n_chars) || (cy >= p_lcd->n_lines)) return false;
+	if(width > (p_lcd->n_chars - cx)) return false;
+	if(height > (p_lcd->n_lines - cy)) return false;
+
+	return true;
+}
+
+/*
+ * Execution time of filling a rectangle with "byte", the cheaper of:
+ * - address set plus data runs over the cells that differ from the RAM shadow, skipping the others
+ *   (every cell without the shadow). Resending unchanged cells to bridge two runs never beats an address set:
+ *   a data write takes longer than an instruction in every timing profile.
+ * - clear display (1.52ms), then the cells of the whole screen that aren't blank afterwards.
+ *   Without the shadow, only for a blank fill of the whole screen.
+ * Return home is never considered: it takes as long as a clear display, where an address set takes 37us.
+ * Sets "p_clear" if the clear display is the cheaper one. The address sets follow the address counter,
+ * as _lcd_put_field() does, and moving a visible cursor back in place afterwards is counted.
+ */
+
+uint32_t _lcd_plan_fill(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, uint8_t byte, bool *p_clear)
+{
+	uint32_t cost_diff;
+	uint32_t cost_clear;
+	uint8_t cursor;
+	uint8_t ac;
+	uint8_t addr;
+	uint8_t idx;
 	uint8_t n_line;
+	uint8_t n_char;
+#if LCD_CFG_FRAMEBUFFER
+	uint8_t target;
+#endif
+
+	*p_clear = false;
+	addr = 0u;
+
+	if(p_lcd->_ac_pending < LCD_DDRAM_SIZE) cursor = p_lcd->_ac_pending;
+	else cursor = p_lcd->_ac;
+
+	cost_diff = 0u;
+	ac = p_lcd->_ac;
+
+	for(n_line = cy; n_line < (cy + height); n_line++)
+	{
+		_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, n_line);
+		idx = _lcd_ddram_addr_to_idx(addr);
+
+		for(n_char = 0u; n_char < width; n_char++)
+		{
+#if LCD_CFG_FRAMEBUFFER
+			if(p_lcd->_fb[idx] != byte) cost_diff += _lcd_plan_cell(&ac, idx);
+#else
+			cost_diff += _lcd_plan_cell(&ac, idx);
+#endif
+			idx = _lcd_next_idx(idx);
+		}
+	}
+
+	if((p_lcd->_display_ctrl & 0x03) && (cursor < LCD_DDRAM_SIZE) && (ac != cursor)) cost_diff += _lcd_exec_time_us(false, 0x80);
+
+#if LCD_CFG_FRAMEBUFFER
+	cost_clear = _lcd_exec_time_us(false, 0x01);
+	ac = 0u;
+
+	for(n_line = 0u; n_line < p_lcd->n_lines; n_line++)
+	{
+		_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, 0u, n_line);
+		idx = _lcd_ddram_addr_to_idx(addr);
+
+		for(n_char = 0u; n_char < p_lcd->n_chars; n_char++)
+		{
+			if((n_line >= cy) && (n_line < (cy + height)) && (n_char >= cx) && (n_char < (cx + width))) target = byte;
+			else target = p_lcd->_fb[idx];
+
+			if(target != ' ') cost_clear += _lcd_plan_cell(&ac, idx);
+			idx = _lcd_next_idx(idx);
+		}
+	}
+#else
+	if((byte != ' ') || (width != p_lcd->n_chars) || (height != p_lcd->n_lines)) return cost_diff;
+
+	cost_clear = _lcd_exec_time_us(false, 0x01);
+	ac = 0u;
+#endif
+
+	if((p_lcd->_display_ctrl & 0x03) && (cursor < LCD_DDRAM_SIZE) && (ac != cursor)) cost_clear += _lcd_exec_time_us(false, 0x80);
 
+	if(cost_clear >= cost_diff) return cost_diff;
+
+	*p_clear = true;
+	return cost_clear;
+}
+
+/*Execution time of sending the cell at DDRAM index "idx" with the address counter at "*p_ac" (moved past it)*/
+
+uint32_t _lcd_plan_cell(uint8_t *p_ac, uint8_t idx)
+{
+	uint32_t cost;
+
+	cost = _lcd_exec_time_us(true, 0x00);
+	if(*p_ac != idx) cost += _lcd_exec_time_us(false, 0x80);
+
+	*p_ac = _lcd_next_idx(idx);
+	return cost;
+}
+
+#if LCD_CFG_FRAMEBUFFER
+bool lcd_set_framebuffer_mode(lcd_t *p_lcd, bool enable)
+{
 	if(p_lcd == NULL) return false;
 	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
-	n_chars = p_lcd->n_chars;
-	n_lines = p_lcd->n_lines;
+	if(enable == p_lcd->_fb_mode) return true;
 
-	for(n_line = 0u; n_line < n_lines; n_line++)
+	if(enable)
 	{
-		lcd_set_cursor_pos(p_lcd, 0u, n_line);
+		if(p_lcd->_ac_pending < LCD_DDRAM_SIZE) p_lcd->_fb_idx = p_lcd->_ac_pending;
+		else if(p_lcd->_ac < LCD_DDRAM_SIZE) p_lcd->_fb_idx = p_lcd->_ac;
+		else p_lcd->_fb_idx = 0u;
 
-		for(n_char = 0u; n_char < n_chars; n_char++)
-			lcd_print_char(p_lcd, c);
+		p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+
+		p_lcd->_fb_mode = true;
+		return true;
 	}
 
+	lcd_flush(p_lcd);
+	p_lcd->_fb_mode = false;
+
+	if(p_lcd->_ac != p_lcd->_fb_idx) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(p_lcd->_fb_idx)));
+	_lcd_transport_flush(p_lcd);
+
 	return true;
 }
 
-void _lcd_send_byte(const lcd_t *p_lcd, bool reg, uint8_t byte)
+bool lcd_flush(lcd_t *p_lcd)
 {
-	gpio_put(p_lcd->e, 0);
-	gpio_put(p_lcd->rs, reg);
-	sleep_us(__LCD_EN_DELAY_US);
+	uint8_t n_cell;
+	uint8_t idx;
 
-	_lcd_write_nibble(p_lcd, (byte >> 4));
-	gpio_put(p_lcd->e, 1);
-	sleep_us(__LCD_EN_DELAY_US);
-	gpio_put(p_lcd->e, 0);
-	sleep_us(__LCD_EN_DELAY_US);
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
 
-	_lcd_write_nibble(p_lcd, (byte & 0xf));
-	gpio_put(p_lcd->e, 1);
-	sleep_us(__LCD_EN_DELAY_US);
-	gpio_put(p_lcd->e, 0);
-	sleep_us(__LCD_CMD_DELAY_US);
+	/*
+	 * Walk the DDRAM in address counter order, starting from the current address counter,
+	 * so that runs of changed cells (including runs crossing from one display line into the next) cost a single address set.
+	 * Gaps of unchanged cells are skipped with an address set: resending them never beats it, as a data write takes
+	 * longer than an instruction in every timing profile.
+	 */
+
+	if(p_lcd->_ac < LCD_DDRAM_SIZE) idx = p_lcd->_ac;
+	else idx = 0u;
+
+	for(n_cell = 0u; n_cell < LCD_DDRAM_SIZE; n_cell++)
+	{
+		if(_lcd_fb_is_dirty(p_lcd, idx))
+		{
+			if(p_lcd->_ac != idx) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(idx)));
+
+			_lcd_send_byte(p_lcd, true, p_lcd->_fb[idx]);
+		}
+
+		idx = _lcd_next_idx(idx);
+	}
+
+	/*Keep the visible cursor where the application left it*/
+	if((p_lcd->_display_ctrl & 0x03) && (p_lcd->_ac != p_lcd->_fb_idx)) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(p_lcd->_fb_idx)));
+	_lcd_transport_flush(p_lcd);
+
+	return true;
+}
+
+uintptr_t lcd_get_n_skipped_bytes(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return 0u;
+
+	return p_lcd->_n_skipped;
+}
+
+void _lcd_fb_write(lcd_t *p_lcd, uint8_t byte)
+{
+	if((p_lcd->_fb[p_lcd->_fb_idx] == byte) || _lcd_fb_is_dirty(p_lcd, p_lcd->_fb_idx))
+	{
+		p_lcd->_n_skipped++;
+#if LCD_CFG_STATS
+		p_lcd->_stats.n_skipped++;
+#endif
+	}
+
+	_lcd_fb_set(p_lcd, p_lcd->_fb_idx, byte);
+	p_lcd->_fb_idx = _lcd_next_idx(p_lcd->_fb_idx);
 
 	return;
 }
 
-void _lcd_write_nibble(const lcd_t *p_lcd, uint8_t nibble)
+void _lcd_fb_set(lcd_t *p_lcd, uint8_t idx, uint8_t byte)
 {
-	gpio_put(p_lcd->db7, (nibble & 0x8));
-	gpio_put(p_lcd->db6, (nibble & 0x4));
-	gpio_put(p_lcd->db5, (nibble & 0x2));
-	gpio_put(p_lcd->db4, (nibble & 0x1));
+	if(p_lcd->_fb[idx] == byte) return;
+
+	p_lcd->_fb[idx] = byte;
+	_lcd_fb_set_dirty(p_lcd, idx, true);
 
 	return;
 }
 
-void _lcd_send_init_nibble(const lcd_t *p_lcd)
+bool _lcd_fb_is_dirty(const lcd_t *p_lcd, uint8_t idx)
 {
-	gpio_put(p_lcd->e, 0);
-	gpio_put(p_lcd->rs, 0);
-	sleep_us(__LCD_EN_DELAY_US);
+	return ((p_lcd->_fb_dirty[idx >> 3] >> (idx & 0x7)) & 0x1);
+}
 
-	_lcd_write_nibble(p_lcd, 0x2);
-	gpio_put(p_lcd->e, 1);
-	sleep_us(__LCD_EN_DELAY_US);
-	gpio_put(p_lcd->e, 0);
-	sleep_us((__LCD_CMD_DELAY_US << 1));
+void _lcd_fb_set_dirty(lcd_t *p_lcd, uint8_t idx, bool dirty)
+{
+	if(dirty) p_lcd->_fb_dirty[idx >> 3] |= (1u << (idx & 0x7));
+	else p_lcd->_fb_dirty[idx >> 3] &= ~(1u << (idx & 0x7));
 
 	return;
 }
 
-bool _lcd_validate_info(const lcd_t *p_lcd)
+/*Blanks the shadow cells that no line of the screen shows, as a clear display does*/
+void _lcd_fb_blank_hidden(lcd_t *p_lcd)
 {
-	uintptr_t n_byte;
+	uint8_t idx;
+	uint8_t start;
+	uint8_t n_line;
+	bool shown;
 
-	for(n_byte = 0u; n_byte < 8u; n_byte++) if(((const uint8_t*) p_lcd)[n_byte] == 0xff) return false;
+	for(idx = 0u; idx < LCD_DDRAM_SIZE; idx++)
+	{
+		shown = false;
 
-	if(!p_lcd->n_chars) return false;
-	if(!p_lcd->n_lines) return false;
+		for(n_line = 0u; n_line < p_lcd->n_lines; n_line++)
+		{
+			start = _lcd_ddram_addr_to_idx(p_lcd->_line_addr[n_line]);
+			if((idx >= start) && (idx < (start + p_lcd->n_chars))) shown = true;
+		}
 
-	return true;
+		if(!shown) p_lcd->_fb[idx] = ' ';
+	}
+
+	return;
 }
+#endif
 
-bool _phys_text_cx_cy_to_virt_text_cx_cy(const lcd_t *p_lcd, uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy)
+#if LCD_CFG_GLYPHS
+bool lcd_set_glyph_table(lcd_t *p_lcd, const lcd_glyph_t *glyphs, uint16_t n_glyphs)
 {
-	uint8_t virtcx;
-	uint8_t virtcy;
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if((glyphs == NULL) && n_glyphs) return false;
+	if(n_glyphs >= LCD_GLYPH_NONE) return false;
 
-	if(physcx >= p_lcd->n_chars) return false;
-	if(physcy >= p_lcd->n_lines) return false;
+	p_lcd->_glyphs = glyphs;
+	p_lcd->_n_glyphs = n_glyphs;
+	_lcd_glyph_forget_slots(p_lcd);
 
-	virtcy = (physcy & 0x1);
+	return true;
+}
 
-	virtcx = physcx;
-	physcy = (physcy >> 1);
+bool lcd_print_glyph(lcd_t *p_lcd, uint16_t glyph_id)
+{
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(glyph_id >= p_lcd->_n_glyphs) return false;
 
-	virtcx += physcy*(p_lcd->n_chars);
+	if(!_lcd_put_glyph(p_lcd, glyph_id)) return false;
 
-	if(p_virtcx != NULL) *p_virtcx = virtcx;
-	if(p_virtcy != NULL) *p_virtcy = virtcy;
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
 
+bool lcd_get_glyph_stats(const lcd_t *p_lcd, lcd_glyph_stats_t *p_stats)
+{
+	if(p_lcd == NULL) return false;
+	if(p_stats == NULL) return false;
+
+	*p_stats = p_lcd->_glyph_stats;
 	return true;
 }
 
+void lcd_reset_glyph_stats(lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return;
+
+	memset(&(p_lcd->_glyph_stats), 0, sizeof(lcd_glyph_stats_t));
+	return;
+}
+
+bool _lcd_put_glyph(lcd_t *p_lcd, uint16_t glyph_id)
+{
+	uint8_t idx;
+	uint8_t slot;
+
+	if(!p_lcd->_fb_mode) _lcd_sync_cursor(p_lcd);
+
+	/*An upload moves the address counter to CGRAM: remember the cell the glyph goes to*/
+	idx = p_lcd->_ac;
+	if(!p_lcd->_fb_mode && (idx >= LCD_DDRAM_SIZE)) return false;
+
+	slot = _lcd_glyph_acquire(p_lcd, glyph_id);
+
+	if(!p_lcd->_fb_mode && (p_lcd->_ac != idx)) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(idx)));
+
+	_lcd_put_char(p_lcd, slot);
+	return true;
+}
+
+uint16_t _lcd_glyph_find(const lcd_t *p_lcd, uint32_t codepoint)
+{
+	uint16_t glyph_id;
+
+	if((codepoint == 0u) || (codepoint > 0xffffU)) return LCD_GLYPH_NONE;
+
+	for(glyph_id = 0u; glyph_id < p_lcd->_n_glyphs; glyph_id++)
+	{
+		if(p_lcd->_glyphs[glyph_id].codepoint == codepoint) return glyph_id;
+	}
+
+	return LCD_GLYPH_NONE;
+}
+
+/*
+ * LRU order: _glyph_lru[] lists the slots from the most to the least recently printed.
+ * Empty slots start at the end, lowest slot last, so they are taken from slot 0 up.
+ */
+
+void _lcd_glyph_forget_slots(lcd_t *p_lcd)
+{
+	uint8_t n_slot;
+
+	for(n_slot = 0u; n_slot < LCD_CGRAM_SLOTS; n_slot++)
+	{
+		p_lcd->_glyph_slot_id[n_slot] = LCD_GLYPH_NONE;
+		p_lcd->_glyph_lru[n_slot] = (LCD_CGRAM_SLOTS - 1u - n_slot);
+	}
+
+	return;
+}
+
+/*Returns the CGRAM slot (character code) holding "glyph_id", uploading it on a miss*/
+uint8_t _lcd_glyph_acquire(lcd_t *p_lcd, uint16_t glyph_id)
+{
+	uint8_t n_lru;
+	uint8_t slot;
+	uint16_t old_id;
+
+	for(n_lru = 0u; n_lru < LCD_CGRAM_SLOTS; n_lru++)
+	{
+		slot = p_lcd->_glyph_lru[n_lru];
+		if(p_lcd->_glyph_slot_id[slot] != glyph_id) continue;
+
+		p_lcd->_glyph_stats.n_hits++;
+		_lcd_glyph_touch(p_lcd, n_lru);
+		return slot;
+	}
+
+	n_lru = LCD_CGRAM_SLOTS - 1u;
+	slot = p_lcd->_glyph_lru[n_lru];
+	old_id = p_lcd->_glyph_slot_id[slot];
+
+	p_lcd->_glyph_stats.n_misses++;
+
+	if(old_id != LCD_GLYPH_NONE)
+	{
+		p_lcd->_glyph_stats.n_evictions++;
+		_lcd_glyph_repaint(p_lcd, slot, (uint8_t) p_lcd->_glyphs[old_id].fallback);
+	}
+
+	_lcd_glyph_upload(p_lcd, slot, &(p_lcd->_glyphs[glyph_id]));
+	p_lcd->_glyph_slot_id[slot] = glyph_id;
+
+	_lcd_glyph_touch(p_lcd, n_lru);
+	return slot;
+}
+
+void _lcd_glyph_touch(lcd_t *p_lcd, uint8_t n_lru)
+{
+	uint8_t slot;
+
+	slot = p_lcd->_glyph_lru[n_lru];
+
+	while(n_lru > 0u)
+	{
+		p_lcd->_glyph_lru[n_lru] = p_lcd->_glyph_lru[n_lru - 1u];
+		n_lru--;
+	}
+
+	p_lcd->_glyph_lru[0] = slot;
+	return;
+}
+
+/*
+ * The RAM shadow holds every DDRAM cell (pending ones too in framebuffer mode). Character codes 0x00-0x0f all show CGRAM,
+ * 0x08-0x0f repeating 0x00-0x07 (5x8 font).
+ */
+
+void _lcd_glyph_repaint(lcd_t *p_lcd, uint8_t slot, uint8_t fallback)
+{
+	uint8_t idx;
+
+	for(idx = 0u; idx < LCD_DDRAM_SIZE; idx++)
+	{
+		if((p_lcd->_fb[idx] >= 0x10) || ((p_lcd->_fb[idx] & 0x07) != slot)) continue;
+
+		p_lcd->_glyph_stats.n_repaints++;
+
+		if(p_lcd->_fb_mode)
+		{
+			_lcd_fb_set(p_lcd, idx, fallback);
+			continue;
+		}
+
+		if(p_lcd->_ac != idx) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(idx)));
+		_lcd_send_byte(p_lcd, true, fallback);
+	}
+
+	return;
+}
+
+void _lcd_glyph_upload(lcd_t *p_lcd, uint8_t slot, const lcd_glyph_t *p_glyph)
+{
+	uint8_t n_row;
+
+	_lcd_send_byte(p_lcd, false, (0x40 | (slot << 3)));
+
+	for(n_row = 0u; n_row < 8u; n_row++) _lcd_send_byte(p_lcd, true, (p_glyph->rows[n_row] & 0x1f));
+
+	return;
+}
+#endif
+
+#if LCD_CFG_STATS
+bool lcd_get_stats(const lcd_t *p_lcd, lcd_stats_t *p_stats)
+{
+	if(p_lcd == NULL) return false;
+	if(p_stats == NULL) return false;
+
+	*p_stats = p_lcd->_stats;
+	return true;
+}
+
+void lcd_reset_stats(lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return;
+
+	memset(&(p_lcd->_stats), 0, sizeof(lcd_stats_t));
+	p_lcd->_stats_in_call = false;
+
+	return;
+}
+
+/*
+ * A call is timed from its first byte sent (or the start of lcd_init()) to its closing transport flush.
+ * Calls that send nothing (framebuffer mode) never block and aren't timed.
+ */
+
+void _lcd_stats_call_begin(lcd_t *p_lcd)
+{
+	if(p_lcd->_stats_in_call) return;
+
+	p_lcd->_stats_in_call = true;
+	p_lcd->_stats_t_call = time_us_32();
+
+	return;
+}
+
+void _lcd_stats_call_end(lcd_t *p_lcd)
+{
+	uint32_t call_us;
+
+	if(!p_lcd->_stats_in_call) return;
+
+	call_us = time_us_32() - p_lcd->_stats_t_call;
+	if(call_us > p_lcd->_stats.max_call_us) p_lcd->_stats.max_call_us = call_us;
+
+	p_lcd->_stats_in_call = false;
+	return;
+}
+
+void _lcd_stats_count_byte(lcd_t *p_lcd, bool reg, uint8_t byte)
+{
+	_lcd_stats_call_begin(p_lcd);
+
+	if(reg)
+	{
+		p_lcd->_stats.n_data++;
+		return;
+	}
+
+	p_lcd->_stats.n_cmds++;
+	if((byte == 0x01) || ((byte & 0xfe) == 0x02)) p_lcd->_stats.n_clear_home++;
+
+	return;
+}
+#endif
+
+#if LCD_CFG_TRACE
+uintptr_t lcd_get_trace(const lcd_t *p_lcd, lcd_trace_entry_t *p_entries, uintptr_t max_entries)
+{
+	uint32_t head;
+	uint32_t first;
+	uint32_t n_entries;
+	uint32_t n_entry;
+	uint32_t n_lost;
+
+	if(p_lcd == NULL) return 0u;
+	if(p_entries == NULL) return 0u;
+
+	head = p_lcd->_trace_head;
+	__dmb();
+
+	/*The slot at the head is the one the writer fills next: up to LCD_CFG_TRACE_SIZE - 1 complete entries behind it*/
+	n_entries = head;
+	if(n_entries > (LCD_CFG_TRACE_SIZE - 1u)) n_entries = LCD_CFG_TRACE_SIZE - 1u;
+	if(n_entries > max_entries) n_entries = (uint32_t) max_entries;
+
+	first = head - n_entries;
+
+	for(n_entry = 0u; n_entry < n_entries; n_entry++) p_entries[n_entry] = p_lcd->_trace[(first + n_entry) & __LCD_TRACE_MASK];
+
+	/*The writer may have moved on during the copy: entries more than LCD_CFG_TRACE_SIZE - 1 behind the new head are (being) overwritten*/
+	__dmb();
+	head = p_lcd->_trace_head;
+
+	if((head - first) < LCD_CFG_TRACE_SIZE) return n_entries;
+
+	n_lost = (head - first) - (LCD_CFG_TRACE_SIZE - 1u);
+	if(n_lost >= n_entries) return 0u;
+
+	memmove(p_entries, &(p_entries[n_lost]), (n_entries - n_lost)*sizeof(lcd_trace_entry_t));
+
+	return (n_entries - n_lost);
+}
+
+void lcd_clear_trace(lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return;
+
+	p_lcd->_trace_head = 0u;
+	return;
+}
+
+/*
+ * Single producer: the caller (synchronous mode) or the alarm callback (async mode), never both.
+ * The entry is complete before the head moves, so readers never see a half written one.
+ */
+
+void _lcd_trace(lcd_t *p_lcd, uint8_t kind, uint8_t value)
+{
+	lcd_trace_entry_t *p_entry;
+
+	p_entry = &(p_lcd->_trace[p_lcd->_trace_head & __LCD_TRACE_MASK]);
+	p_entry->t_us = time_us_32();
+	p_entry->kind = kind;
+	p_entry->value = value;
+
+	__dmb();
+	p_lcd->_trace_head++;
+
+	return;
+}
+#endif
+
+void _lcd_put_char(lcd_t *p_lcd, uint8_t byte)
+{
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		_lcd_fb_write(p_lcd, byte);
+		return;
+	}
+#endif
+
+	_lcd_sync_cursor(p_lcd);
+	_lcd_send_byte(p_lcd, true, byte);
+	return;
+}
+
+/*
+ * Fields leave the cells they didn't change unsent, so the address counter can lag behind the cursor.
+ * The cursor is then kept in _ac_pending until something needs the address counter there.
+ */
+
+void _lcd_sync_cursor(lcd_t *p_lcd)
+{
+	if(p_lcd->_ac_pending == __LCD_AC_UNKNOWN) return;
+
+	if(p_lcd->_ac != p_lcd->_ac_pending) _lcd_send_byte(p_lcd, false, (0x80 | _lcd_idx_to_ddram_addr(p_lcd->_ac_pending)));
+	p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+
+	return;
+}
+
+/*
+ * Same as lcd_set_cursor_pos(), except the address is only sent once a character needs it
+ * (nothing is sent if the characters printed there are already on the display).
+ */
+
+bool _lcd_set_cursor_lazy(lcd_t *p_lcd, uint8_t cx, uint8_t cy)
+{
+	uint8_t addr;
+
+	if(!_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, cx, cy)) return false;
+
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode)
+	{
+		p_lcd->_fb_idx = _lcd_ddram_addr_to_idx(addr);
+		return true;
+	}
+#endif
+
+	p_lcd->_ac_pending = _lcd_ddram_addr_to_idx(addr);
+	if(p_lcd->_display_ctrl & 0x03) _lcd_sync_cursor(p_lcd);
+
+	return true;
+}
+
+bool _lcd_put_number(lcd_t *p_lcd, uint32_t magnitude, bool negative, uint8_t base, uint8_t n_decimals, uint8_t width, intptr_t align, char pad)
+{
+	uint8_t field[LCD_DDRAM_LINE_SIZE];
+	uint8_t n_digits;
+	uint8_t len;
+	uint8_t n_pad;
+	uint8_t n_char;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(width > LCD_DDRAM_LINE_SIZE) return false;
+	if((align != LCD_ALIGN_RIGHT) && (align != LCD_ALIGN_LEFT)) return false;
+
+	/*Formatted at the end of the field (up to 11 characters), moved into place below*/
+	n_digits = _lcd_format_number(&(field[LCD_DDRAM_LINE_SIZE]), magnitude, base, n_decimals);
+	len = n_digits + (negative ? 1u : 0u);
+
+	if(!width) width = len;
+
+	if(len > width)
+	{
+		memset(field, '#', width);
+		_lcd_put_field(p_lcd, field, width);
+		_lcd_transport_flush(p_lcd);
+
+		return true;
+	}
+
+	n_pad = width - len;
+
+	if(align == LCD_ALIGN_RIGHT) n_char = width - n_digits;
+	else n_char = len - n_digits;
+
+	memmove(&(field[n_char]), &(field[LCD_DDRAM_LINE_SIZE - n_digits]), n_digits);
+
+	/*Sign and padding around the digits: "  -12", "-0012" or "-12  "*/
+	if(align == LCD_ALIGN_LEFT)
+	{
+		if(negative) field[0] = '-';
+		memset(&(field[len]), pad, n_pad);
+	}
+	else if(pad == '0')
+	{
+		if(negative) field[0] = '-';
+		memset(&(field[len - n_digits]), '0', n_pad);
+	}
+	else
+	{
+		memset(field, pad, n_pad);
+		if(negative) field[n_pad] = '-';
+	}
+
+	_lcd_put_field(p_lcd, field, width);
+	_lcd_transport_flush(p_lcd);
+
+	return true;
+}
+
+/*
+ * Writes the digits of "magnitude" backwards from "p_end", with a point before the last "n_decimals" of them
+ * and at least one digit before the point.
+ * returns the number of characters written (up to 11).
+ */
+
+uint8_t _lcd_format_number(uint8_t *p_end, uint32_t magnitude, uint8_t base, uint8_t n_decimals)
+{
+	uint8_t len;
+	uint8_t n_digits;
+	uint8_t digit;
+
+	len = 0u;
+	n_digits = 0u;
+
+	do
+	{
+		if(n_decimals && (n_digits == n_decimals))
+		{
+			p_end--;
+			*p_end = '.';
+			len++;
+		}
+
+		digit = (uint8_t) (magnitude % base);
+		magnitude /= base;
+
+		p_end--;
+		*p_end = "0123456789ABCDEF"[digit];
+
+		n_digits++;
+		len++;
+	} while(magnitude || (n_digits <= n_decimals));
+
+	return len;
+}
+
+/*
+ * Prints "len" characters at the cursor. Outside framebuffer mode, the RAM shadow holds what the display shows,
+ * so only the characters that differ are sent: an unchanged field costs nothing.
+ */
+
+void _lcd_put_field(lcd_t *p_lcd, const uint8_t *p_field, uint8_t len)
+{
+	uint8_t n_char;
+#if LCD_CFG_FRAMEBUFFER
+	uint8_t idx;
+
+	if(p_lcd->_ac_pending < LCD_DDRAM_SIZE) idx = p_lcd->_ac_pending;
+	else idx = p_lcd->_ac;
+
+	if(!p_lcd->_fb_mode && (idx < LCD_DDRAM_SIZE))
+	{
+		for(n_char = 0u; n_char < len; n_char++)
+		{
+			if(p_lcd->_fb[idx] != p_field[n_char])
+			{
+				p_lcd->_ac_pending = idx;
+				_lcd_put_char(p_lcd, p_field[n_char]);
+			}
+			else
+			{
+				p_lcd->_n_skipped++;
+#if LCD_CFG_STATS
+				p_lcd->_stats.n_skipped++;
+#endif
+			}
+
+			idx = _lcd_next_idx(idx);
+		}
+
+		p_lcd->_ac_pending = idx;
+		if(p_lcd->_display_ctrl & 0x03) _lcd_sync_cursor(p_lcd);
+
+		return;
+	}
+#endif
+
+	for(n_char = 0u; n_char < len; n_char++) _lcd_put_char(p_lcd, p_field[n_char]);
+
+	return;
+}
+
+/*ROM character, else glyph of the glyph table, else replacement character*/
+void _lcd_put_codepoint(lcd_t *p_lcd, uint32_t codepoint)
+{
+	uint8_t code;
+#if LCD_CFG_GLYPHS
+	uint16_t glyph_id;
+#endif
+
+	if(_lcd_rom_lookup(codepoint, &code))
+	{
+		_lcd_put_char(p_lcd, code);
+		return;
+	}
+
+#if LCD_CFG_GLYPHS
+	glyph_id = _lcd_glyph_find(p_lcd, codepoint);
+
+	if(glyph_id != LCD_GLYPH_NONE)
+	{
+		if(!_lcd_put_glyph(p_lcd, glyph_id)) _lcd_put_char(p_lcd, (uint8_t) p_lcd->_glyphs[glyph_id].fallback);
+		return;
+	}
+#endif
+
+	_lcd_put_char(p_lcd, (uint8_t) LCD_CFG_UTF8_REPLACEMENT);
+	return;
+}
+
+/*
+ * Decodes the character at "p_text" ("len" bytes left) into "p_codepoint", __LCD_UTF8_INVALID if malformed.
+ * A malformed sequence ends before the first byte that can't continue it, so decoding resumes there.
+ * returns the number of bytes used (at least 1).
+ */
+
+uint8_t _lcd_utf8_decode(const uint8_t *p_text, uintptr_t len, uint32_t *p_codepoint)
+{
+	uint8_t n_bytes;
+	uint8_t n_byte;
+	uint32_t codepoint;
+
+	if(p_text[0] < 0x80)
+	{
+		*p_codepoint = p_text[0];
+		return 1u;
+	}
+
+	n_bytes = _lcd_utf8_len[(p_text[0] >> 3) & 0xf];
+
+	if(!n_bytes)
+	{
+		*p_codepoint = __LCD_UTF8_INVALID;
+		return 1u;
+	}
+
+	codepoint = p_text[0] & (0x7f >> n_bytes);
+
+	for(n_byte = 1u; n_byte < n_bytes; n_byte++)
+	{
+		if((n_byte >= len) || ((p_text[n_byte] & 0xc0) != 0x80))
+		{
+			*p_codepoint = __LCD_UTF8_INVALID;
+			return n_byte;
+		}
+
+		codepoint = (codepoint << 6) | (p_text[n_byte] & 0x3f);
+	}
+
+	if(codepoint < _lcd_utf8_min[n_bytes]) codepoint = __LCD_UTF8_INVALID;
+
+	*p_codepoint = codepoint;
+	return n_bytes;
+}
+
+bool _lcd_rom_lookup(uint32_t codepoint, uint8_t *p_code)
+{
+	const struct _lcd_rom_range *p_range;
+	uint8_t lo;
+	uint8_t hi;
+	uint8_t mid;
+
+	/*lo ends up as the number of ranges starting at or before the code point*/
+	lo = 0u;
+	hi = __LCD_ROM_N_RANGES;
+
+	while(lo < hi)
+	{
+		mid = (lo + hi) >> 1;
+
+		if(_lcd_rom_ranges[mid].first <= codepoint) lo = mid + 1u;
+		else hi = mid;
+	}
+
+	if(!lo) return false;
+
+	p_range = &(_lcd_rom_ranges[lo - 1u]);
+	if((codepoint - p_range->first) >= p_range->len) return false;
+
+	*p_code = p_range->code + (uint8_t) (codepoint - p_range->first);
+	return true;
+}
+
+void _lcd_track_byte(lcd_t *p_lcd, bool reg, uint8_t byte)
+{
+	/*Data write: the controller stores the byte at the address counter and increments it*/
+	if(reg)
+	{
+		if(p_lcd->_ac >= LCD_DDRAM_SIZE) return;
+
+#if LCD_CFG_FRAMEBUFFER
+		p_lcd->_fb[p_lcd->_ac] = byte;
+		_lcd_fb_set_dirty(p_lcd, p_lcd->_ac, false);
+#endif
+		p_lcd->_ac = _lcd_next_idx(p_lcd->_ac);
+		return;
+	}
+
+	if(byte & 0x80)
+	{
+		p_lcd->_ac = _lcd_ddram_addr_to_idx(byte & 0x7f);
+		p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+		return;
+	}
+
+	/*Set CGRAM address: following data writes don't touch the DDRAM*/
+	if(byte & 0x40)
+	{
+		p_lcd->_ac = __LCD_AC_UNKNOWN;
+		p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+		return;
+	}
+
+	/*Function set*/
+	if(byte & 0x20) return;
+
+	/*Cursor/display shift*/
+	if(byte & 0x10)
+	{
+		if((byte & 0x08) || (p_lcd->_ac >= LCD_DDRAM_SIZE)) return;
+
+		if(byte & 0x04) p_lcd->_ac = _lcd_next_idx(p_lcd->_ac);
+		else p_lcd->_ac = (p_lcd->_ac + LCD_DDRAM_SIZE - 1u) % LCD_DDRAM_SIZE;
+
+		return;
+	}
+
+	/*Display control*/
+	if(byte & 0x08)
+	{
+		p_lcd->_display_ctrl = byte;
+		return;
+	}
+
+	/*Entry mode set*/
+	if(byte & 0x04) return;
+
+	/*Return home*/
+	if(byte & 0x02)
+	{
+		p_lcd->_ac = 0u;
+		p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+		return;
+	}
+
+	/*Clear display*/
+	if(byte & 0x01)
+	{
+#if LCD_CFG_FRAMEBUFFER
+		/*lcd_fill_rect() replays the screen from the shadow after its clear*/
+		if(!p_lcd->_fb_keep) memset(p_lcd->_fb, ' ', LCD_DDRAM_SIZE);
+		memset(p_lcd->_fb_dirty, 0, sizeof(p_lcd->_fb_dirty));
+#endif
+		p_lcd->_ac = 0u;
+		p_lcd->_ac_pending = __LCD_AC_UNKNOWN;
+		return;
+	}
+
+	return;
+}
+
+uint8_t _lcd_ddram_addr_to_idx(uint8_t addr)
+{
+	uint8_t col;
+
+	col = (addr & 0x3f);
+	if(col >= LCD_DDRAM_LINE_SIZE) return __LCD_AC_UNKNOWN;
+
+	if(addr & 0x40) return (LCD_DDRAM_LINE_SIZE + col);
+
+	return col;
+}
+
+uint8_t _lcd_idx_to_ddram_addr(uint8_t idx)
+{
+	if(idx >= LCD_DDRAM_LINE_SIZE) return (0x40 | (idx - LCD_DDRAM_LINE_SIZE));
+
+	return idx;
+}
+
+uint8_t _lcd_next_idx(uint8_t idx)
+{
+	idx++;
+	if(idx >= LCD_DDRAM_SIZE) idx = 0u;
+
+	return idx;
+}
+
+#if LCD_CFG_ASYNC
+bool lcd_set_async_mode(lcd_t *p_lcd, bool enable)
+{
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+
+	if(enable == p_lcd->_async_mode) return true;
+
+	if(!enable)
+	{
+		lcd_wait_idle(p_lcd);
+		p_lcd->_async_mode = false;
+
+		/*The queue waited for the last execution time: the busy flag can be polled again from here*/
+		p_lcd->_bf_ok = p_lcd->_async_bf_ok;
+		p_lcd->_bf_pending_us = 0u;
+		return true;
+	}
+
+	if(p_lcd->transport != NULL) return false;
+
+	/*Let the last synchronous instruction finish before the queue takes over*/
+	if(p_lcd->_bf_ok) _lcd_wait_ready(p_lcd);
+	p_lcd->_async_bf_ok = p_lcd->_bf_ok;
+	p_lcd->_bf_ok = false;
+
+	p_lcd->_txq_head = 0u;
+	p_lcd->_txq_tail = 0u;
+	p_lcd->_async_running = false;
+	p_lcd->_async_mode = true;
+
+	return true;
+}
+
+bool lcd_is_idle(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return true;
+	if(!p_lcd->_async_mode) return true;
+
+	return ((p_lcd->_txq_head == p_lcd->_txq_tail) && !p_lcd->_async_running);
+}
+
+void lcd_wait_idle(const lcd_t *p_lcd)
+{
+	while(!lcd_is_idle(p_lcd)) tight_loop_contents();
+
+	return;
+}
+
+uint8_t lcd_get_queue_hwm(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return 0u;
+
+	return p_lcd->_txq_hwm;
+}
+
+void _lcd_txq_push(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	uint8_t n_entries;
+	uint32_t irq_status;
+	alarm_id_t alarm_id;
+	struct _lcd_txq_entry *p_entry;
+
+	/*Queue full: wait for the alarm to free an entry*/
+	while(((uint8_t) (p_lcd->_txq_head - p_lcd->_txq_tail)) >= LCD_CFG_TXQUEUE_SIZE) tight_loop_contents();
+
+	p_entry = &(p_lcd->_txq[p_lcd->_txq_head & __LCD_TXQ_MASK]);
+	p_entry->byte = byte;
+	p_entry->reg = reg;
+	p_entry->delay_us = delay_us;
+
+	__dmb();
+	p_lcd->_txq_head++;
+
+	n_entries = (uint8_t) (p_lcd->_txq_head - p_lcd->_txq_tail);
+	if(n_entries > p_lcd->_txq_hwm) p_lcd->_txq_hwm = n_entries;
+
+	alarm_id = 0;
+	irq_status = save_and_disable_interrupts();
+
+	if(!p_lcd->_async_running)
+	{
+		p_lcd->_async_running = true;
+		alarm_id = add_alarm_in_us(0u, _lcd_async_alarm_callback, p_lcd, true);
+
+		/*No alarm slot left: nothing would ever drain the queue*/
+		if(alarm_id < 0) p_lcd->_async_running = false;
+	}
+
+	restore_interrupts(irq_status);
+
+	if(alarm_id < 0) _lcd_txq_drain(p_lcd);
+
+	return;
+}
+
+/*
+ * Sends the queued bytes synchronously, waiting each execution time. Fallback when no alarm could be scheduled.
+ */
+
+void _lcd_txq_drain(lcd_t *p_lcd)
+{
+	struct _lcd_txq_entry *p_entry;
+	uint16_t delay_us;
+
+	while(p_lcd->_txq_head != p_lcd->_txq_tail)
+	{
+		p_entry = &(p_lcd->_txq[p_lcd->_txq_tail & __LCD_TXQ_MASK]);
+
+		_lcd_transmit_byte(p_lcd, p_entry->reg, p_entry->byte);
+		delay_us = p_entry->delay_us;
+
+		__dmb();
+		p_lcd->_txq_tail++;
+
+		sleep_us(delay_us);
+	}
+
+	return;
+}
+
+/*
+ * Alarm callback. Sends the next queued byte and reschedules itself after its execution time.
+ * The call following the last byte only marks the queue as idle, so lcd_is_idle() also covers the last instruction execution time.
+ */
+
+int64_t _lcd_async_alarm_callback(alarm_id_t id, void *user_data)
+{
+	lcd_t *p_lcd;
+	struct _lcd_txq_entry *p_entry;
+	uint16_t delay_us;
+
+	(void) id;
+
+	p_lcd = (lcd_t*) user_data;
+
+	if(p_lcd->_txq_head == p_lcd->_txq_tail)
+	{
+		p_lcd->_async_running = false;
+		return 0;
+	}
+
+	p_entry = &(p_lcd->_txq[p_lcd->_txq_tail & __LCD_TXQ_MASK]);
+
+	_lcd_transmit_byte(p_lcd, p_entry->reg, p_entry->byte);
+	delay_us = p_entry->delay_us;
+
+	__dmb();
+	p_lcd->_txq_tail++;
+
+	return (int64_t) delay_us;
+}
+#endif
+
+uint16_t _lcd_exec_time_us(bool reg, uint8_t byte)
+{
+	if(reg) return LCD_TIMING_DATA_US;
+
+	if(byte == 0x01) return LCD_TIMING_CLEAR_US;
+	if((byte & 0xfe) == 0x02) return LCD_TIMING_HOME_US;
+
+	return LCD_TIMING_CMD_US;
+}
+
+void _lcd_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte)
+{
+#if LCD_CFG_STATS
+	uint32_t t_start;
+
+	_lcd_stats_count_byte(p_lcd, reg, byte);
+	t_start = time_us_32();
+#endif
+
+	_lcd_track_byte(p_lcd, reg, byte);
+	_lcd_bus_send_byte(p_lcd, reg, byte);
+
+#if LCD_CFG_STATS
+	p_lcd->_stats.wait_us += (uint32_t) (time_us_32() - t_start);
+#endif
+	return;
+}
+
+/*Sends a byte through the transport, the async queue or the GPIO pins, then waits for its execution time where the path requires it*/
+void _lcd_bus_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte)
+{
+	if(p_lcd->transport != NULL)
+	{
+#if LCD_CFG_TRACE
+		_lcd_trace(p_lcd, (reg ? LCD_TRACE_DATA : LCD_TRACE_CMD), byte);
+#endif
+		p_lcd->transport->send_byte(p_lcd, reg, byte, _lcd_exec_time_us(reg, byte));
+		return;
+	}
+
+#if LCD_CFG_ASYNC
+	if(p_lcd->_async_mode)
+	{
+		_lcd_txq_push(p_lcd, reg, byte, _lcd_exec_time_us(reg, byte));
+		return;
+	}
+#endif
+
+	if(p_lcd->_bf_ok) _lcd_wait_ready(p_lcd);
+
+	_lcd_transmit_byte(p_lcd, reg, byte);
+
+	if(p_lcd->_bf_ok)
+	{
+		p_lcd->_bf_pending_us = _lcd_exec_time_us(reg, byte);
+		p_lcd->_bf_t_write = time_us_32();
+		return;
+	}
+
+	sleep_us(_lcd_exec_time_us(reg, byte));
+
+	return;
+}
+
+/*End of an lcd_*() call: push out whatever a batching transport still holds*/
+void _lcd_transport_flush(lcd_t *p_lcd)
+{
+#if LCD_CFG_STATS
+	uint32_t t_start;
+
+	t_start = time_us_32();
+#endif
+
+	if((p_lcd->transport != NULL) && (p_lcd->transport->flush != NULL)) p_lcd->transport->flush(p_lcd);
+
+#if LCD_CFG_STATS
+	if(p_lcd->_stats_in_call) p_lcd->_stats.wait_us += (uint32_t) (time_us_32() - t_start);
+	_lcd_stats_call_end(p_lcd);
+#endif
+	return;
+}
+
+/*Also called from the async alarm IRQ: the E strobe delays busy wait (sleep_us() must not be called from an IRQ handler)*/
+void _lcd_transmit_byte(lcd_t *p_lcd, bool reg, uint8_t byte)
+{
+#if LCD_CFG_TRACE
+	_lcd_trace(p_lcd, (reg ? LCD_TRACE_DATA : LCD_TRACE_CMD), byte);
+#endif
+
+	gpio_put(p_lcd->e, 0);
+	gpio_put(p_lcd->rs, reg);
+	busy_wait_us_32(__LCD_EN_DELAY_US);
+
+	if(p_lcd->bus_8bit)
+	{
+		_lcd_write_byte(p_lcd, byte);
+		gpio_put(p_lcd->e, 1);
+		busy_wait_us_32(__LCD_EN_DELAY_US);
+		gpio_put(p_lcd->e, 0);
+		return;
+	}
+
+	_lcd_write_nibble(p_lcd, (byte >> 4));
+	gpio_put(p_lcd->e, 1);
+	busy_wait_us_32(__LCD_EN_DELAY_US);
+	gpio_put(p_lcd->e, 0);
+	busy_wait_us_32(__LCD_EN_DELAY_US);
+
+	_lcd_write_nibble(p_lcd, (byte & 0xf));
+	gpio_put(p_lcd->e, 1);
+	busy_wait_us_32(__LCD_EN_DELAY_US);
+	gpio_put(p_lcd->e, 0);
+
+	return;
+}
+
+void _lcd_write_nibble(const lcd_t *p_lcd, uint8_t nibble)
+{
+	gpio_put_masked(p_lcd->_db_mask, p_lcd->_db_lut[nibble]);
+
+	return;
+}
+
+void _lcd_write_byte(const lcd_t *p_lcd, uint8_t byte)
+{
+	gpio_put_masked((p_lcd->_db_mask | p_lcd->_db_lo_mask), (p_lcd->_db_lut[byte >> 4] | p_lcd->_db_lo_lut[byte & 0xf]));
+
+	return;
+}
+
+void _lcd_wait_ready(lcd_t *p_lcd)
+{
+	uint32_t elapsed;
+	uint32_t timeout;
+
+	if(!p_lcd->_bf_pending_us) return;
+
+	elapsed = time_us_32() - p_lcd->_bf_t_write;
+
+	if(elapsed >= p_lcd->_bf_pending_us)
+	{
+		p_lcd->_bf_pending_us = 0u;
+		return;
+	}
+
+	/*Less left than a single poll costs (direction switches included): just wait it out*/
+	if((p_lcd->_bf_pending_us - elapsed) <= __LCD_BF_POLL_US)
+	{
+		sleep_us(p_lcd->_bf_pending_us - elapsed);
+		p_lcd->_bf_pending_us = 0u;
+		return;
+	}
+
+	timeout = ((uint32_t) p_lcd->_bf_pending_us)*__LCD_BF_TIMEOUT_FACTOR;
+
+	_lcd_set_data_dir(p_lcd, false);
+
+	while(_lcd_read_bf_ac(p_lcd) & 0x80)
+	{
+		if((time_us_32() - p_lcd->_bf_t_write) < timeout) continue;
+
+		/*Busy flag stuck: R/W or DB7 likely not connected. Fall back to the timed profile.*/
+		p_lcd->_bf_ok = false;
+		break;
+	}
+
+	_lcd_set_data_dir(p_lcd, true);
+
+	p_lcd->_bf_pending_us = 0u;
+	return;
+}
+
+uint8_t _lcd_read_bf_ac(const lcd_t *p_lcd)
+{
+	uint8_t bf_ac;
+
+	gpio_put(p_lcd->e, 0);
+	gpio_put(p_lcd->rs, 0);
+	gpio_put(p_lcd->rw, 1);
+	sleep_us(__LCD_EN_DELAY_US);
+
+	gpio_put(p_lcd->e, 1);
+	sleep_us(__LCD_EN_DELAY_US);
+	bf_ac = (_lcd_read_nibble(p_lcd) << 4);
+
+	if(p_lcd->bus_8bit)
+	{
+		bf_ac |= _lcd_read_low_nibble(p_lcd);
+		gpio_put(p_lcd->e, 0);
+		gpio_put(p_lcd->rw, 0);
+
+		return bf_ac;
+	}
+
+	gpio_put(p_lcd->e, 0);
+	sleep_us(__LCD_EN_DELAY_US);
+
+	gpio_put(p_lcd->e, 1);
+	sleep_us(__LCD_EN_DELAY_US);
+	bf_ac |= _lcd_read_nibble(p_lcd);
+	gpio_put(p_lcd->e, 0);
+
+	gpio_put(p_lcd->rw, 0);
+
+	return bf_ac;
+}
+
+uint8_t _lcd_read_nibble(const lcd_t *p_lcd)
+{
+	uint8_t nibble;
+
+	nibble = 0u;
+	if(gpio_get(p_lcd->db7)) nibble |= 0x8;
+	if(gpio_get(p_lcd->db6)) nibble |= 0x4;
+	if(gpio_get(p_lcd->db5)) nibble |= 0x2;
+	if(gpio_get(p_lcd->db4)) nibble |= 0x1;
+
+	return nibble;
+}
+
+uint8_t _lcd_read_low_nibble(const lcd_t *p_lcd)
+{
+	uint8_t nibble;
+
+	nibble = 0u;
+	if(gpio_get(p_lcd->db3)) nibble |= 0x8;
+	if(gpio_get(p_lcd->db2)) nibble |= 0x4;
+	if(gpio_get(p_lcd->db1)) nibble |= 0x2;
+	if(gpio_get(p_lcd->db0)) nibble |= 0x1;
+
+	return nibble;
+}
+
+void _lcd_set_data_dir(const lcd_t *p_lcd, bool out)
+{
+	gpio_set_dir(p_lcd->db4, out);
+	gpio_set_dir(p_lcd->db5, out);
+	gpio_set_dir(p_lcd->db6, out);
+	gpio_set_dir(p_lcd->db7, out);
+
+	if(p_lcd->bus_8bit)
+	{
+		gpio_set_dir(p_lcd->db0, out);
+		gpio_set_dir(p_lcd->db1, out);
+		gpio_set_dir(p_lcd->db2, out);
+		gpio_set_dir(p_lcd->db3, out);
+	}
+
+	return;
+}
+
+void _lcd_gpio_init(lcd_t *p_lcd)
+{
+	uint8_t nibble;
+
+	gpio_init(p_lcd->e);
+	gpio_set_dir(p_lcd->e, GPIO_OUT);
+	gpio_put(p_lcd->e, 0);
+
+	gpio_init(p_lcd->rs);
+	gpio_set_dir(p_lcd->rs, GPIO_OUT);
+
+	gpio_init(p_lcd->db4);
+	gpio_init(p_lcd->db5);
+	gpio_init(p_lcd->db6);
+	gpio_init(p_lcd->db7);
+
+	gpio_set_dir(p_lcd->db4, GPIO_OUT);
+	gpio_set_dir(p_lcd->db5, GPIO_OUT);
+	gpio_set_dir(p_lcd->db6, GPIO_OUT);
+	gpio_set_dir(p_lcd->db7, GPIO_OUT);
+
+	if(p_lcd->bus_8bit)
+	{
+		gpio_init(p_lcd->db0);
+		gpio_init(p_lcd->db1);
+		gpio_init(p_lcd->db2);
+		gpio_init(p_lcd->db3);
+
+		gpio_set_dir(p_lcd->db0, GPIO_OUT);
+		gpio_set_dir(p_lcd->db1, GPIO_OUT);
+		gpio_set_dir(p_lcd->db2, GPIO_OUT);
+		gpio_set_dir(p_lcd->db3, GPIO_OUT);
+	}
+
+	if(p_lcd->use_rw)
+	{
+		gpio_init(p_lcd->rw);
+		gpio_set_dir(p_lcd->rw, GPIO_OUT);
+		gpio_put(p_lcd->rw, 0);
+	}
+
+	/*All GPIOs live in the same SIO bank, so a nibble is always a single masked write*/
+	p_lcd->_db_mask = (1u << p_lcd->db4) | (1u << p_lcd->db5) | (1u << p_lcd->db6) | (1u << p_lcd->db7);
+
+	for(nibble = 0u; nibble < 16u; nibble++)
+	{
+		p_lcd->_db_lut[nibble] = 0u;
+		if(nibble & 0x1) p_lcd->_db_lut[nibble] |= (1u << p_lcd->db4);
+		if(nibble & 0x2) p_lcd->_db_lut[nibble] |= (1u << p_lcd->db5);
+		if(nibble & 0x4) p_lcd->_db_lut[nibble] |= (1u << p_lcd->db6);
+		if(nibble & 0x8) p_lcd->_db_lut[nibble] |= (1u << p_lcd->db7);
+	}
+
+	/*8-bit mode: DB0-DB3 get their own table, so a byte is still a single masked write*/
+	p_lcd->_db_lo_mask = 0u;
+	memset(p_lcd->_db_lo_lut, 0, sizeof(p_lcd->_db_lo_lut));
+
+	if(!p_lcd->bus_8bit) return;
+
+	p_lcd->_db_lo_mask = (1u << p_lcd->db0) | (1u << p_lcd->db1) | (1u << p_lcd->db2) | (1u << p_lcd->db3);
+
+	for(nibble = 0u; nibble < 16u; nibble++)
+	{
+		if(nibble & 0x1) p_lcd->_db_lo_lut[nibble] |= (1u << p_lcd->db0);
+		if(nibble & 0x2) p_lcd->_db_lo_lut[nibble] |= (1u << p_lcd->db1);
+		if(nibble & 0x4) p_lcd->_db_lo_lut[nibble] |= (1u << p_lcd->db2);
+		if(nibble & 0x8) p_lcd->_db_lo_lut[nibble] |= (1u << p_lcd->db3);
+	}
+
+	return;
+}
+
+void _lcd_send_init_nibble(lcd_t *p_lcd)
+{
+#if LCD_CFG_TRACE
+	_lcd_trace(p_lcd, LCD_TRACE_INIT_NIBBLE, 0x2);
+#endif
+
+	gpio_put(p_lcd->e, 0);
+	gpio_put(p_lcd->rs, 0);
+	sleep_us(__LCD_EN_DELAY_US);
+
+	_lcd_write_nibble(p_lcd, 0x2);
+	gpio_put(p_lcd->e, 1);
+	sleep_us(__LCD_EN_DELAY_US);
+	gpio_put(p_lcd->e, 0);
+	sleep_us(LCD_TIMING_INIT_US);
+
+	return;
+}
+
+void _lcd_send_init_8bit(lcd_t *p_lcd)
+{
+	/*Initialization by instruction: 3 function sets (8-bit), whatever interface mode the controller was left in*/
+	_lcd_transmit_byte(p_lcd, false, 0x30);
+	sleep_us(LCD_TIMING_INIT_US);
+
+	_lcd_transmit_byte(p_lcd, false, 0x30);
+	sleep_us(LCD_TIMING_INIT_RETRY_US);
+
+	_lcd_transmit_byte(p_lcd, false, 0x30);
+	sleep_us(LCD_TIMING_CMD_US);
+
+	return;
+}
+
+bool _lcd_validate_info(const lcd_t *p_lcd)
+{
+	uintptr_t n_byte;
+
+	for(n_byte = 0u; n_byte < 8u; n_byte++) if(((const uint8_t*) p_lcd)[n_byte] == 0xff) return false;
+
+	if(!p_lcd->n_chars) return false;
+	if(!p_lcd->n_lines) return false;
+
+	if(p_lcd->use_rw && (p_lcd->rw == 0xff)) return false;
+
+	if(p_lcd->bus_8bit)
+	{
+		if(p_lcd->transport != NULL) return false;
+
+		if(p_lcd->db0 == 0xff) return false;
+		if(p_lcd->db1 == 0xff) return false;
+		if(p_lcd->db2 == 0xff) return false;
+		if(p_lcd->db3 == 0xff) return false;
+	}
+
+	/*Every line must fit in the controller DDRAM*/
+	if(p_lcd->n_lines > 4u) return false;
+	if((p_lcd->n_chars)*((p_lcd->n_lines + 1u) >> 1) > LCD_DDRAM_LINE_SIZE) return false;
+
+	return true;
+}
+
+bool _phys_text_cx_cy_to_virt_text_cx_cy(const lcd_t *p_lcd, uint8_t *p_virtcx, uint8_t *p_virtcy, uint8_t physcx, uint8_t physcy)
+{
+	uint8_t virtcx;
+	uint8_t virtcy;
+
+	if(physcx >= p_lcd->n_chars) return false;
+	if(physcy >= p_lcd->n_lines) return false;
+
+	virtcy = (physcy & 0x1);
+
+	virtcx = physcx;
+	physcy = (physcy >> 1);
+
+	virtcx += physcy*(p_lcd->n_chars);
+
+	if(p_virtcx != NULL) *p_virtcx = virtcx;
+	if(p_virtcy != NULL) *p_virtcy = virtcy;
+
+	return true;
+}
+
+void _lcd_load_line_addr_table(lcd_t *p_lcd)
+{
+	uint8_t n_line;
+	uint8_t virtcx;
+	uint8_t virtcy;
+
+	/*
+	 * Lines are interleaved on the two DDRAM lines (0x00 and 0x40):
+	 * 16x2: 0x00 0x40
+	 * 16x4: 0x00 0x40 0x10 0x50
+	 * 20x4: 0x00 0x40 0x14 0x54
+	 */
+
+	for(n_line = 0u; n_line < 4u; n_line++)
+	{
+		if(!_phys_text_cx_cy_to_virt_text_cx_cy(p_lcd, &virtcx, &virtcy, 0u, n_line))
+		{
+			p_lcd->_line_addr[n_line] = 0u;
+			continue;
+		}
+
+		if(virtcy) virtcx |= 0x40;
+
+		p_lcd->_line_addr[n_line] = virtcx;
+	}
+
+	return;
+}
+
+bool _lcd_phys_text_cx_cy_to_ddram_addr(const lcd_t *p_lcd, uint8_t *p_addr, uint8_t physcx, uint8_t physcy)
+{
+	if(physcx >= p_lcd->n_chars) return false;
+	if(physcy >= p_lcd->n_lines) return false;
+
+	if(p_addr != NULL) *p_addr = p_lcd->_line_addr[physcy] + physcx;
+
+	return true;
+}
@@ -13,6 +13,168 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/*
+ * LCD_CFG_FRAMEBUFFER
+ * Set to 1 to keep a RAM shadow of the display DDRAM inside every lcd_t object (required by lcd_set_framebuffer_mode(), lcd_flush(),
+ * the console and the glyph cache; fields, screen layouts and fills only send the characters that changed with it).
+ * Off by default: it costs LCD_DDRAM_SIZE + LCD_DDRAM_SIZE/8 bytes per object.
+ */
+
+#ifndef LCD_CFG_FRAMEBUFFER
+#define LCD_CFG_FRAMEBUFFER 0
+#endif
+
+/*
+ * LCD_CFG_TIMING_PROFILE
+ * Selects the controller instruction execution times the driver waits for after each write.
+ * One of LCD_TIMING_PROFILE_HD44780, LCD_TIMING_PROFILE_ST7066U, LCD_TIMING_PROFILE_KS0066, LCD_TIMING_PROFILE_SPLC780.
+ *
+ * LCD_CFG_TIMING_DERATED
+ * Set to 1 to double every execution time (long cables, low supply voltage, slow controller oscillator).
+ */
+
+#define LCD_TIMING_PROFILE_HD44780 0
+#define LCD_TIMING_PROFILE_ST7066U 1
+#define LCD_TIMING_PROFILE_KS0066 2
+#define LCD_TIMING_PROFILE_SPLC780 3
+
+#ifndef LCD_CFG_TIMING_PROFILE
+#define LCD_CFG_TIMING_PROFILE LCD_TIMING_PROFILE_HD44780
+#endif
+
+#ifndef LCD_CFG_TIMING_DERATED
+#define LCD_CFG_TIMING_DERATED 0
+#endif
+
+/*Datasheet execution times (fosc = 270kHz). Data writes include tADD (address counter update)*/
+#if LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_HD44780
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 41U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_ST7066U
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 43U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_KS0066
+#define __LCD_TIMING_CLEAR_US 1530U
+#define __LCD_TIMING_HOME_US 1530U
+#define __LCD_TIMING_CMD_US 39U
+#define __LCD_TIMING_DATA_US 43U
+#elif LCD_CFG_TIMING_PROFILE == LCD_TIMING_PROFILE_SPLC780
+#define __LCD_TIMING_CLEAR_US 1520U
+#define __LCD_TIMING_HOME_US 1520U
+#define __LCD_TIMING_CMD_US 37U
+#define __LCD_TIMING_DATA_US 41U
+#else
+#error "LCD_CFG_TIMING_PROFILE: unknown timing profile"
+#endif
+
+/*Wait after the first (8-bit mode) function set nibble, and after the second one of the 8-bit initialization sequence*/
+#define __LCD_TIMING_INIT_US 4100U
+#define __LCD_TIMING_INIT_RETRY_US 100U
+
+#define LCD_TIMING_CLEAR_US (__LCD_TIMING_CLEAR_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_HOME_US (__LCD_TIMING_HOME_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_CMD_US (__LCD_TIMING_CMD_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_DATA_US (__LCD_TIMING_DATA_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_INIT_US (__LCD_TIMING_INIT_US << LCD_CFG_TIMING_DERATED)
+#define LCD_TIMING_INIT_RETRY_US (__LCD_TIMING_INIT_RETRY_US << LCD_CFG_TIMING_DERATED)
+
+/*
+ * LCD_CFG_ASYNC
+ * Set to 1 to enable the interrupt driven transmit queue (lcd_set_async_mode()).
+ * The queue is drained from a hardware alarm callback (default alarm pool) on the core that enabled the async mode.
+ *
+ * LCD_CFG_TXQUEUE_SIZE
+ * Number of entries in the transmit queue (power of 2, up to 128). Each entry takes 4 bytes.
+ */
+
+#ifndef LCD_CFG_ASYNC
+#define LCD_CFG_ASYNC 0
+#endif
+
+#ifndef LCD_CFG_TXQUEUE_SIZE
+#define LCD_CFG_TXQUEUE_SIZE 32
+#endif
+
+/*
+ * LCD_CFG_STATS
+ * Set to 1 to keep per-object performance counters (lcd_get_stats(), lcd_reset_stats()).
+ * Costs two timer reads per byte sent. Set to 0 to compile them out.
+ */
+
+#ifndef LCD_CFG_STATS
+#define LCD_CFG_STATS 0
+#endif
+
+/*
+ * LCD_CFG_TRACE
+ * Set to 1 to log every byte and initialization nibble sent to the display into a ring buffer inside the lcd_t object
+ * (lcd_get_trace(), lcd_clear_trace()). It keeps the newest LCD_CFG_TRACE_SIZE - 1 entries.
+ * Costs one timer read per byte sent. Set to 0 to compile it out.
+ *
+ * LCD_CFG_TRACE_SIZE
+ * Number of entries in the ring buffer (power of 2). Each entry takes 8 bytes.
+ */
+
+#ifndef LCD_CFG_TRACE
+#define LCD_CFG_TRACE 0
+#endif
+
+#ifndef LCD_CFG_TRACE_SIZE
+#define LCD_CFG_TRACE_SIZE 64
+#endif
+
+#define LCD_TRACE_CMD 0U		/*BYTE SENT TO THE INSTRUCTION REGISTER*/
+#define LCD_TRACE_DATA 1U		/*BYTE SENT TO THE DATA REGISTER*/
+#define LCD_TRACE_INIT_NIBBLE 2U	/*SINGLE NIBBLE WITH RS LOW (4-BIT MODE SWITCH)*/
+
+/*
+ * LCD_CFG_GLYPHS
+ * Set to 1 to enable the custom glyph cache (lcd_set_glyph_table(), lcd_print_glyph()). Glyphs of an application table
+ * are uploaded to the 8 CGRAM slots when first printed, replacing the least recently printed one once every slot is taken.
+ * The cells still showing a replaced glyph are found in the RAM shadow, so it requires LCD_CFG_FRAMEBUFFER.
+ * Costs 48 bytes of RAM per object. Set to 0 to compile it out.
+ */
+
+#ifndef LCD_CFG_GLYPHS
+#define LCD_CFG_GLYPHS 0
+#endif
+
+#if LCD_CFG_GLYPHS && !LCD_CFG_FRAMEBUFFER
+#error "LCD_CFG_GLYPHS requires LCD_CFG_FRAMEBUFFER"
+#endif
+
+/*
+ * LCD_CFG_ROM_CODE
+ * Character generator ROM of the controller, used by lcd_print_text_utf8() to find the character code of each character.
+ * LCD_ROM_CODE_A00 (Japanese: ASCII except '\\' and '~', half-width katakana, a few Greek letters and symbols) or
+ * LCD_ROM_CODE_A02 (European: ASCII, Latin-1, a few Greek and Cyrillic letters and symbols).
+ * Printing codes 0x20 to 0xff on the display tells them apart.
+ *
+ * LCD_CFG_UTF8_REPLACEMENT
+ * Character code lcd_print_text_utf8() prints for malformed sequences and characters it can't show.
+ */
+
+#define LCD_ROM_CODE_A00 0
+#define LCD_ROM_CODE_A02 1
+
+#ifndef LCD_CFG_ROM_CODE
+#define LCD_CFG_ROM_CODE LCD_ROM_CODE_A00
+#endif
+
+#ifndef LCD_CFG_UTF8_REPLACEMENT
+#define LCD_CFG_UTF8_REPLACEMENT '?'
+#endif
+
+#define LCD_CGRAM_SLOTS 8U
+#define LCD_GLYPH_NONE 0xffffU
+
+#define LCD_DDRAM_LINE_SIZE 40U
+#define LCD_DDRAM_SIZE 80U
+
 #define __LCD_STATUS_ERROR -1
 #define __LCD_STATUS_UNINITIALIZED 0
 #define __LCD_STATUS_INITIALIZED 1
@@ -22,6 +184,53 @@
 #define LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_ON 2
 #define LCD_DISPLAYMODE_DISPLAY_ON_CURSOR_BLINK 3
 
+#define LCD_ALIGN_RIGHT 0
+#define LCD_ALIGN_LEFT 1
+
+struct _lcd_transport;
+
+struct _lcd_txq_entry {
+	uint8_t byte;
+	bool reg;
+	uint16_t delay_us;
+};
+
+struct _lcd_trace_entry {
+	uint32_t t_us;		/*time_us_32() WHEN THE TRANSFER STARTED (OR WAS HANDED TO THE TRANSPORT)*/
+	uint8_t kind;		/*LCD_TRACE_**/
+	uint8_t value;		/*BYTE (OR NIBBLE) SENT*/
+};
+
+typedef struct _lcd_trace_entry lcd_trace_entry_t;
+
+struct _lcd_stats {
+	uint32_t n_cmds;	/*INSTRUCTIONS SENT*/
+	uint32_t n_data;	/*DATA BYTES SENT*/
+	uint32_t n_skipped;	/*CHARACTERS PRINTED (FRAMEBUFFER MODE, FIELDS) THAT DIDN'T NEED TO BE SENT*/
+	uint32_t n_clear_home;	/*CLEAR DISPLAY AND RETURN HOME INSTRUCTIONS SENT (1.52ms EACH)*/
+	uint64_t wait_us;	/*TIME SPENT SENDING BYTES (EXECUTION TIME WAITS, BUSY FLAG POLLING, FULL QUEUE OR TRANSPORT BUFFER)*/
+	uint32_t max_call_us;	/*LONGEST A SINGLE lcd_*() CALL KEPT THE CALLER BLOCKED, FROM ITS FIRST BYTE SENT TO ITS RETURN*/
+};
+
+typedef struct _lcd_stats lcd_stats_t;
+
+struct _lcd_glyph {
+	uint8_t rows[8];	/*5x8 DOT PATTERN, TOP ROW FIRST (BIT 4 IS THE LEFTMOST DOT, ROW 7 IS THE CURSOR LINE)*/
+	char fallback;		/*CHARACTER SHOWN IN PLACE OF THE GLYPH ONCE ANOTHER ONE TOOK ITS CGRAM SLOT*/
+	uint16_t codepoint;	/*UNICODE CHARACTER lcd_print_text_utf8() SHOWS WITH THIS GLYPH IF THE ROM DOESN'T HAVE IT (0 FOR NONE)*/
+};
+
+typedef struct _lcd_glyph lcd_glyph_t;
+
+struct _lcd_glyph_stats {
+	uint32_t n_hits;	/*GLYPHS PRINTED THAT WERE ALREADY IN CGRAM*/
+	uint32_t n_misses;	/*GLYPHS PRINTED THAT HAD TO BE UPLOADED FIRST (9 INSTRUCTIONS EACH)*/
+	uint32_t n_evictions;	/*UPLOADS THAT REPLACED ANOTHER GLYPH*/
+	uint32_t n_repaints;	/*CELLS REWRITTEN WITH THE FALLBACK CHARACTER OF A REPLACED GLYPH*/
+};
+
+typedef struct _lcd_glyph_stats lcd_glyph_stats_t;
+
 struct _lcd {
 	uint8_t db4;		/*DB4 GPIO PIN*/
 	uint8_t db5;		/*DB5 GPIO PIN*/
@@ -31,14 +240,90 @@ struct _lcd {
 	uint8_t e;		/*E GPIO PIN*/
 	uint8_t n_chars;	/*NUMBER CHARACTERS PER LINE*/
 	uint8_t n_lines;	/*NUMBER LINES*/
+	uint8_t rw;		/*R/W GPIO PIN (OPTIONAL, ONLY USED IF "use_rw" IS SET)*/
+	bool use_rw;		/*POLL THE BUSY FLAG THROUGH THE R/W PIN (ONLY FASTER THAN THE TIMED PROFILE ON CONTROLLERS BEATING THE DATASHEET WORST CASE)*/
+	const struct _lcd_transport *transport;	/*BUS TRANSPORT (OPTIONAL, NULL FOR THE BUILT-IN GPIO TRANSPORT)*/
+	void *transport_ctx;	/*BUS TRANSPORT CONTEXT (SEE THE TRANSPORT HEADER)*/
+	bool bus_8bit;		/*8-BIT DATA BUS (DB0-DB3 BELOW MUST BE SET, GPIO TRANSPORT ONLY)*/
+	uint8_t db0;		/*DB0 GPIO PIN (OPTIONAL, ONLY USED IF "bus_8bit" IS SET)*/
+	uint8_t db1;		/*DB1 GPIO PIN (OPTIONAL, ONLY USED IF "bus_8bit" IS SET)*/
+	uint8_t db2;		/*DB2 GPIO PIN (OPTIONAL, ONLY USED IF "bus_8bit" IS SET)*/
+	uint8_t db3;		/*DB3 GPIO PIN (OPTIONAL, ONLY USED IF "bus_8bit" IS SET)*/
 	intptr_t _status;	/*IGNORE (INTERNAL USE)*/
+	bool _bf_ok;		/*IGNORE (INTERNAL USE)*/
+	uint16_t _bf_pending_us;	/*IGNORE (INTERNAL USE)*/
+	uint32_t _bf_t_write;	/*IGNORE (INTERNAL USE)*/
+	uint8_t _line_addr[4];	/*IGNORE (INTERNAL USE)*/
+	uint32_t _db_mask;	/*IGNORE (INTERNAL USE)*/
+	uint32_t _db_lut[16];	/*IGNORE (INTERNAL USE)*/
+	uint32_t _db_lo_mask;	/*IGNORE (INTERNAL USE)*/
+	uint32_t _db_lo_lut[16];	/*IGNORE (INTERNAL USE)*/
+	uint8_t _ac;		/*IGNORE (INTERNAL USE)*/
+	uint8_t _ac_pending;	/*IGNORE (INTERNAL USE)*/
+	uint8_t _display_ctrl;	/*IGNORE (INTERNAL USE)*/
+#if LCD_CFG_FRAMEBUFFER
+	bool _fb_mode;					/*IGNORE (INTERNAL USE)*/
+	bool _fb_keep;					/*IGNORE (INTERNAL USE)*/
+	uint8_t _fb_idx;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _fb[LCD_DDRAM_SIZE];			/*IGNORE (INTERNAL USE)*/
+	uint8_t _fb_dirty[LCD_DDRAM_SIZE >> 3];	/*IGNORE (INTERNAL USE)*/
+	uintptr_t _n_skipped;				/*IGNORE (INTERNAL USE)*/
+#endif
+#if LCD_CFG_STATS
+	lcd_stats_t _stats;				/*IGNORE (INTERNAL USE)*/
+	bool _stats_in_call;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _stats_t_call;				/*IGNORE (INTERNAL USE)*/
+#endif
+#if LCD_CFG_TRACE
+	lcd_trace_entry_t _trace[LCD_CFG_TRACE_SIZE];	/*IGNORE (INTERNAL USE)*/
+	volatile uint32_t _trace_head;			/*IGNORE (INTERNAL USE)*/
+#endif
+#if LCD_CFG_GLYPHS
+	const lcd_glyph_t *_glyphs;			/*IGNORE (INTERNAL USE)*/
+	uint16_t _n_glyphs;				/*IGNORE (INTERNAL USE)*/
+	uint16_t _glyph_slot_id[LCD_CGRAM_SLOTS];	/*IGNORE (INTERNAL USE)*/
+	uint8_t _glyph_lru[LCD_CGRAM_SLOTS];		/*IGNORE (INTERNAL USE)*/
+	lcd_glyph_stats_t _glyph_stats;			/*IGNORE (INTERNAL USE)*/
+#endif
+#if LCD_CFG_ASYNC
+	struct _lcd_txq_entry _txq[LCD_CFG_TXQUEUE_SIZE];	/*IGNORE (INTERNAL USE)*/
+	volatile uint8_t _txq_head;			/*IGNORE (INTERNAL USE)*/
+	volatile uint8_t _txq_tail;			/*IGNORE (INTERNAL USE)*/
+	volatile bool _async_running;			/*IGNORE (INTERNAL USE)*/
+	bool _async_mode;				/*IGNORE (INTERNAL USE)*/
+	bool _async_bf_ok;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _txq_hwm;				/*IGNORE (INTERNAL USE)*/
+#endif
 };
 
 typedef struct _lcd lcd_t;
 
+/*
+ * Bus transport.
+ * Replaces the built-in GPIO bit-banging below the command layer. Busy flag polling and the async mode are GPIO transport only.
+ *
+ * init(): configures the transport hardware. Called by lcd_init() before anything is sent.
+ * send_init_nibble(): sends a single nibble with RS low (4-bit mode switch), then keeps the bus idle for "delay_us".
+ * send_byte(): sends a byte to the instruction (reg = false) or data (reg = true) register,
+ * then keeps the bus idle for "delay_us" before the next byte.
+ * flush(): optional (NULL if the transport doesn't batch). Called at the end of every lcd_*() call that sent something,
+ * sends whatever send_byte() still holds in its buffer.
+ */
+
+struct _lcd_transport {
+	bool (*init)(lcd_t *p_lcd);
+	void (*send_init_nibble)(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+	void (*send_byte)(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+	void (*flush)(lcd_t *p_lcd);
+};
+
 /*
  * lcd_init()
  * initializes LCD object. Must be called before calling any other functions in this driver.
+ * The object must start zeroed (static storage, an initializer like "lcd_t lcd = {.db4 = 2, ...}" or a memset):
+ * lcd_init() tells a first initialization from a new one by its internal fields, and only waits for the async queue in the latter.
+ * If "use_rw" is set, the data pins are read back from the display, so the display must run at 3.3V (or be level shifted).
+ * If "bus_8bit" is set, every byte is written with a single E strobe (and a single masked GPIO write) instead of two.
  *
  * returns true if successful, false otherwise.
  */
@@ -52,7 +337,7 @@ extern bool lcd_init(lcd_t *p_lcd);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_clear(const lcd_t *p_lcd);
+extern bool lcd_clear(lcd_t *p_lcd);
 
 /*
  * lcd_home()
@@ -61,7 +346,7 @@ extern bool lcd_clear(const lcd_t *p_lcd);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_home(const lcd_t *p_lcd);
+extern bool lcd_home(lcd_t *p_lcd);
 
 /*
  * lcd_set_display_mode()
@@ -70,7 +355,7 @@ extern bool lcd_home(const lcd_t *p_lcd);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_set_display_mode(const lcd_t *p_lcd, intptr_t display_mode);
+extern bool lcd_set_display_mode(lcd_t *p_lcd, intptr_t display_mode);
 
 /*
  * lcd_set_cursor_pos()
@@ -79,7 +364,7 @@ extern bool lcd_set_display_mode(const lcd_t *p_lcd, intptr_t display_mode);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_set_cursor_pos(const lcd_t *p_lcd, uint8_t cx, uint8_t cy);
+extern bool lcd_set_cursor_pos(lcd_t *p_lcd, uint8_t cx, uint8_t cy);
 
 /*
  * lcd_print_char()
@@ -88,7 +373,7 @@ extern bool lcd_set_cursor_pos(const lcd_t *p_lcd, uint8_t cx, uint8_t cy);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_print_char(const lcd_t *p_lcd, char c);
+extern bool lcd_print_char(lcd_t *p_lcd, char c);
 
 /*
  * lcd_print_text()
@@ -97,7 +382,7 @@ extern bool lcd_print_char(const lcd_t *p_lcd, char c);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_print_text(const lcd_t *p_lcd, const char *text);
+extern bool lcd_print_text(lcd_t *p_lcd, const char *text);
 
 /*
  * lcd_print_text_deflen()
@@ -106,16 +391,264 @@ extern bool lcd_print_text(const lcd_t *p_lcd, const char *text);
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_print_text_deflen(const lcd_t *p_lcd, const char *text, uintptr_t len);
+extern bool lcd_print_text_deflen(lcd_t *p_lcd, const char *text, uintptr_t len);
+
+/*
+ * lcd_print_text_utf8()
+ * prints a null-terminated UTF-8 string at the current cursor position.
+ * Each character is printed with its code in the controller character ROM (LCD_CFG_ROM_CODE), else with the glyph
+ * of the glyph table standing for it (LCD_CFG_GLYPHS), else as LCD_CFG_UTF8_REPLACEMENT, like malformed sequences.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_text_utf8(lcd_t *p_lcd, const char *text);
+
+/*
+ * lcd_print_text_utf8_deflen()
+ * prints a UTF-8 string of length "len" (in bytes) at the current cursor position, like lcd_print_text_utf8().
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_text_utf8_deflen(lcd_t *p_lcd, const char *text, uintptr_t len);
+
+/*
+ * lcd_print_uint()
+ * prints "value" in decimal as a field of "width" characters at the current cursor position (0 for just the digits),
+ * aligned to the right (LCD_ALIGN_RIGHT) or left (LCD_ALIGN_LEFT) and padded with "pad".
+ * A value too wide for the field fills it with '#'. Fields are formatted without stdio nor a caller buffer, and only
+ * the characters that differ from what the display shows are sent (with LCD_CFG_FRAMEBUFFER).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_uint(lcd_t *p_lcd, uint32_t value, uint8_t width, intptr_t align, char pad);
+
+/*
+ * lcd_print_int()
+ * same as lcd_print_uint() for a signed value. With '0' as "pad", the minus sign goes before the zeros.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_int(lcd_t *p_lcd, int32_t value, uint8_t width, intptr_t align, char pad);
+
+/*
+ * lcd_print_fixed()
+ * same as lcd_print_int() for a fixed point value: "value" is in units of 10^-"n_decimals" (up to 9),
+ * e.g. 215 with 1 decimal prints "21.5".
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_fixed(lcd_t *p_lcd, int32_t value, uint8_t n_decimals, uint8_t width, intptr_t align, char pad);
+
+/*
+ * lcd_print_hex()
+ * same as lcd_print_uint() in hexadecimal (upper case digits).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_hex(lcd_t *p_lcd, uint32_t value, uint8_t width, intptr_t align, char pad);
 
 /*
  * lcd_fill_screen_char()
- * print a given character repeatedly filling the whole screen.
+ * print a given character repeatedly filling the whole screen (see lcd_fill_rect()).
+ * The cursor stays where it was (it used to be left after the last cell of the screen).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_fill_screen_char(lcd_t *p_lcd, char c);
+
+/*
+ * lcd_fill_rect()
+ * fill "width" characters of "height" lines from (cx , cy) with a given character. The cursor stays where it was.
+ * Sends whichever is quicker by the controller execution times (see lcd_estimate_fill_rect()): the cells that differ
+ * from what the display shows (every cell without LCD_CFG_FRAMEBUFFER), or a clear display followed by the cells
+ * of the whole screen that aren't blank afterwards.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_fill_rect(lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c);
+
+/*
+ * lcd_clear_line()
+ * blank line "cy" (lcd_fill_rect() with spaces).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_clear_line(lcd_t *p_lcd, uint8_t cy);
+
+/*
+ * lcd_clear_rect()
+ * blank "width" characters of "height" lines from (cx , cy) (lcd_fill_rect() with spaces).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_clear_rect(lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height);
+
+/*
+ * lcd_estimate_fill_rect()
+ * stores in "p_us" how long lcd_fill_rect() would keep the display busy with the same arguments, in microseconds,
+ * without sending anything: the sum of the execution times (LCD_CFG_TIMING_PROFILE) of the bytes it would send.
+ * The bus transfer time of each byte comes on top (significant with I2C and SPI transports).
+ * Nothing is sent in framebuffer mode, the estimate is then 0 (the cells go out with lcd_flush()).
  *
  * returns true if successful, false otherwise.
  */
 
-extern bool lcd_fill_screen_char(const lcd_t *p_lcd, char c);
+extern bool lcd_estimate_fill_rect(const lcd_t *p_lcd, uint8_t cx, uint8_t cy, uint8_t width, uint8_t height, char c, uint32_t *p_us);
+
+#if LCD_CFG_FRAMEBUFFER
+/*
+ * lcd_set_framebuffer_mode()
+ * enables/disables the framebuffer mode.
+ * While enabled, lcd_set_cursor_pos(), lcd_print_*(), lcd_fill_*(), lcd_clear*() and lcd_home() only update
+ * the RAM shadow of the display. Nothing is sent to the display until lcd_flush() is called.
+ * Disabling the framebuffer mode flushes any pending changes.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_set_framebuffer_mode(lcd_t *p_lcd, bool enable);
+
+/*
+ * lcd_flush()
+ * sends the characters that changed since the last flush to the display.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_flush(lcd_t *p_lcd);
+
+/*
+ * lcd_get_n_skipped_bytes()
+ * returns the number of characters printed in framebuffer mode that didn't need to be sent to the display.
+ */
+
+extern uintptr_t lcd_get_n_skipped_bytes(const lcd_t *p_lcd);
+#endif
+
+#if LCD_CFG_GLYPHS
+/*
+ * lcd_set_glyph_table()
+ * sets the custom glyphs lcd_print_glyph() can print, "glyphs[glyph_id]" being glyph "glyph_id". The table must outlive its use.
+ * Forgets which glyph each CGRAM slot holds: cells already showing one keep it until they are rewritten.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_set_glyph_table(lcd_t *p_lcd, const lcd_glyph_t *glyphs, uint16_t n_glyphs);
+
+/*
+ * lcd_print_glyph()
+ * prints custom glyph "glyph_id" at the current cursor position.
+ * A glyph not in CGRAM yet is uploaded first (9 instructions), to the least recently printed slot once all 8 are taken.
+ * Every cell still showing the glyph it replaces gets its fallback character, as the glyph can't be shown there anymore.
+ * In framebuffer mode, the cells being replaced show the new glyph until the next lcd_flush().
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_print_glyph(lcd_t *p_lcd, uint16_t glyph_id);
+
+/*
+ * lcd_get_glyph_stats()
+ * copies the glyph cache counters gathered since lcd_init() or the last lcd_reset_glyph_stats() to "p_stats".
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_get_glyph_stats(const lcd_t *p_lcd, lcd_glyph_stats_t *p_stats);
+
+/*
+ * lcd_reset_glyph_stats()
+ * sets every glyph cache counter back to 0.
+ */
+
+extern void lcd_reset_glyph_stats(lcd_t *p_lcd);
+#endif
+
+#if LCD_CFG_STATS
+/*
+ * lcd_get_stats()
+ * copies the performance counters gathered since lcd_init() or the last lcd_reset_stats() to "p_stats".
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_get_stats(const lcd_t *p_lcd, lcd_stats_t *p_stats);
+
+/*
+ * lcd_reset_stats()
+ * sets every performance counter back to 0.
+ */
+
+extern void lcd_reset_stats(lcd_t *p_lcd);
+#endif
+
+#if LCD_CFG_TRACE
+/*
+ * lcd_get_trace()
+ * copies up to "max_entries" of the newest trace entries to "p_entries", oldest first.
+ * Doesn't block the transfers: it may run while the async mode (or another core) keeps sending,
+ * entries overwritten during the copy are left out.
+ *
+ * returns the number of entries copied.
+ */
+
+extern uintptr_t lcd_get_trace(const lcd_t *p_lcd, lcd_trace_entry_t *p_entries, uintptr_t max_entries);
+
+/*
+ * lcd_clear_trace()
+ * empties the trace. Call it while nothing is being sent (async mode idle).
+ */
+
+extern void lcd_clear_trace(lcd_t *p_lcd);
+#endif
+
+#if LCD_CFG_ASYNC
+/*
+ * lcd_set_async_mode()
+ * enables/disables the asynchronous mode.
+ * While enabled, every function that talks to the display queues its bytes and returns immediately.
+ * The queue is drained in the background by a hardware alarm, respecting each instruction execution time.
+ * If no alarm can be scheduled (all alarm slots in use), the queued bytes are sent synchronously instead.
+ * If the queue is full, the caller waits for a free entry.
+ * Disabling the asynchronous mode waits until the queue is empty, then goes back to busy flag polling if lcd_init() enabled it.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_set_async_mode(lcd_t *p_lcd, bool enable);
+
+/*
+ * lcd_is_idle()
+ * returns true if the transmit queue is empty and the display finished executing the last instruction, false otherwise.
+ */
+
+extern bool lcd_is_idle(const lcd_t *p_lcd);
+
+/*
+ * lcd_wait_idle()
+ * waits until lcd_is_idle() is true.
+ */
+
+extern void lcd_wait_idle(const lcd_t *p_lcd);
+
+/*
+ * lcd_get_queue_hwm()
+ * returns the highest number of entries ever waiting in the transmit queue.
+ */
+
+extern uint8_t lcd_get_queue_hwm(const lcd_t *p_lcd);
+#endif
 
 #endif /*LCD_H*/
 
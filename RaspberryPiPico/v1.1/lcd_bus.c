@@ -0,0 +1,522 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Shared bus transport (several displays on the same DB4-DB7 and RS pins, one E pin each).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_bus.h"
+
+#include "lcd_hal.h"
+
+#define __LCD_BUS_EN_DELAY_US 1U
+
+/*time_us_32() may tick right after the write, so the execution time is counted from the next tick*/
+#define __LCD_BUS_TICK_US 1U
+
+#define __LCD_BUS_QUEUE_MASK (LCD_CFG_BUS_QUEUE_SIZE - 1U)
+
+#define __LCD_BUS_ENTRY_REG 0x01U
+#define __LCD_BUS_ENTRY_INIT_NIBBLE 0x02U
+#define __LCD_BUS_ENTRY_MIRROR 0x04U	/*PLACEHOLDER: THE NEXT BYTE OF THE DISPLAY'S MIRROR*/
+
+extern bool _lcd_bus_init_display(lcd_t *p_lcd);
+extern void _lcd_bus_queue_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_bus_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_bus_end_call(lcd_t *p_lcd);
+extern bool _lcd_bus_mirror_init(lcd_t *p_lcd);
+extern void _lcd_bus_mirror_skip_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_bus_mirror_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_bus_mirror_end_call(lcd_t *p_lcd);
+extern void _lcd_bus_mirror_push(lcd_bus_mirror_t *p_ctx, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_bus_init_pins(lcd_bus_t *p_bus);
+extern bool _lcd_bus_attach(lcd_bus_t *p_bus, lcd_bus_display_t *p_ctx);
+extern void _lcd_bus_push(lcd_bus_display_t *p_ctx, uint8_t byte, uint8_t flags, uint16_t delay_us);
+extern bool _lcd_bus_service(lcd_bus_t *p_bus);
+extern bool _lcd_bus_service_mirror(lcd_bus_t *p_bus, lcd_bus_mirror_t *p_mirror);
+extern void _lcd_bus_strobe(const lcd_bus_t *p_bus, uint32_t e_mask, const struct _lcd_bus_entry *p_entry);
+
+/*lcd.c internals the mirror replays its bytes into, to keep every member's state in step*/
+extern void _lcd_track_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+extern uint16_t _lcd_exec_time_us(bool reg, uint8_t byte);
+extern uint8_t _lcd_ddram_addr_to_idx(uint8_t addr);
+extern uint8_t _lcd_idx_to_ddram_addr(uint8_t idx);
+extern bool _lcd_phys_text_cx_cy_to_ddram_addr(const lcd_t *p_lcd, uint8_t *p_addr, uint8_t physcx, uint8_t physcy);
+#if LCD_CFG_FRAMEBUFFER
+extern void _lcd_fb_set_dirty(lcd_t *p_lcd, uint8_t idx, bool dirty);
+#endif
+
+const struct _lcd_transport lcd_transport_bus = {
+	.init = _lcd_bus_init_display,
+	.send_init_nibble = _lcd_bus_queue_init_nibble,
+	.send_byte = _lcd_bus_queue_byte,
+	.flush = _lcd_bus_end_call
+};
+
+const struct _lcd_transport lcd_transport_bus_mirror = {
+	.init = _lcd_bus_mirror_init,
+	.send_init_nibble = _lcd_bus_mirror_skip_init_nibble,
+	.send_byte = _lcd_bus_mirror_queue_byte,
+	.flush = _lcd_bus_mirror_end_call
+};
+
+bool lcd_bus_poll(lcd_bus_t *p_bus)
+{
+	uint8_t n_display;
+
+	if(p_bus == NULL) return true;
+	if(!p_bus->_init) return true;
+
+	while(_lcd_bus_service(p_bus));
+
+	for(n_display = 0u; n_display < p_bus->_n_displays; n_display++)
+	{
+		if(p_bus->_displays[n_display]->_head != p_bus->_displays[n_display]->_tail) return false;
+	}
+
+	return true;
+}
+
+void lcd_bus_flush(lcd_bus_t *p_bus)
+{
+	while(!lcd_bus_poll(p_bus)) tight_loop_contents();
+
+	return;
+}
+
+bool lcd_bus_is_idle(const lcd_bus_t *p_bus)
+{
+	const lcd_bus_display_t *p_ctx;
+	uint32_t t_now;
+	uint8_t n_display;
+
+	if(p_bus == NULL) return true;
+	if(!p_bus->_init) return true;
+
+	t_now = time_us_32();
+
+	for(n_display = 0u; n_display < p_bus->_n_displays; n_display++)
+	{
+		p_ctx = p_bus->_displays[n_display];
+
+		if(p_ctx->_head != p_ctx->_tail) return false;
+		if(((int32_t) (t_now - p_ctx->_t_ready)) < 0) return false;
+	}
+
+	return true;
+}
+
+uintptr_t lcd_bus_mirror_sync(lcd_t *p_mirror)
+{
+#if LCD_CFG_FRAMEBUFFER
+	lcd_bus_mirror_t *p_ctx;
+	uintptr_t n_cells;
+	uint8_t n_line;
+	uint8_t n_char;
+	uint8_t n_member;
+	uint8_t addr;
+	uint8_t idx;
+
+	if(p_mirror == NULL) return 0u;
+	if(p_mirror->_status != __LCD_STATUS_INITIALIZED) return 0u;
+	if(p_mirror->transport != &lcd_transport_bus_mirror) return 0u;
+
+	p_ctx = (lcd_bus_mirror_t*) p_mirror->transport_ctx;
+	n_cells = 0u;
+
+	for(n_line = 0u; n_line < p_mirror->n_lines; n_line++)
+	{
+		for(n_char = 0u; n_char < p_mirror->n_chars; n_char++)
+		{
+			if(!_lcd_phys_text_cx_cy_to_ddram_addr(p_mirror, &addr, n_char, n_line)) continue;
+
+			idx = _lcd_ddram_addr_to_idx(addr);
+			if(idx >= LCD_DDRAM_SIZE) continue;
+
+			for(n_member = 0u; n_member < p_ctx->n_members; n_member++)
+			{
+				if(p_ctx->members[n_member]->_fb[idx] == p_mirror->_fb[idx]) continue;
+
+				_lcd_fb_set_dirty(p_mirror, idx, true);
+				n_cells++;
+				break;
+			}
+		}
+	}
+
+	return n_cells;
+#else
+	(void) p_mirror;
+	return 0u;
+#endif
+}
+
+bool _lcd_bus_init_display(lcd_t *p_lcd)
+{
+	lcd_bus_display_t *p_ctx;
+
+	p_ctx = (lcd_bus_display_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+	if(p_ctx->bus == NULL) return false;
+
+	if(!p_ctx->bus->_init) _lcd_bus_init_pins(p_ctx->bus);
+
+	/*Reinitialization sends whatever the bus still had queued first (mirrored bytes need every member's queue)*/
+	lcd_bus_flush(p_ctx->bus);
+
+	p_ctx->_head = 0u;
+	p_ctx->_tail = 0u;
+	p_ctx->_t_ready = time_us_32();
+
+	if(!_lcd_bus_attach(p_ctx->bus, p_ctx)) return false;
+
+	gpio_init(p_ctx->e);
+	gpio_set_dir(p_ctx->e, true);
+	gpio_put(p_ctx->e, 0);
+
+	return true;
+}
+
+void _lcd_bus_queue_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	_lcd_bus_push((lcd_bus_display_t*) p_lcd->transport_ctx, (nibble << 4), __LCD_BUS_ENTRY_INIT_NIBBLE, delay_us);
+	return;
+}
+
+void _lcd_bus_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	_lcd_bus_push((lcd_bus_display_t*) p_lcd->transport_ctx, byte, (reg ? __LCD_BUS_ENTRY_REG : 0u), delay_us);
+	return;
+}
+
+/*End of an lcd_*() call: whatever is ready goes out now, the rest on the next poll*/
+void _lcd_bus_end_call(lcd_t *p_lcd)
+{
+	while(_lcd_bus_service(((lcd_bus_display_t*) p_lcd->transport_ctx)->bus));
+
+	return;
+}
+
+bool _lcd_bus_mirror_init(lcd_t *p_lcd)
+{
+	lcd_bus_mirror_t *p_ctx;
+	lcd_bus_display_t *p_member;
+	uint8_t n_member;
+
+	p_ctx = (lcd_bus_mirror_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+	if(!p_ctx->n_members || (p_ctx->n_members > LCD_CFG_BUS_MAX_DISPLAYS)) return false;
+
+	p_ctx->_bus = NULL;
+	p_ctx->_e_mask = 0u;
+
+	for(n_member = 0u; n_member < p_ctx->n_members; n_member++)
+	{
+		if(p_ctx->members[n_member] == NULL) return false;
+		if(p_ctx->members[n_member]->_status != __LCD_STATUS_INITIALIZED) return false;
+		if(p_ctx->members[n_member]->transport != &lcd_transport_bus) return false;
+
+		p_member = (lcd_bus_display_t*) p_ctx->members[n_member]->transport_ctx;
+
+		if((p_member->_mirror != NULL) && (p_member->_mirror != p_ctx)) return false;
+		if((p_ctx->_bus != NULL) && (p_member->bus != p_ctx->_bus)) return false;
+
+		p_ctx->_bus = p_member->bus;
+		p_ctx->_e_mask |= (1u << p_member->e);
+	}
+
+	/*Reinitialization: every mirrored byte still queued goes out first*/
+	lcd_bus_flush(p_ctx->_bus);
+
+	p_ctx->_head = 0u;
+	p_ctx->_tail = 0u;
+	p_ctx->_ac = 0xff;
+
+	for(n_member = 0u; n_member < p_ctx->n_members; n_member++)
+	{
+		((lcd_bus_display_t*) p_ctx->members[n_member]->transport_ctx)->_mirror = p_ctx;
+	}
+
+	return true;
+}
+
+/*The members are already in 4-bit mode: a lone nibble now would be taken as half a byte*/
+void _lcd_bus_mirror_skip_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	(void) p_lcd;
+	(void) nibble;
+	(void) delay_us;
+
+	return;
+}
+
+/*
+ * Data writes and cursor moves depend on the address counter, which a member's own writes may have moved since the last
+ * mirrored byte: those get an address set first, so that every member writes where the mirror does.
+ */
+
+void _lcd_bus_mirror_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	lcd_bus_mirror_t *p_ctx;
+	uint8_t n_member;
+
+	p_ctx = (lcd_bus_mirror_t*) p_lcd->transport_ctx;
+
+	if((reg || ((byte & 0xf8) == 0x10)) && (p_ctx->_ac < LCD_DDRAM_SIZE))
+	{
+		for(n_member = 0u; n_member < p_ctx->n_members; n_member++)
+		{
+			if(p_ctx->members[n_member]->_ac == p_ctx->_ac) continue;
+
+			_lcd_bus_mirror_push(p_ctx, false, (0x80 | _lcd_idx_to_ddram_addr(p_ctx->_ac)), _lcd_exec_time_us(false, 0x80));
+			break;
+		}
+	}
+
+	_lcd_bus_mirror_push(p_ctx, reg, byte, delay_us);
+
+	/*Every member's address counter now matches the mirror's*/
+	p_ctx->_ac = p_ctx->members[0]->_ac;
+
+	return;
+}
+
+/*
+ * Queues the byte once in the mirror and a placeholder in every member queue, so that it goes out in order with each
+ * member's own bytes. The members track it as if it had been sent to them alone.
+ */
+
+void _lcd_bus_mirror_push(lcd_bus_mirror_t *p_ctx, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	struct _lcd_bus_entry *p_entry;
+	uint8_t n_member;
+
+	while((p_ctx->_head - p_ctx->_tail) >= LCD_CFG_BUS_QUEUE_SIZE)
+	{
+		if(!_lcd_bus_service(p_ctx->_bus)) tight_loop_contents();
+	}
+
+	p_entry = &(p_ctx->_queue[p_ctx->_head & __LCD_BUS_QUEUE_MASK]);
+	p_entry->byte = byte;
+	p_entry->flags = (reg ? __LCD_BUS_ENTRY_REG : 0u);
+	p_entry->delay_us = delay_us;
+
+	p_ctx->_head++;
+
+	for(n_member = 0u; n_member < p_ctx->n_members; n_member++)
+	{
+		_lcd_track_byte(p_ctx->members[n_member], reg, byte);
+		_lcd_bus_push((lcd_bus_display_t*) p_ctx->members[n_member]->transport_ctx, 0u, __LCD_BUS_ENTRY_MIRROR, 0u);
+	}
+
+	return;
+}
+
+void _lcd_bus_mirror_end_call(lcd_t *p_lcd)
+{
+	while(_lcd_bus_service(((lcd_bus_mirror_t*) p_lcd->transport_ctx)->_bus));
+
+	return;
+}
+
+void _lcd_bus_init_pins(lcd_bus_t *p_bus)
+{
+	uint8_t pins[4];
+	uint8_t n_pin;
+	uint8_t nibble;
+
+	pins[0] = p_bus->db4;
+	pins[1] = p_bus->db5;
+	pins[2] = p_bus->db6;
+	pins[3] = p_bus->db7;
+
+	p_bus->_mask = 0u;
+
+	for(n_pin = 0u; n_pin < 4u; n_pin++)
+	{
+		gpio_init(pins[n_pin]);
+		gpio_set_dir(pins[n_pin], true);
+		p_bus->_mask |= (1u << pins[n_pin]);
+	}
+
+	gpio_init(p_bus->rs);
+	gpio_set_dir(p_bus->rs, true);
+	p_bus->_rs_mask = (1u << p_bus->rs);
+	p_bus->_mask |= p_bus->_rs_mask;
+
+	for(nibble = 0u; nibble < 16u; nibble++)
+	{
+		p_bus->_db_lut[nibble] = 0u;
+
+		for(n_pin = 0u; n_pin < 4u; n_pin++)
+		{
+			if(nibble & (1u << n_pin)) p_bus->_db_lut[nibble] |= (1u << pins[n_pin]);
+		}
+	}
+
+	p_bus->_n_displays = 0u;
+	p_bus->_next = 0u;
+	p_bus->_init = true;
+
+	return;
+}
+
+bool _lcd_bus_attach(lcd_bus_t *p_bus, lcd_bus_display_t *p_ctx)
+{
+	uint8_t n_display;
+
+	for(n_display = 0u; n_display < p_bus->_n_displays; n_display++)
+	{
+		if(p_bus->_displays[n_display] == p_ctx) return true;
+	}
+
+	if(p_bus->_n_displays >= LCD_CFG_BUS_MAX_DISPLAYS) return false;
+
+	p_bus->_displays[p_bus->_n_displays] = p_ctx;
+	p_bus->_n_displays++;
+
+	return true;
+}
+
+/*A full queue keeps the whole bus moving (not just this display) until there's room*/
+void _lcd_bus_push(lcd_bus_display_t *p_ctx, uint8_t byte, uint8_t flags, uint16_t delay_us)
+{
+	struct _lcd_bus_entry *p_entry;
+
+	while((p_ctx->_head - p_ctx->_tail) >= LCD_CFG_BUS_QUEUE_SIZE)
+	{
+		if(!_lcd_bus_service(p_ctx->bus)) tight_loop_contents();
+	}
+
+	p_entry = &(p_ctx->_queue[p_ctx->_head & __LCD_BUS_QUEUE_MASK]);
+	p_entry->byte = byte;
+	p_entry->flags = flags;
+	p_entry->delay_us = delay_us;
+
+	p_ctx->_head++;
+	return;
+}
+
+/*
+ * One round robin pass over the displays, starting after the last one served:
+ * every display with a queued byte that isn't executing an instruction gets its next byte.
+ * A mirrored byte waits until it is next in every member queue.
+ * returns true if anything was sent.
+ */
+
+bool _lcd_bus_service(lcd_bus_t *p_bus)
+{
+	lcd_bus_display_t *p_ctx;
+	const struct _lcd_bus_entry *p_entry;
+	uint8_t n_display;
+	uint8_t idx;
+	bool sent;
+
+	sent = false;
+
+	for(n_display = 0u; n_display < p_bus->_n_displays; n_display++)
+	{
+		idx = p_bus->_next + n_display;
+		if(idx >= p_bus->_n_displays) idx -= p_bus->_n_displays;
+
+		p_ctx = p_bus->_displays[idx];
+
+		if(p_ctx->_head == p_ctx->_tail) continue;
+		if(((int32_t) (time_us_32() - p_ctx->_t_ready)) < 0) continue;
+
+		p_entry = &(p_ctx->_queue[p_ctx->_tail & __LCD_BUS_QUEUE_MASK]);
+
+		if(p_entry->flags & __LCD_BUS_ENTRY_MIRROR)
+		{
+			if(_lcd_bus_service_mirror(p_bus, p_ctx->_mirror)) sent = true;
+			continue;
+		}
+
+		_lcd_bus_strobe(p_bus, (1u << p_ctx->e), p_entry);
+
+		p_ctx->_t_ready = time_us_32() + ((uint32_t) p_entry->delay_us) + __LCD_BUS_TICK_US;
+		p_ctx->_tail++;
+
+		sent = true;
+	}
+
+	if(p_bus->_n_displays)
+	{
+		p_bus->_next++;
+		if(p_bus->_next >= p_bus->_n_displays) p_bus->_next = 0u;
+	}
+
+	return sent;
+}
+
+/*
+ * Sends the next mirrored byte if every member has it next in its queue and none is executing an instruction.
+ * returns true if it was sent.
+ */
+
+bool _lcd_bus_service_mirror(lcd_bus_t *p_bus, lcd_bus_mirror_t *p_mirror)
+{
+	lcd_bus_display_t *p_member;
+	const struct _lcd_bus_entry *p_entry;
+	uint32_t t_ready;
+	uint8_t n_member;
+
+	for(n_member = 0u; n_member < p_mirror->n_members; n_member++)
+	{
+		p_member = (lcd_bus_display_t*) p_mirror->members[n_member]->transport_ctx;
+
+		if(p_member->_head == p_member->_tail) return false;
+		if(!(p_member->_queue[p_member->_tail & __LCD_BUS_QUEUE_MASK].flags & __LCD_BUS_ENTRY_MIRROR)) return false;
+		if(((int32_t) (time_us_32() - p_member->_t_ready)) < 0) return false;
+	}
+
+	p_entry = &(p_mirror->_queue[p_mirror->_tail & __LCD_BUS_QUEUE_MASK]);
+
+	_lcd_bus_strobe(p_bus, p_mirror->_e_mask, p_entry);
+
+	t_ready = time_us_32() + ((uint32_t) p_entry->delay_us) + __LCD_BUS_TICK_US;
+	p_mirror->_tail++;
+
+	for(n_member = 0u; n_member < p_mirror->n_members; n_member++)
+	{
+		p_member = (lcd_bus_display_t*) p_mirror->members[n_member]->transport_ctx;
+
+		p_member->_t_ready = t_ready;
+		p_member->_tail++;
+	}
+
+	return true;
+}
+
+/*
+ * Strobes a byte into the displays whose E lines are in "e_mask" (raised together), the others ignore the shared lines.
+ * RS and the high nibble change together (one masked write), then E goes high at least tAS later.
+ */
+
+void _lcd_bus_strobe(const lcd_bus_t *p_bus, uint32_t e_mask, const struct _lcd_bus_entry *p_entry)
+{
+	uint32_t rs;
+
+	rs = 0u;
+	if(p_entry->flags & __LCD_BUS_ENTRY_REG) rs = p_bus->_rs_mask;
+
+	gpio_put_masked(p_bus->_mask, (p_bus->_db_lut[p_entry->byte >> 4] | rs));
+	sleep_us(__LCD_BUS_EN_DELAY_US);
+	gpio_put_masked(e_mask, e_mask);
+	sleep_us(__LCD_BUS_EN_DELAY_US);
+	gpio_put_masked(e_mask, 0u);
+
+	if(!(p_entry->flags & __LCD_BUS_ENTRY_INIT_NIBBLE))
+	{
+		sleep_us(__LCD_BUS_EN_DELAY_US);
+		gpio_put_masked(p_bus->_mask, (p_bus->_db_lut[p_entry->byte & 0xf] | rs));
+		gpio_put_masked(e_mask, e_mask);
+		sleep_us(__LCD_BUS_EN_DELAY_US);
+		gpio_put_masked(e_mask, 0u);
+	}
+
+	return;
+}
@@ -0,0 +1,166 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Shared bus transport (several displays on the same DB4-DB7 and RS pins, one E pin each).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_BUS_H
+#define LCD_BUS_H
+
+#include "lcd.h"
+
+/*
+ * LCD_CFG_BUS_QUEUE_SIZE
+ * Number of bytes each display can have queued (power of 2). Each entry takes 4 bytes.
+ * The default holds a full 20x4 screen refresh, so refreshing one display never waits for the others.
+ *
+ * LCD_CFG_BUS_MAX_DISPLAYS
+ * Maximum number of displays on a single bus.
+ */
+
+#ifndef LCD_CFG_BUS_QUEUE_SIZE
+#define LCD_CFG_BUS_QUEUE_SIZE 128U
+#endif
+
+#ifndef LCD_CFG_BUS_MAX_DISPLAYS
+#define LCD_CFG_BUS_MAX_DISPLAYS 4U
+#endif
+
+/*
+ * The bus owns the shared pins and a byte queue per display. lcd_*() calls on a display only queue its bytes,
+ * the bus then strobes the next byte into every display that isn't executing an instruction, so one display's
+ * execution time (37us per byte, 1.52ms per clear) is spent writing to the others instead of waiting.
+ *
+ * Bytes go out while queuing (when a queue is full), at the end of every lcd_*() call and on lcd_bus_poll()/lcd_bus_flush().
+ * Call lcd_bus_poll() from the main loop, or lcd_bus_flush() once every display was updated.
+ *
+ * 4-bit bus only, the R/W pins must be tied low (execution times are timed, the busy flag isn't read).
+ * The lcd_t GPIO pin fields are not used. The first lcd_init() on the bus initializes the shared pins.
+ * An E pin isn't driven until lcd_init() of its display, so give each E line a pull-down resistor
+ * to keep that display from latching the bytes sent to the others before then.
+ *
+ * Usage:
+ * lcd_bus_t lcd_bus = {.db4 = 6, .db5 = 7, .db6 = 8, .db7 = 9, .rs = 5};
+ * lcd_bus_display_t lcd_bus_1 = {.bus = &lcd_bus, .e = 3};
+ * lcd_bus_display_t lcd_bus_2 = {.bus = &lcd_bus, .e = 2};
+ * lcd_t lcd1 = {.n_chars = 20, .n_lines = 4, .transport = &lcd_transport_bus, .transport_ctx = &lcd_bus_1};
+ * lcd_t lcd2 = {.n_chars = 16, .n_lines = 2, .transport = &lcd_transport_bus, .transport_ctx = &lcd_bus_2};
+ */
+
+struct _lcd_bus_display;
+struct _lcd_bus_mirror;
+
+struct _lcd_bus_entry {
+	uint8_t byte;
+	uint8_t flags;
+	uint16_t delay_us;
+};
+
+struct _lcd_bus {
+	uint8_t db4;					/*DB4 GPIO PIN (SHARED)*/
+	uint8_t db5;					/*DB5 GPIO PIN (SHARED)*/
+	uint8_t db6;					/*DB6 GPIO PIN (SHARED)*/
+	uint8_t db7;					/*DB7 GPIO PIN (SHARED)*/
+	uint8_t rs;					/*RS GPIO PIN (SHARED)*/
+	bool _init;					/*IGNORE (INTERNAL USE)*/
+	uint8_t _n_displays;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _next;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _mask;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _rs_mask;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _db_lut[16];				/*IGNORE (INTERNAL USE)*/
+	struct _lcd_bus_display *_displays[LCD_CFG_BUS_MAX_DISPLAYS];	/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_bus lcd_bus_t;
+
+struct _lcd_bus_display {
+	lcd_bus_t *bus;					/*SHARED BUS*/
+	uint8_t e;					/*E GPIO PIN OF THIS DISPLAY*/
+	uint32_t _t_ready;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _head;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _tail;					/*IGNORE (INTERNAL USE)*/
+	struct _lcd_bus_mirror *_mirror;		/*IGNORE (INTERNAL USE)*/
+	struct _lcd_bus_entry _queue[LCD_CFG_BUS_QUEUE_SIZE];	/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_bus_display lcd_bus_display_t;
+
+/*
+ * Mirror group: an lcd_t on lcd_transport_bus_mirror drives every member display at once. Each byte it sends is strobed
+ * with the E lines of all members raised together, so mirrored content costs one transfer instead of one per display.
+ * The members stay usable on their own: their own bytes keep going out individually, in order with the mirrored ones.
+ * After a member's own writes, the next mirrored write first puts the cursor of every member back where the mirror left it.
+ *
+ * The members must be lcd_transport_bus displays of the same bus, initialized before the mirror, and a display can
+ * only belong to one mirror. lcd_init() of the mirror doesn't send the init nibble (the members are already in 4-bit mode)
+ * but clears every member.
+ * The mirror geometry (n_chars, n_lines) is the area shown on every member: usually the smallest member's size
+ * (16x2 for a 20x4 and a 16x2). 4 line mirrors need members with the same number of characters per line.
+ *
+ * Every member keeps track of the mirrored bytes (cursor position, framebuffer contents). With LCD_CFG_FRAMEBUFFER,
+ * lcd_bus_mirror_sync() finds the cells a member was given its own content for, so that the next lcd_flush()
+ * of the mirror puts the mirrored contents back (see below).
+ *
+ * Usage (with the displays of the example above):
+ * lcd_bus_mirror_t lcd_mirror = {.members = {&lcd1, &lcd2}, .n_members = 2};
+ * lcd_t lcd_all = {.n_chars = 16, .n_lines = 2, .transport = &lcd_transport_bus_mirror, .transport_ctx = &lcd_mirror};
+ */
+
+struct _lcd_bus_mirror {
+	lcd_t *members[LCD_CFG_BUS_MAX_DISPLAYS];	/*MEMBER DISPLAYS*/
+	uint8_t n_members;				/*NUMBER OF MEMBERS*/
+	lcd_bus_t *_bus;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _e_mask;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _ac;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _head;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _tail;					/*IGNORE (INTERNAL USE)*/
+	struct _lcd_bus_entry _queue[LCD_CFG_BUS_QUEUE_SIZE];	/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_bus_mirror lcd_bus_mirror_t;
+
+extern const struct _lcd_transport lcd_transport_bus;
+extern const struct _lcd_transport lcd_transport_bus_mirror;
+
+/*
+ * lcd_bus_poll()
+ * sends the next queued byte of every display that finished executing its last instruction, as long as there are any,
+ * without waiting for the busy ones.
+ *
+ * returns true if every queue is empty, false otherwise.
+ */
+
+extern bool lcd_bus_poll(lcd_bus_t *p_bus);
+
+/*
+ * lcd_bus_flush()
+ * sends every queued byte of every display, overlapping their execution times.
+ * returns once the last byte was sent (the display may still be executing it).
+ */
+
+extern void lcd_bus_flush(lcd_bus_t *p_bus);
+
+/*
+ * lcd_bus_is_idle()
+ * returns true if every queue is empty and every display finished executing its last instruction, false otherwise.
+ */
+
+extern bool lcd_bus_is_idle(const lcd_bus_t *p_bus);
+
+/*
+ * lcd_bus_mirror_sync()
+ * marks every cell of the mirror area that some member doesn't show (because it was written to that member alone)
+ * as changed in the mirror framebuffer, so that the next lcd_flush() of the mirror (framebuffer mode) rewrites it
+ * on every member, one transfer per cell. Cells every member already shows stay untouched.
+ * Requires LCD_CFG_FRAMEBUFFER.
+ *
+ * returns the number of cells marked.
+ */
+
+extern uintptr_t lcd_bus_mirror_sync(lcd_t *p_mirror);
+
+#endif /*LCD_BUS_H*/
@@ -0,0 +1,206 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Console (text stream with control characters, line wrap and scrolling).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_console.h"
+
+#include <string.h>
+
+#if LCD_CFG_FRAMEBUFFER
+
+extern bool _lcd_console_control(lcd_console_t *p_console, uint8_t byte);
+extern void _lcd_console_scroll(lcd_console_t *p_console, const uint8_t *p_run, uint8_t len);
+
+/*lcd.c internals: lazy cursor, field output and the RAM shadow*/
+extern bool _lcd_set_cursor_lazy(lcd_t *p_lcd, uint8_t cx, uint8_t cy);
+extern void _lcd_put_field(lcd_t *p_lcd, const uint8_t *p_field, uint8_t len);
+extern void _lcd_transport_flush(lcd_t *p_lcd);
+extern uint8_t _lcd_ddram_addr_to_idx(uint8_t addr);
+extern bool _lcd_phys_text_cx_cy_to_ddram_addr(const lcd_t *p_lcd, uint8_t *p_addr, uint8_t physcx, uint8_t physcy);
+
+bool lcd_console_clear(lcd_console_t *p_console)
+{
+	if(p_console == NULL) return false;
+	if(p_console->lcd == NULL) return false;
+
+	if(!lcd_clear(p_console->lcd)) return false;
+
+	p_console->_cx = 0u;
+	p_console->_cy = 0u;
+
+	return true;
+}
+
+bool lcd_console_set_cursor(lcd_console_t *p_console, uint8_t cx, uint8_t cy)
+{
+	if(p_console == NULL) return false;
+	if(p_console->lcd == NULL) return false;
+	if(cx >= p_console->lcd->n_chars) return false;
+	if(cy >= p_console->lcd->n_lines) return false;
+
+	p_console->_cx = cx;
+	p_console->_cy = cy;
+
+	return true;
+}
+
+bool lcd_console_write(lcd_console_t *p_console, const char *text, uintptr_t len)
+{
+	lcd_t *p_lcd;
+	const uint8_t *p_text;
+	uintptr_t n_byte;
+	uint8_t run;
+
+	if(p_console == NULL) return false;
+	if(text == NULL) return false;
+
+	p_lcd = p_console->lcd;
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+
+	p_text = (const uint8_t*) text;
+	n_byte = 0u;
+
+	while(n_byte < len)
+	{
+		if(_lcd_console_control(p_console, p_text[n_byte]))
+		{
+			n_byte++;
+			continue;
+		}
+
+		/*Line end reached by the previous character: wrap now*/
+		if(p_console->_cx >= p_lcd->n_chars)
+		{
+			p_console->_cx = 0u;
+			p_console->_cy++;
+		}
+
+		/*Printable characters up to the next control character or the line end*/
+		run = 0u;
+		while(((n_byte + run) < len) && (run < (p_lcd->n_chars - p_console->_cx)))
+		{
+			if((p_text[n_byte + run] == '\n') || (p_text[n_byte + run] == '\r') || (p_text[n_byte + run] == '\b') || (p_text[n_byte + run] == '\t')) break;
+			run++;
+		}
+
+		if(p_console->_cy >= p_lcd->n_lines)
+		{
+			_lcd_console_scroll(p_console, &(p_text[n_byte]), run);
+			p_console->_cy = p_lcd->n_lines - 1u;
+		}
+		else
+		{
+			_lcd_set_cursor_lazy(p_lcd, p_console->_cx, p_console->_cy);
+			_lcd_put_field(p_lcd, &(p_text[n_byte]), run);
+		}
+
+		p_console->_cx += run;
+		n_byte += run;
+	}
+
+	/*A visible cursor shows where the next character goes*/
+	if((p_console->_cx < p_lcd->n_chars) && (p_console->_cy < p_lcd->n_lines)) _lcd_set_cursor_lazy(p_lcd, p_console->_cx, p_console->_cy);
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_console_print(lcd_console_t *p_console, const char *text)
+{
+	if(text == NULL) return false;
+
+	return lcd_console_write(p_console, text, strlen(text));
+}
+
+bool lcd_console_put_char(lcd_console_t *p_console, char c)
+{
+	return lcd_console_write(p_console, &c, 1u);
+}
+
+/*
+ * Moves the console cursor for a control character. The line and screen ends are handled by the next printable character.
+ * returns false if "byte" is printable.
+ */
+
+bool _lcd_console_control(lcd_console_t *p_console, uint8_t byte)
+{
+	uint8_t n_chars;
+
+	n_chars = p_console->lcd->n_chars;
+
+	switch(byte)
+	{
+		case '\n':
+			/*Past the bottom line already: scroll for the blank line in between*/
+			if(p_console->_cy >= p_console->lcd->n_lines)
+			{
+				_lcd_console_scroll(p_console, NULL, 0u);
+				p_console->_cy = p_console->lcd->n_lines - 1u;
+			}
+
+			p_console->_cx = 0u;
+			p_console->_cy++;
+			return true;
+
+		case '\r':
+			p_console->_cx = 0u;
+			return true;
+
+		case '\b':
+			if(p_console->_cx > n_chars) p_console->_cx = n_chars;
+			if(p_console->_cx) p_console->_cx--;
+			return true;
+
+		case '\t':
+			p_console->_cx = ((p_console->_cx/LCD_CFG_CONSOLE_TAB_SIZE) + 1u)*LCD_CFG_CONSOLE_TAB_SIZE;
+			if(p_console->_cx > n_chars) p_console->_cx = n_chars;
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Every line takes the contents of the one below it in the RAM shadow, and the bottom line gets "len" characters of "p_run"
+ * at the console cursor position (blanks elsewhere). Only the cells that differ from the shadow are sent,
+ * so a log of similar lines costs the characters that differ rather than the whole screen.
+ */
+
+void _lcd_console_scroll(lcd_console_t *p_console, const uint8_t *p_run, uint8_t len)
+{
+	lcd_t *p_lcd;
+	uint8_t line[LCD_DDRAM_LINE_SIZE];
+	uint8_t addr;
+	uint8_t idx;
+	uint8_t cy;
+
+	p_lcd = p_console->lcd;
+
+	for(cy = 1u; cy < p_lcd->n_lines; cy++)
+	{
+		_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, 0u, cy);
+		idx = _lcd_ddram_addr_to_idx(addr);
+
+		memcpy(line, &(p_lcd->_fb[idx]), p_lcd->n_chars);
+
+		_lcd_set_cursor_lazy(p_lcd, 0u, (cy - 1u));
+		_lcd_put_field(p_lcd, line, p_lcd->n_chars);
+	}
+
+	memset(line, ' ', p_lcd->n_chars);
+	if(len) memcpy(&(line[p_console->_cx]), p_run, len);
+
+	_lcd_set_cursor_lazy(p_lcd, 0u, (p_lcd->n_lines - 1u));
+	_lcd_put_field(p_lcd, line, p_lcd->n_chars);
+
+	return;
+}
+
+#endif /*LCD_CFG_FRAMEBUFFER*/
@@ -0,0 +1,105 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Console (text stream with control characters, line wrap and scrolling).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_CONSOLE_H
+#define LCD_CONSOLE_H
+
+#include "lcd.h"
+
+/*
+ * LCD_CFG_CONSOLE_TAB_SIZE
+ * Distance between two tab stops, in characters.
+ */
+
+#ifndef LCD_CFG_CONSOLE_TAB_SIZE
+#define LCD_CFG_CONSOLE_TAB_SIZE 4U
+#endif
+
+/*
+ * The console prints a stream of text like a terminal, line after line in screen order (also on 20x4 displays,
+ * whose DDRAM lines are interleaved):
+ *
+ * '\n': next line, first character.
+ * '\r': first character of the line.
+ * '\b': one character back, without erasing it (nothing at the first character of a line).
+ * '\t': next tab stop (the line end at most), without erasing the characters skipped.
+ *
+ * Text reaching the line end wraps to the next line. Past the bottom line, the screen scrolls up by one line,
+ * but only when something is printed there: a text ending with '\n' doesn't leave a blank bottom line.
+ * Scrolling moves the lines through the RAM shadow of the display, so only the cells that differ are sent.
+ * Every other byte (custom glyph codes 0 to 7 included) is printed as is.
+ *
+ * The console keeps its own cursor: lcd_set_cursor_pos() and the other print functions don't move it.
+ * Requires LCD_CFG_FRAMEBUFFER (the console isn't built without the RAM shadow).
+ *
+ * Usage:
+ * lcd_console_t console = {.lcd = &lcd};
+ * lcd_console_clear(&console);
+ * lcd_console_print(&console, "Booting...\n");
+ */
+
+#if LCD_CFG_FRAMEBUFFER
+
+struct _lcd_console {
+	lcd_t *lcd;			/*DISPLAY*/
+	uint8_t _cx;			/*IGNORE (INTERNAL USE)*/
+	uint8_t _cy;			/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_console lcd_console_t;
+
+/*
+ * lcd_console_clear()
+ * clears the display and moves the console cursor to (0 , 0). The display must be initialized.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_console_clear(lcd_console_t *p_console);
+
+/*
+ * lcd_console_set_cursor()
+ * moves the console cursor to character "cx" of line "cy".
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_console_set_cursor(lcd_console_t *p_console, uint8_t cx, uint8_t cy);
+
+/*
+ * lcd_console_write()
+ * prints "len" bytes of "text" at the console cursor, consecutive printable characters of a line being sent together.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_console_write(lcd_console_t *p_console, const char *text, uintptr_t len);
+
+/*
+ * lcd_console_print()
+ * same as lcd_console_write() for a null terminated text.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_console_print(lcd_console_t *p_console, const char *text);
+
+/*
+ * lcd_console_put_char()
+ * same as lcd_console_write() for a single character.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_console_put_char(lcd_console_t *p_console, char c);
+
+#endif /*LCD_CFG_FRAMEBUFFER*/
+
+#endif /*LCD_CONSOLE_H*/
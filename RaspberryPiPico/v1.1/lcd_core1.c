@@ -0,0 +1,247 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Core 1 offload transport (RP2040 second core drives the bus).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_core1.h"
+
+#define __LCD_CORE1_EN_DELAY_US 1U
+
+/*time_us_32() resolution: the execution time is counted from the next tick after the write*/
+#define __LCD_CORE1_TICK_US 1U
+
+#define __LCD_CORE1_QUEUE_MASK (LCD_CFG_CORE1_QUEUE_SIZE - 1U)
+
+#define __LCD_CORE1_ENTRY_REG 0x01U
+#define __LCD_CORE1_ENTRY_INIT_NIBBLE 0x02U
+
+extern bool _lcd_core1_init(lcd_t *p_lcd);
+extern void _lcd_core1_queue_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_core1_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_core1_push(lcd_core1_t *p_ctx, uint8_t byte, uint8_t flags, uint16_t delay_us);
+extern void _lcd_core1_strobe(const lcd_t *p_lcd, const struct _lcd_core1_entry *p_entry);
+extern void _lcd_core1_main(void);
+
+/*lcd.c internals: pin setup and nibble writes*/
+extern void _lcd_gpio_init(lcd_t *p_lcd);
+extern void _lcd_write_nibble(const lcd_t *p_lcd, uint8_t nibble);
+
+const struct _lcd_transport lcd_transport_core1 = {
+	.init = _lcd_core1_init,
+	.send_init_nibble = _lcd_core1_queue_init_nibble,
+	.send_byte = _lcd_core1_queue_byte,
+	.flush = NULL
+};
+
+/*Display of the lcd_core1_launch() loop (core 1 takes no argument)*/
+static lcd_t *volatile _lcd_core1_lcd = NULL;
+
+bool lcd_core1_launch(lcd_t *p_lcd)
+{
+	lcd_core1_t *p_ctx;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->transport != &lcd_transport_core1) return false;
+	if(p_lcd->transport_ctx == NULL) return false;
+	if(_lcd_core1_lcd != NULL) return false;
+
+	p_ctx = (lcd_core1_t*) p_lcd->transport_ctx;
+
+	/*Core 1 isn't running yet: the only time both indexes can be written from here*/
+	p_ctx->_head = 0u;
+	p_ctx->_tail = 0u;
+	p_ctx->_busy = false;
+	p_ctx->_n_stalls = 0u;
+
+	_lcd_core1_lcd = p_lcd;
+	__dmb();
+
+	multicore_launch_core1(_lcd_core1_main);
+	return true;
+}
+
+/*
+ * Core 1. The entry at the tail is only read after the head that published it (barrier),
+ * and the tail only moves once the entry was read, which hands its slot back to core 0.
+ */
+
+bool lcd_core1_task(lcd_t *p_lcd)
+{
+	lcd_core1_t *p_ctx;
+	const struct _lcd_core1_entry *p_entry;
+	uint32_t tail;
+	bool sent;
+
+	p_ctx = (lcd_core1_t*) p_lcd->transport_ctx;
+	sent = false;
+
+	while(true)
+	{
+		if(p_ctx->_busy && (((int32_t) (time_us_32() - p_ctx->_t_ready)) < 0)) return sent;
+
+		tail = p_ctx->_tail;
+
+		if(tail == p_ctx->_head)
+		{
+			p_ctx->_busy = false;
+			return sent;
+		}
+
+		__dmb();
+
+		p_entry = &(p_ctx->_queue[tail & __LCD_CORE1_QUEUE_MASK]);
+
+		p_ctx->_busy = true;
+		_lcd_core1_strobe(p_lcd, p_entry);
+		p_ctx->_t_ready = time_us_32() + ((uint32_t) p_entry->delay_us) + __LCD_CORE1_TICK_US;
+
+		__dmb();
+		p_ctx->_tail = tail + 1u;
+
+		sent = true;
+	}
+}
+
+uint32_t lcd_core1_get_free(const lcd_t *p_lcd)
+{
+	const lcd_core1_t *p_ctx;
+
+	if(p_lcd == NULL) return 0u;
+	if(p_lcd->transport != &lcd_transport_core1) return 0u;
+
+	p_ctx = (const lcd_core1_t*) p_lcd->transport_ctx;
+
+	return (LCD_CFG_CORE1_QUEUE_SIZE - (p_ctx->_head - p_ctx->_tail));
+}
+
+uint32_t lcd_core1_get_n_stalls(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return 0u;
+	if(p_lcd->transport != &lcd_transport_core1) return 0u;
+
+	return ((const lcd_core1_t*) p_lcd->transport_ctx)->_n_stalls;
+}
+
+bool lcd_core1_is_idle(const lcd_t *p_lcd)
+{
+	const lcd_core1_t *p_ctx;
+
+	if(p_lcd == NULL) return true;
+	if(p_lcd->transport != &lcd_transport_core1) return true;
+
+	p_ctx = (const lcd_core1_t*) p_lcd->transport_ctx;
+
+	if(p_ctx->_tail != p_ctx->_head) return false;
+
+	/*Core 1 sets the busy flag before moving the tail past the last entry, and clears it once that entry was executed*/
+	__dmb();
+	return !p_ctx->_busy;
+}
+
+void lcd_core1_wait_idle(const lcd_t *p_lcd)
+{
+	while(!lcd_core1_is_idle(p_lcd)) tight_loop_contents();
+
+	return;
+}
+
+bool _lcd_core1_init(lcd_t *p_lcd)
+{
+	lcd_core1_t *p_ctx;
+
+	p_ctx = (lcd_core1_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+
+	/*Reinitialization: core 1 sends whatever is still queued before the pins are set up again*/
+	while(p_ctx->_tail != p_ctx->_head) tight_loop_contents();
+
+	_lcd_gpio_init(p_lcd);
+
+	p_ctx->_n_stalls = 0u;
+	return true;
+}
+
+void _lcd_core1_queue_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	_lcd_core1_push((lcd_core1_t*) p_lcd->transport_ctx, (nibble << 4), __LCD_CORE1_ENTRY_INIT_NIBBLE, delay_us);
+	return;
+}
+
+void _lcd_core1_queue_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	_lcd_core1_push((lcd_core1_t*) p_lcd->transport_ctx, byte, (reg ? __LCD_CORE1_ENTRY_REG : 0u), delay_us);
+	return;
+}
+
+/*
+ * Core 0. A full ring waits for core 1 to move the tail. The entry is written before the head that publishes it (barrier).
+ */
+
+void _lcd_core1_push(lcd_core1_t *p_ctx, uint8_t byte, uint8_t flags, uint16_t delay_us)
+{
+	struct _lcd_core1_entry *p_entry;
+	uint32_t head;
+
+	head = p_ctx->_head;
+
+	if((head - p_ctx->_tail) >= LCD_CFG_CORE1_QUEUE_SIZE)
+	{
+		p_ctx->_n_stalls++;
+		while((head - p_ctx->_tail) >= LCD_CFG_CORE1_QUEUE_SIZE) tight_loop_contents();
+	}
+
+	/*Core 1 read the slot before it moved the tail past it*/
+	__dmb();
+
+	p_entry = &(p_ctx->_queue[head & __LCD_CORE1_QUEUE_MASK]);
+	p_entry->byte = byte;
+	p_entry->flags = flags;
+	p_entry->delay_us = delay_us;
+
+	__dmb();
+	p_ctx->_head = head + 1u;
+
+	return;
+}
+
+/*Core 1: 4-bit transfer of one entry (RS, high nibble, low nibble unless it's the init nibble)*/
+void _lcd_core1_strobe(const lcd_t *p_lcd, const struct _lcd_core1_entry *p_entry)
+{
+	gpio_put(p_lcd->rs, (p_entry->flags & __LCD_CORE1_ENTRY_REG));
+	sleep_us(__LCD_CORE1_EN_DELAY_US);
+
+	_lcd_write_nibble(p_lcd, (p_entry->byte >> 4));
+	gpio_put(p_lcd->e, 1);
+	sleep_us(__LCD_CORE1_EN_DELAY_US);
+	gpio_put(p_lcd->e, 0);
+
+	if(p_entry->flags & __LCD_CORE1_ENTRY_INIT_NIBBLE) return;
+
+	sleep_us(__LCD_CORE1_EN_DELAY_US);
+
+	_lcd_write_nibble(p_lcd, (p_entry->byte & 0xf));
+	gpio_put(p_lcd->e, 1);
+	sleep_us(__LCD_CORE1_EN_DELAY_US);
+	gpio_put(p_lcd->e, 0);
+
+	return;
+}
+
+void _lcd_core1_main(void)
+{
+	lcd_t *p_lcd;
+
+	p_lcd = _lcd_core1_lcd;
+
+	while(true)
+	{
+		if(!lcd_core1_task(p_lcd)) tight_loop_contents();
+	}
+
+	return;
+}
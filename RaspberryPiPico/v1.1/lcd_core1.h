@@ -0,0 +1,119 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Core 1 offload transport (RP2040 second core drives the bus).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_CORE1_H
+#define LCD_CORE1_H
+
+#include "lcd.h"
+
+#include "lcd_hal.h"
+
+#if !defined(LCD_HAL_HOST)
+#include "pico/multicore.h"
+#endif
+
+/*
+ * LCD_CFG_CORE1_QUEUE_SIZE
+ * Number of bytes that can wait for core 1 (power of 2). Each entry takes 4 bytes.
+ * The default holds a full 20x4 screen refresh, so a refresh never waits for the display.
+ */
+
+#ifndef LCD_CFG_CORE1_QUEUE_SIZE
+#define LCD_CFG_CORE1_QUEUE_SIZE 128U
+#endif
+
+/*
+ * lcd_*() calls on core 0 only append their bytes to a single producer/single consumer ring in SRAM.
+ * Core 1 drains it: it owns the GPIO pins and every execution time wait, so core 0 never sleeps on the display.
+ * Neither side takes a lock or disables interrupts: core 0 only writes the head index, core 1 only the tail index.
+ *
+ * The GPIO pins of the lcd_t are used (4-bit bus, the busy flag isn't polled).
+ * Call lcd_core1_launch() before lcd_init(), or run lcd_core1_task() from your own core 1 loop
+ * (the lcd_core1_t must then start zeroed: static storage or memset()).
+ * A single display per core 1. Every lcd_*() call on it must come from the same core.
+ *
+ * When the ring is full, lcd_*() calls wait for core 1 to make room (counted by lcd_core1_get_n_stalls(),
+ * and by the wait time of lcd_get_stats() with LCD_CFG_STATS). Check lcd_core1_get_free() first to never wait.
+ *
+ * Usage:
+ * lcd_core1_t lcd_core1;
+ * lcd_t lcd = {.db4 = 6, ..., .transport = &lcd_transport_core1, .transport_ctx = &lcd_core1};
+ * lcd_core1_launch(&lcd);
+ * lcd_init(&lcd);
+ */
+
+struct _lcd_core1_entry {
+	uint8_t byte;
+	uint8_t flags;
+	uint16_t delay_us;
+};
+
+struct _lcd_core1 {
+	volatile uint32_t _head;			/*IGNORE (INTERNAL USE)*/
+	volatile uint32_t _tail;			/*IGNORE (INTERNAL USE)*/
+	volatile bool _busy;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _t_ready;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _n_stalls;				/*IGNORE (INTERNAL USE)*/
+	struct _lcd_core1_entry _queue[LCD_CFG_CORE1_QUEUE_SIZE];	/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_core1 lcd_core1_t;
+
+extern const struct _lcd_transport lcd_transport_core1;
+
+/*
+ * lcd_core1_launch()
+ * starts core 1 (multicore_launch_core1()) on a loop that runs lcd_core1_task() for this display.
+ * Core 1 must be in reset (not launched yet).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_core1_launch(lcd_t *p_lcd);
+
+/*
+ * lcd_core1_task()
+ * core 1 side: sends every queued byte whose turn has come, without waiting for the display.
+ * Only needed when core 1 runs its own loop instead of lcd_core1_launch().
+ *
+ * returns true if anything was sent, false otherwise.
+ */
+
+extern bool lcd_core1_task(lcd_t *p_lcd);
+
+/*
+ * lcd_core1_get_free()
+ * returns the number of bytes that can be queued without waiting for core 1.
+ */
+
+extern uint32_t lcd_core1_get_free(const lcd_t *p_lcd);
+
+/*
+ * lcd_core1_get_n_stalls()
+ * returns the number of bytes that had to wait for room in the ring since lcd_init().
+ */
+
+extern uint32_t lcd_core1_get_n_stalls(const lcd_t *p_lcd);
+
+/*
+ * lcd_core1_is_idle()
+ * returns true if core 1 sent every queued byte and the display finished executing the last instruction, false otherwise.
+ */
+
+extern bool lcd_core1_is_idle(const lcd_t *p_lcd);
+
+/*
+ * lcd_core1_wait_idle()
+ * waits until lcd_core1_is_idle() is true: once it returns, the display shows every lcd_*() call made before.
+ */
+
+extern void lcd_core1_wait_idle(const lcd_t *p_lcd);
+
+#endif /*LCD_CORE1_H*/
@@ -0,0 +1,41 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Hardware abstraction layer.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_HAL_H
+#define LCD_HAL_H
+
+/*
+ * The driver only talks to the hardware through this subset of the Pico SDK:
+ *
+ * GPIO:	gpio_init(), gpio_set_dir(), gpio_put(), gpio_put_masked(), gpio_get(), gpio_set_function(), gpio_pull_up()
+ * Time:	sleep_us(), time_us_32(), tight_loop_contents()
+ * Alarms:	add_alarm_in_us() (LCD_CFG_ASYNC only)
+ * Sync:	save_and_disable_interrupts(), restore_interrupts(), __dmb()
+ * I2C:	i2c_init(), i2c_write_blocking() (lcd_i2c.c only)
+ * SPI:	spi_init(), spi_set_format(), spi_write_blocking() (lcd_spi.c only)
+ * Multicore:	multicore_launch_core1() (lcd_core1.c only)
+ *
+ * lcd_pio.c drives the PIO and DMA blocks directly and is not covered by this layer.
+ *
+ * LCD_HAL_HOST
+ * Define it to build the driver on a host machine: the functions above then come from lcd_hal_host.h (see Host/),
+ * which runs them against an emulated HD44780 on a virtual clock.
+ */
+
+#if defined(LCD_HAL_HOST)
+#include "lcd_hal_host.h"
+#else
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#endif
+
+#endif /*LCD_HAL_H*/
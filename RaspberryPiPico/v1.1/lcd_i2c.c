@@ -0,0 +1,268 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * PCF8574/PCF8574A I2C backpack transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_i2c.h"
+
+#include "lcd_hal.h"
+
+#define __LCD_I2C_RS 0x01U
+#define __LCD_I2C_RW 0x02U
+#define __LCD_I2C_E 0x04U
+#define __LCD_I2C_BL 0x08U
+
+#define __LCD_I2C_DEFAULT_BAUDRATE 400000U
+
+/*Bits per byte on the wire (8 data + ACK)*/
+#define __LCD_I2C_BITS_PER_BYTE 9U
+
+/*Longer waits than this many idle bytes are done after the write instead*/
+#define __LCD_I2C_MAX_IDLE_BYTES 4U
+
+extern bool _lcd_i2c_init(lcd_t *p_lcd);
+extern void _lcd_i2c_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_i2c_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_i2c_flush(lcd_t *p_lcd);
+extern bool _lcd_i2c_probe(lcd_i2c_t *p_ctx, uint8_t address);
+extern void _lcd_i2c_put(lcd_i2c_t *p_ctx, uint8_t byte);
+extern void _lcd_i2c_put_nibble(lcd_i2c_t *p_ctx, uint8_t nibble);
+extern void _lcd_i2c_wait_pending(lcd_i2c_t *p_ctx);
+extern bool _lcd_i2c_write(lcd_i2c_t *p_ctx);
+
+const struct _lcd_transport lcd_transport_i2c = {
+	.init = _lcd_i2c_init,
+	.send_init_nibble = _lcd_i2c_send_init_nibble,
+	.send_byte = _lcd_i2c_send_byte,
+	.flush = _lcd_i2c_flush
+};
+
+bool lcd_i2c_set_backlight(lcd_t *p_lcd, bool on)
+{
+	lcd_i2c_t *p_ctx;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(p_lcd->transport != &lcd_transport_i2c) return false;
+
+	p_ctx = (lcd_i2c_t*) p_lcd->transport_ctx;
+
+	if(on) p_ctx->_ctrl = __LCD_I2C_BL;
+	else p_ctx->_ctrl = 0u;
+
+	/*E low: the display doesn't see this write*/
+	_lcd_i2c_put(p_ctx, (p_ctx->_ctrl | p_ctx->_rs));
+
+	return _lcd_i2c_write(p_ctx);
+}
+
+uint8_t lcd_i2c_get_address(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return 0u;
+	if(p_lcd->transport != &lcd_transport_i2c) return 0u;
+
+	return ((const lcd_i2c_t*) p_lcd->transport_ctx)->address;
+}
+
+uint32_t lcd_i2c_get_errors(const lcd_t *p_lcd)
+{
+	if(p_lcd == NULL) return 0u;
+	if(p_lcd->transport != &lcd_transport_i2c) return 0u;
+
+	return ((const lcd_i2c_t*) p_lcd->transport_ctx)->_n_errors;
+}
+
+bool _lcd_i2c_init(lcd_t *p_lcd)
+{
+	lcd_i2c_t *p_ctx;
+	uint32_t baudrate;
+	uint8_t address;
+
+	p_ctx = (lcd_i2c_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+	if(p_ctx->i2c == NULL) return false;
+
+	baudrate = p_ctx->baudrate;
+	if(!baudrate) baudrate = __LCD_I2C_DEFAULT_BAUDRATE;
+
+	baudrate = i2c_init(p_ctx->i2c, baudrate);
+
+	gpio_set_function(p_ctx->sda, GPIO_FUNC_I2C);
+	gpio_set_function(p_ctx->scl, GPIO_FUNC_I2C);
+	gpio_pull_up(p_ctx->sda);
+	gpio_pull_up(p_ctx->scl);
+
+	p_ctx->_ctrl = __LCD_I2C_BL;
+	p_ctx->_rs = 0u;
+	p_ctx->_n_bytes = 0u;
+	p_ctx->_pending_us = 0u;
+	p_ctx->_n_errors = 0u;
+	p_ctx->_byte_ns = (uint32_t) ((((uint64_t) __LCD_I2C_BITS_PER_BYTE)*1000000000ULL)/baudrate);
+
+	/*The probe write also drives E low, so the display ignores the bus until the init nibble*/
+	if(p_ctx->address) return _lcd_i2c_probe(p_ctx, p_ctx->address);
+
+	for(address = 0x20; address <= 0x27; address++)
+	{
+		if(_lcd_i2c_probe(p_ctx, address)) return true;
+	}
+
+	for(address = 0x38; address <= 0x3f; address++)
+	{
+		if(_lcd_i2c_probe(p_ctx, address)) return true;
+	}
+
+	return false;
+}
+
+void _lcd_i2c_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	lcd_i2c_t *p_ctx;
+
+	p_ctx = (lcd_i2c_t*) p_lcd->transport_ctx;
+
+	_lcd_i2c_wait_pending(p_ctx);
+
+	p_ctx->_rs = 0u;
+	_lcd_i2c_put(p_ctx, ((nibble << 4) | p_ctx->_ctrl));
+	_lcd_i2c_put_nibble(p_ctx, (nibble << 4));
+	_lcd_i2c_write(p_ctx);
+
+	sleep_us(delay_us);
+	return;
+}
+
+/*
+ * Expander bytes per display byte:
+ * [RS setup, only if RS changed] [high nibble | E] [high nibble] [low nibble | E] [low nibble]
+ * The display latches each nibble on the E falling edge.
+ */
+
+void _lcd_i2c_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	lcd_i2c_t *p_ctx;
+	uint8_t rs;
+
+	p_ctx = (lcd_i2c_t*) p_lcd->transport_ctx;
+
+	_lcd_i2c_wait_pending(p_ctx);
+
+	if(reg) rs = __LCD_I2C_RS;
+	else rs = 0u;
+
+	/*RS must be stable before E rises*/
+	if(rs != p_ctx->_rs)
+	{
+		p_ctx->_rs = rs;
+		_lcd_i2c_put(p_ctx, ((byte & 0xf0) | p_ctx->_ctrl | rs));
+	}
+
+	_lcd_i2c_put_nibble(p_ctx, (byte & 0xf0));
+	_lcd_i2c_put_nibble(p_ctx, (byte << 4));
+
+	p_ctx->_pending_us = delay_us;
+	return;
+}
+
+void _lcd_i2c_flush(lcd_t *p_lcd)
+{
+	_lcd_i2c_write((lcd_i2c_t*) p_lcd->transport_ctx);
+	return;
+}
+
+bool _lcd_i2c_probe(lcd_i2c_t *p_ctx, uint8_t address)
+{
+	uint8_t byte;
+
+	byte = p_ctx->_ctrl;
+
+	if(i2c_write_blocking(p_ctx->i2c, address, &byte, 1u, false) != 1) return false;
+
+	p_ctx->address = address;
+	return true;
+}
+
+void _lcd_i2c_put(lcd_i2c_t *p_ctx, uint8_t byte)
+{
+	if(p_ctx->_n_bytes >= LCD_CFG_I2C_BUFFER_SIZE) _lcd_i2c_write(p_ctx);
+
+	p_ctx->_buf[p_ctx->_n_bytes] = byte;
+	p_ctx->_n_bytes++;
+
+	return;
+}
+
+void _lcd_i2c_put_nibble(lcd_i2c_t *p_ctx, uint8_t nibble)
+{
+	nibble &= 0xf0;
+
+	_lcd_i2c_put(p_ctx, (nibble | p_ctx->_ctrl | p_ctx->_rs | __LCD_I2C_E));
+	_lcd_i2c_put(p_ctx, (nibble | p_ctx->_ctrl | p_ctx->_rs));
+
+	return;
+}
+
+/*
+ * Makes sure the previous instruction finished executing before the next E falling edge.
+ * The next byte latches its first nibble 2 expander bytes after the last one queued, so only the rest needs waiting for:
+ * short waits are idle bytes (E low) in the same write, long ones (clear, home) a sleep after sending the buffer.
+ */
+
+void _lcd_i2c_wait_pending(lcd_i2c_t *p_ctx)
+{
+	uint32_t wait_ns;
+	uint32_t n_idle;
+	uint8_t idle;
+
+	if(!p_ctx->_pending_us) return;
+
+	wait_ns = ((uint32_t) p_ctx->_pending_us)*1000u;
+	p_ctx->_pending_us = 0u;
+
+	if(wait_ns <= 2u*(p_ctx->_byte_ns)) return;
+
+	wait_ns -= 2u*(p_ctx->_byte_ns);
+	n_idle = (wait_ns + p_ctx->_byte_ns - 1u)/(p_ctx->_byte_ns);
+
+	if(n_idle > __LCD_I2C_MAX_IDLE_BYTES)
+	{
+		_lcd_i2c_write(p_ctx);
+		sleep_us((wait_ns + 999u)/1000u);
+		return;
+	}
+
+	if(p_ctx->_n_bytes) idle = p_ctx->_buf[p_ctx->_n_bytes - 1u];
+	else idle = (p_ctx->_ctrl | p_ctx->_rs);
+
+	while(n_idle--) _lcd_i2c_put(p_ctx, idle);
+
+	return;
+}
+
+/*
+ * Sends the buffered expander bytes. The transport functions have no way to report a failure to the lcd_*() call,
+ * so a write the expander doesn't acknowledge (PICO_ERROR_GENERIC) is counted for lcd_i2c_get_errors().
+ * returns false if the write failed.
+ */
+
+bool _lcd_i2c_write(lcd_i2c_t *p_ctx)
+{
+	int n_written;
+	uint16_t n_bytes;
+
+	if(!p_ctx->_n_bytes) return true;
+
+	n_bytes = p_ctx->_n_bytes;
+	p_ctx->_n_bytes = 0u;
+
+	n_written = i2c_write_blocking(p_ctx->i2c, p_ctx->address, p_ctx->_buf, n_bytes, false);
+	if(n_written == ((int) n_bytes)) return true;
+
+	p_ctx->_n_errors++;
+	return false;
+}
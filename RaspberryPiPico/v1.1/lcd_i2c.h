@@ -0,0 +1,90 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * PCF8574/PCF8574A I2C backpack transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_I2C_H
+#define LCD_I2C_H
+
+#include "lcd.h"
+
+#include "lcd_hal.h"
+
+#if !defined(LCD_HAL_HOST)
+#include "hardware/i2c.h"
+#endif
+
+/*
+ * LCD_CFG_I2C_BUFFER_SIZE
+ * Maximum number of expander bytes sent in a single I2C write. Each display byte takes 4 (5 if RS changes).
+ */
+
+#ifndef LCD_CFG_I2C_BUFFER_SIZE
+#define LCD_CFG_I2C_BUFFER_SIZE 128U
+#endif
+
+/*
+ * Expander pinout (common backpack wiring):
+ * P0 = RS, P1 = R/W (always low), P2 = E, P3 = backlight, P4-P7 = DB4-DB7.
+ *
+ * The E high/E low sequence of every byte sent by an lcd_*() call is packed into a single I2C write (split in
+ * LCD_CFG_I2C_BUFFER_SIZE chunks). Instruction execution times are covered by the I2C transfer time itself,
+ * by idle expander bytes for slightly longer ones, or by a wait after the write for clear/home.
+ *
+ * The transport initializes the I2C block (i2c_init()) and the SDA/SCL pins.
+ * The lcd_t GPIO pin fields are not used.
+ *
+ * Usage:
+ * lcd_i2c_t lcd_i2c = {.i2c = i2c0, .sda = 4, .scl = 5};
+ * lcd_t lcd = {.n_chars = 20, .n_lines = 4, .transport = &lcd_transport_i2c, .transport_ctx = &lcd_i2c};
+ */
+
+struct _lcd_i2c {
+	i2c_inst_t *i2c;				/*I2C BLOCK (i2c0 OR i2c1)*/
+	uint8_t sda;					/*SDA GPIO PIN*/
+	uint8_t scl;					/*SCL GPIO PIN*/
+	uint8_t address;				/*7-BIT EXPANDER ADDRESS (0 TO PROBE 0x20-0x27 AND 0x38-0x3F, THEN SET TO THE ONE FOUND)*/
+	uint32_t baudrate;				/*I2C CLOCK IN HZ (0 FOR 400kHz)*/
+	uint8_t _ctrl;					/*IGNORE (INTERNAL USE)*/
+	uint8_t _rs;					/*IGNORE (INTERNAL USE)*/
+	uint16_t _n_bytes;				/*IGNORE (INTERNAL USE)*/
+	uint16_t _pending_us;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _byte_ns;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _n_errors;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _buf[LCD_CFG_I2C_BUFFER_SIZE];		/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_i2c lcd_i2c_t;
+
+extern const struct _lcd_transport lcd_transport_i2c;
+
+/*
+ * lcd_i2c_set_backlight()
+ * turns the backlight on/off (the backlight is on after lcd_init()).
+ *
+ * returns true if successful, false otherwise (the expander didn't acknowledge the write included).
+ */
+
+extern bool lcd_i2c_set_backlight(lcd_t *p_lcd, bool on);
+
+/*
+ * lcd_i2c_get_address()
+ * returns the expander address in use (the probed one if "address" was 0), or 0 if the transport isn't initialized.
+ */
+
+extern uint8_t lcd_i2c_get_address(const lcd_t *p_lcd);
+
+/*
+ * lcd_i2c_get_errors()
+ * returns the number of I2C writes the expander didn't acknowledge since lcd_init() (backpack unplugged, bus stuck),
+ * or 0 if the transport isn't initialized. The bytes of a failed write are lost, so the display may need lcd_init() again.
+ */
+
+extern uint32_t lcd_i2c_get_errors(const lcd_t *p_lcd);
+
+#endif /*LCD_I2C_H*/
@@ -0,0 +1,201 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Marquee (lines longer than the display, scrolled back and forth).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_marquee.h"
+
+#include "lcd_hal.h"
+
+#include <string.h>
+
+/*Cursor/display shift instruction: shift the display to the left (texts move left) or to the right*/
+#define __LCD_MARQUEE_SHIFT_LEFT 0x18U
+#define __LCD_MARQUEE_SHIFT_RIGHT 0x1cU
+
+extern void _lcd_marquee_draw_line(lcd_marquee_t *p_marquee, uint8_t cy, uint8_t offset, uint8_t len);
+
+/*lcd.c internals: lazy cursor, field output and the instruction register*/
+extern bool _lcd_set_cursor_lazy(lcd_t *p_lcd, uint8_t cx, uint8_t cy);
+extern void _lcd_put_field(lcd_t *p_lcd, const uint8_t *p_field, uint8_t len);
+extern void _lcd_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte);
+extern void _lcd_transport_flush(lcd_t *p_lcd);
+
+bool lcd_marquee_set_line(lcd_marquee_t *p_marquee, uint8_t cy, const char *text)
+{
+	if(p_marquee == NULL) return false;
+	if(cy >= 4u) return false;
+
+	p_marquee->_texts[cy] = text;
+	return true;
+}
+
+bool lcd_marquee_start(lcd_marquee_t *p_marquee)
+{
+	lcd_t *p_lcd;
+	uintptr_t len;
+	bool shift;
+	uint8_t cy;
+
+	if(p_marquee == NULL) return false;
+
+	p_lcd = p_marquee->lcd;
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+
+	p_marquee->_span = 0u;
+
+	/*The display shift moves every line, each over its own 40 character DDRAM line (1 and 2 line displays)*/
+	shift = (p_lcd->n_lines <= 2u);
+#if LCD_CFG_FRAMEBUFFER
+	if(p_lcd->_fb_mode) shift = false;
+#endif
+
+	for(cy = 0u; cy < 4u; cy++)
+	{
+		if(p_marquee->_texts[cy] == NULL)
+		{
+			p_marquee->_lens[cy] = 0u;
+			if(cy < p_lcd->n_lines) shift = false;
+			continue;
+		}
+
+		if(cy >= p_lcd->n_lines) return false;
+
+		len = strlen(p_marquee->_texts[cy]);
+		if(len > 0xffU) return false;
+
+		p_marquee->_lens[cy] = (uint8_t) len;
+
+		if(len <= p_lcd->n_chars) shift = false;
+		else if((len - p_lcd->n_chars) > p_marquee->_span) p_marquee->_span = (uint8_t) (len - p_lcd->n_chars);
+
+		if(len > LCD_DDRAM_LINE_SIZE) shift = false;
+	}
+
+	/*A previous marquee may have left the display shifted: return home resets the shift*/
+	if(shift || (p_marquee->_running && p_marquee->_shift && p_marquee->_pos)) lcd_home(p_lcd);
+
+	p_marquee->_shift = shift;
+	p_marquee->_pos = 0u;
+	p_marquee->_backwards = false;
+	p_marquee->_running = true;
+
+	/*Display shift: every text is written whole (padded to the longest one), all of it off screen past the line end*/
+	for(cy = 0u; cy < p_lcd->n_lines; cy++)
+	{
+		if(p_marquee->_texts[cy] == NULL) continue;
+
+		if(shift) _lcd_marquee_draw_line(p_marquee, cy, 0u, (p_marquee->_span + p_lcd->n_chars));
+		else _lcd_marquee_draw_line(p_marquee, cy, 0u, p_lcd->n_chars);
+	}
+
+	p_marquee->_t_next = time_us_32() + p_marquee->pause_ms*1000u;
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_marquee_tick(lcd_marquee_t *p_marquee)
+{
+	lcd_t *p_lcd;
+	uint32_t t_now;
+	uint8_t offset;
+	uint8_t cy;
+
+	if(p_marquee == NULL) return false;
+	if(!p_marquee->_running || !p_marquee->_span) return false;
+
+	t_now = time_us_32();
+	if(((int32_t) (t_now - p_marquee->_t_next)) < 0) return false;
+
+	p_lcd = p_marquee->lcd;
+
+	if(p_marquee->_backwards) p_marquee->_pos--;
+	else p_marquee->_pos++;
+
+	if(p_marquee->_shift) _lcd_send_byte(p_lcd, false, (p_marquee->_backwards ? __LCD_MARQUEE_SHIFT_RIGHT : __LCD_MARQUEE_SHIFT_LEFT));
+	else
+	{
+		/*Each line stops once its end shows*/
+		for(cy = 0u; cy < p_lcd->n_lines; cy++)
+		{
+			if(p_marquee->_lens[cy] <= p_lcd->n_chars) continue;
+
+			offset = p_marquee->_lens[cy] - p_lcd->n_chars;
+			if(p_marquee->_pos < offset) offset = p_marquee->_pos;
+
+			_lcd_marquee_draw_line(p_marquee, cy, offset, p_lcd->n_chars);
+		}
+	}
+
+	if((p_marquee->_pos == 0u) || (p_marquee->_pos == p_marquee->_span))
+	{
+		p_marquee->_backwards = (p_marquee->_pos != 0u);
+		p_marquee->_t_next = t_now + p_marquee->pause_ms*1000u;
+	}
+	else p_marquee->_t_next = t_now + p_marquee->step_ms*1000u;
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_marquee_stop(lcd_marquee_t *p_marquee)
+{
+	lcd_t *p_lcd;
+	uint8_t cy;
+
+	if(p_marquee == NULL) return false;
+	if(!p_marquee->_running) return true;
+
+	p_lcd = p_marquee->lcd;
+	p_marquee->_running = false;
+
+	if(!p_marquee->_pos) return true;
+
+	p_marquee->_pos = 0u;
+
+	if(p_marquee->_shift) return lcd_home(p_lcd);
+
+	for(cy = 0u; cy < p_lcd->n_lines; cy++)
+	{
+		if(p_marquee->_lens[cy] > p_lcd->n_chars) _lcd_marquee_draw_line(p_marquee, cy, 0u, p_lcd->n_chars);
+	}
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_marquee_uses_display_shift(const lcd_marquee_t *p_marquee)
+{
+	if(p_marquee == NULL) return false;
+
+	return (p_marquee->_running && p_marquee->_shift);
+}
+
+/*
+ * "len" characters of line "cy" from the character "offset" of its text, padded with spaces.
+ * Only the characters that differ from the display are sent.
+ */
+
+void _lcd_marquee_draw_line(lcd_marquee_t *p_marquee, uint8_t cy, uint8_t offset, uint8_t len)
+{
+	uint8_t line[LCD_DDRAM_LINE_SIZE];
+	uint8_t n_text;
+
+	n_text = p_marquee->_lens[cy] - offset;
+	if(n_text > len) n_text = len;
+
+	memcpy(line, &(p_marquee->_texts[cy][offset]), n_text);
+	memset(&(line[n_text]), ' ', (len - n_text));
+
+	_lcd_set_cursor_lazy(p_marquee->lcd, 0u, cy);
+	_lcd_put_field(p_marquee->lcd, line, len);
+
+	return;
+}
@@ -0,0 +1,98 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Marquee (lines longer than the display, scrolled back and forth).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_MARQUEE_H
+#define LCD_MARQUEE_H
+
+#include "lcd.h"
+
+/*
+ * Each display line can get a text longer than the line. lcd_marquee_start() prints every text,
+ * lcd_marquee_tick() then scrolls the long ones one character at a time until their end shows, pauses,
+ * scrolls them back, pauses, and so on. Texts that fit in the line don't move.
+ *
+ * Display shift: when every line of a 1 or 2 line display scrolls and every text fits in the 40 characters
+ * of its DDRAM line, the texts are written once and each step is a single display shift instruction.
+ * Otherwise (one line out of several, 4 line displays, longer texts, framebuffer mode) each step rewrites
+ * the characters of the scrolling lines that changed.
+ *
+ * The display shift moves everything shown (cursor positions are still DDRAM positions): don't print on the display
+ * while it runs. lcd_clear() and lcd_home() undo the shift, call lcd_marquee_start() again after them.
+ *
+ * Usage:
+ * lcd_marquee_t marquee = {.lcd = &lcd, .step_ms = 300, .pause_ms = 1500};
+ * lcd_marquee_set_line(&marquee, 0, "Now playing: a song with a rather long title");
+ * lcd_marquee_set_line(&marquee, 1, "An artist with an even longer name");
+ * lcd_marquee_start(&marquee);
+ * while(true) {lcd_marquee_tick(&marquee); ...}
+ */
+
+struct _lcd_marquee {
+	lcd_t *lcd;			/*DISPLAY*/
+	uint32_t step_ms;		/*TIME BETWEEN TWO STEPS*/
+	uint32_t pause_ms;		/*PAUSE AT BOTH ENDS*/
+	const char *_texts[4];		/*IGNORE (INTERNAL USE)*/
+	uint8_t _lens[4];		/*IGNORE (INTERNAL USE)*/
+	uint8_t _span;			/*IGNORE (INTERNAL USE)*/
+	uint8_t _pos;			/*IGNORE (INTERNAL USE)*/
+	bool _backwards;		/*IGNORE (INTERNAL USE)*/
+	bool _shift;			/*IGNORE (INTERNAL USE)*/
+	bool _running;			/*IGNORE (INTERNAL USE)*/
+	uint32_t _t_next;		/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_marquee lcd_marquee_t;
+
+/*
+ * lcd_marquee_set_line()
+ * sets the text of line "cy" (NULL for none: the line is left alone). The text must outlive the marquee.
+ * Takes effect on the next lcd_marquee_start().
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_marquee_set_line(lcd_marquee_t *p_marquee, uint8_t cy, const char *text);
+
+/*
+ * lcd_marquee_start()
+ * prints the texts from their start and picks the display shift or the rewriting of the lines.
+ * The display must be initialized.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_marquee_start(lcd_marquee_t *p_marquee);
+
+/*
+ * lcd_marquee_tick()
+ * scrolls by one character if the step or pause time elapsed, never waits. Call it from the main loop.
+ *
+ * returns true if a step was sent, false otherwise.
+ */
+
+extern bool lcd_marquee_tick(lcd_marquee_t *p_marquee);
+
+/*
+ * lcd_marquee_stop()
+ * stops scrolling and shows the texts from their start again (undoing the display shift).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_marquee_stop(lcd_marquee_t *p_marquee);
+
+/*
+ * lcd_marquee_uses_display_shift()
+ * returns true if the running marquee scrolls with the display shift instruction, false otherwise.
+ */
+
+extern bool lcd_marquee_uses_display_shift(const lcd_marquee_t *p_marquee);
+
+#endif /*LCD_MARQUEE_H*/
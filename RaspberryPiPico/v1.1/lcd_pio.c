@@ -0,0 +1,353 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * PIO + DMA bus transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_pio.h"
+
+#include <string.h>
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+
+/*State machine clock: one cycle per microsecond, so delay loop counts are microseconds*/
+#define __LCD_PIO_SM_CLK_HZ 1000000U
+
+#define __LCD_PIO_PROGRAM_LENGTH 14U
+
+extern bool _lcd_pio_init(lcd_t *p_lcd);
+extern void _lcd_pio_release(const lcd_pio_t *p_ctx);
+extern void _lcd_pio_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_pio_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_pio_load_program(PIO pio, uint8_t *p_offset);
+extern void _lcd_pio_start_dma(lcd_pio_t *p_ctx);
+extern void _lcd_pio_dma_irq_handler(void);
+
+const struct _lcd_transport lcd_transport_pio = {
+	.init = _lcd_pio_init,
+	.send_init_nibble = _lcd_pio_send_init_nibble,
+	.send_byte = _lcd_pio_send_byte,
+	.flush = NULL
+};
+
+static lcd_pio_t *_lcd_pio_dma_ctx[NUM_DMA_CHANNELS];
+static PIO _lcd_pio_dma_pio[NUM_DMA_CHANNELS];
+static uint8_t _lcd_pio_dma_sm[NUM_DMA_CHANNELS];
+static bool _lcd_pio_irq_installed = false;
+
+static bool _lcd_pio_program_loaded[NUM_PIOS];
+static uint8_t _lcd_pio_program_offset[NUM_PIOS];
+
+bool lcd_pio_is_idle(const lcd_t *p_lcd)
+{
+	const lcd_pio_t *p_ctx;
+
+	if(p_lcd == NULL) return true;
+	if(p_lcd->transport != &lcd_transport_pio) return true;
+
+	p_ctx = (const lcd_pio_t*) p_lcd->transport_ctx;
+
+	if(p_ctx->_busy || p_ctx->_n_words) return false;
+	if(!pio_sm_is_tx_fifo_empty(p_ctx->pio, p_ctx->_sm)) return false;
+
+	/*The state machine stalls on "pull" (program offset) once the last delay loop is over*/
+	return (pio_sm_get_pc(p_ctx->pio, p_ctx->_sm) == p_ctx->_offset);
+}
+
+void lcd_pio_wait_idle(const lcd_t *p_lcd)
+{
+	while(!lcd_pio_is_idle(p_lcd)) tight_loop_contents();
+
+	return;
+}
+
+bool _lcd_pio_init(lcd_t *p_lcd)
+{
+	lcd_pio_t *p_ctx;
+	int sm;
+	int dma_chan;
+	pio_sm_config sm_cfg;
+	dma_channel_config dma_cfg;
+
+	p_ctx = (lcd_pio_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+	if(p_ctx->pio == NULL) return false;
+
+	if(p_lcd->db5 != (p_lcd->db4 + 1u)) return false;
+	if(p_lcd->db6 != (p_lcd->db4 + 2u)) return false;
+	if(p_lcd->db7 != (p_lcd->db4 + 3u)) return false;
+
+	/*lcd_init() called again on the same context: give back the state machine and DMA channel it claimed last time*/
+	_lcd_pio_release(p_ctx);
+
+	sm = pio_claim_unused_sm(p_ctx->pio, false);
+	if(sm < 0) return false;
+
+	dma_chan = dma_claim_unused_channel(false);
+	if(dma_chan < 0)
+	{
+		pio_sm_unclaim(p_ctx->pio, (uint) sm);
+		return false;
+	}
+
+	p_ctx->_sm = (uint8_t) sm;
+	p_ctx->_dma_chan = (uint8_t) dma_chan;
+	p_ctx->_fill = 0u;
+	p_ctx->_n_words = 0u;
+	p_ctx->_busy = false;
+
+	_lcd_pio_load_program(p_ctx->pio, &(p_ctx->_offset));
+
+	/*The pins stay on SIO until the init nibble is sent (see _lcd_pio_send_init_nibble())*/
+	gpio_init(p_lcd->e);
+	gpio_init(p_lcd->rs);
+	gpio_init(p_lcd->db4);
+	gpio_init(p_lcd->db5);
+	gpio_init(p_lcd->db6);
+	gpio_init(p_lcd->db7);
+
+	gpio_set_dir(p_lcd->e, GPIO_OUT);
+	gpio_set_dir(p_lcd->rs, GPIO_OUT);
+	gpio_set_dir(p_lcd->db4, GPIO_OUT);
+	gpio_set_dir(p_lcd->db5, GPIO_OUT);
+	gpio_set_dir(p_lcd->db6, GPIO_OUT);
+	gpio_set_dir(p_lcd->db7, GPIO_OUT);
+
+	gpio_put(p_lcd->e, 0);
+
+	sm_cfg = pio_get_default_sm_config();
+	sm_config_set_wrap(&sm_cfg, p_ctx->_offset, p_ctx->_offset + __LCD_PIO_PROGRAM_LENGTH - 1u);
+	sm_config_set_out_pins(&sm_cfg, p_lcd->db4, 4u);
+	sm_config_set_set_pins(&sm_cfg, p_lcd->rs, 1u);
+	sm_config_set_sideset_pins(&sm_cfg, p_lcd->e);
+	sm_config_set_sideset(&sm_cfg, 2u, true, false);
+	sm_config_set_out_shift(&sm_cfg, true, false, 32u);
+	sm_config_set_fifo_join(&sm_cfg, PIO_FIFO_JOIN_TX);
+	sm_config_set_clkdiv(&sm_cfg, ((float) clock_get_hz(clk_sys))/((float) __LCD_PIO_SM_CLK_HZ));
+
+	pio_sm_set_consecutive_pindirs(p_ctx->pio, p_ctx->_sm, p_lcd->db4, 4u, true);
+	pio_sm_set_consecutive_pindirs(p_ctx->pio, p_ctx->_sm, p_lcd->rs, 1u, true);
+	pio_sm_set_consecutive_pindirs(p_ctx->pio, p_ctx->_sm, p_lcd->e, 1u, true);
+
+	pio_sm_init(p_ctx->pio, p_ctx->_sm, p_ctx->_offset, &sm_cfg);
+	pio_sm_set_enabled(p_ctx->pio, p_ctx->_sm, true);
+
+	dma_cfg = dma_channel_get_default_config(p_ctx->_dma_chan);
+	channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_32);
+	channel_config_set_read_increment(&dma_cfg, true);
+	channel_config_set_write_increment(&dma_cfg, false);
+	channel_config_set_dreq(&dma_cfg, pio_get_dreq(p_ctx->pio, p_ctx->_sm, true));
+	dma_channel_configure(p_ctx->_dma_chan, &dma_cfg, &(p_ctx->pio->txf[p_ctx->_sm]), p_ctx->_buf[0], 0u, false);
+
+	_lcd_pio_dma_ctx[p_ctx->_dma_chan] = p_ctx;
+	_lcd_pio_dma_pio[p_ctx->_dma_chan] = p_ctx->pio;
+	_lcd_pio_dma_sm[p_ctx->_dma_chan] = p_ctx->_sm;
+	dma_channel_set_irq0_enabled(p_ctx->_dma_chan, true);
+
+	if(!_lcd_pio_irq_installed)
+	{
+		irq_add_shared_handler(DMA_IRQ_0, _lcd_pio_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+		irq_set_enabled(DMA_IRQ_0, true);
+		_lcd_pio_irq_installed = true;
+	}
+
+	return true;
+}
+
+void _lcd_pio_release(const lcd_pio_t *p_ctx)
+{
+	uint dma_chan;
+
+	for(dma_chan = 0u; dma_chan < NUM_DMA_CHANNELS; dma_chan++)
+	{
+		if(_lcd_pio_dma_ctx[dma_chan] != p_ctx) continue;
+
+		dma_channel_set_irq0_enabled(dma_chan, false);
+		dma_channel_abort(dma_chan);
+		dma_channel_acknowledge_irq0(dma_chan);
+		_lcd_pio_dma_ctx[dma_chan] = NULL;
+		dma_channel_unclaim(dma_chan);
+
+		/*Claimed from the PIO block recorded at the time, in case "pio" changed since*/
+		pio_sm_set_enabled(_lcd_pio_dma_pio[dma_chan], _lcd_pio_dma_sm[dma_chan], false);
+		pio_sm_unclaim(_lcd_pio_dma_pio[dma_chan], _lcd_pio_dma_sm[dma_chan]);
+	}
+
+	return;
+}
+
+void _lcd_pio_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	lcd_pio_t *p_ctx;
+
+	p_ctx = (lcd_pio_t*) p_lcd->transport_ctx;
+
+	/*A lone nibble doesn't fit the state machine byte format, so it is bit-banged before the pins are handed over*/
+	gpio_put(p_lcd->rs, 0);
+	gpio_put(p_lcd->db4, (nibble & 0x1));
+	gpio_put(p_lcd->db5, (nibble & 0x2));
+	gpio_put(p_lcd->db6, (nibble & 0x4));
+	gpio_put(p_lcd->db7, (nibble & 0x8));
+	sleep_us(1u);
+
+	gpio_put(p_lcd->e, 1);
+	sleep_us(1u);
+	gpio_put(p_lcd->e, 0);
+	sleep_us(delay_us);
+
+	pio_gpio_init(p_ctx->pio, p_lcd->e);
+	pio_gpio_init(p_ctx->pio, p_lcd->rs);
+	pio_gpio_init(p_ctx->pio, p_lcd->db4);
+	pio_gpio_init(p_ctx->pio, p_lcd->db5);
+	pio_gpio_init(p_ctx->pio, p_lcd->db6);
+	pio_gpio_init(p_ctx->pio, p_lcd->db7);
+
+	return;
+}
+
+/*
+ * Word format (shifted out LSB first):
+ * bit 0: RS
+ * bits 1-4: high nibble (DB4-DB7)
+ * bits 5-8: low nibble (DB4-DB7)
+ * bits 9-31: execution time (us)
+ */
+
+void _lcd_pio_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	lcd_pio_t *p_ctx;
+	uint32_t word;
+	uint32_t irq_status;
+
+	p_ctx = (lcd_pio_t*) p_lcd->transport_ctx;
+
+	word = (reg ? 0x1 : 0x0);
+	word |= (((uint32_t) (byte >> 4)) << 1);
+	word |= (((uint32_t) (byte & 0xf)) << 5);
+	word |= (((uint32_t) delay_us) << 9);
+
+	while(true)
+	{
+		irq_status = save_and_disable_interrupts();
+		if(p_ctx->_n_words < LCD_CFG_PIO_BUFFER_WORDS) break;
+
+		/*Both buffers full: wait for the DMA to take the one being filled*/
+		restore_interrupts(irq_status);
+		tight_loop_contents();
+	}
+
+	p_ctx->_buf[p_ctx->_fill][p_ctx->_n_words] = word;
+	p_ctx->_n_words++;
+
+	if(!p_ctx->_busy) _lcd_pio_start_dma(p_ctx);
+
+	restore_interrupts(irq_status);
+	return;
+}
+
+/*
+ * .side_set 1 opt			(E)
+ * 0:	pull block		side 0
+ * 1:	out x, 1			(RS)
+ * 2:	jmp !x, 5
+ * 3:	set pins, 1
+ * 4:	jmp 6
+ * 5:	set pins, 0
+ * 6:	out pins, 4			(high nibble)
+ * 7:	nop			side 1
+ * 8:	nop			side 0
+ * 9:	out pins, 4			(low nibble)
+ * 10:	nop			side 1
+ * 11:	nop			side 0
+ * 12:	out y, 23			(execution time)
+ * 13:	jmp y--, 13
+ */
+
+void _lcd_pio_load_program(PIO pio, uint8_t *p_offset)
+{
+	static uint16_t instructions[__LCD_PIO_PROGRAM_LENGTH];
+	uint pio_index;
+	struct pio_program program;
+
+	pio_index = pio_get_index(pio);
+
+	if(!_lcd_pio_program_loaded[pio_index])
+	{
+		instructions[0] = pio_encode_pull(false, true) | pio_encode_sideset_opt(1u, 0u);
+		instructions[1] = pio_encode_out(pio_x, 1u);
+		instructions[2] = pio_encode_jmp_not_x(5u);
+		instructions[3] = pio_encode_set(pio_pins, 1u);
+		instructions[4] = pio_encode_jmp(6u);
+		instructions[5] = pio_encode_set(pio_pins, 0u);
+		instructions[6] = pio_encode_out(pio_pins, 4u);
+		instructions[7] = pio_encode_nop() | pio_encode_sideset_opt(1u, 1u);
+		instructions[8] = pio_encode_nop() | pio_encode_sideset_opt(1u, 0u);
+		instructions[9] = pio_encode_out(pio_pins, 4u);
+		instructions[10] = pio_encode_nop() | pio_encode_sideset_opt(1u, 1u);
+		instructions[11] = pio_encode_nop() | pio_encode_sideset_opt(1u, 0u);
+		instructions[12] = pio_encode_out(pio_y, 23u);
+		instructions[13] = pio_encode_jmp_y_dec(13u);
+
+		memset(&program, 0, sizeof(struct pio_program));
+		program.instructions = instructions;
+		program.length = __LCD_PIO_PROGRAM_LENGTH;
+		program.origin = -1;
+
+		/*pio_add_program() relocates the jmp targets*/
+		_lcd_pio_program_offset[pio_index] = (uint8_t) pio_add_program(pio, &program);
+		_lcd_pio_program_loaded[pio_index] = true;
+	}
+
+	*p_offset = _lcd_pio_program_offset[pio_index];
+	return;
+}
+
+/*Must be called with interrupts disabled or from the DMA interrupt*/
+void _lcd_pio_start_dma(lcd_pio_t *p_ctx)
+{
+	uint32_t *p_buf;
+	uint16_t n_words;
+
+	if(!p_ctx->_n_words)
+	{
+		p_ctx->_busy = false;
+		return;
+	}
+
+	p_buf = p_ctx->_buf[p_ctx->_fill];
+	n_words = p_ctx->_n_words;
+
+	p_ctx->_fill ^= 1u;
+	p_ctx->_n_words = 0u;
+	p_ctx->_busy = true;
+
+	dma_channel_transfer_from_buffer_now(p_ctx->_dma_chan, p_buf, n_words);
+	return;
+}
+
+void _lcd_pio_dma_irq_handler(void)
+{
+	uint dma_chan;
+
+	for(dma_chan = 0u; dma_chan < NUM_DMA_CHANNELS; dma_chan++)
+	{
+		if(_lcd_pio_dma_ctx[dma_chan] == NULL) continue;
+		if(!dma_channel_get_irq0_status(dma_chan)) continue;
+
+		dma_channel_acknowledge_irq0(dma_chan);
+		_lcd_pio_start_dma(_lcd_pio_dma_ctx[dma_chan]);
+	}
+
+	return;
+}
@@ -0,0 +1,71 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * PIO + DMA bus transport.
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_PIO_H
+#define LCD_PIO_H
+
+#include "lcd.h"
+
+#include "hardware/pio.h"
+
+/*
+ * LCD_CFG_PIO_BUFFER_WORDS
+ * Size of each of the two DMA buffers, in bytes sent to the display. Each entry takes 4 bytes.
+ * The default holds a full 20x4 screen refresh, so a refresh never waits for the bus.
+ */
+
+#ifndef LCD_CFG_PIO_BUFFER_WORDS
+#define LCD_CFG_PIO_BUFFER_WORDS 96U
+#endif
+
+/*
+ * A PIO state machine generates the RS/DB4-DB7/E waveform and the instruction execution time of every byte.
+ * A DMA channel feeds it from a double buffer: lcd_*() calls only append to the buffer being filled
+ * while the other one is streamed into the state machine TX FIFO.
+ *
+ * Requirements:
+ * DB4, DB5, DB6 and DB7 must be consecutive GPIO pins (DB5 = DB4 + 1, ...). RS and E can be any pin.
+ * Displays sharing data pins can't use this transport (each state machine drives its pins permanently), see lcd_bus.h.
+ *
+ * Usage:
+ * lcd_pio_t lcd_pio = {.pio = pio0};
+ * lcd_t lcd = {.db4 = 6, ..., .transport = &lcd_transport_pio, .transport_ctx = &lcd_pio};
+ */
+
+struct _lcd_pio {
+	PIO pio;					/*PIO BLOCK (pio0 OR pio1)*/
+	uint8_t _sm;					/*IGNORE (INTERNAL USE)*/
+	uint8_t _dma_chan;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _offset;				/*IGNORE (INTERNAL USE)*/
+	volatile uint8_t _fill;				/*IGNORE (INTERNAL USE)*/
+	volatile uint16_t _n_words;			/*IGNORE (INTERNAL USE)*/
+	volatile bool _busy;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _buf[2][LCD_CFG_PIO_BUFFER_WORDS];	/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_pio lcd_pio_t;
+
+extern const struct _lcd_transport lcd_transport_pio;
+
+/*
+ * lcd_pio_is_idle()
+ * returns true if every queued byte was sent and the display finished executing the last instruction, false otherwise.
+ */
+
+extern bool lcd_pio_is_idle(const lcd_t *p_lcd);
+
+/*
+ * lcd_pio_wait_idle()
+ * waits until lcd_pio_is_idle() is true.
+ */
+
+extern void lcd_pio_wait_idle(const lcd_t *p_lcd);
+
+#endif /*LCD_PIO_H*/
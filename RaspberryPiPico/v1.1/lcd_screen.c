@@ -0,0 +1,252 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Screen layouts (static text and dynamic fields declared once, updated with the fewest bytes).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_screen.h"
+
+#include <string.h>
+
+extern bool _lcd_screen_validate(const lcd_t *p_lcd, const lcd_screen_layout_t *p_layout);
+extern void _lcd_screen_draw_line(lcd_t *p_lcd, const lcd_screen_layout_t *p_layout, uint8_t cy);
+extern void _lcd_screen_print_field(lcd_screen_t *p_screen, uint8_t field_id);
+extern void _lcd_screen_print_text(lcd_t *p_lcd, const lcd_screen_field_t *p_field, const char *text);
+
+/*lcd.c internals: lazy cursor, field output and the RAM shadow*/
+extern bool _lcd_set_cursor_lazy(lcd_t *p_lcd, uint8_t cx, uint8_t cy);
+extern void _lcd_put_field(lcd_t *p_lcd, const uint8_t *p_field, uint8_t len);
+extern void _lcd_transport_flush(lcd_t *p_lcd);
+extern uint8_t _lcd_ddram_addr_to_idx(uint8_t addr);
+extern bool _lcd_phys_text_cx_cy_to_ddram_addr(const lcd_t *p_lcd, uint8_t *p_addr, uint8_t physcx, uint8_t physcy);
+
+bool lcd_screen_set_layout(lcd_screen_t *p_screen, const lcd_screen_layout_t *p_layout)
+{
+	lcd_t *p_lcd;
+	uint8_t cy;
+
+	if(p_screen == NULL) return false;
+	if(p_layout == NULL) return false;
+
+	p_lcd = p_screen->lcd;
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+
+	if(!_lcd_screen_validate(p_lcd, p_layout)) return false;
+
+	p_screen->_layout = p_layout;
+	p_screen->_set = 0u;
+
+	if(p_layout->n_fields < 32u) p_screen->_dirty = ((1u << p_layout->n_fields) - 1u);
+	else p_screen->_dirty = 0xffffffffU;
+
+	for(cy = 0u; cy < p_lcd->n_lines; cy++) _lcd_screen_draw_line(p_lcd, p_layout, cy);
+
+	_lcd_transport_flush(p_lcd);
+	return true;
+}
+
+bool lcd_screen_set_field(lcd_screen_t *p_screen, uint8_t field_id, int32_t value)
+{
+	uint32_t mask;
+
+	if(p_screen == NULL) return false;
+	if(p_screen->_layout == NULL) return false;
+	if(field_id >= p_screen->_layout->n_fields) return false;
+	if(p_screen->_layout->fields[field_id].format == LCD_FIELD_TEXT) return false;
+
+	mask = (1u << field_id);
+
+	if((p_screen->_set & mask) && (p_screen->_values[field_id].num == value)) return true;
+
+	p_screen->_values[field_id].num = value;
+	p_screen->_set |= mask;
+	p_screen->_dirty |= mask;
+
+	return true;
+}
+
+bool lcd_screen_set_field_text(lcd_screen_t *p_screen, uint8_t field_id, const char *text)
+{
+	if(p_screen == NULL) return false;
+	if(p_screen->_layout == NULL) return false;
+	if(text == NULL) return false;
+	if(field_id >= p_screen->_layout->n_fields) return false;
+	if(p_screen->_layout->fields[field_id].format != LCD_FIELD_TEXT) return false;
+
+	/*The text may have changed in place: the update finds out which characters did*/
+	p_screen->_values[field_id].text = text;
+	p_screen->_set |= (1u << field_id);
+	p_screen->_dirty |= (1u << field_id);
+
+	return true;
+}
+
+bool lcd_screen_update(lcd_screen_t *p_screen)
+{
+	uint8_t field_id;
+
+	if(p_screen == NULL) return false;
+	if(p_screen->_layout == NULL) return false;
+	if(p_screen->lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+
+	for(field_id = 0u; field_id < p_screen->_layout->n_fields; field_id++)
+	{
+		if(!(p_screen->_dirty & (1u << field_id))) continue;
+
+		_lcd_screen_print_field(p_screen, field_id);
+	}
+
+	p_screen->_dirty = 0u;
+
+	_lcd_transport_flush(p_screen->lcd);
+	return true;
+}
+
+bool _lcd_screen_validate(const lcd_t *p_lcd, const lcd_screen_layout_t *p_layout)
+{
+	const lcd_screen_text_t *p_text;
+	const lcd_screen_field_t *p_field;
+	uint8_t n_item;
+
+	if(p_layout->n_fields > LCD_CFG_SCREEN_MAX_FIELDS) return false;
+	if(p_layout->n_texts && (p_layout->texts == NULL)) return false;
+	if(p_layout->n_fields && (p_layout->fields == NULL)) return false;
+
+	for(n_item = 0u; n_item < p_layout->n_texts; n_item++)
+	{
+		p_text = &(p_layout->texts[n_item]);
+
+		if(p_text->text == NULL) return false;
+		if(p_text->cy >= p_lcd->n_lines) return false;
+		if(p_text->cx >= p_lcd->n_chars) return false;
+		if(strlen(p_text->text) > (uintptr_t) (p_lcd->n_chars - p_text->cx)) return false;
+	}
+
+	for(n_item = 0u; n_item < p_layout->n_fields; n_item++)
+	{
+		p_field = &(p_layout->fields[n_item]);
+
+		if(p_field->cy >= p_lcd->n_lines) return false;
+		if(!p_field->width || (p_field->cx >= p_lcd->n_chars)) return false;
+		if(p_field->width > (p_lcd->n_chars - p_field->cx)) return false;
+		if(p_field->format > LCD_FIELD_TEXT) return false;
+		if(p_field->n_decimals > 9u) return false;
+		if((p_field->align != LCD_ALIGN_RIGHT) && (p_field->align != LCD_ALIGN_LEFT)) return false;
+	}
+
+	return true;
+}
+
+/*
+ * Line "cy" as the layout wants it: static texts, blanks, and the field cells as they are (the update prints them).
+ * Only the cells that differ from the RAM shadow are sent, so the texts both layouts share cost nothing.
+ */
+
+void _lcd_screen_draw_line(lcd_t *p_lcd, const lcd_screen_layout_t *p_layout, uint8_t cy)
+{
+	uint8_t line[LCD_DDRAM_LINE_SIZE];
+	const lcd_screen_text_t *p_text;
+	const lcd_screen_field_t *p_field;
+	uint8_t n_item;
+#if LCD_CFG_FRAMEBUFFER
+	uint8_t addr;
+	uint8_t idx;
+#endif
+
+	memset(line, ' ', p_lcd->n_chars);
+
+#if LCD_CFG_FRAMEBUFFER
+	_lcd_phys_text_cx_cy_to_ddram_addr(p_lcd, &addr, 0u, cy);
+	idx = _lcd_ddram_addr_to_idx(addr);
+
+	for(n_item = 0u; n_item < p_layout->n_fields; n_item++)
+	{
+		p_field = &(p_layout->fields[n_item]);
+		if(p_field->cy != cy) continue;
+
+		memcpy(&(line[p_field->cx]), &(p_lcd->_fb[idx + p_field->cx]), p_field->width);
+	}
+#else
+	(void) p_field;
+#endif
+
+	for(n_item = 0u; n_item < p_layout->n_texts; n_item++)
+	{
+		p_text = &(p_layout->texts[n_item]);
+		if(p_text->cy != cy) continue;
+
+		memcpy(&(line[p_text->cx]), p_text->text, strlen(p_text->text));
+	}
+
+	_lcd_set_cursor_lazy(p_lcd, 0u, cy);
+	_lcd_put_field(p_lcd, line, p_lcd->n_chars);
+
+	return;
+}
+
+void _lcd_screen_print_field(lcd_screen_t *p_screen, uint8_t field_id)
+{
+	const lcd_screen_field_t *p_field;
+	uint8_t blank[LCD_DDRAM_LINE_SIZE];
+	int32_t value;
+
+	p_field = &(p_screen->_layout->fields[field_id]);
+	value = p_screen->_values[field_id].num;
+
+	_lcd_set_cursor_lazy(p_screen->lcd, p_field->cx, p_field->cy);
+
+	/*Not set since the layout was selected*/
+	if(!(p_screen->_set & (1u << field_id)))
+	{
+		memset(blank, ' ', p_field->width);
+		_lcd_put_field(p_screen->lcd, blank, p_field->width);
+		return;
+	}
+
+	switch(p_field->format)
+	{
+		case LCD_FIELD_UINT:
+			lcd_print_uint(p_screen->lcd, (uint32_t) value, p_field->width, p_field->align, p_field->pad);
+			break;
+
+		case LCD_FIELD_INT:
+			lcd_print_int(p_screen->lcd, value, p_field->width, p_field->align, p_field->pad);
+			break;
+
+		case LCD_FIELD_FIXED:
+			lcd_print_fixed(p_screen->lcd, value, p_field->n_decimals, p_field->width, p_field->align, p_field->pad);
+			break;
+
+		case LCD_FIELD_HEX:
+			lcd_print_hex(p_screen->lcd, (uint32_t) value, p_field->width, p_field->align, p_field->pad);
+			break;
+
+		case LCD_FIELD_TEXT:
+			_lcd_screen_print_text(p_screen->lcd, p_field, p_screen->_values[field_id].text);
+			break;
+	}
+
+	return;
+}
+
+void _lcd_screen_print_text(lcd_t *p_lcd, const lcd_screen_field_t *p_field, const char *text)
+{
+	uint8_t field[LCD_DDRAM_LINE_SIZE];
+	uint8_t len;
+
+	len = 0u;
+	while((len < p_field->width) && (text[len] != '\0')) len++;
+
+	memset(field, p_field->pad, p_field->width);
+
+	if(p_field->align == LCD_ALIGN_LEFT) memcpy(field, text, len);
+	else memcpy(&(field[p_field->width - len]), text, len);
+
+	_lcd_put_field(p_lcd, field, p_field->width);
+	return;
+}
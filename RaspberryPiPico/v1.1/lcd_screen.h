@@ -0,0 +1,141 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * Screen layouts (static text and dynamic fields declared once, updated with the fewest bytes).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_SCREEN_H
+#define LCD_SCREEN_H
+
+#include "lcd.h"
+
+/*
+ * LCD_CFG_SCREEN_MAX_FIELDS
+ * Maximum number of fields in a layout (up to 32). Each field takes 4 bytes in the lcd_screen_t.
+ */
+
+#ifndef LCD_CFG_SCREEN_MAX_FIELDS
+#define LCD_CFG_SCREEN_MAX_FIELDS 16U
+#endif
+
+#if (LCD_CFG_SCREEN_MAX_FIELDS > 32U)
+#error "lcd_screen.h: LCD_CFG_SCREEN_MAX_FIELDS must be 32 or less"
+#endif
+
+/*
+ * A layout is a const table of static texts and fields, each at a fixed position.
+ * Fields are identified by their index in the field table (an enum of field names, typically).
+ *
+ * lcd_screen_set_layout() draws the static texts of a layout and blanks the cells no longer used,
+ * sending only the cells that differ from what the previous layout left on the display (no clear).
+ * lcd_screen_set_field() only stores a value and marks its field dirty: lcd_screen_update() then prints every dirty field,
+ * sending only the characters that changed (see lcd_print_uint()). Fields not set since the layout was selected are blank.
+ *
+ * The diff relies on the RAM shadow of the display (LCD_CFG_FRAMEBUFFER), otherwise layout switches and fields are sent whole.
+ *
+ * Usage:
+ * enum {FIELD_TEMP, FIELD_STATE};
+ * static const lcd_screen_text_t main_texts[] = {{0, 0, "Temp:"}, {11, 0, "C"}};
+ * static const lcd_screen_field_t main_fields[] = {
+ * 	[FIELD_TEMP] = {.cx = 5, .cy = 0, .width = 5, .format = LCD_FIELD_FIXED, .n_decimals = 1, .align = LCD_ALIGN_RIGHT, .pad = ' '},
+ * 	[FIELD_STATE] = {.cx = 0, .cy = 1, .width = 8, .format = LCD_FIELD_TEXT, .align = LCD_ALIGN_LEFT, .pad = ' '}
+ * };
+ * static const lcd_screen_layout_t main_layout = {main_texts, 2, main_fields, 2};
+ *
+ * lcd_screen_t screen = {.lcd = &lcd};
+ * lcd_screen_set_layout(&screen, &main_layout);
+ * lcd_screen_set_field(&screen, FIELD_TEMP, 215);
+ * lcd_screen_update(&screen);
+ */
+
+#define LCD_FIELD_UINT 0
+#define LCD_FIELD_INT 1
+#define LCD_FIELD_FIXED 2
+#define LCD_FIELD_HEX 3
+#define LCD_FIELD_TEXT 4
+
+struct _lcd_screen_text {
+	uint8_t cx;		/*HORIZONTAL POSITION*/
+	uint8_t cy;		/*LINE*/
+	const char *text;	/*TEXT (MUST FIT IN THE LINE)*/
+};
+
+struct _lcd_screen_field {
+	uint8_t cx;		/*HORIZONTAL POSITION*/
+	uint8_t cy;		/*LINE*/
+	uint8_t width;		/*NUMBER OF CHARACTERS (MUST FIT IN THE LINE)*/
+	uint8_t format;		/*LCD_FIELD_UINT, LCD_FIELD_INT, LCD_FIELD_FIXED, LCD_FIELD_HEX OR LCD_FIELD_TEXT*/
+	uint8_t n_decimals;	/*DECIMALS OF LCD_FIELD_FIXED*/
+	uint8_t align;		/*LCD_ALIGN_RIGHT OR LCD_ALIGN_LEFT*/
+	char pad;		/*PADDING CHARACTER*/
+};
+
+struct _lcd_screen_layout {
+	const struct _lcd_screen_text *texts;
+	uint8_t n_texts;
+	const struct _lcd_screen_field *fields;
+	uint8_t n_fields;
+};
+
+typedef struct _lcd_screen_text lcd_screen_text_t;
+typedef struct _lcd_screen_field lcd_screen_field_t;
+typedef struct _lcd_screen_layout lcd_screen_layout_t;
+
+union _lcd_screen_value {
+	int32_t num;
+	const char *text;
+};
+
+struct _lcd_screen {
+	lcd_t *lcd;								/*DISPLAY*/
+	const lcd_screen_layout_t *_layout;					/*IGNORE (INTERNAL USE)*/
+	uint32_t _dirty;							/*IGNORE (INTERNAL USE)*/
+	uint32_t _set;								/*IGNORE (INTERNAL USE)*/
+	union _lcd_screen_value _values[LCD_CFG_SCREEN_MAX_FIELDS];		/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_screen lcd_screen_t;
+
+/*
+ * lcd_screen_set_layout()
+ * selects "p_layout" (which must outlive its use) and draws its static texts. Every field is left unset and dirty.
+ * The display must be initialized. The layout is checked first: nothing is drawn if any text or field doesn't fit.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_screen_set_layout(lcd_screen_t *p_screen, const lcd_screen_layout_t *p_layout);
+
+/*
+ * lcd_screen_set_field()
+ * sets the value of a numeric field (LCD_FIELD_UINT and LCD_FIELD_HEX read it as uint32_t). Nothing is sent.
+ * An unchanged value doesn't mark the field dirty.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_screen_set_field(lcd_screen_t *p_screen, uint8_t field_id, int32_t value);
+
+/*
+ * lcd_screen_set_field_text()
+ * sets the text of a LCD_FIELD_TEXT field (which must outlive the next lcd_screen_update()), cut to the field width. Nothing is sent.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_screen_set_field_text(lcd_screen_t *p_screen, uint8_t field_id, const char *text);
+
+/*
+ * lcd_screen_update()
+ * prints the fields set since the last update.
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_screen_update(lcd_screen_t *p_screen);
+
+#endif /*LCD_SCREEN_H*/
@@ -0,0 +1,243 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * 74HC595 shift register transport (hardware SPI).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#include "lcd_spi.h"
+
+#include "lcd_hal.h"
+
+#define __LCD_SPI_RS 0x01U
+#define __LCD_SPI_RW 0x02U
+#define __LCD_SPI_E 0x04U
+#define __LCD_SPI_BL 0x08U
+
+#define __LCD_SPI_DEFAULT_BAUDRATE 4000000U
+
+#define __LCD_SPI_BITS_PER_FRAME 8U
+
+/*Longer waits than this many idle frames are done after the burst instead*/
+#define __LCD_SPI_MAX_IDLE_FRAMES 32U
+
+extern bool _lcd_spi_init(lcd_t *p_lcd);
+extern void _lcd_spi_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us);
+extern void _lcd_spi_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us);
+extern void _lcd_spi_flush(lcd_t *p_lcd);
+extern void _lcd_spi_put(lcd_spi_t *p_ctx, uint8_t frame);
+extern void _lcd_spi_put_nibble(lcd_spi_t *p_ctx, uint8_t nibble);
+extern void _lcd_spi_wait_pending(lcd_spi_t *p_ctx);
+extern void _lcd_spi_write(lcd_spi_t *p_ctx);
+
+const struct _lcd_transport lcd_transport_spi = {
+	.init = _lcd_spi_init,
+	.send_init_nibble = _lcd_spi_send_init_nibble,
+	.send_byte = _lcd_spi_send_byte,
+	.flush = _lcd_spi_flush
+};
+
+bool lcd_spi_set_backlight(lcd_t *p_lcd, bool on)
+{
+	lcd_spi_t *p_ctx;
+
+	if(p_lcd == NULL) return false;
+	if(p_lcd->_status != __LCD_STATUS_INITIALIZED) return false;
+	if(p_lcd->transport != &lcd_transport_spi) return false;
+
+	p_ctx = (lcd_spi_t*) p_lcd->transport_ctx;
+
+	if(on) p_ctx->_ctrl = __LCD_SPI_BL;
+	else p_ctx->_ctrl = 0u;
+
+	/*E low: the display doesn't see this frame*/
+	_lcd_spi_put(p_ctx, (p_ctx->_ctrl | p_ctx->_rs));
+	_lcd_spi_write(p_ctx);
+
+	return true;
+}
+
+uint32_t lcd_spi_get_bytes_per_sec(const lcd_t *p_lcd)
+{
+	const lcd_spi_t *p_ctx;
+
+	if(p_lcd == NULL) return 0u;
+	if(p_lcd->transport != &lcd_transport_spi) return 0u;
+
+	p_ctx = (const lcd_spi_t*) p_lcd->transport_ctx;
+	if(!p_ctx->_t_bus_us) return 0u;
+
+	return (uint32_t) ((((uint64_t) p_ctx->_n_sent)*1000000ULL)/(p_ctx->_t_bus_us));
+}
+
+bool _lcd_spi_init(lcd_t *p_lcd)
+{
+	lcd_spi_t *p_ctx;
+	uint32_t baudrate;
+
+	p_ctx = (lcd_spi_t*) p_lcd->transport_ctx;
+	if(p_ctx == NULL) return false;
+	if(p_ctx->spi == NULL) return false;
+
+	baudrate = p_ctx->baudrate;
+	if(!baudrate) baudrate = __LCD_SPI_DEFAULT_BAUDRATE;
+
+	baudrate = spi_init(p_ctx->spi, baudrate);
+
+	/*Mode 0: CSn (RCLK) goes high after every frame*/
+	spi_set_format(p_ctx->spi, __LCD_SPI_BITS_PER_FRAME, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+
+	gpio_set_function(p_ctx->sck, GPIO_FUNC_SPI);
+	gpio_set_function(p_ctx->tx, GPIO_FUNC_SPI);
+	gpio_set_function(p_ctx->csn, GPIO_FUNC_SPI);
+
+	p_ctx->_ctrl = __LCD_SPI_BL;
+	p_ctx->_rs = 0u;
+	p_ctx->_n_frames = 0u;
+	p_ctx->_pending_us = 0u;
+	p_ctx->_frame_ns = (uint32_t) ((((uint64_t) __LCD_SPI_BITS_PER_FRAME)*1000000000ULL)/baudrate);
+	p_ctx->_n_sent = 0u;
+	p_ctx->_t_bus_us = 0u;
+
+	/*E low before the init nibble*/
+	_lcd_spi_put(p_ctx, p_ctx->_ctrl);
+	_lcd_spi_write(p_ctx);
+
+	return true;
+}
+
+void _lcd_spi_send_init_nibble(lcd_t *p_lcd, uint8_t nibble, uint16_t delay_us)
+{
+	lcd_spi_t *p_ctx;
+
+	p_ctx = (lcd_spi_t*) p_lcd->transport_ctx;
+
+	_lcd_spi_wait_pending(p_ctx);
+
+	p_ctx->_rs = 0u;
+	_lcd_spi_put(p_ctx, ((nibble << 4) | p_ctx->_ctrl));
+	_lcd_spi_put_nibble(p_ctx, (nibble << 4));
+	_lcd_spi_write(p_ctx);
+
+	sleep_us(delay_us);
+	return;
+}
+
+/*
+ * Frames per display byte:
+ * [RS setup, only if RS changed] [high nibble | E] [high nibble] [low nibble | E] [low nibble] [idle frames...]
+ * The display latches each nibble on the E falling edge.
+ */
+
+void _lcd_spi_send_byte(lcd_t *p_lcd, bool reg, uint8_t byte, uint16_t delay_us)
+{
+	lcd_spi_t *p_ctx;
+	uint8_t rs;
+
+	p_ctx = (lcd_spi_t*) p_lcd->transport_ctx;
+
+	_lcd_spi_wait_pending(p_ctx);
+
+	if(reg) rs = __LCD_SPI_RS;
+	else rs = 0u;
+
+	/*RS must be stable before E rises*/
+	if(rs != p_ctx->_rs)
+	{
+		p_ctx->_rs = rs;
+		_lcd_spi_put(p_ctx, ((byte & 0xf0) | p_ctx->_ctrl | rs));
+	}
+
+	_lcd_spi_put_nibble(p_ctx, (byte & 0xf0));
+	_lcd_spi_put_nibble(p_ctx, (byte << 4));
+
+	p_ctx->_pending_us = delay_us;
+	p_ctx->_n_sent++;
+
+	return;
+}
+
+void _lcd_spi_flush(lcd_t *p_lcd)
+{
+	_lcd_spi_write((lcd_spi_t*) p_lcd->transport_ctx);
+	return;
+}
+
+void _lcd_spi_put(lcd_spi_t *p_ctx, uint8_t frame)
+{
+	if(p_ctx->_n_frames >= LCD_CFG_SPI_BUFFER_SIZE) _lcd_spi_write(p_ctx);
+
+	p_ctx->_buf[p_ctx->_n_frames] = frame;
+	p_ctx->_n_frames++;
+
+	return;
+}
+
+void _lcd_spi_put_nibble(lcd_spi_t *p_ctx, uint8_t nibble)
+{
+	nibble &= 0xf0;
+
+	_lcd_spi_put(p_ctx, (nibble | p_ctx->_ctrl | p_ctx->_rs | __LCD_SPI_E));
+	_lcd_spi_put(p_ctx, (nibble | p_ctx->_ctrl | p_ctx->_rs));
+
+	return;
+}
+
+/*
+ * Makes sure the previous instruction finished executing before the next E falling edge.
+ * The next byte latches its first nibble 2 frames after the last one queued, so only the rest needs waiting for:
+ * idle frames (E low) in the same burst, or a sleep after the burst for clear/home.
+ */
+
+void _lcd_spi_wait_pending(lcd_spi_t *p_ctx)
+{
+	uint32_t wait_ns;
+	uint32_t n_idle;
+	uint32_t t_start;
+	uint8_t idle;
+
+	if(!p_ctx->_pending_us) return;
+
+	wait_ns = ((uint32_t) p_ctx->_pending_us)*1000u;
+	p_ctx->_pending_us = 0u;
+
+	if(wait_ns <= 2u*(p_ctx->_frame_ns)) return;
+
+	wait_ns -= 2u*(p_ctx->_frame_ns);
+	n_idle = (wait_ns + p_ctx->_frame_ns - 1u)/(p_ctx->_frame_ns);
+
+	if(n_idle > __LCD_SPI_MAX_IDLE_FRAMES)
+	{
+		_lcd_spi_write(p_ctx);
+
+		t_start = time_us_32();
+		sleep_us((wait_ns + 999u)/1000u);
+		p_ctx->_t_bus_us += (uint32_t) (time_us_32() - t_start);
+
+		return;
+	}
+
+	if(p_ctx->_n_frames) idle = p_ctx->_buf[p_ctx->_n_frames - 1u];
+	else idle = (p_ctx->_ctrl | p_ctx->_rs);
+
+	while(n_idle--) _lcd_spi_put(p_ctx, idle);
+
+	return;
+}
+
+void _lcd_spi_write(lcd_spi_t *p_ctx)
+{
+	uint32_t t_start;
+
+	if(!p_ctx->_n_frames) return;
+
+	t_start = time_us_32();
+	spi_write_blocking(p_ctx->spi, p_ctx->_buf, p_ctx->_n_frames);
+	p_ctx->_t_bus_us += (uint32_t) (time_us_32() - t_start);
+
+	p_ctx->_n_frames = 0u;
+	return;
+}
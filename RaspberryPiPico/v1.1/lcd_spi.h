@@ -0,0 +1,85 @@
+/*
+ * Generic Alphanumeric LCD display driver for Raspberry Pi Pico
+ * Version 1.1
+ *
+ * 74HC595 shift register transport (hardware SPI).
+ *
+ * Author: Rafael Sabe
+ * Email: rafaelmsabe@gmail.com
+ */
+
+#ifndef LCD_SPI_H
+#define LCD_SPI_H
+
+#include "lcd.h"
+
+#include "lcd_hal.h"
+
+#if !defined(LCD_HAL_HOST)
+#include "hardware/spi.h"
+#endif
+
+/*
+ * LCD_CFG_SPI_BUFFER_SIZE
+ * Maximum number of shift register frames sent in a single burst.
+ */
+
+#ifndef LCD_CFG_SPI_BUFFER_SIZE
+#define LCD_CFG_SPI_BUFFER_SIZE 512U
+#endif
+
+/*
+ * Shift register pinout (same as the I2C backpack):
+ * Q0 = RS, Q1 = R/W (always low), Q2 = E, Q3 = backlight, Q4-Q7 = DB4-DB7.
+ * SPI TX -> SER, SPI SCK -> SRCLK, SPI CSn -> RCLK.
+ *
+ * In SPI mode 0 the hardware pulses CSn after every frame, so each byte is latched to the outputs without any CPU help.
+ * Every byte sent by an lcd_*() call becomes an E high/E low frame sequence, padded with idle frames (E low) covering
+ * the instruction execution times, and the whole buffer is clocked out in a single spi_write_blocking() burst.
+ * Clear/home execution times are waited for after the burst instead.
+ *
+ * The transport initializes the SPI block (spi_init()) and the SCK/TX/CSn pins.
+ * The lcd_t GPIO pin fields are not used.
+ *
+ * Usage:
+ * lcd_spi_t lcd_spi = {.spi = spi0, .sck = 2, .tx = 3, .csn = 5};
+ * lcd_t lcd = {.n_chars = 20, .n_lines = 4, .transport = &lcd_transport_spi, .transport_ctx = &lcd_spi};
+ */
+
+struct _lcd_spi {
+	spi_inst_t *spi;				/*SPI BLOCK (spi0 OR spi1)*/
+	uint8_t sck;					/*SCK GPIO PIN (74HC595 SRCLK)*/
+	uint8_t tx;					/*TX GPIO PIN (74HC595 SER)*/
+	uint8_t csn;					/*CSn GPIO PIN (74HC595 RCLK)*/
+	uint32_t baudrate;				/*SPI CLOCK IN HZ (0 FOR 4MHz)*/
+	uint8_t _ctrl;					/*IGNORE (INTERNAL USE)*/
+	uint8_t _rs;					/*IGNORE (INTERNAL USE)*/
+	uint16_t _n_frames;				/*IGNORE (INTERNAL USE)*/
+	uint16_t _pending_us;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _frame_ns;				/*IGNORE (INTERNAL USE)*/
+	uint32_t _n_sent;				/*IGNORE (INTERNAL USE)*/
+	uint64_t _t_bus_us;				/*IGNORE (INTERNAL USE)*/
+	uint8_t _buf[LCD_CFG_SPI_BUFFER_SIZE];		/*IGNORE (INTERNAL USE)*/
+};
+
+typedef struct _lcd_spi lcd_spi_t;
+
+extern const struct _lcd_transport lcd_transport_spi;
+
+/*
+ * lcd_spi_set_backlight()
+ * turns the backlight on/off (the backlight is on after lcd_init()).
+ *
+ * returns true if successful, false otherwise.
+ */
+
+extern bool lcd_spi_set_backlight(lcd_t *p_lcd, bool on);
+
+/*
+ * lcd_spi_get_bytes_per_sec()
+ * returns the achieved display throughput: bytes sent to the display per second of bus time (bursts and execution waits).
+ */
+
+extern uint32_t lcd_spi_get_bytes_per_sec(const lcd_t *p_lcd);
+
+#endif /*LCD_SPI_H*/